@@ -0,0 +1,109 @@
+/*
+ * Setup and frame time of ARTI-FX programs (usermods/artifx): parse tree interpreter vs. bytecode
+ *
+ *   g++ -O2 -std=c++17 -I tools/arti_bench -o /tmp/arti_bench tools/arti_bench/arti_bench.cpp
+ *   /tmp/arti_bench -C tools/arti_bench/programs
+ *
+ * ARTI is compiled for the host (ARTI_PLATFORM != ARTI_ARDUINO), with a simulated segment of width x height pixels
+ * (see hostLeds in arti_wled.h). Each program runs three times: interpreting the parse tree, compiled to bytecode
+ * (which saves <program>.wbc) and loading <program>.wbc. All runs must produce the same pixels.
+ * Setup is the time from reading the files until main has run, memory what the program uses while running
+ * (ARTI::memoryUsage()).
+ * The programs folder has a definition file (wledv033.json) and a few example programs. They are written for this
+ * benchmark: on WLED, the definition file is downloaded in the ARTI-FX editor ("Download wled json").
+ * Options: -C <folder> folder with definition and programs (default .), -d <file> definition file (default wledv033.json),
+ *          -n <frames> frames per program (default 200), -w <width> -h <height> segment size (default 32x16).
+ * Without program names, the example programs are used.
+ */
+#define ARTI_BENCHMARK
+#include "../../usermods/artifx/arti_wled.h"
+
+#include <unistd.h>
+#include <vector>
+
+struct RunResult {
+  bool ok = false;
+  double setupMs = 0;
+  double frameUs = 0;
+  size_t memory = 0;
+  bool cached = false;
+  std::vector<uint32_t> pixels;
+};
+
+static double nowUs() {
+  return std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static RunResult runProgram(const char *definition, const char *name, bool bytecode, unsigned frames) {
+  RunResult result;
+  result.pixels.assign(hostWidth * hostHeight, 0);
+  hostLeds = result.pixels.data();
+
+  ARTI *arti = new ARTI();
+  arti->useBytecode = bytecode;
+  double t0 = nowUs();
+  result.ok = arti->setup(definition, name);
+  result.setupMs = (nowUs() - t0) / 1000.0;
+  result.memory = arti->memoryUsage();
+  result.cached = arti->programCached;
+  if (result.ok) {
+    t0 = nowUs();
+    unsigned frame = 0;
+    for (; frame < frames && result.ok; frame++) result.ok = arti->loop();
+    result.frameUs = (nowUs() - t0) / frame;
+  }
+  arti->close();
+  delete arti;
+  hostLeds = nullptr;
+
+  char logName[fileNameLength + 8];
+  snprintf(logName, sizeof(logName), "%s.log", name);
+  if (result.ok) remove(logName);   // keep the log if something went wrong
+  return result;
+}
+
+int main(int argc, char** argv) {
+  const char *folder = nullptr;
+  const char *definition = "wledv033.json";
+  unsigned frames = 200;
+  hostWidth = 32;
+  hostHeight = 16;
+  int opt;
+  while ((opt = getopt(argc, argv, "C:d:n:w:h:")) != -1) {
+    switch (opt) {
+      case 'C': folder = optarg; break;
+      case 'd': definition = optarg; break;
+      case 'n': frames = strtoul(optarg, nullptr, 10); break;
+      case 'w': hostWidth = atoi(optarg); break;
+      case 'h': hostHeight = atoi(optarg); break;
+      default:  fprintf(stderr, "usage: %s [-C folder] [-d definition.json] [-n frames] [-w width] [-h height] [program ...]\n", argv[0]); return 2;
+    }
+  }
+  if (folder && chdir(folder) != 0) { perror(folder); return 1; }
+  if (frames < 1 || hostWidth < 1 || hostHeight < 1) { fprintf(stderr, "frames, width and height must be 1 or more\n"); return 2; }
+
+  std::vector<const char *> programs(argv + optind, argv + argc);
+  if (programs.empty()) programs = { "rainbow", "plasma", "ripple", "bars" };
+
+  printf("%d x %d pixels, %u frames\n", hostWidth, hostHeight, frames);
+  printf("%-12s %12s %12s %12s %14s %14s %8s %12s %12s  %s\n", "program", "setup tree", "compile", "load", "frame tree", "frame byte",
+         "speedup", "memory tree", "memory byte", "pixels");
+  bool allOk = true;
+  for (const char *name : programs) {
+    char compiledName[fileNameLength + 8];
+    snprintf(compiledName, sizeof(compiledName), "%s.wbc", name);
+    remove(compiledName);   // first bytecode run compiles
+    RunResult tree = runProgram(definition, name, false, frames);
+    RunResult byte = runProgram(definition, name, true, frames);
+    RunResult load = runProgram(definition, name, true, frames);
+    remove(compiledName);
+    bool ok = tree.ok && byte.ok && load.ok;
+    bool same = ok && tree.pixels == byte.pixels && tree.pixels == load.pixels;
+    if (!ok) printf("%-12s failed (%s), see %s.log\n", name, !tree.ok ? "interpreter" : !byte.ok ? "bytecode" : "load", name);
+    else printf("%-12s %9.2f ms %9.2f ms %9.2f ms %11.1f us %11.1f us %7.1fx %12zu %12zu  %s%s\n", name, tree.setupMs, byte.setupMs,
+                load.setupMs, tree.frameUs, byte.frameUs, tree.frameUs / byte.frameUs, tree.memory, byte.memory, same ? "same" : "DIFFERENT",
+                (byte.cached || !load.cached) ? " (not cached)" : "");
+    allOk = allOk && same;
+  }
+  return allOk ? 0 : 1;
+}
@@ -0,0 +1,4 @@
+#pragma once
+// host build of usermods/artifx (ARTI_PLATFORM != ARTI_ARDUINO): use the ArduinoJson copy of WLED
+#include "../../../wled00/src/dependencies/json/ArduinoJson-v6.h"
+#define PSRAMDynamicJsonDocument DynamicJsonDocument
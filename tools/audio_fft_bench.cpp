@@ -0,0 +1,223 @@
+/*
+ * Host benchmark and accuracy test for the audioreactive FFT engines (usermods/audioreactive/audio_fft.h)
+ *
+ *   g++ -O2 -std=c++17 -o /tmp/audio_fft_bench tools/audio_fft_bench.cpp && /tmp/audio_fft_bench recording.wav
+ *
+ * Runs every 512 sample frame of a WAV file (8/16/24/32 bit PCM or 32 bit float, first channel, 50% overlap) through
+ * dcRemoval + Blackman-Harris window + FFT + magnitudes + majorPeak, like FFTcode() does, using
+ *   - "arduinoFFT": a copy of the arduinoFFT 1.9 compute() loop, as used by the audioreactive usermod so far
+ *   - "real" / "fixed": the real-input engines from audio_fft.h
+ * and compares bins and the major peak against a double precision DFT. Without a WAV file, a synthetic test signal
+ * (tones, chirp, noise, silence) is used. Bin errors are relative to the largest bin of each frame.
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "../usermods/audioreactive/audio_fft.h"
+
+constexpr unsigned samplesFFT = 512;
+
+// WAV reader: returns first channel as int16 range floats
+static bool readWav(const char* path, std::vector<float>& out, unsigned& rate) {
+  FILE* f = fopen(path, "rb");
+  if (!f) { perror(path); return false; }
+  char id[4]; uint32_t size;
+  if (fread(id, 1, 4, f) != 4 || memcmp(id, "RIFF", 4) || fread(&size, 4, 1, f) != 1 || fread(id, 1, 4, f) != 4 || memcmp(id, "WAVE", 4)) {
+    fprintf(stderr, "%s: not a WAV file\n", path); fclose(f); return false;
+  }
+  uint16_t format = 0, channels = 0, bits = 0;
+  while (fread(id, 1, 4, f) == 4 && fread(&size, 4, 1, f) == 1) {
+    if (!memcmp(id, "fmt ", 4)) {
+      uint8_t fmt[40] = {0};
+      if (fread(fmt, 1, size < 40 ? size : 40, f) == 0) break;
+      if (size > 40) fseek(f, size - 40, SEEK_CUR);
+      memcpy(&format, fmt, 2); memcpy(&channels, fmt + 2, 2); memcpy(&rate, fmt + 4, 4); memcpy(&bits, fmt + 14, 2);
+      if (format == 0xFFFE) memcpy(&format, fmt + 24, 2);  // WAVE_FORMAT_EXTENSIBLE: sub format
+    } else if (!memcmp(id, "data", 4)) {
+      if (!channels || !bits || (format != 1 && format != 3)) break;
+      unsigned frameBytes = channels * bits / 8;
+      std::vector<uint8_t> raw(size);
+      size = fread(raw.data(), 1, size, f);
+      for (size_t p = 0; p + frameBytes <= size; p += frameBytes) {
+        const uint8_t* s = raw.data() + p;
+        float v = 0;
+        if (format == 3 && bits == 32) { memcpy(&v, s, 4); v *= 32768.0f; }
+        else if (bits == 8)  v = (int(s[0]) - 128) * 256.0f;
+        else if (bits == 16) v = int16_t(s[0] | (s[1] << 8));
+        else if (bits == 24) v = int32_t((s[0] << 8) | (s[1] << 16) | (s[2] << 24)) / 65536.0f;
+        else if (bits == 32) v = int32_t(s[0] | (s[1] << 8) | (s[2] << 16) | (s[3] << 24)) / 65536.0f;
+        out.push_back(v);
+      }
+      fclose(f);
+      return true;
+    } else fseek(f, size + (size & 1), SEEK_CUR);
+  }
+  fprintf(stderr, "%s: unsupported WAV format\n", path);
+  fclose(f);
+  return false;
+}
+
+static void synthesize(std::vector<float>& out, unsigned rate) {
+  srand(42);
+  for (unsigned i = 0; i < rate * 8; i++) {
+    double t = double(i) / rate;
+    int part = i / (rate * 2);
+    double v = 0;
+    switch (part) {
+      case 0: v = 9000 * sin(2*M_PI*440*t) + 3000 * sin(2*M_PI*1250*t) + 50 * sin(2*M_PI*6000*t); break;  // tones, one of them weak
+      case 1: v = 12000 * sin(2*M_PI*(60 + 2000*(t-2)) * (t-2)); break;                                // chirp
+      case 2: v = 4000.0 * (rand() / double(RAND_MAX) - 0.5) + 300 * sin(2*M_PI*95*t); break;           // noise + bass
+      default: v = 2 * sin(2*M_PI*300*t); break;                                                        // near silence
+    }
+    out.push_back(v + 200);  // DC offset
+  }
+}
+
+// arduinoFFT 1.9 compute() + complexToMagnitude(), forward direction
+static void arduinoFFTCompute(float* vReal, float* vImag, unsigned samples) {
+  unsigned power = 0; while ((1U << power) < samples) power++;
+  unsigned j = 0;
+  for (unsigned i = 0; i < (samples - 1); i++) {
+    if (i < j) { float t = vReal[i]; vReal[i] = vReal[j]; vReal[j] = t; }
+    unsigned k = (samples >> 1);
+    while (k <= j) { j -= k; k >>= 1; }
+    j += k;
+  }
+  float c1 = -1.0f, c2 = 0.0f;
+  unsigned l2 = 1;
+  for (unsigned l = 0; l < power; l++) {
+    unsigned l1 = l2;
+    l2 <<= 1;
+    float u1 = 1.0f, u2 = 0.0f;
+    for (j = 0; j < l1; j++) {
+      for (unsigned i = j; i < samples; i += l2) {
+        unsigned i1 = i + l1;
+        float t1 = u1 * vReal[i1] - u2 * vImag[i1];
+        float t2 = u1 * vImag[i1] + u2 * vReal[i1];
+        vReal[i1] = vReal[i] - t1;
+        vImag[i1] = vImag[i] - t2;
+        vReal[i] += t1;
+        vImag[i] += t2;
+      }
+      float z = ((u1 * c1) - (u2 * c2));
+      u2 = ((u1 * c2) + (u2 * c1));
+      u1 = z;
+    }
+    c2 = -sqrtf((1.0f - c1) / 2.0f);
+    c1 = sqrtf((1.0f + c1) / 2.0f);
+  }
+  for (unsigned i = 0; i < samples; i++) vReal[i] = sqrtf(vReal[i] * vReal[i] + vImag[i] * vImag[i]);
+}
+
+struct Result {
+  const char* name;
+  double us = 0;
+  double maxErrDb = -200, sumErr = 0, maxPeakErr = 0;
+  unsigned frames = 0, peakMiss = 0;
+};
+
+static double relErrDb(const float* mag, const std::vector<double>& ref, double refMax) {
+  double e = 0;
+  for (unsigned k = 0; k <= samplesFFT/2; k++) e = fmax(e, fabs(mag[k] - ref[k]));
+  return refMax > 0 ? 20 * log10(fmax(e / refMax, 1e-10)) : -200;
+}
+
+int main(int argc, char** argv) {
+  unsigned rate = 22050;
+  std::vector<float> input;
+  if (argc > 1) { if (!readWav(argv[1], input, rate)) return 1; }
+  else synthesize(input, rate);
+  if (input.size() < samplesFFT) { fprintf(stderr, "recording too short\n"); return 1; }
+  int repeat = argc > 2 ? atoi(argv[2]) : 20;
+
+  std::vector<float> vReal(samplesFFT), vImag(samplesFFT), window(samplesFFT);
+  ArRealFFT realFFT(vReal.data(), samplesFFT, rate);
+  ArRealFFTFixed fixedFFT(vReal.data(), samplesFFT, rate);
+  ArRealFFT helper(window.data(), samplesFFT, rate);  // only used for window weights
+  if (!realFFT.begin() || !fixedFFT.begin()) { fprintf(stderr, "out of memory\n"); return 1; }
+  for (auto& w : window) w = 1.0f;
+  helper.windowing(ArFFTWindow::Blackman_Harris);
+
+  Result results[3] = {{"arduinoFFT"}, {ArRealFFT::name()}, {ArRealFFTFixed::name()}};
+  std::vector<double> ref(samplesFFT/2 + 1);
+  std::vector<float> frame(samplesFFT);
+
+  for (size_t start = 0; start + samplesFFT <= input.size(); start += samplesFFT/2) {
+    // double precision reference: DC removal, window, DFT
+    double mean = 0;
+    for (unsigned i = 0; i < samplesFFT; i++) mean += input[start + i];
+    mean /= samplesFFT;
+    double refMax = 0;
+    for (unsigned k = 0; k <= samplesFFT/2; k++) {
+      double re = 0, im = 0;
+      for (unsigned i = 0; i < samplesFFT; i++) {
+        double x = (input[start + i] - mean) * window[i];
+        re += x * cos(2*M_PI*k*i / samplesFFT);
+        im -= x * sin(2*M_PI*k*i / samplesFFT);
+      }
+      ref[k] = sqrt(re*re + im*im);
+      if (k > 0) refMax = fmax(refMax, ref[k]);
+    }
+    // reference peak, using the same interpolation on exact magnitudes
+    std::vector<float> refMag(samplesFFT);
+    for (unsigned k = 0; k <= samplesFFT/2; k++) refMag[k] = ref[k];
+    for (unsigned k = 1; k < samplesFFT/2; k++) refMag[samplesFFT - k] = refMag[k];
+    float refPeak, refValue;
+    ArRealFFT refPeakFinder(refMag.data(), samplesFFT, rate);
+    refPeakFinder.majorPeak(refPeak, refValue);
+
+    for (int e = 0; e < 3; e++) {
+      Result& r = results[e];
+      float peak = 0, value = 0;
+      auto t0 = std::chrono::steady_clock::now();
+      for (int n = 0; n < repeat; n++) {
+        memcpy(vReal.data(), input.data() + start, sizeof(float) * samplesFFT);
+        if (e == 0) {
+          float m = 0;
+          for (unsigned i = 0; i < samplesFFT; i++) m += vReal[i];
+          m /= samplesFFT;
+          for (unsigned i = 0; i < samplesFFT; i++) vReal[i] = (vReal[i] - m) * window[i];
+          memset(vImag.data(), 0, sizeof(float) * samplesFFT);
+          arduinoFFTCompute(vReal.data(), vImag.data(), samplesFFT);
+          realFFT.majorPeak(peak, value);  // same peak code as arduinoFFT
+        } else if (e == 1) {
+          realFFT.dcRemoval();
+          realFFT.windowing(ArFFTWindow::Blackman_Harris);
+          realFFT.compute();
+          realFFT.complexToMagnitude();
+          realFFT.majorPeak(peak, value);
+        } else {
+          fixedFFT.dcRemoval();
+          fixedFFT.windowing(ArFFTWindow::Blackman_Harris);
+          fixedFFT.compute();
+          fixedFFT.complexToMagnitude();
+          fixedFFT.majorPeak(peak, value);
+        }
+      }
+      r.us += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / repeat;
+      double err = relErrDb(vReal.data(), ref, refMax);
+      r.maxErrDb = fmax(r.maxErrDb, err);
+      r.sumErr += err;
+      if (refMax > 100) {  // only count peaks of frames with some signal
+        double pe = fabs(peak - refPeak);
+        r.maxPeakErr = fmax(r.maxPeakErr, pe);
+        if (pe > rate / float(samplesFFT)) r.peakMiss++;
+      }
+      r.frames++;
+    }
+  }
+
+  printf("%s: %zu samples @ %u Hz, %u frames of %u samples\n", argc > 1 ? argv[1] : "synthetic signal", input.size(), rate, results[0].frames, samplesFFT);
+  for (auto& r : results) {
+    printf("%-10s %7.2f us/frame (%5.2fx)  bin error vs. DFT: max %6.1f dB, avg %6.1f dB  major peak: max error %6.2f Hz, %u frames off by more than one bin\n",
+           r.name, r.us / r.frames, results[0].us / r.us, r.maxErrDb, r.sumErr / r.frames, r.maxPeakErr, r.peakMiss);
+  }
+  // the float engine has to match the current results; the fixed-point engine trades precision for speed on boards without FPU
+  if (results[1].maxErrDb > results[0].maxErrDb + 6 || results[1].peakMiss > results[0].peakMiss) { printf("real FFT: ACCURACY CHECK FAILED\n"); return 1; }
+  if (results[2].maxErrDb > -50) { printf("fixed FFT: ACCURACY CHECK FAILED\n"); return 1; }
+  printf("accuracy OK\n");
+  return 0;
+}
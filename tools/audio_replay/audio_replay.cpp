@@ -0,0 +1,90 @@
+/*
+ * Offline replay of a WAV recording through the audioreactive usermod (usermods/audioreactive/audio_reactive.h)
+ *
+ *   g++ -O2 -std=c++17 -pthread -I tools/audio_replay -o /tmp/audio_replay tools/audio_replay/audio_replay.cpp
+ *   /tmp/audio_replay recording.wav > recording.csv
+ *
+ * The usermod is compiled unchanged for the host (see wled.h in this folder), with the "WAV file" audio source
+ * (SR_DMTYPE 10) reading the recording instead of an I2S microphone. FFT task and usermod loop() run against a
+ * simulated clock, so the output is the same on every run and does not depend on the speed of the host
+ * (tools/audio_replay/check_replay.sh verifies that).
+ *
+ * One CSV line is written per FFT task cycle:
+ *   time in ms, the 16 GEQ channels (fftResult), volumeSmth, FFT_MajorPeak, samplePeak, beat tracking (BPM, phase, confidence).
+ * Options: -a <0|1|2|3> AGC mode (default 0 = off), -g <gain> input gain (default 60), -n <ms> stop after that much audio,
+ *          -d <ms> audio delay line (dynamics:delay, default 0),
+ *          -t add filterTime / fftTime of the FFT task and the time taken by loop() (AGC, peak detection), in microseconds
+ *             of host CPU. The usermod then sees real time, so the results differ a little between runs.
+ * Without -n, the replay stops when the end of the recording is reached.
+ */
+#define SR_STATS
+#define SR_DMTYPE 10
+#define UM_AUDIOREACTIVE_ENABLE
+#include "../../usermods/audioreactive/audio_reactive.h"
+
+#include <unistd.h>
+
+int main(int argc, char** argv) {
+  int agc = 0, gain = 60, delay = 0;
+  unsigned long stopAfter = 0;
+  bool timing = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "a:g:n:d:t")) != -1) {
+    switch (opt) {
+      case 'a': agc = atoi(optarg); break;
+      case 'g': gain = atoi(optarg); break;
+      case 'd': delay = atoi(optarg); break;
+      case 'n': stopAfter = strtoul(optarg, nullptr, 10); break;
+      case 't': timing = true; break;
+      default:  fprintf(stderr, "usage: %s [-a agc] [-g gain] [-d ms] [-n ms] [-t] recording.wav\n", argv[0]); return 2;
+    }
+  }
+  if (optind >= argc) { fprintf(stderr, "usage: %s [-a agc] [-g gain] [-d ms] [-n ms] [-t] recording.wav\n", argv[0]); return 2; }
+  hostClock().cpuTimer = timing;
+  WLED_FS.audioFile = argv[optind];
+  if (FILE* f = fopen(argv[optind], "rb")) fclose(f);
+  else { perror(argv[optind]); return 1; }
+
+  static AudioReactive um;
+  // apply settings the same way as a saved configuration would
+  {
+    DynamicJsonDocument doc(4096);
+    JsonObject root = doc.to<JsonObject>();
+    um.addToConfig(root);
+    JsonObject top = root["AudioReactive"];
+    top["analogmic"]["pin"] = -1;
+    top["digitalmic"]["type"] = SR_DMTYPE;
+    top["config"]["AGC"] = agc;
+    top["config"]["gain"] = gain;
+    top["dynamics"]["delay"] = delay;
+    um.readFromConfig(root);
+  }
+  um.setup();
+  if (!audioSource || !audioSource->isInitialized()) { fprintf(stderr, "%s: cannot replay this file\n", argv[optind]); return 1; }
+  WavFileSource* wav = static_cast<WavFileSource*>(audioSource);
+
+  printf("ms");
+  for (int i = 0; i < NUM_GEQ_CHANNELS; i++) printf(",geq%d", i);
+  printf(",volumeSmth,majorPeak,samplePeak,bpm,beatPhase,beatConfidence%s\n", timing ? ",filterTime,fftTime,loopTime" : "");
+
+  unsigned lastCycle = hostClock().cycles;
+  unsigned long start = millis();
+  double loopTime = 0;
+  while (wav->getLoopCount() == 0 && (stopAfter == 0 || millis() - start < stopAfter)) {
+    hostAdvance(1);
+    int64_t t0 = esp_timer_get_time();
+    um.loop();
+    loopTime = 0.8 * loopTime + 0.2 * double(esp_timer_get_time() - t0);   // same kind of averaging as fftTime
+    unsigned cycle;
+    { std::lock_guard<std::mutex> lk(hostClock().m); cycle = hostClock().cycles; }
+    if (cycle == lastCycle) continue;
+    lastCycle = cycle;
+    printf("%lu", millis() - start);
+    for (int i = 0; i < NUM_GEQ_CHANNELS; i++) printf(",%u", fftResult[i]);
+    printf(",%.2f,%.1f,%d,%.1f,%.3f,%.2f", volumeSmth, FFT_MajorPeak, samplePeak ? 1 : 0, beatBpm, beatPhase, beatConfidence);
+    if (timing) printf(",%.1f,%.1f,%.1f", filterTime, fftTime, loopTime);
+    printf("\n");
+  }
+  fflush(stdout);
+  quick_exit(0);   // the FFT task never returns
+}
@@ -0,0 +1,24 @@
+#!/bin/sh
+# Replays a recording twice with tools/audio_replay and fails if the two CSV outputs differ.
+#
+#   tools/audio_replay/check_replay.sh recording.wav [audio_replay options except -t]
+#
+# Run from the repository root. Several checks in parallel put the host under load, which is when
+# thread timing would show up in the results.
+
+set -e
+[ -n "$1" ] || { echo "usage: $0 recording.wav [options]" >&2; exit 2; }
+wav="$1"; shift
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+g++ -O2 -std=c++17 -pthread -I tools/audio_replay -o "$tmp/audio_replay" tools/audio_replay/audio_replay.cpp
+"$tmp/audio_replay" "$@" "$wav" > "$tmp/run1.csv"
+"$tmp/audio_replay" "$@" "$wav" > "$tmp/run2.csv"
+if cmp -s "$tmp/run1.csv" "$tmp/run2.csv"; then
+  echo "$wav: $(($(wc -l < "$tmp/run1.csv") - 1)) FFT cycles, identical in both runs"
+else
+  echo "$wav: replay results differ between runs" >&2
+  diff "$tmp/run1.csv" "$tmp/run2.csv" | head -n 10 >&2
+  exit 1
+fi
@@ -0,0 +1,2 @@
+#pragma once
+#include "../wled.h"   // host stand-in, see tools/audio_replay/wled.h
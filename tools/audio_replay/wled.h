@@ -0,0 +1,470 @@
+#pragma once
+/*
+ * Host stand-in for wled.h, Arduino, FreeRTOS and the ESP-IDF I2S driver - just enough to compile
+ * usermods/audioreactive/audio_reactive.h natively for tools/audio_replay/audio_replay.cpp.
+ *
+ * Time is simulated: millis(), micros(), esp_timer_get_time() and the FreeRTOS tick only move when the runner calls
+ * hostAdvance(), so a replay gives the same results on every run. The FFT task runs in its own thread, but never at the
+ * same time as the runner: task creation and hostAdvance() return once the task waits for a later point in time.
+ * With hostClock().cpuTimer set, esp_timer_get_time() is the real clock instead, so the per-stage timing of FFTcode()
+ * measures host CPU time - results are then no longer reproducible (latency and beat phase use that clock, too).
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#define ARDUINO_ARCH_ESP32
+#define ESP32
+#define CONFIG_IDF_TARGET_ESP32 1
+#define _MoonModules_WLED_
+#define ESP_IDF_VERSION_VAL(major, minor, patch) ((major << 16) | (minor << 8) | (patch))
+#define ESP_IDF_VERSION ESP_IDF_VERSION_VAL(4, 4, 4)
+#define SOC_I2S_NUM 2
+#define SOC_I2S_SUPPORTS_PDM_RX 1
+#define SOC_I2S_SUPPORTS_APLL 1
+#define SOC_I2S_SUPPORTS_ADC 1
+
+// ---- Arduino basics ----
+#define PROGMEM
+#define PSTR(s) (s)
+#define F(s) (s)
+#define FPSTR(s) ((const char*)(s))
+#define SET_F(x) (const char*)F(x)
+#define snprintf_P snprintf
+#define sprintf_P sprintf
+#define strcpy_P strcpy
+#define strcmp_P strcmp
+#define strncpy_P strncpy
+#define strncmp_P strncmp
+#define strlen_P strlen
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define IRAM_ATTR
+#define BIT(n) (1UL << (n))
+typedef uint8_t byte;
+typedef char __FlashStringHelper;
+
+template <class T, class L> inline typename std::common_type<T, L>::type min(T a, L b) { return (b < a) ? b : a; }
+template <class T, class L> inline typename std::common_type<T, L>::type max(T a, L b) { return (a < b) ? b : a; }
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+class String {
+  std::string _s;
+  public:
+    String(const char* s = "") : _s(s ? s : "") {}
+    String(const std::string& s) : _s(s) {}
+    String(int v) : _s(std::to_string(v)) {}
+    String(unsigned v) : _s(std::to_string(v)) {}
+    String(long v) : _s(std::to_string(v)) {}
+    String(unsigned long v) : _s(std::to_string(v)) {}
+    String(float v, int decimals = 2) { char b[32]; snprintf(b, sizeof(b), "%.*f", decimals, v); _s = b; }
+    const char* c_str() const { return _s.c_str(); }
+    unsigned length() const { return _s.length(); }
+    bool concat(const char* s) { _s += s; return true; }
+    bool concat(char c) { _s += c; return true; }
+    bool reserve(unsigned n) { _s.reserve(n); return true; }
+    String& operator+=(const String& o) { _s += o._s; return *this; }
+    String& operator+=(const char* o) { _s += o; return *this; }
+    String& operator+=(char c) { _s += c; return *this; }
+    friend String operator+(const String& a, const String& b) { return String(a._s + b._s); }
+    friend String operator+(const String& a, const char* b) { return String(a._s + b); }
+    bool operator==(const String& o) const { return _s == o._s; }
+    bool operator==(const char* o) const { return _s == o; }
+};
+
+class StringSumHelper : public String { public: using String::String; };
+
+#define ARDUINOJSON_ENABLE_ARDUINO_STRING 1
+#include "../../wled00/src/dependencies/json/ArduinoJson-v6.h"
+
+// ---- simulated time and task scheduling ----
+struct HostClock {
+  std::mutex m;
+  std::condition_variable cv;
+  uint64_t now = 0;                // simulated time in microseconds
+  bool taskRunning = false;        // FFT task exists
+  bool taskWaiting = false;        // FFT task waits for taskWake
+  uint64_t taskWake = 0;
+  unsigned cycles = 0;             // number of vTaskDelayUntil() calls - one per FFTcode() cycle
+  bool cpuTimer = false;           // esp_timer_get_time() measures host CPU time instead of simulated time
+  std::thread::id mainThread = std::this_thread::get_id();
+};
+inline HostClock& hostClock() { static HostClock c; return c; }
+
+// main thread: move simulated time forward in 1ms steps, and let the FFT task catch up
+inline void hostAdvance(uint32_t ms) {
+  HostClock& c = hostClock();
+  std::unique_lock<std::mutex> lk(c.m);
+  for (uint32_t i = 0; i < ms; i++) {
+    c.now += 1000;
+    c.cv.notify_all();
+    c.cv.wait(lk, [&c]{ return !c.taskRunning || (c.taskWaiting && c.taskWake > c.now); });
+  }
+}
+
+// FFT task: sleep until simulated time has reached wake
+inline void hostSleepUntil(uint64_t wake) {
+  HostClock& c = hostClock();
+  if (std::this_thread::get_id() == c.mainThread) {               // main thread (setup): just advance time
+    uint64_t now; { std::lock_guard<std::mutex> lk(c.m); now = c.now; }
+    if (wake > now) hostAdvance((wake - now + 999) / 1000);
+    return;
+  }
+  std::unique_lock<std::mutex> lk(c.m);
+  c.taskWaiting = true;
+  c.taskWake = wake;
+  c.cv.notify_all();
+  c.cv.wait(lk, [&c]{ return c.now >= c.taskWake; });
+  c.taskWaiting = false;
+}
+
+inline unsigned long millis() { std::lock_guard<std::mutex> lk(hostClock().m); return hostClock().now / 1000; }
+inline unsigned long micros() { std::lock_guard<std::mutex> lk(hostClock().m); return hostClock().now; }
+inline void delay(uint32_t ms) { hostSleepUntil(micros() + 1000ULL * ms); }
+inline void yield() {}
+inline int64_t esp_timer_get_time() {
+  static const auto t0 = std::chrono::steady_clock::now();
+  if (!hostClock().cpuTimer) return micros();
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// ---- FreeRTOS ----
+typedef void* TaskHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef void (*TaskFunction_t)(void*);
+#define portTICK_PERIOD_MS 1
+#define portMAX_DELAY 0xFFFFFFFF
+#define pdPASS 1
+#define pdMS_TO_TICKS(ms) (ms)
+inline TickType_t xTaskGetTickCount() { return millis(); }
+inline void vTaskDelay(TickType_t ticks) { hostSleepUntil(micros() + 1000ULL * ticks); }
+inline void vTaskDelayUntil(TickType_t* last, TickType_t increment) {
+  { std::lock_guard<std::mutex> lk(hostClock().m); hostClock().cycles++; }
+  *last += increment;
+  if (*last > millis()) hostSleepUntil(1000ULL * *last);
+  else *last = millis();
+}
+// the task starts at the current simulated time; the caller continues once it waits for a later point in time
+inline BaseType_t xTaskCreateUniversal(TaskFunction_t fn, const char*, uint32_t, void* param, UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+  HostClock& c = hostClock();
+  std::unique_lock<std::mutex> lk(c.m);
+  c.taskRunning = true;
+  c.taskWaiting = false;
+  std::thread(fn, param).detach();
+  c.cv.wait(lk, [&c]{ return c.taskWaiting && c.taskWake > c.now; });
+  if (handle) *handle = (TaskHandle_t)1;
+  return pdPASS;
+}
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* param, UBaseType_t prio, TaskHandle_t* handle, BaseType_t core) {
+  return xTaskCreateUniversal(fn, name, stack, param, prio, handle, core);
+}
+inline void vTaskSuspend(TaskHandle_t) {}
+inline void vTaskResume(TaskHandle_t) {}
+inline void vTaskDelete(TaskHandle_t) {}
+inline UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t) { return 4096; }
+inline UBaseType_t uxTaskPriorityGet(TaskHandle_t) { return 1; }
+inline const char* pcTaskGetTaskName(TaskHandle_t) { return "FFT"; }
+inline BaseType_t xPortGetCoreID() { return 0; }
+inline void esp_task_wdt_feed() {}
+
+// ---- ESP-IDF I2S / ADC (never called during replay, only needs to compile) ----
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+typedef int i2s_port_t;
+#define I2S_NUM_0 0
+#define I2S_NUM_1 1
+#define I2S_PIN_NO_CHANGE (-1)
+typedef int i2s_mode_t;
+enum { I2S_MODE_MASTER = 1, I2S_MODE_SLAVE = 2, I2S_MODE_TX = 4, I2S_MODE_RX = 8, I2S_MODE_DAC_BUILT_IN = 16, I2S_MODE_ADC_BUILT_IN = 32, I2S_MODE_PDM = 64 };
+typedef int i2s_bits_per_sample_t;
+enum { I2S_BITS_PER_SAMPLE_16BIT = 16, I2S_BITS_PER_SAMPLE_24BIT = 24, I2S_BITS_PER_SAMPLE_32BIT = 32 };
+typedef int i2s_bits_per_chan_t;
+enum { I2S_BITS_PER_CHAN_16BIT = 16, I2S_BITS_PER_CHAN_32BIT = 32 };
+typedef int i2s_channel_fmt_t;
+enum { I2S_CHANNEL_FMT_RIGHT_LEFT, I2S_CHANNEL_FMT_ALL_RIGHT, I2S_CHANNEL_FMT_ALL_LEFT, I2S_CHANNEL_FMT_ONLY_RIGHT, I2S_CHANNEL_FMT_ONLY_LEFT, I2S_CHANNEL_FMT_MULTIPLE };
+typedef int i2s_comm_format_t;
+enum { I2S_COMM_FORMAT_STAND_I2S = 1, I2S_COMM_FORMAT_I2S = 1, I2S_COMM_FORMAT_I2S_MSB = 2 };
+enum { I2S_CHANNEL_MONO = 1, I2S_CHANNEL_STEREO = 2 };
+#define ESP_INTR_FLAG_LEVEL1 (1<<1)
+#define ESP_INTR_FLAG_LEVEL2 (1<<2)
+#define ESP_INTR_FLAG_LEVEL3 (1<<3)
+#define ESP_INTR_FLAG_IRAM (1<<10)
+typedef struct {
+  i2s_mode_t mode; uint32_t sample_rate; i2s_bits_per_sample_t bits_per_sample; i2s_channel_fmt_t channel_format;
+  i2s_comm_format_t communication_format; int intr_alloc_flags; int dma_buf_count; int dma_buf_len; bool use_apll;
+  bool tx_desc_auto_clear; int fixed_mclk; int mclk_multiple; i2s_bits_per_chan_t bits_per_chan;
+} i2s_config_t;
+typedef struct { int mck_io_num; int bck_io_num; int ws_io_num; int data_out_num; int data_in_num; } i2s_pin_config_t;
+inline esp_err_t i2s_driver_install(i2s_port_t, const i2s_config_t*, int, void*) { return ESP_FAIL; }
+inline esp_err_t i2s_driver_uninstall(i2s_port_t) { return ESP_OK; }
+inline esp_err_t i2s_set_pin(i2s_port_t, const i2s_pin_config_t*) { return ESP_FAIL; }
+inline esp_err_t i2s_set_clk(i2s_port_t, uint32_t, int, int) { return ESP_FAIL; }
+inline esp_err_t i2s_read(i2s_port_t, void*, size_t, size_t* read, uint32_t) { *read = 0; return ESP_FAIL; }
+inline esp_err_t i2s_start(i2s_port_t) { return ESP_OK; }
+inline esp_err_t i2s_stop(i2s_port_t) { return ESP_OK; }
+inline esp_err_t i2s_set_adc_mode(int, int) { return ESP_FAIL; }
+inline esp_err_t i2s_adc_enable(i2s_port_t) { return ESP_FAIL; }
+inline esp_err_t i2s_adc_disable(i2s_port_t) { return ESP_OK; }
+typedef int adc1_channel_t;
+typedef int adc_channel_t;
+enum { ADC_UNIT_1 = 1, ADC_WIDTH_BIT_12 = 3, ADC_ATTEN_DB_11 = 3 };
+inline esp_err_t adc1_config_width(int) { return ESP_OK; }
+inline esp_err_t adc1_config_channel_atten(adc1_channel_t, int) { return ESP_OK; }
+inline esp_err_t adc_gpio_init(int, adc_channel_t) { return ESP_OK; }
+inline int digitalPinToAnalogChannel(int) { return -1; }
+#define REG_SET_BIT(r, b) ((void)(r), (void)(b))
+#define I2S_TIMING_REG(i) (i)
+#define I2S_CONF_REG(i) (i)
+#define I2S_RX_MSB_SHIFT 0
+#define PERIPH_I2S0_MODULE 0
+inline void periph_module_reset(int) {}
+#define PIN_FUNC_SELECT(a, b)
+#define PERIPHS_IO_MUX_GPIO0_U 0
+#define PERIPHS_IO_MUX_U0TXD_U 0
+#define PERIPHS_IO_MUX_U0RXD_U 0
+#define FUNC_GPIO0_CLK_OUT1 0
+#define FUNC_U0TXD_CLK_OUT3 0
+#define FUNC_U0RXD_CLK_OUT2 0
+#define PIN_CTRL 0
+#define WRITE_PERI_REG(a, b)
+#define GPIO_NUM_0 0
+#define GPIO_NUM_1 1
+#define GPIO_NUM_3 3
+
+class TwoWire {
+  public:
+    bool begin(int = -1, int = -1, uint32_t = 0) { return false; }
+    void beginTransmission(uint8_t) {}
+    size_t write(uint8_t) { return 1; }
+    size_t write(const uint8_t*, size_t len) { return len; }
+    uint8_t endTransmission(bool = true) { return 2; }
+    uint8_t requestFrom(uint8_t, uint8_t) { return 0; }
+    int read() { return -1; }
+    void setClock(uint32_t) {}
+};
+static TwoWire Wire;
+
+struct EspClass {
+  uint32_t getFreeHeap() { return 200000; }
+  uint8_t getChipRevision() { return 3; }
+  uint32_t getMaxAllocHeap() { return 100000; }
+};
+static EspClass ESP;
+
+struct HostSerial {
+  template <typename T> void print(T) {}
+  template <typename T> void println(T) {}
+  void println() {}
+  void printf(const char*, ...) {}
+  void flush() {}
+  operator bool() const { return false; }
+};
+static HostSerial Serial;
+
+// ---- file system: WLED_FS.open("/audio.wav") reads the recording given to the runner ----
+class File {
+  FILE* _f = nullptr;
+  public:
+    File(FILE* f = nullptr) : _f(f) {}
+    operator bool() const { return _f != nullptr; }
+    size_t read(uint8_t* buf, size_t len) { return _f ? fread(buf, 1, len, _f) : 0; }
+    bool seek(uint32_t pos) { return _f && fseek(_f, pos, SEEK_SET) == 0; }
+    size_t position() const { return _f ? ftell(_f) : 0; }
+    size_t size() const { if (!_f) return 0; long p = ftell(_f); fseek(_f, 0, SEEK_END); long s = ftell(_f); fseek(_f, p, SEEK_SET); return s; }
+    void close() { if (_f) fclose(_f); _f = nullptr; }
+};
+struct HostFS {
+  std::string audioFile;
+  File open(const char* path, const char*) { return File(fopen(strcmp(path, "/audio.wav") ? path : audioFile.c_str(), "rb")); }
+};
+static HostFS WLED_FS;
+
+// ---- network (sound sync is not used during replay) ----
+class IPAddress {
+  uint8_t _a[4] = {0};
+  public:
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) { _a[0] = a; _a[1] = b; _a[2] = c; _a[3] = d; }
+    uint8_t operator[](int i) const { return _a[i]; }
+    String toString() const { char b[16]; snprintf(b, sizeof(b), "%u.%u.%u.%u", _a[0], _a[1], _a[2], _a[3]); return String(b); }
+};
+class WiFiUDP {
+  public:
+    uint8_t beginMulticast(IPAddress, uint16_t) { return 0; }
+    uint8_t begin(uint16_t) { return 0; }
+    void stop() {}
+    int parsePacket() { return 0; }
+    int read(uint8_t*, size_t) { return 0; }
+    void flush() {}
+    int beginMulticastPacket() { return 0; }
+    int beginPacket(IPAddress, uint16_t) { return 0; }
+    size_t write(const uint8_t*, size_t len) { return len; }
+    int endPacket() { return 0; }
+    IPAddress remoteIP() { return IPAddress(); }
+};
+struct HostWiFi {
+  IPAddress localIP() { return IPAddress(); }
+  bool isConnected() { return false; }
+};
+static HostWiFi WiFi;
+struct HostNetwork {
+  IPAddress localIP() { return IPAddress(); }
+  bool isConnected() { return false; }
+};
+static HostNetwork Network;
+
+// ---- WLED ----
+#define WLED_DEBUG_NONE
+#define DEBUG_PRINT(x)
+#define DEBUG_PRINTLN(x)
+#define DEBUG_PRINTF(x...)
+#define USER_PRINT(x)
+#define USER_PRINTLN(x)
+#define USER_PRINTF(x...)
+#define USER_FLUSH()
+#define SETTINGS_STACK_BUF_SIZE 3904
+#define CONFIG_ASYNC_TCP_TASK_STACK_SIZE 9472
+#define WLED_CONNECTED false
+#define BTN_TYPE_ANALOG 7
+#define BTN_TYPE_ANALOG_INVERTED 8
+#define ERR_NONE 0
+#define ERR_REBOOT_NEEDED 9
+#define ERR_POWEROFF_NEEDED 10
+#define REALTIME_MODE_INACTIVE 0
+#define REALTIME_MODE_GENERIC 1
+#define REALTIME_MODE_UDP 2
+#define REALTIME_MODE_HYPERION 3
+#define REALTIME_MODE_E131 4
+#define REALTIME_MODE_ADALIGHT 5
+#define REALTIME_MODE_ARTNET 6
+#define REALTIME_MODE_TPM2NET 7
+#define REALTIME_MODE_DDP 8
+#define REALTIME_OVERRIDE_NONE 0
+#define USERMOD_ID_UNSPECIFIED 1
+#define USERMOD_ID_AUDIOREACTIVE 32
+#define WLED_MAX_USERMODS 4
+
+static uint8_t realtimeMode = REALTIME_MODE_INACTIVE;
+static uint8_t realtimeOverride = REALTIME_OVERRIDE_NONE;
+static uint8_t errorFlag = ERR_NONE;
+static int8_t i2c_sda = -1, i2c_scl = -1;
+static bool apActive = false;
+static bool interfacesInited = false;
+static uint8_t buttonType[4] = {0};
+static bool OTAisRunning = false;
+static char serverDescription[33] = "WLED";
+
+enum class PinOwner : uint8_t { None = 0, UM_Audioreactive = 0x84 };
+struct HostPinManager {
+  bool allocatePin(int, bool, PinOwner) { return true; }
+  bool deallocatePin(int, PinOwner) { return true; }
+  bool joinWire(int8_t = -1, int8_t = -1) { return false; }
+  bool isPinAllocated(int, PinOwner = PinOwner::None) { return false; }
+};
+static HostPinManager pinManager;
+
+// one segment, running an audio effect - so adaptive processing stays at full rate
+#define FPS_UNLIMITED    250
+#define FPS_UNLIMITED_AC 0
+#define WLED_FPS         42
+struct Segment {
+  uint16_t start = 0, stop = 16;
+  bool on = true;
+  uint8_t mode = 1;
+  bool isActive() const { return stop > start; }
+};
+struct HostStrip {
+  Segment seg;
+  bool isServicing() const { return false; }
+  uint16_t getMinShowDelay() const { return 15; }
+  void setPixelColor(int, uint32_t) {}
+  uint16_t getLengthTotal() const { return 0; }
+  uint8_t getSegmentsNum() const { return 1; }
+  Segment& getSegment(uint8_t) { return seg; }
+  const char* getModeData(uint8_t id = 0) const { return id ? "Host replay@;;;1f;" : "Solid"; }
+  uint16_t getFps() const { return WLED_FPS; }
+  uint8_t getTargetFps() const { return WLED_FPS; }
+};
+static HostStrip strip;
+
+// no LED outputs on the host
+#define TYPE_HUB75MATRIX 100
+#define IS_DIGITAL(t) (((t) & 0x10) || ((t)==TYPE_HUB75MATRIX))
+#define IS_2PIN(t)    ((t) > 47)
+struct Bus {
+  uint8_t getType() const { return 0; }
+  uint16_t getLength() const { return 0; }
+  bool hasWhite() const { return false; }
+};
+struct HostBusManager {
+  uint8_t getNumBusses() const { return 0; }
+  Bus* getBus(uint8_t) { return nullptr; }
+};
+static HostBusManager busses;
+
+inline bool oappend(const char*) { return true; }
+inline bool oappendi(int) { return true; }
+
+template<typename DestType>
+bool getJsonValue(const JsonVariant& element, DestType& destination) {
+  if (element.isNull()) return false;
+  destination = element.as<DestType>();
+  return true;
+}
+template<typename DestType, typename DefaultType>
+bool getJsonValue(const JsonVariant& element, DestType& destination, const DefaultType defaultValue) {
+  if (!getJsonValue(element, destination)) { destination = defaultValue; return false; }
+  return true;
+}
+
+typedef enum UM_Data_Types {
+  UMT_BYTE = 0, UMT_UINT16, UMT_INT16, UMT_UINT32, UMT_INT32, UMT_FLOAT, UMT_DOUBLE,
+  UMT_BYTE_ARR, UMT_UINT16_ARR, UMT_INT16_ARR, UMT_UINT32_ARR, UMT_INT32_ARR, UMT_FLOAT_ARR, UMT_DOUBLE_ARR
+} um_types_t;
+typedef struct UM_Exchange_Data {
+  size_t       u_size = 0;
+  um_types_t  *u_type = nullptr;
+  void       **u_data = nullptr;
+  ~UM_Exchange_Data() { delete[] u_type; delete[] u_data; }
+} um_data_t;
+
+class Usermod {
+  protected:
+    um_data_t *um_data;
+    bool enabled = false;
+    const char *_name;
+    bool initDone = false;
+    unsigned long lastTime = 0;
+  public:
+    Usermod(const char *_name = nullptr, bool enabled = false) { um_data = nullptr; this->_name = _name; this->enabled = enabled; }
+    virtual ~Usermod() { if (um_data) delete um_data; }
+    virtual void setup() = 0;
+    virtual void loop() = 0;
+    virtual void loop2() {}
+    virtual void handleOverlayDraw() {}
+    virtual bool handleButton(uint8_t) { return false; }
+    virtual bool getUMData(um_data_t **data) { if (data) *data = nullptr; return false; }
+    virtual void connected() {}
+    virtual void appendConfigData() {}
+    virtual void addToJsonState(JsonObject&) {}
+    virtual void addToJsonInfo(JsonObject&) {}
+    virtual void readFromJsonState(JsonObject&) {}
+    virtual void addToConfig(JsonObject&) {}
+    virtual bool readFromConfig(JsonObject&) { return true; }
+    virtual void onUpdateBegin(bool) {}
+    virtual void onStateChange(uint8_t) {}
+    virtual uint16_t getId() { return USERMOD_ID_UNSPECIFIED; }
+};
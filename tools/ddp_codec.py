@@ -0,0 +1,331 @@
+#!/usr/bin/env python3
+"""
+Reference encoder for the WLED compressed DDP stream (see wled00/ddp_codec.h).
+
+Frames are sent as DDP packets with data type 0x8B (RGB) or 0x9B (RGBW). Delta frames only carry the
+pixel runs that changed since the previous frame, keyframes carry every pixel using run-length
+encoding and, where it is smaller, a per-packet palette.
+
+  python3 tools/ddp_codec.py bench [--width 128 --height 128 --frames 120 --dump stream.bin]
+      compares bandwidth of plain DDP and the compressed stream for synthetic test patterns,
+      --dump writes the packets for the decode-time benchmark (tools/ddp_codec_bench.cpp)
+  python3 tools/ddp_codec.py send --host 192.168.1.50 [--pattern sprite --fps 40 --keyframe 50]
+      streams a synthetic pattern (or --raw file with consecutive RGB frames) to a WLED device
+
+Only the Python standard library is required.
+"""
+
+import argparse
+import math
+import socket
+import struct
+import sys
+import time
+
+DDP_PORT = 4048
+DDP_HEADER_LEN = 10
+DDP_FLAGS_VER1 = 0x40
+DDP_FLAGS_PUSH = 0x01
+DDP_TYPE_COMPRESSED_RGB = 0x8B
+DDP_TYPE_COMPRESSED_RGBW = 0x9B
+DDP_TYPE_RGB24 = 0x0B
+DDP_MAX_DATALEN = 1440  # same payload limit WLED uses for sending
+
+FLAG_KEYFRAME = 0x01
+OP_SKIP, OP_LITERAL, OP_REPEAT = 0x00, 0x40, 0x80
+
+
+def op_header(op, count):
+    if count <= 63:
+        return bytes([op | (count - 1)])
+    return bytes([op | 0x3F]) + struct.pack(">H", count - 64)
+
+
+def op_header_len(count):
+    return 1 if count <= 63 else 3
+
+
+def tokenize(prev, cur, keyframe, min_repeat):
+    """split a frame into (kind, position, colors) tokens; unchanged pixels are left out of delta frames"""
+    tokens = []
+    n = len(cur)
+    i = 0
+    while i < n:
+        if not keyframe and prev is not None and prev[i] == cur[i]:
+            i += 1
+            continue
+        j = i + 1
+        while j < n and cur[j] == cur[i] and j - i < 65599:
+            j += 1
+        if j - i >= min_repeat:
+            tokens.append(("R", i, [cur[i]] * (j - i)))
+            i = j
+            continue
+        if tokens and tokens[-1][0] == "L" and tokens[-1][1] + len(tokens[-1][2]) == i and len(tokens[-1][2]) < 65599:
+            tokens[-1][2].append(cur[i])
+        else:
+            tokens.append(("L", i, [cur[i]]))
+        i += 1
+    return tokens
+
+
+class PacketBuilder:
+    def __init__(self, channels, max_len):
+        self.channels = channels
+        self.max_len = max_len
+        self.reset()
+
+    def reset(self):
+        self.tokens = []
+        self.palette = {}
+        self.palette_ok = True
+        self.size_rgb = 2
+        self.size_pal = 2
+
+    def token_cost(self, kind, pos, colors, palette):
+        gap = 0
+        if self.tokens:
+            last = self.tokens[-1]
+            gap = pos - (last[1] + len(last[2]))
+        cost_hdr = (op_header_len(gap) if gap else 0) + op_header_len(len(colors))
+        values = 1 if kind == "R" else len(colors)
+        new_colors = [c for c in dict.fromkeys(colors if kind == "L" else colors[:1]) if c not in palette]
+        return (cost_hdr + values * self.channels,
+                cost_hdr + values + len(new_colors) * self.channels,
+                new_colors)
+
+    def fits(self, kind, pos, colors):
+        rgb, pal, new_colors = self.token_cost(kind, pos, colors, self.palette)
+        pal_ok = self.palette_ok and len(self.palette) + len(new_colors) <= 255
+        size = self.size_rgb + rgb
+        if pal_ok:
+            size = min(size, self.size_pal + pal)
+        return size <= self.max_len
+
+    def add(self, kind, pos, colors):
+        rgb, pal, new_colors = self.token_cost(kind, pos, colors, self.palette)
+        self.size_rgb += rgb
+        self.size_pal += pal
+        if len(self.palette) + len(new_colors) > 255:
+            self.palette_ok = False
+        if self.palette_ok:
+            for c in new_colors:
+                self.palette[c] = len(self.palette)
+        self.tokens.append((kind, pos, colors))
+
+    def build(self, keyframe):
+        use_palette = self.palette_ok and self.size_pal < self.size_rgb
+        start = self.tokens[0][1]
+        out = bytearray([FLAG_KEYFRAME if keyframe else 0, len(self.palette) if use_palette else 0])
+        if use_palette:
+            for c in self.palette:
+                out += bytes(c[:self.channels])
+        cursor = start
+        for kind, pos, colors in self.tokens:
+            if pos > cursor:
+                out += op_header(OP_SKIP, pos - cursor)
+            values = colors[:1] if kind == "R" else colors
+            out += op_header(OP_REPEAT if kind == "R" else OP_LITERAL, len(colors))
+            for c in values:
+                out += bytes([self.palette[c]]) if use_palette else bytes(c[:self.channels])
+            cursor = pos + len(colors)
+        return start, bytes(out)
+
+
+def encode_frame(prev, cur, channels=3, keyframe=False, max_len=DDP_MAX_DATALEN):
+    """encode one frame, returns a list of (first pixel, payload) tuples"""
+    builder = PacketBuilder(channels, max_len)
+    packets = []
+    pending = tokenize(prev, cur, keyframe or prev is None, 3)
+    pending.reverse()
+    while pending:
+        kind, pos, colors = pending.pop()
+        if builder.fits(kind, pos, colors):
+            builder.add(kind, pos, colors)
+            continue
+        if kind == "L" and len(colors) > 1:
+            # split literal runs so they fill the current packet
+            lo, hi = 1, len(colors) - 1
+            best = 0
+            while lo <= hi:
+                mid = (lo + hi) // 2
+                if builder.fits(kind, pos, colors[:mid]):
+                    best, lo = mid, mid + 1
+                else:
+                    hi = mid - 1
+            if best:
+                builder.add(kind, pos, colors[:best])
+                pending.append((kind, pos + best, colors[best:]))
+                packets.append(builder.build(keyframe or prev is None))
+                builder.reset()
+                continue
+        if not builder.tokens:
+            raise ValueError("token does not fit into an empty packet")
+        packets.append(builder.build(keyframe or prev is None))
+        builder.reset()
+        pending.append((kind, pos, colors))
+    if builder.tokens:
+        packets.append(builder.build(keyframe or prev is None))
+    return packets
+
+
+def decode_payload(payload, start, channels, frame):
+    """python version of ddpzDecode() used to verify the encoder"""
+    flags, pal_size = payload[0], payload[1]
+    p = 2
+    palette = [tuple(payload[p + i * channels:p + (i + 1) * channels]) for i in range(pal_size)]
+    p += pal_size * channels
+    pos = start
+    vsize = 1 if pal_size else channels
+    while p < len(payload):
+        op = payload[p]
+        p += 1
+        count = op & 0x3F
+        if count == 0x3F:
+            count = 64 + struct.unpack(">H", payload[p:p + 2])[0]
+            p += 2
+        else:
+            count += 1
+        kind = op & 0xC0
+        if kind == OP_SKIP:
+            pos += count
+        elif kind == OP_LITERAL:
+            for _ in range(count):
+                v = payload[p:p + vsize]
+                frame[pos] = palette[v[0]] if pal_size else tuple(v)
+                pos += 1
+                p += vsize
+        elif kind == OP_REPEAT:
+            v = payload[p:p + vsize]
+            c = palette[v[0]] if pal_size else tuple(v)
+            p += vsize
+            for _ in range(count):
+                frame[pos] = c
+                pos += 1
+        else:
+            raise ValueError("reserved op")
+
+
+def ddp_packet(seq, offset, payload, push, channels):
+    data_type = DDP_TYPE_COMPRESSED_RGBW if channels == 4 else DDP_TYPE_COMPRESSED_RGB
+    flags = DDP_FLAGS_VER1 | (DDP_FLAGS_PUSH if push else 0)
+    return struct.pack(">BBBBIH", flags, seq, data_type, 1, offset * channels, len(payload)) + payload
+
+
+# synthetic test patterns (w x h, list of RGB tuples)
+def pattern_plasma(w, h, t):
+    return [(int(127 + 127 * math.sin(x * 0.11 + t * 0.07)),
+             int(127 + 127 * math.sin(y * 0.13 + t * 0.05)),
+             int(127 + 127 * math.sin((x + y) * 0.07 + t * 0.09))) for y in range(h) for x in range(w)]
+
+
+def pattern_sprite(w, h, t):
+    frame = [(0, 0, 32)] * (w * h)
+    for s in range(4):
+        cx = int((w - 8) * (0.5 + 0.5 * math.sin(t * 0.05 + s)))
+        cy = int((h - 8) * (0.5 + 0.5 * math.cos(t * 0.04 + 2 * s)))
+        for y in range(cy, cy + 8):
+            for x in range(cx, cx + 8):
+                frame[y * w + x] = (255, 64 * s, 255 - 64 * s)
+    return frame
+
+
+def pattern_text(w, h, t):
+    # few colors, large flat areas: scrolling bars on a static background
+    colors = [(0, 0, 0), (255, 0, 0), (0, 255, 0), (255, 255, 255)]
+    return [colors[((x + t) // 6 + y // 16) % 4] if y % 16 < 10 else (0, 0, 0) for y in range(h) for x in range(w)]
+
+
+PATTERNS = {"plasma": pattern_plasma, "sprite": pattern_sprite, "text": pattern_text}
+
+
+def read_raw_frames(path, w, h):
+    size = w * h * 3
+    with open(path, "rb") as f:
+        while True:
+            raw = f.read(size)
+            if len(raw) < size:
+                return
+            yield [tuple(raw[i:i + 3]) for i in range(0, size, 3)]
+
+
+def cmd_bench(args):
+    n = args.width * args.height
+    raw_packets = math.ceil(n * 3 / DDP_MAX_DATALEN)
+    raw_bytes = n * 3 + raw_packets * DDP_HEADER_LEN
+    dump = open(args.dump, "wb") if args.dump else None
+    if dump:
+        dump.write(b"DDPZ" + struct.pack("<IB", n, 3))
+    print(f"{args.width}x{args.height}, {args.frames} frames, keyframe every {args.keyframe} frames")
+    print(f"plain DDP: {raw_bytes} bytes/frame, {raw_packets} packets, {raw_bytes * 8 * 40 / 1e6:.1f} Mbit/s at 40 fps")
+    for name, gen in PATTERNS.items():
+        prev = None
+        total = packets = 0
+        t0 = time.perf_counter()
+        check = [(0, 0, 0)] * n
+        last = None
+        for t in range(args.frames):
+            cur = gen(args.width, args.height, t)
+            pk = encode_frame(prev, cur, 3, keyframe=(t % args.keyframe == 0))
+            for i, (start, payload) in enumerate(pk):
+                decode_payload(payload, start, 3, check)
+                total += len(payload) + DDP_HEADER_LEN
+                if dump:
+                    pkt = ddp_packet(t & 0x0F or 1, start, payload, i == len(pk) - 1, 3)
+                    dump.write(struct.pack("<H", len(pkt)) + pkt)
+            if dump:
+                dump.write(struct.pack("<H", 0))  # end of frame
+            packets += len(pk)
+            if check != cur:
+                sys.exit(f"{name}: decoded frame {t} differs from source")
+            prev = last = cur
+        if dump:
+            dump.write(struct.pack("<H", 0xFFFF) + b"".join(bytes(c) for c in last))  # reference frame
+        enc = (time.perf_counter() - t0) / args.frames * 1000
+        per_frame = total / args.frames
+        print(f"{name:8s}: {per_frame:8.0f} bytes/frame ({100 * per_frame / raw_bytes:5.1f}%), "
+              f"{packets / args.frames:5.1f} packets, {per_frame * 8 * 40 / 1e6:5.2f} Mbit/s at 40 fps, "
+              f"encode+verify {enc:.1f} ms/frame")
+    if dump:
+        dump.close()
+
+
+def cmd_send(args):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    if args.raw:
+        frames = read_raw_frames(args.raw, args.width, args.height)
+    else:
+        gen = PATTERNS[args.pattern]
+        frames = (gen(args.width, args.height, t) for t in range(args.frames))
+    prev = None
+    seq = 1
+    for t, cur in enumerate(frames):
+        t0 = time.perf_counter()
+        pk = encode_frame(prev, cur, 3, keyframe=(t % args.keyframe == 0))
+        for i, (start, payload) in enumerate(pk):
+            sock.sendto(ddp_packet(seq, start, payload, i == len(pk) - 1, 3), (args.host, DDP_PORT))
+        seq = seq % 15 + 1
+        prev = cur
+        time.sleep(max(0.0, 1.0 / args.fps - (time.perf_counter() - t0)))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = ap.add_subparsers(dest="cmd", required=True)
+    for name in ("bench", "send"):
+        p = sub.add_parser(name)
+        p.add_argument("--width", type=int, default=128)
+        p.add_argument("--height", type=int, default=128)
+        p.add_argument("--frames", type=int, default=120)
+        p.add_argument("--keyframe", type=int, default=50, help="send a keyframe every n frames")
+    sub.choices["bench"].add_argument("--dump", help="write packets for tools/ddp_codec_bench.cpp")
+    sub.choices["send"].add_argument("--host", required=True)
+    sub.choices["send"].add_argument("--fps", type=float, default=40)
+    sub.choices["send"].add_argument("--pattern", choices=PATTERNS.keys(), default="sprite")
+    sub.choices["send"].add_argument("--raw", help="file with consecutive width*height*3 byte RGB frames")
+    args = ap.parse_args()
+    cmd_bench(args) if args.cmd == "bench" else cmd_send(args)
+
+
+if __name__ == "__main__":
+    main()
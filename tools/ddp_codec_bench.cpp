@@ -0,0 +1,93 @@
+/*
+ * Host benchmark for the compressed DDP decoder (wled00/ddp_codec.h)
+ *
+ *   python3 tools/ddp_codec.py bench --dump /tmp/stream.bin
+ *   g++ -O2 -std=c++17 -o /tmp/ddp_codec_bench tools/ddp_codec_bench.cpp && /tmp/ddp_codec_bench /tmp/stream.bin
+ *
+ * Decodes every stream in the dump several times, checks the last frame against the reference frame
+ * written by the encoder and compares decode time with copying the same frames as plain DDP RGB data.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "../wled00/ddp_codec.h"
+
+static std::vector<uint8_t> frameBuffer;
+
+static void setPixel(uint32_t i, uint8_t r, uint8_t g, uint8_t b, uint8_t) {
+  if (3 * i + 2 >= frameBuffer.size()) return;
+  frameBuffer[3*i] = r; frameBuffer[3*i+1] = g; frameBuffer[3*i+2] = b;
+}
+
+struct Stream {
+  std::vector<std::vector<std::vector<uint8_t>>> frames; // frames -> DDP packets
+  std::vector<uint8_t> reference;
+};
+
+int main(int argc, char** argv) {
+  if (argc < 2) { fprintf(stderr, "usage: %s stream.bin [repeat]\n", argv[0]); return 1; }
+  int repeat = argc > 2 ? atoi(argv[2]) : 20;
+  FILE* f = fopen(argv[1], "rb");
+  if (!f) { perror(argv[1]); return 1; }
+  char magic[4]; uint32_t pixels = 0; uint8_t channels = 0;
+  if (fread(magic, 1, 4, f) != 4 || memcmp(magic, "DDPZ", 4) || fread(&pixels, 4, 1, f) != 1 || fread(&channels, 1, 1, f) != 1) {
+    fprintf(stderr, "not a ddp_codec.py dump\n"); return 1;
+  }
+
+  std::vector<Stream> streams(1);
+  std::vector<std::vector<uint8_t>> frame;
+  uint16_t len;
+  while (fread(&len, 2, 1, f) == 1) {
+    if (len == 0xFFFF) { // reference frame ends a stream
+      streams.back().reference.resize(pixels * channels);
+      if (fread(streams.back().reference.data(), 1, pixels * channels, f) != pixels * channels) break;
+      streams.emplace_back();
+    } else if (len == 0) {
+      streams.back().frames.push_back(frame);
+      frame.clear();
+    } else {
+      std::vector<uint8_t> pkt(len);
+      if (fread(pkt.data(), 1, len, f) != len) break;
+      frame.push_back(pkt);
+    }
+  }
+  fclose(f);
+  streams.pop_back();
+
+  std::vector<uint8_t> plain(pixels * 3);
+  for (size_t s = 0; s < streams.size(); s++) {
+    Stream& st = streams[s];
+    size_t bytes = 0;
+    for (auto& fr : st.frames) for (auto& p : fr) bytes += p.size();
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; r++) {
+      frameBuffer.assign(pixels * 3, 0);
+      for (auto& fr : st.frames) for (auto& p : fr) {
+        uint32_t offset = (p[4] << 24) | (p[5] << 16) | (p[6] << 8) | p[7];
+        uint16_t dataLen = (p[8] << 8) | p[9];
+        uint8_t ch = ((p[2] & 0b00111000) >> 3 == 0b011) ? 4 : 3;
+        if (ddpzDecode(p.data() + 10, dataLen, offset / ch, pixels, ch, setPixel) < 0) { fprintf(stderr, "stream %zu: decode error\n", s); return 1; }
+      }
+    }
+    double compressed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / repeat / st.frames.size();
+    bool ok = frameBuffer == st.reference;
+
+    // plain DDP for comparison: every pixel of every frame written from packet data
+    t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; r++) {
+      for (size_t fr = 0; fr < st.frames.size(); fr++) {
+        for (uint32_t i = 0; i < pixels; i++) setPixel(i, plain[3*i], plain[3*i+1], plain[3*i+2], 0);
+        plain[fr % plain.size()]++;
+      }
+    }
+    double raw = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / repeat / st.frames.size();
+
+    printf("stream %zu: %zu frames, %6zu bytes/frame, decode %7.1f us/frame (plain DDP %7.1f us/frame), %s\n",
+           s, st.frames.size(), bytes / st.frames.size(), compressed, raw, ok ? "last frame matches" : "LAST FRAME DIFFERS");
+    if (!ok) return 1;
+  }
+  return 0;
+}
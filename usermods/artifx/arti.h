@@ -70,13 +70,17 @@
   FILE * logFile; // FILE needed to use in fprintf (std stream does not work)
 
   #define ARTI_ERRORWARNING 1
-  #define ARTI_DEBUG 1
-  #define ARTI_ANDBG 1
-  #define ARTI_RUNLOG 1
-  #define ARTI_MEMORY 1
+  #ifndef ARTI_BENCHMARK //WLEDMM tools/arti_bench measures run time, so no tracing
+    #define ARTI_DEBUG 1
+    #define ARTI_ANDBG 1
+    #define ARTI_RUNLOG 1
+    #define ARTI_MEMORY 1
+  #endif
   #define ARTI_PRINT 1
 
   #include <math.h>
+  #include <stdarg.h>
+  #include <chrono>
   #include <iostream>
   #include <fstream>
   #include <sstream>
@@ -140,7 +144,7 @@ void artiPrintf(char const * format, ...)
       }
     }
   #else
-    vfprintf(logFile, format, argp);
+    vfprintf((logToFile && logFile) ? logFile : stdout, format, argp); //WLEDMM not to a closed logFile
   #endif
   va_end(argp);
 }
@@ -149,7 +153,7 @@ void artiPrintf(char const * format, ...)
 #if ARTI_PLATFORM != ARTI_ARDUINO
   uint32_t millis()
   {
-    return std::chrono::system_clock::now().time_since_epoch().count();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count(); //WLEDMM milliseconds, not clock ticks
   }
 #endif
 
@@ -1042,6 +1046,450 @@ public:
 
 }; //ValueStack
 
+//WLEDMM bytecode: after analyze, the parse tree is compiled once into a flat program for a small stack machine
+// - variables are resolved to slots at compile time (no json lookups, symbol tables or activation records while running)
+// - expressions are folded left to right as interpret() does, so the results are the same
+// - if the parse tree has something the compiler does not know, the parse tree is interpreted as before
+
+enum BytecodeOps
+{
+  // binary operators: same numbers as the tokens F_plus ... F_or
+  BC_PLUS = F_plus,
+  BC_MINUS,
+  BC_MULTIPLICATION,
+  BC_DIVISION,
+  BC_MODULO,
+  BC_BITSHIFTLEFT,
+  BC_BITSHIFTRIGHT,
+  BC_EQUAL,
+  BC_NOTEQUAL,
+  BC_LESSTHEN,
+  BC_LESSTHENOREQUAL,
+  BC_GREATERTHEN,
+  BC_GREATERTHENOREQUAL,
+  BC_AND,
+  BC_OR,
+  BC_NEG,           // unary minus
+  BC_CONST,         // float: push
+  BC_LOAD_GLOBAL,   // slot: push variable of the program
+  BC_LOAD_LOCAL,    // slot: push variable of the running function
+  BC_LOAD_OUTER,    // level, slot: push variable of the nearest function with that nesting level
+  BC_STORE_GLOBAL,  // slot, assignoperator (F_NoToken: =): pop into variable
+  BC_STORE_LOCAL,   // slot, assignoperator
+  BC_STORE_OUTER,   // level, slot, assignoperator
+  BC_GET_EXT,       // external, nrOfIndices: pop indices, push external variable
+  BC_SET_EXT,       // external, nrOfIndices: pop indices and value, set external variable
+  BC_CALL_EXT,      // external, nrOfArgs, keep: pop arguments, call external function, push result if keep
+  BC_CALL,          // function, nrOfArgs: pop arguments into the formals and run the function
+  BC_DEFINE,        // function: function can be called from here on (see F_Function in interpret)
+  BC_RETURN,
+  BC_POP,           // count
+  BC_JUMP,          // address
+  BC_JUMP_IF_NOT_ONE, // address: pop condition, jump if not 1 (if and cex)
+  BC_FOR_BEGIN,     // push iteration counter
+  BC_FOR_CHECK,     // address: increase counter, to address if too many iterations
+  BC_FOR_TEST,      // variable, address: pop condition, 1: push normal, 0: to address, else pascal (variable <= condition): push pascal or to address
+  BC_FOR_NEXT,      // variable, address: pop normal/pascal, pascal: variable + 1 and to address, normal: next instruction (increment)
+};
+
+// variables referred to by BC_FOR_TEST and BC_FOR_NEXT: kind, level, slot
+#define VAR_NONE 0
+#define VAR_GLOBAL 1
+#define VAR_LOCAL 2
+#define VAR_OUTER 3
+
+// compile time image of the value stack: operator tokens and values
+#define ITEM_VALUE 254
+#define ITEM_NOFOLD 255
+
+#define nrOfFunctions 20 // including the program itself
+#define nrOfSlots 128 // variables of all running functions
+#define codeLength 16384
+
+//WLEDMM compiled program file (<program>.wbc), little endian:
+//  header: "ARTB", bytecodeVersion, functionsIndex, codeSize (2), definition hash, program hash, body hash (4 each)
+//  body: functionsIndex x (name, entry (2), nesting_level, nrOfFormals, nrOfVars, maxStack), code
+// definition and program hash are of the files the program was compiled from: if one of them changed, it is compiled again
+// bytecodeVersion: increase if opcodes or the file layout change
+#define bytecodeVersion 1
+#define bytecodeHeaderSize 20
+#define bytecodeFunctionSize (charLength + 6)
+#define hashSeed 2166136261UL
+
+// FNV-1a, start with hashSeed
+uint32_t artiHash(uint32_t hash, const uint8_t *data, size_t length) 
+{
+  for (size_t i=0; i<length; i++)
+    hash = (hash ^ data[i]) * 16777619UL;
+  return hash;
+}
+
+struct ArtiFunction {
+  char name[charLength];
+  uint16_t entry;       // address of first instruction
+  uint8_t nesting_level;
+  uint8_t nrOfFormals;
+  uint8_t nrOfVars;     // formals and other symbols of the function scope
+  uint8_t maxStack;     // values on the stack while running the function (without functions it calls)
+};
+
+class ArtiProgram 
+{
+  private:
+  public:
+    uint8_t *code = nullptr;
+    uint16_t codeSize = 0;
+    uint16_t codeCapacity = 0;
+    ArtiFunction functions[nrOfFunctions]; //0 is the program itself
+    uint8_t functionsIndex = 0;
+
+    ArtiProgram() 
+    {
+    }
+
+    ~ArtiProgram() 
+    {
+      if (code != nullptr) free(code);
+      MEMORY_ARTI("Destruct ArtiProgram\n");
+    }
+
+    bool emit(uint8_t value) 
+    {
+      if (codeSize >= codeCapacity) 
+      {
+        uint16_t newCapacity = codeCapacity ? ((2 * codeCapacity < codeLength) ? 2 * codeCapacity : codeLength) : 256;
+        if (codeSize >= newCapacity) return false;
+        uint8_t *newCode = (uint8_t *)realloc(code, newCapacity);
+        if (newCode == nullptr) return false;
+        code = newCode;
+        codeCapacity = newCapacity;
+      }
+      code[codeSize++] = value;
+      return true;
+    }
+
+    bool emit16(uint16_t value) 
+    {
+      return emit(value & 0xFF) && emit(value >> 8);
+    }
+
+    bool emitFloat(float value) 
+    {
+      uint8_t bytes[sizeof(float)];
+      memcpy(bytes, &value, sizeof(float));
+      for (uint8_t i=0; i<sizeof(float); i++)
+        if (!emit(bytes[i])) return false;
+      return true;
+    }
+
+    void patch16(uint16_t address, uint16_t value) 
+    {
+      code[address] = value & 0xFF;
+      code[address+1] = value >> 8;
+    }
+
+    uint8_t lookup(const char * name) //functions of the program scope
+    {
+      for (uint8_t i=1; i<functionsIndex; i++)
+        if (functions[i].nesting_level == 2 && strcmp(functions[i].name, name) == 0) return i;
+      return F_NoToken;
+    }
+
+    size_t memoryUsage() 
+    {
+      return sizeof(ArtiProgram) + codeCapacity;
+    }
+
+    size_t fileSize() 
+    {
+      return bytecodeHeaderSize + functionsIndex * bytecodeFunctionSize + codeSize;
+    }
+
+    // buffer: fileSize() bytes
+    void write(uint8_t *buffer, uint32_t definitionHash, uint32_t programHash) 
+    {
+      uint8_t *body = buffer + bytecodeHeaderSize;
+      uint8_t *p = body;
+      for (uint8_t i=0; i<functionsIndex; i++) 
+      {
+        ArtiFunction *f = &functions[i];
+        memset(p, 0, charLength);
+        strncpy((char *)p, f->name, charLength-1);
+        p += charLength;
+        *p++ = f->entry & 0xFF; *p++ = f->entry >> 8;
+        *p++ = f->nesting_level; *p++ = f->nrOfFormals; *p++ = f->nrOfVars; *p++ = f->maxStack;
+      }
+      memcpy(p, code, codeSize);
+      p += codeSize;
+
+      memcpy(buffer, "ARTB", 4);
+      buffer[4] = bytecodeVersion;
+      buffer[5] = functionsIndex;
+      buffer[6] = codeSize & 0xFF; buffer[7] = codeSize >> 8;
+      put32(buffer + 8, definitionHash);
+      put32(buffer + 12, programHash);
+      put32(buffer + 16, artiHash(hashSeed, body, p - body));
+    }
+
+    // false if the buffer is not a valid program file or compiled from other files
+    bool read(const uint8_t *buffer, size_t length, uint32_t definitionHash, uint32_t programHash) 
+    {
+      if (length < bytecodeHeaderSize || memcmp(buffer, "ARTB", 4) != 0 || buffer[4] != bytecodeVersion) return false;
+      if (get32(buffer + 8) != definitionHash || get32(buffer + 12) != programHash) return false;
+      uint8_t nrOfFunctionsRead = buffer[5];
+      uint16_t codeSizeRead = buffer[6] | (buffer[7] << 8);
+      if (nrOfFunctionsRead < 1 || nrOfFunctionsRead > nrOfFunctions || codeSizeRead == 0) return false;
+      if (length != (size_t)bytecodeHeaderSize + nrOfFunctionsRead * bytecodeFunctionSize + codeSizeRead) return false;
+      const uint8_t *p = buffer + bytecodeHeaderSize;
+      if (get32(buffer + 16) != artiHash(hashSeed, p, length - bytecodeHeaderSize)) return false;
+
+      for (uint8_t i=0; i<nrOfFunctionsRead; i++) 
+      {
+        ArtiFunction *f = &functions[i];
+        memcpy(f->name, p, charLength);
+        f->name[charLength-1] = '\0';
+        p += charLength;
+        f->entry = p[0] | (p[1] << 8);
+        f->nesting_level = p[2]; f->nrOfFormals = p[3]; f->nrOfVars = p[4]; f->maxStack = p[5];
+        p += 6;
+        if (f->entry >= codeSizeRead || f->maxStack > arrayLength) return false;
+      }
+
+      uint8_t *newCode = (uint8_t *)malloc(codeSizeRead);
+      if (newCode == nullptr) return false;
+      memcpy(newCode, p, codeSizeRead);
+      if (!verify(newCode, codeSizeRead, nrOfFunctionsRead)) 
+      {
+        free(newCode);
+        return false;
+      }
+      if (code != nullptr) free(code);
+      code = newCode;
+      codeSize = codeCapacity = codeSizeRead;
+      functionsIndex = nrOfFunctionsRead;
+      return true;
+    }
+
+  private:
+    // bytes following opcode op, 0xFF if op is not an opcode
+    static uint8_t operandSize(uint8_t op) 
+    {
+      if (op >= BC_PLUS && op <= BC_NEG) return 0;
+      switch (op) 
+      {
+        case BC_RETURN: case BC_FOR_BEGIN: return 0;
+        case BC_LOAD_GLOBAL: case BC_LOAD_LOCAL: case BC_DEFINE: case BC_POP: return 1;
+        case BC_LOAD_OUTER: case BC_STORE_GLOBAL: case BC_STORE_LOCAL: case BC_GET_EXT: case BC_SET_EXT: case BC_CALL: 
+        case BC_JUMP: case BC_JUMP_IF_NOT_ONE: case BC_FOR_CHECK: return 2;
+        case BC_STORE_OUTER: case BC_CALL_EXT: return 3;
+        case BC_CONST: return sizeof(float);
+        case BC_FOR_TEST: case BC_FOR_NEXT: return 5;
+        default: return 0xFF;
+      }
+    }
+
+    // number of variables of the innermost function at nesting level that contains address, -1 if there is none
+    int varsAt(uint16_t address, uint8_t level, const uint16_t *end, uint8_t count) const
+    {
+      int found = -1;
+      for (uint8_t i=0; i<count; i++) 
+        if (functions[i].nesting_level == level && (i == 0 || (functions[i].entry <= address && address < end[i])) && (found < 0 || functions[i].entry >= functions[found].entry)) 
+          found = i;
+      return (found < 0) ? -1 : functions[found].nrOfVars;
+    }
+
+    // variable operands of VAR_xxx kind
+    bool validVariable(uint16_t address, uint8_t kind, uint8_t level, uint8_t slot, uint8_t nesting, const uint16_t *end, uint8_t count) const
+    {
+      switch (kind) 
+      {
+        case VAR_NONE: return level == 0 && slot == 0;
+        case VAR_GLOBAL: return slot < functions[0].nrOfVars;
+        case VAR_LOCAL: return slot < varsAt(address, nesting, end, count);
+        case VAR_OUTER: return level < nesting && slot < varsAt(address, level, end, count);
+        default: return false;
+      }
+    }
+
+    // innermost function whose code contains address (0: the program itself)
+    uint8_t functionAt(uint16_t address, const uint16_t *end, uint8_t count) const
+    {
+      uint8_t found = 0;
+      for (uint8_t i=1; i<count; i++) 
+        if (functions[i].entry <= address && address < end[i] && (found == 0 || functions[i].entry > functions[found].entry)) found = i;
+      return found;
+    }
+
+    // values an instruction needs on the stack, and how many it leaves there instead
+    static void stackEffect(uint8_t op, const uint8_t *operands, uint8_t &pops, uint8_t &pushes)
+    {
+      pops = 0; pushes = 0;
+      if (op >= BC_PLUS && op <= BC_OR) { pops = 2; pushes = 1; return; }
+      switch (op) 
+      {
+        case BC_NEG: pops = 1; pushes = 1; break;
+        case BC_CONST: case BC_LOAD_GLOBAL: case BC_LOAD_LOCAL: case BC_LOAD_OUTER: case BC_FOR_BEGIN: pushes = 1; break;
+        case BC_STORE_GLOBAL: case BC_STORE_LOCAL: case BC_STORE_OUTER: pops = 1; break;
+        case BC_GET_EXT: pops = operands[1]; pushes = 1; break;
+        case BC_SET_EXT: pops = operands[1] + 1; break;
+        case BC_CALL_EXT: pops = operands[1]; pushes = operands[2] ? 1 : 0; break;
+        case BC_CALL: pops = operands[1]; break;
+        case BC_POP: pops = operands[0]; break;
+        case BC_JUMP_IF_NOT_ONE: pops = 1; break;
+        case BC_FOR_CHECK: pops = 1; pushes = 1; break;          // counter stays on the stack
+        case BC_FOR_TEST: case BC_FOR_NEXT: pops = 1; break;      // BC_FOR_TEST pushes 1 again when it does not jump
+        default: break;
+      }
+    }
+
+    // run() does not check operands or the stack. A damaged or forged file must not make it access variables, functions,
+    // code or stack outside their arrays, so the code is checked once after loading:
+    // - every byte belongs to an instruction, function entries and jumps go to instructions
+    // - slots are variables of the function the instruction is in (or of an enclosing one), functions exist
+    // - the stack never has fewer values than an instruction takes, or more than maxStack of the function
+    bool verify(const uint8_t *program, uint16_t size, uint8_t count) const
+    {
+      // functions are compiled as BC_JUMP <end>, code, BC_RETURN, BC_DEFINE (see F_Function in compile)
+      uint16_t end[nrOfFunctions];
+      for (uint8_t i=0; i<count; i++) 
+      {
+        const ArtiFunction *f = &functions[i];
+        if (f->nrOfVars > nrOfSlots || f->nrOfFormals > f->nrOfVars) return false;
+        if (i == 0) { end[i] = size; continue; }
+        if (f->entry < 3 || program[f->entry-3] != BC_JUMP || f->nesting_level < 2) return false;
+        end[i] = program[f->entry-2] | (program[f->entry-1] << 8);
+        if (end[i] <= f->entry || end[i] > size) return false;
+      }
+
+      // depth[address]: values on the stack before the instruction at address; NOT_CODE: operand byte, UNKNOWN: not reached yet
+      #define NOT_CODE 0xFF
+      #define UNKNOWN 0xFE
+      uint8_t *depth = (uint8_t *)malloc(size);
+      if (depth == nullptr) return false;
+      memset(depth, NOT_CODE, size);
+      bool valid = true;
+
+      // instructions and their operands
+      uint16_t pc = 0;
+      while (valid && pc < size) 
+      {
+        uint16_t address = pc;
+        uint8_t op = program[pc++];
+        uint8_t length = operandSize(op);
+        if (length == 0xFF || pc + length > size) { valid = false; break; }
+        depth[address] = UNKNOWN;
+        const uint8_t *operands = program + pc;
+        pc += length;
+
+        uint8_t nesting = functions[functionAt(address, end, count)].nesting_level;
+        switch (op) 
+        {
+          case BC_LOAD_GLOBAL: case BC_STORE_GLOBAL: valid = validVariable(address, VAR_GLOBAL, 0, operands[0], nesting, end, count); break;
+          case BC_LOAD_LOCAL: case BC_STORE_LOCAL: valid = validVariable(address, VAR_LOCAL, 0, operands[0], nesting, end, count); break;
+          case BC_LOAD_OUTER: case BC_STORE_OUTER: valid = validVariable(address, VAR_OUTER, operands[0], operands[1], nesting, end, count); break;
+          case BC_FOR_TEST: case BC_FOR_NEXT: valid = validVariable(address, operands[0], operands[1], operands[2], nesting, end, count); break;
+          case BC_GET_EXT: case BC_SET_EXT: valid = operands[1] <= 2; break;
+          case BC_CALL_EXT: valid = operands[1] <= 5; break;
+          case BC_CALL: valid = operands[0] > 0 && operands[0] < count; break;
+          case BC_DEFINE: valid = operands[0] > 0 && operands[0] < count; break;
+          default: break;
+        }
+      }
+      if (pc != size) valid = false;
+
+      // stack depth along all paths from the function entries, until nothing changes (loops jump back)
+      for (uint8_t i=0; i<count && valid; i++) 
+      {
+        if (functions[i].entry >= size || depth[functions[i].entry] == NOT_CODE) valid = false;
+        else depth[functions[i].entry] = 0;
+      }
+      bool changed = true;
+      while (valid && changed) 
+      {
+        changed = false;
+        for (pc = 0; pc < size && valid; ) 
+        {
+          uint16_t address = pc;
+          uint8_t op = program[pc++];
+          const uint8_t *operands = program + pc;
+          pc += operandSize(op);
+          if (depth[address] == UNKNOWN) continue;
+
+          uint8_t pops, pushes;
+          stackEffect(op, operands, pops, pushes);
+          if (depth[address] < pops) { valid = false; break; }
+          uint8_t after = depth[address] - pops + pushes;
+          if (after > functions[functionAt(address, end, count)].maxStack) { valid = false; break; }
+
+          // next instructions: (address, depth) - at most two
+          uint16_t next[2] = {pc, size};
+          uint8_t nextDepth[2] = {after, after};
+          if (op == BC_JUMP) next[0] = operands[0] | (operands[1] << 8);
+          else if (op == BC_JUMP_IF_NOT_ONE || op == BC_FOR_CHECK) next[1] = operands[0] | (operands[1] << 8);
+          else if (op == BC_FOR_TEST) { next[1] = operands[3] | (operands[4] << 8); nextDepth[0] = after + 1; }
+          else if (op == BC_FOR_NEXT) next[1] = operands[3] | (operands[4] << 8);
+          else if (op == BC_RETURN) { valid = (depth[address] == 0); next[0] = size; }
+          if (nextDepth[0] > functions[functionAt(address, end, count)].maxStack) valid = false;
+
+          for (uint8_t n=0; n<2 && valid; n++) 
+          {
+            if (next[n] == size && (n == 1 || op == BC_RETURN)) continue;
+            if (next[n] >= size || depth[next[n]] == NOT_CODE) valid = false;             // not an instruction
+            else if (depth[next[n]] == UNKNOWN) { depth[next[n]] = nextDepth[n]; changed = true; }
+            else if (depth[next[n]] != nextDepth[n]) valid = false;                         // different depth on another path
+          }
+        }
+      }
+      #undef NOT_CODE
+      #undef UNKNOWN
+
+      free(depth);
+      return valid;
+    }
+
+    static void put32(uint8_t *p, uint32_t value) 
+    {
+      for (uint8_t i=0; i<4; i++) p[i] = (value >> (8*i)) & 0xFF;
+    }
+
+    static uint32_t get32(const uint8_t *p) 
+    {
+      return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+}; //ArtiProgram
+
+struct ArtiFrame {
+  uint8_t function;
+  uint8_t nesting_level;
+  uint8_t base;              // first slot
+  uint16_t returnAddress;
+};
+
+class ArtiMachine 
+{
+  private:
+  public:
+    float stack[arrayLength];
+    uint8_t stack_index = 0;
+    float slots[nrOfSlots];
+    uint8_t slotsIndex = 0;
+    ArtiFrame frames[nrOfRecords];
+    uint8_t framesIndex = 0;
+    bool defined[nrOfFunctions];
+
+    ArtiMachine() 
+    {
+      memset(slots, 0, sizeof(slots));
+      memset(defined, 0, sizeof(defined));
+    }
+
+    ~ArtiMachine() 
+    {
+      RUNLOG_ARTI("Destruct ArtiMachine\n");
+    }
+}; //ArtiMachine
+
 #define programTextSize 5000
 
 class ARTI {
@@ -1057,6 +1505,20 @@ private:
   CallStack *callStack = nullptr;
   ValueStack *valueStack = nullptr;
 
+  ArtiProgram *program = nullptr; //WLEDMM bytecode, see compile()
+  ArtiMachine *machine = nullptr;
+
+  //compile state
+  uint8_t cItems[arrayLength]; //compile time image of the value stack (ITEM_VALUE or operator token)
+  uint8_t cItemsIndex = 0;
+  uint8_t cBase = ITEM_NOFOLD; //first item of the innermost expr or term
+  bool cValueContext = false; //false: statement, results are not used
+  uint8_t cDepth = 0; //values on the stack when running
+  uint8_t cMaxDepth = 0;
+  uint8_t cNesting = 1; //nesting level of the function compiled
+  bool cFailed = false;
+  ScopedSymbolTable *cScopes[nrOfFunctions];
+
   uint8_t stages = 5; //for debugging: 0:parseFile, 1:Lexer, 2:parse, 3:optimize, 4:analyze, 5:interpret should be 5 if no debugging
 
   char logFileName[fileNameLength];
@@ -1064,6 +1526,11 @@ private:
   uint32_t startMillis;
 
 public:
+  bool useBytecode = true; //WLEDMM compile to bytecode after analyze (false: interpret the parse tree)
+  bool useCache = true; //WLEDMM load the compiled program from <program>.wbc if the program and definition did not change, save it after compile
+  bool programCached = false; //program loaded from <program>.wbc
+  uint32_t setupMillis = 0; //time setup took (until main has run)
+
   ARTI() 
   {
     // MEMORY_ARTI("new Arti < %u\n", FREE_SIZE); //logfile not open here
@@ -2427,6 +2894,746 @@ public:
     return !errorOccurred;
   } //interpret
 
+  //WLEDMM compile to bytecode, see BytecodeOps
+
+  bool compileFail(const char * reason, const char * name = "") 
+  {
+    if (!cFailed)
+      WARNING_ARTI("Compile: %s %s, parse tree will be interpreted\n", reason, name);
+    cFailed = true;
+    return false;
+  }
+
+  bool emit(uint8_t value) 
+  {
+    if (!program->emit(value)) return compileFail("program too large");
+    return true;
+  }
+
+  bool emit16(uint16_t value) 
+  {
+    if (!program->emit16(value)) return compileFail("program too large");
+    return true;
+  }
+
+  // add an item to the compile time value stack, ITEM_VALUE if code was emitted that pushes a value
+  bool cPush(uint8_t item) 
+  {
+    if (cItemsIndex >= arrayLength) return compileFail("expression too long");
+    cItems[cItemsIndex++] = item;
+    if (item == ITEM_VALUE && ++cDepth > cMaxDepth) cMaxDepth = cDepth;
+    return true;
+  }
+
+  void cPop(uint8_t count) 
+  {
+    for (uint8_t i=0; i<count; i++)
+      if (cItems[--cItemsIndex] == ITEM_VALUE) cDepth--;
+  }
+
+  // value, operator, value: evaluate now (interpret() evaluates left to right at the end of expr / term: same result)
+  bool cFold() 
+  {
+    if (cBase != ITEM_NOFOLD && cItemsIndex - cBase == 3 && cItems[cBase] == ITEM_VALUE && cItems[cBase+2] == ITEM_VALUE) 
+    {
+      uint8_t operatorx = cItems[cBase+1];
+      if (operatorx < F_plus || operatorx > F_or) return compileFail("unknown operator");
+      cPop(2);
+      return emit(operatorx);
+    }
+    return true;
+  }
+
+  bool cValue() 
+  {
+    if (!cValueContext) return compileFail("value not used");
+    return cPush(ITEM_VALUE) && cFold();
+  }
+
+  // check that the arguments / indices pushed since oldIndex are all values
+  bool cValues(uint8_t oldIndex, uint8_t maxCount) 
+  {
+    if (cItemsIndex - oldIndex > maxCount) return compileFail("too many arguments");
+    for (uint8_t i=oldIndex; i<cItemsIndex; i++)
+      if (cItems[i] != ITEM_VALUE) return compileFail("operator without values");
+    return true;
+  }
+
+  // compile a subtree in value context, not folded with items already on the stack (arguments, indices, conditions)
+  bool compileValues(JsonVariant parseTree, const char * treeElement, ScopedSymbolTable* current_scope, uint8_t depth) 
+  {
+    uint8_t oldBase = cBase;
+    bool oldValueContext = cValueContext;
+    cBase = ITEM_NOFOLD;
+    cValueContext = true;
+    compile(parseTree, treeElement, current_scope, depth);
+    cBase = oldBase;
+    cValueContext = oldValueContext;
+    return !cFailed;
+  }
+
+  uint8_t functionIndex(Symbol* function_symbol) 
+  {
+    for (uint8_t i=1; i<program->functionsIndex; i++)
+      if (cScopes[i] == function_symbol->function_scope) return i;
+    if (program->functionsIndex >= nrOfFunctions) {
+      compileFail("too many functions", function_symbol->name);
+      return 0;
+    }
+    uint8_t index = program->functionsIndex++;
+    ArtiFunction *function = &program->functions[index];
+    strcpy(function->name, function_symbol->name);
+    function->entry = 0;
+    function->nesting_level = function_symbol->scope_level + 1;
+    function->nrOfFormals = function_symbol->function_scope->nrOfFormals;
+    function->nrOfVars = function_symbol->function_scope->symbolsIndex;
+    function->maxStack = 0;
+    cScopes[index] = function_symbol->function_scope;
+    return index;
+  }
+
+  // variable: kind and operands as in VAR_xxx
+  void cVariable(JsonObject variable_value, uint8_t &kind, uint8_t &level, uint8_t &index) 
+  {
+    level = variable_value["level"];
+    index = variable_value["index"];
+    if (level == 1)
+      kind = VAR_GLOBAL;
+    else if (level == 0 || level == cNesting) // 0: not found by analyze, interpret() uses the current activation record
+      kind = VAR_LOCAL;
+    else
+      kind = VAR_OUTER;
+  }
+
+  bool emitVariable(uint8_t opGlobal, uint8_t kind, uint8_t level, uint8_t index) 
+  {
+    if (kind == VAR_OUTER) 
+      return emit(opGlobal + 2) && emit(level) && emit(index);
+    return emit(opGlobal + (kind == VAR_LOCAL)) && emit(index);
+  }
+
+  bool compile(JsonVariant parseTree, const char * treeElement = nullptr, ScopedSymbolTable* current_scope = nullptr, uint8_t depth = 0) 
+  {
+    if (depth >= 50) return compileFail("recursion level too deep");
+    if (cFailed) return false;
+
+    if (parseTree.is<JsonObject>()) 
+    {
+      for (JsonPair parseTreePair : parseTree.as<JsonObject>()) 
+      {
+        const char * key = parseTreePair.key().c_str();
+        JsonVariant value = parseTreePair.value();
+        if (treeElement == nullptr || strcmp(treeElement, key) == 0) 
+        {
+          bool visitedAlready = false;
+
+          if (strcmp(key, "*") == 0)
+          {
+            // do the recursive call below
+          }
+          else if (strcmp(key, "token") == 0 || strcmp(key, "variable") == 0)
+            visitedAlready = true;
+          else if (parseTree.containsKey("token")) //key is token
+          {
+            uint8_t token = parseTree["token"];
+            if (token == F_integerConstant || token == F_realConstant) 
+            {
+              if (!value.is<const char *>()) return compileFail("constant without value", key);
+              if (!emit(BC_CONST) || !program->emitFloat(atof(value.as<const char *>())) || !cValue()) return compileFail("program too large");
+            }
+            else if (!cPush(token)) //operator, evaluated in cFold or at the end of expr / term
+              return false;
+            visitedAlready = true;
+          }
+          else //if key is node_name
+          {
+            uint8_t node = stringToNode(key);
+
+            switch (node)
+            {
+              case F_Program: 
+              {
+                ArtiFunction *function = &program->functions[0];
+                strncpy(function->name, stringOrEmpty(value["ID"]), charLength-1);
+                function->name[charLength-1] = '\0';
+                function->entry = program->codeSize;
+                function->nesting_level = 1;
+                function->nrOfFormals = 0;
+                function->nrOfVars = global_scope->symbolsIndex;
+                program->functionsIndex = 1;
+
+                compile(value["block"], nullptr, global_scope, depth + 1);
+                emit(BC_RETURN);
+                function->maxStack = cMaxDepth;
+
+                visitedAlready = true;
+                break;
+              }
+              case F_Function: 
+              {
+                const char * function_name = value["ID"];
+                Symbol* function_symbol = current_scope->lookup(function_name);
+                if (function_symbol == nullptr || function_symbol->function_scope == nullptr) return compileFail("function not found", function_name);
+                uint8_t index = functionIndex(function_symbol);
+                if (cFailed) return false;
+
+                // the code of the function is placed here, but only run by BC_CALL
+                emit(BC_JUMP);
+                uint16_t jumpAddress = program->codeSize;
+                emit16(0);
+                program->functions[index].entry = program->codeSize;
+
+                uint8_t oldDepth = cDepth, oldMaxDepth = cMaxDepth, oldNesting = cNesting, oldBase = cBase;
+                bool oldValueContext = cValueContext;
+                cDepth = 0; cMaxDepth = 0; cBase = ITEM_NOFOLD; cValueContext = false;
+                cNesting = program->functions[index].nesting_level;
+
+                compile(value["block"], nullptr, function_symbol->function_scope, depth + 1);
+                emit(BC_RETURN);
+                program->functions[index].maxStack = cMaxDepth;
+
+                cDepth = oldDepth; cMaxDepth = oldMaxDepth; cNesting = oldNesting; cBase = oldBase;
+                cValueContext = oldValueContext;
+
+                if (!cFailed) program->patch16(jumpAddress, program->codeSize);
+                emit(BC_DEFINE);
+                emit(index);
+
+                visitedAlready = true;
+                break;
+              }
+              case F_Call: 
+              {
+                const char * function_name = value["ID"];
+                uint8_t oldIndex = cItemsIndex;
+
+                if (value.containsKey("external")) 
+                {
+                  if (value.containsKey("actuals") && !compileValues(value["actuals"], nullptr, current_scope, depth + 1)) return false;
+                  if (!cValues(oldIndex, 5)) return false;
+                  uint8_t nrOfArgs = cItemsIndex - oldIndex;
+                  cPop(nrOfArgs);
+                  emit(BC_CALL_EXT); emit(value["external"].as<uint8_t>()); emit(nrOfArgs); emit(cValueContext);
+                  if (cValueContext) cValue();
+                }
+                else 
+                {
+                  Symbol* function_symbol = current_scope->lookup(function_name);
+                  if (function_symbol != nullptr) //else nothing happens in interpret()
+                  {
+                    if (function_symbol->function_scope == nullptr) return compileFail("not a function", function_name);
+                    if (cValueContext) return compileFail("no result from function", function_name);
+                    uint8_t index = functionIndex(function_symbol);
+                    if (value.containsKey("actuals") && !compileValues(value["actuals"], nullptr, current_scope, depth + 1)) return false;
+                    if (!cValues(oldIndex, arrayLength)) return false;
+                    uint8_t nrOfArgs = cItemsIndex - oldIndex;
+                    cPop(nrOfArgs);
+                    emit(BC_CALL); emit(index); emit(nrOfArgs);
+                  }
+                }
+
+                visitedAlready = true;
+                break;
+              }
+              case F_VarRef:
+              case F_Assign: //get or set a variable
+              {
+                JsonObject variable_value = (node == F_Assign) ? value["varref"].as<JsonObject>() : value.as<JsonObject>();
+                const char * variable_name = variable_value["ID"];
+                bool external = variable_value.containsKey("external");
+                uint8_t kind, level, index;
+                uint8_t assignoperator = F_NoToken;
+
+                if (node == F_Assign) 
+                {
+                  if (value.containsKey("assignoperator")) 
+                  {
+                    if (!value["assignoperator"].is<uint8_t>()) return compileFail("unknown assignment", variable_name);
+                    assignoperator = value["assignoperator"];
+                  }
+                  if (value.containsKey("expr")) 
+                  {
+                    if (!compileValues(value, "expr", current_scope, depth + 1)) return false;
+                  }
+                  else if (external) //++ and -- on externals: value floatNull (see interpret)
+                  {
+                    emit(BC_CONST); program->emitFloat(floatNull);
+                    cPush(ITEM_VALUE);
+                  }
+                  else if (assignoperator == F_plusplus || assignoperator == F_minmin) 
+                  {
+                    emit(BC_CONST); program->emitFloat(1);
+                    cPush(ITEM_VALUE);
+                    assignoperator = (assignoperator == F_plusplus) ? F_plus : F_minus;
+                  }
+                  else
+                    return compileFail("assign without expression", variable_name);
+                  if (cFailed) return false;
+                }
+                else if (variable_value.containsKey("indices") && !external)
+                  return compileFail("indices not supported", variable_name); //interpret() leaves them on the stack
+
+                uint8_t oldIndex = cItemsIndex;
+                if (variable_value.containsKey("indices")) 
+                {
+                  if (!compileValues(variable_value, "indices", current_scope, depth + 1)) return false;
+                  if (!cValues(oldIndex, arrayLength)) return false;
+                }
+                uint8_t nrOfIndices = cItemsIndex - oldIndex;
+
+                if (external) 
+                {
+                  cPop(nrOfIndices);
+                  emit((node == F_VarRef) ? BC_GET_EXT : BC_SET_EXT); emit(variable_value["external"].as<uint8_t>()); emit(nrOfIndices);
+                  if (node == F_VarRef) 
+                    cValue();
+                  else
+                    cPop(1);
+                }
+                else 
+                {
+                  if (nrOfIndices > 0) //ignored by interpret()
+                  {
+                    cPop(nrOfIndices);
+                    emit(BC_POP); emit(nrOfIndices);
+                  }
+                  cVariable(variable_value, kind, level, index);
+                  if (node == F_VarRef) 
+                  {
+                    emitVariable(BC_LOAD_GLOBAL, kind, level, index);
+                    cValue();
+                  }
+                  else 
+                  {
+                    emitVariable(BC_STORE_GLOBAL, kind, level, index);
+                    emit(assignoperator);
+                    cPop(1);
+                  }
+                }
+
+                visitedAlready = true;
+                break;
+              }
+              case F_Expr:
+              case F_Term: 
+              {
+                uint8_t oldBase = cBase;
+                bool oldValueContext = cValueContext;
+                cBase = cItemsIndex;
+                cValueContext = true;
+
+                compile(value, nullptr, current_scope, depth + 1);
+                if (cFailed) return false;
+
+                // left: nothing, one value or unary minus
+                if (cItemsIndex - cBase == 2 && cItems[cBase] == F_minus && cItems[cBase+1] == ITEM_VALUE) 
+                {
+                  cPop(2);
+                  cPush(ITEM_VALUE);
+                  emit(BC_NEG);
+                }
+                else if (cItemsIndex - cBase > 1 || (cItemsIndex - cBase == 1 && cItems[cBase] != ITEM_VALUE))
+                  return compileFail("expression not supported");
+
+                bool result = cItemsIndex > cBase;
+                cBase = oldBase;
+                cValueContext = oldValueContext;
+                if (result) 
+                {
+                  if (!cValueContext) return compileFail("value not used");
+                  cFold();
+                }
+
+                visitedAlready = true;
+                break;
+              }
+              case F_For: 
+              {
+                if (cValueContext) return compileFail("for in expression");
+
+                compile(value, "assign", current_scope, depth + 1);
+
+                //variable for pascal style loops (interpret() uses the last variable set)
+                uint8_t kind = VAR_NONE, level = 0, index = 0;
+                JsonObject variable_value = value["assign"]["varref"];
+                if (!variable_value.isNull() && !variable_value.containsKey("external"))
+                  cVariable(variable_value, kind, level, index);
+
+                emit(BC_FOR_BEGIN);
+                cPush(ITEM_VALUE); //counter
+                uint16_t loopAddress = program->codeSize;
+                emit(BC_FOR_CHECK);
+                uint16_t exitAddress1 = program->codeSize;
+                emit16(0);
+
+                if (!value.containsKey("expr")) return compileFail("for without condition");
+                if (!compileValues(value, "expr", current_scope, depth + 1)) return false;
+                if (!cValues(cItemsIndex - 1, 1)) return false;
+                cPop(1);
+
+                emit(BC_FOR_TEST); emit(kind); emit(level); emit(index);
+                uint16_t exitAddress2 = program->codeSize;
+                emit16(0);
+                cPush(ITEM_VALUE); //normal or pascal
+
+                compile(value["block"], nullptr, current_scope, depth + 1);
+
+                cPop(1);
+                emit(BC_FOR_NEXT); emit(kind); emit(level); emit(index); emit16(loopAddress);
+
+                compile(value["increment"], nullptr, current_scope, depth + 1);
+                emit(BC_JUMP); emit16(loopAddress);
+
+                if (cFailed) return false;
+                program->patch16(exitAddress1, program->codeSize);
+                program->patch16(exitAddress2, program->codeSize);
+                cPop(1);
+                emit(BC_POP); emit(1);
+
+                visitedAlready = true;
+                break;
+              }
+              case F_If: 
+              case F_Cex: 
+              {
+                if (node == F_If && cValueContext) return compileFail("if in expression");
+                if (!value.containsKey("expr")) return compileFail("condition missing");
+                if (!compileValues(value, "expr", current_scope, depth + 1)) return false;
+                if (!cValues(cItemsIndex - 1, 1)) return false;
+                cPop(1);
+
+                emit(BC_JUMP_IF_NOT_ONE);
+                uint16_t elseAddress = program->codeSize;
+                emit16(0);
+
+                uint8_t oldIndex = cItemsIndex;
+                if (node == F_If) 
+                  compile(value, "block", current_scope, depth + 1);
+                else 
+                {
+                  compileValues(value, "trueExpr", current_scope, depth + 1);
+                  if (!cValues(oldIndex, 1) || cItemsIndex == oldIndex) return compileFail("cex without value");
+                  cPop(1);
+                }
+
+                if (node == F_Cex || value.containsKey("elseBlock")) 
+                {
+                  emit(BC_JUMP);
+                  uint16_t endAddress = program->codeSize;
+                  emit16(0);
+                  if (cFailed) return false;
+                  program->patch16(elseAddress, program->codeSize);
+
+                  if (node == F_If) 
+                    compile(value, "elseBlock", current_scope, depth + 1);
+                  else 
+                  {
+                    compileValues(value, "falseExpr", current_scope, depth + 1);
+                    if (!cValues(oldIndex, 1) || cItemsIndex == oldIndex) return compileFail("cex without value");
+                    cPop(1);
+                  }
+                  if (cFailed) return false;
+                  program->patch16(endAddress, program->codeSize);
+                }
+                else if (!cFailed)
+                  program->patch16(elseAddress, program->codeSize);
+
+                if (node == F_Cex) cValue();
+
+                visitedAlready = true;
+                break;
+              }
+              default:  //visitedalready false => recursive call
+                break;
+            }
+          } // is key is node_name
+
+          if (!visitedAlready && value.size() > 0) // if size == 0 then injected key/value like operator
+            compile(value, nullptr, current_scope, depth + 1);
+        } // if treeelement
+      } // for (JsonPair)
+    }
+    else if (parseTree.is<JsonArray>()) 
+    {
+      for (JsonVariant newParseTree: parseTree.as<JsonArray>()) 
+        compile(newParseTree, nullptr, current_scope, depth + 1);
+    }
+    else
+      return compileFail("parseTree should be array or object");
+
+    return !cFailed;
+  } //compile
+
+  // run the program from address until the function of frame entryFrame returns
+  bool run(uint16_t address, uint8_t entryFrame) 
+  {
+    const uint8_t *code = program->code;
+    float *stack = machine->stack;
+    uint8_t sp = machine->stack_index;
+    float *locals = machine->slots + machine->frames[machine->framesIndex-1].base;
+    float *globals = machine->slots;
+    uint16_t pc = address;
+
+    for (;;) 
+    {
+      uint8_t op = code[pc++];
+      switch (op) 
+      {
+        case BC_PLUS: sp--; stack[sp-1] = stack[sp-1] + stack[sp]; break;
+        case BC_MINUS: sp--; stack[sp-1] = stack[sp-1] - stack[sp]; break;
+        case BC_MULTIPLICATION: sp--; stack[sp-1] = stack[sp-1] * stack[sp]; break;
+        case BC_DIVISION: 
+        {
+          sp--;
+          float right = stack[sp];
+          if (right == 0) 
+          {
+            right = 1;
+            ERROR_ARTI("division by 0 not possible, divisor ignored for %f\n", stack[sp-1]);
+          }
+          stack[sp-1] = stack[sp-1] / right;
+          break;
+        }
+        case BC_MODULO: 
+        {
+          sp--;
+          if (stack[sp] == 0)
+            ERROR_ARTI("mod 0 not possible, mod ignored %f\n", stack[sp-1]);
+          else
+            stack[sp-1] = fmod(stack[sp-1], stack[sp]);
+          break;
+        }
+        case BC_BITSHIFTLEFT: sp--; stack[sp-1] = (int)stack[sp-1] << (int)stack[sp]; break;
+        case BC_BITSHIFTRIGHT: sp--; stack[sp-1] = (int)stack[sp-1] >> (int)stack[sp]; break;
+        case BC_EQUAL: sp--; stack[sp-1] = stack[sp-1] == stack[sp]; break;
+        case BC_NOTEQUAL: sp--; stack[sp-1] = stack[sp-1] != stack[sp]; break;
+        case BC_LESSTHEN: sp--; stack[sp-1] = stack[sp-1] < stack[sp]; break;
+        case BC_LESSTHENOREQUAL: sp--; stack[sp-1] = stack[sp-1] <= stack[sp]; break;
+        case BC_GREATERTHEN: sp--; stack[sp-1] = stack[sp-1] > stack[sp]; break;
+        case BC_GREATERTHENOREQUAL: sp--; stack[sp-1] = stack[sp-1] >= stack[sp]; break;
+        case BC_AND: sp--; stack[sp-1] = stack[sp-1] && stack[sp]; break;
+        case BC_OR: sp--; stack[sp-1] = stack[sp-1] || stack[sp]; break;
+        case BC_NEG: stack[sp-1] = -stack[sp-1]; break;
+        case BC_CONST: memcpy(&stack[sp++], code + pc, sizeof(float)); pc += sizeof(float); break;
+        case BC_LOAD_GLOBAL: stack[sp++] = globals[code[pc++]]; break;
+        case BC_LOAD_LOCAL: stack[sp++] = locals[code[pc++]]; break;
+        case BC_LOAD_OUTER: stack[sp++] = *outerVariable(code[pc], code[pc+1]); pc += 2; break;
+        case BC_STORE_GLOBAL: assign(&globals[code[pc]], code[pc+1], stack[--sp]); pc += 2; break;
+        case BC_STORE_LOCAL: assign(&locals[code[pc]], code[pc+1], stack[--sp]); pc += 2; break;
+        case BC_STORE_OUTER: assign(outerVariable(code[pc], code[pc+1]), code[pc+2], stack[--sp]); pc += 3; break;
+        case BC_GET_EXT: 
+        case BC_SET_EXT: 
+        {
+          uint8_t external = code[pc], nrOfIndices = code[pc+1];
+          pc += 2;
+          sp -= nrOfIndices;
+          float par1 = (nrOfIndices > 0) ? stack[sp] : floatNull;
+          float par2 = (nrOfIndices > 1) ? stack[sp+1] : floatNull;
+          if (op == BC_GET_EXT) 
+          {
+            float result = arti_get_external_variable(external, par1, par2);
+            if (result == floatNull) 
+            {
+              ERROR_ARTI("Error: ext.%u no value\n", external);
+              result = 0;
+            }
+            stack[sp++] = result;
+          }
+          else
+            arti_set_external_variable(stack[--sp], external, par1, par2);
+          if (errorOccurred) {machine->stack_index = 0; return false;}
+          break;
+        }
+        case BC_CALL_EXT: 
+        {
+          uint8_t external = code[pc], nrOfArgs = code[pc+1], keep = code[pc+2];
+          pc += 3;
+          sp -= nrOfArgs;
+          float *args = stack + sp;
+          float result = arti_external_function(external, (nrOfArgs > 0) ? args[0] : floatNull, (nrOfArgs > 1) ? args[1] : floatNull, (nrOfArgs > 2) ? args[2] : floatNull
+                                                        , (nrOfArgs > 3) ? args[3] : floatNull, (nrOfArgs > 4) ? args[4] : floatNull);
+          if (keep) 
+          {
+            if (result == floatNull) 
+            {
+              ERROR_ARTI("Push null value on float stack\n");
+              result = 0;
+            }
+            stack[sp++] = result;
+          }
+          if (errorOccurred) {machine->stack_index = 0; return false;}
+          break;
+        }
+        case BC_CALL: 
+        {
+          uint8_t function = code[pc], nrOfArgs = code[pc+1];
+          pc += 2;
+          sp -= nrOfArgs;
+          if (!machine->defined[function]) 
+          {
+            ERROR_ARTI("Function %s not defined yet\n", program->functions[function].name);
+            break;
+          }
+          machine->stack_index = sp;
+          if (!pushFrame(function, pc, stack + sp, nrOfArgs)) {machine->stack_index = 0; return false;}
+          locals = machine->slots + machine->frames[machine->framesIndex-1].base;
+          pc = program->functions[function].entry;
+          break;
+        }
+        case BC_DEFINE: machine->defined[code[pc++]] = true; break;
+        case BC_RETURN: 
+        {
+          ArtiFrame *frame = &machine->frames[machine->framesIndex-1];
+          if (frame->function == 0) //program variables are kept for the render functions
+          {
+            machine->stack_index = sp;
+            return true;
+          }
+          machine->slotsIndex = frame->base;
+          machine->framesIndex--;
+          if (machine->framesIndex == entryFrame) 
+          {
+            machine->stack_index = sp;
+            return true;
+          }
+          pc = frame->returnAddress;
+          locals = machine->slots + machine->frames[machine->framesIndex-1].base;
+          break;
+        }
+        case BC_POP: sp -= code[pc++]; break;
+        case BC_JUMP: pc = code[pc] | (code[pc+1] << 8); break;
+        case BC_JUMP_IF_NOT_ONE: pc = (stack[--sp] == 1) ? pc + 2 : (code[pc] | (code[pc+1] << 8)); break;
+        case BC_FOR_BEGIN: stack[sp++] = 0; break;
+        case BC_FOR_CHECK: 
+        {
+          if (stack[sp-1] >= 2000) //to avoid endless loops
+          {
+            ERROR_ARTI("too many iterations in for loop %u\n", 2000);
+            pc = code[pc] | (code[pc+1] << 8);
+          }
+          else 
+          {
+            stack[sp-1]++;
+            pc += 2;
+          }
+          break;
+        }
+        case BC_FOR_TEST: 
+        {
+          float conditionResult = stack[--sp];
+          if (conditionResult == 1) 
+          {
+            stack[sp++] = 1;
+            pc += 5;
+          }
+          else if (conditionResult != 0 && code[pc] != VAR_NONE && *forVariable(code + pc, globals, locals) <= conditionResult) //pascal
+          {
+            stack[sp++] = 2;
+            pc += 5;
+          }
+          else
+            pc = code[pc+3] | (code[pc+4] << 8);
+          break;
+        }
+        case BC_FOR_NEXT: 
+        {
+          if (stack[--sp] == 2) //pascal: no increment
+          {
+            *forVariable(code + pc, globals, locals) += 1;
+            pc = code[pc+3] | (code[pc+4] << 8);
+          }
+          else
+            pc += 5;
+          break;
+        }
+        default:
+          ERROR_ARTI("Programming error: unknown opcode %u at %u\n", op, pc-1);
+          errorOccurred = true;
+          machine->stack_index = 0;
+          return false;
+      }
+    }
+  } //run
+
+  float *outerVariable(uint8_t level, uint8_t index) 
+  {
+    for (int8_t i=machine->framesIndex-1; i>=0; i--)
+      if (machine->frames[i].nesting_level == level) return &machine->slots[machine->frames[i].base + index];
+    return &machine->slots[index]; //should not happen
+  }
+
+  float *forVariable(const uint8_t *operands, float *globals, float *locals) 
+  {
+    switch (operands[0]) 
+    {
+      case VAR_GLOBAL: return &globals[operands[2]];
+      case VAR_LOCAL: return &locals[operands[2]];
+      default: return outerVariable(operands[1], operands[2]);
+    }
+  }
+
+  void assign(float *variable, uint8_t assignoperator, float value) 
+  {
+    switch (assignoperator) 
+    {
+      case F_plus: *variable += value; break;
+      case F_minus: *variable -= value; break;
+      case F_multiplication: *variable *= value; break;
+      case F_division: 
+      {
+        if (value == 0) // divisor
+        {
+          value = 1;
+          ERROR_ARTI("/= division by 0 not possible, divisor ignored for %f\n", *variable);
+        }
+        *variable /= value;
+        break;
+      }
+      default: *variable = value;
+    }
+  }
+
+  bool pushFrame(uint8_t function, uint16_t returnAddress, const float *args, uint8_t nrOfArgs) 
+  {
+    ArtiFunction *f = &program->functions[function];
+    if (machine->framesIndex >= nrOfRecords) 
+    {
+      ERROR_ARTI("no space left in callstack\n");
+      errorOccurred = true;
+      return false;
+    }
+    if (machine->slotsIndex + f->nrOfVars > nrOfSlots || machine->stack_index + f->maxStack > arrayLength) 
+    {
+      ERROR_ARTI("no space left for variables of %s\n", f->name);
+      errorOccurred = true;
+      return false;
+    }
+    ArtiFrame *frame = &machine->frames[machine->framesIndex++];
+    frame->function = function;
+    frame->nesting_level = f->nesting_level;
+    frame->base = machine->slotsIndex;
+    frame->returnAddress = returnAddress;
+    machine->slotsIndex += f->nrOfVars;
+    float *locals = machine->slots + frame->base;
+    for (uint8_t i=0; i<f->nrOfVars; i++)
+      locals[i] = (i < nrOfArgs && i < f->nrOfFormals) ? args[i] : 0;
+    return true;
+  }
+
+  // run a function of the program: 0 (main) or a render function
+  bool execute(uint8_t function, float par1 = floatNull, float par2 = floatNull) 
+  {
+    if (function != 0 && !machine->defined[function]) 
+    {
+      ERROR_ARTI("Function %s not defined yet\n", program->functions[function].name);
+      return true;
+    }
+    float args[2] = {par1, par2};
+    uint8_t entryFrame = machine->framesIndex;
+    if (!pushFrame(function, 0, args, (par1 == floatNull) ? 0 : (par2 == floatNull) ? 1 : 2)) return false;
+    return run(program->functions[function].entry, entryFrame);
+  }
+
   void closeLog() 
   {
     //non arduino stops log here
@@ -2439,16 +3646,122 @@ public:
     #else
       if (logToFile)
       {
-        fclose(logFile);
+        if (logFile) fclose(logFile);
+        logFile = nullptr;
         logToFile = false;
       }
     #endif
   }
 
+  //WLEDMM hash of a file, false if it cannot be read
+  bool hashFile(const char *fileName, uint32_t &hash) 
+  {
+    uint8_t buffer[128];
+    hash = hashSeed;
+    #if ARTI_PLATFORM == ARTI_ARDUINO
+      File file = WLED_FS.open(fileName, "r");
+      if (!file) return false;
+      size_t length;
+      while ((length = file.read(buffer, sizeof(buffer))) > 0)
+        hash = artiHash(hash, buffer, length);
+    #else
+      std::fstream file;
+      file.open(fileName, std::ios::in | std::ios::binary);
+      if (!file) return false;
+      while (file.read((char *)buffer, sizeof(buffer)) || file.gcount() > 0)
+        hash = artiHash(hash, buffer, file.gcount());
+    #endif
+    file.close();
+    return true;
+  }
+
+  //WLEDMM read a compiled program, false if there is none or it is outdated
+  bool loadProgram(const char *fileName, uint32_t definitionHash, uint32_t programHash) 
+  {
+    #if ARTI_PLATFORM == ARTI_ARDUINO
+      if (!WLED_FS.exists(fileName)) return false;
+      File file = WLED_FS.open(fileName, "r");
+      if (!file) return false;
+      size_t length = file.size();
+    #else
+      std::fstream file;
+      file.open(fileName, std::ios::in | std::ios::binary | std::ios::ate);
+      if (!file) return false;
+      size_t length = file.tellg();
+      file.seekg(0);
+    #endif
+    if (length < bytecodeHeaderSize || length > bytecodeHeaderSize + nrOfFunctions * bytecodeFunctionSize + codeLength) {file.close(); return false;}
+
+    uint8_t *buffer = (uint8_t *)malloc(length);
+    if (buffer == nullptr) {file.close(); return false;}
+    #if ARTI_PLATFORM == ARTI_ARDUINO
+      bool ok = file.read(buffer, length) == length;
+    #else
+      bool ok = (bool)file.read((char *)buffer, length);
+    #endif
+    file.close();
+
+    program = new ArtiProgram();
+    ok = ok && program->read(buffer, length, definitionHash, programHash);
+    free(buffer);
+    if (!ok) 
+    {
+      delete program; program = nullptr;
+      MEMORY_ARTI("%s outdated or invalid, compile\n", fileName);
+    }
+    return ok;
+  }
+
+  //WLEDMM write the compiled program, so next setup can skip lexer, parser, analyzer and compiler
+  void saveProgram(const char *fileName, uint32_t definitionHash, uint32_t programHash) 
+  {
+    size_t length = program->fileSize();
+    uint8_t *buffer = (uint8_t *)malloc(length);
+    if (buffer == nullptr) return;
+    program->write(buffer, definitionHash, programHash);
+    #if ARTI_PLATFORM == ARTI_ARDUINO
+      File file = WLED_FS.open(fileName, "w");
+      bool ok = file && file.write(buffer, length) == length;
+    #else
+      std::fstream file;
+      file.open(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+      bool ok = file && file.write((const char *)buffer, length);
+    #endif
+    if (file) file.close();
+    free(buffer);
+    if (!ok) 
+    {
+      WARNING_ARTI("Could not write %s, program will be compiled again next time\n", fileName);
+      #if ARTI_PLATFORM == ARTI_ARDUINO
+        WLED_FS.remove(fileName);
+      #else
+        remove(fileName);
+      #endif
+    }
+    else
+      MEMORY_ARTI("save %s %u bytes ✓\n", fileName, (unsigned int)length);
+  }
+
+  //WLEDMM memory used by the program while running: bytecode and machine, or parse tree and interpreter stacks
+  size_t memoryUsage() 
+  {
+    size_t usage = 0;
+    if (program != nullptr) usage += program->memoryUsage();
+    if (machine != nullptr) usage += sizeof(ArtiMachine);
+    if (parseTreeJsonDoc != nullptr) usage += parseTreeJsonDoc->capacity();
+    if (definitionJsonDoc != nullptr) usage += definitionJsonDoc->capacity();
+    if (callStack != nullptr) usage += sizeof(CallStack);
+    if (valueStack != nullptr) usage += sizeof(ValueStack);
+    return usage;
+  }
+
   bool setup(const char *definitionName, const char *programName)
   {
     errorOccurred = false;
     frameCounter = 0;
+    programCached = false;
+    setupMillis = 0;
+    unsigned long setupStart = millis();
 
     // softhack007 check that programName has max 43 chars: fileNameLength -7 ("/" +Name + ".wled\0")
     if ((programName == NULL) || (strlen(programName) < 1) || (strlen(programName) > (fileNameLength-7))) {
@@ -2463,6 +3776,8 @@ public:
     {
       #if ARTI_PLATFORM == ARTI_ARDUINO
         strcpy(logFileName, "/");
+      #else
+        strcpy(logFileName, "");
       #endif
       strcat(logFileName, programName);   // softhack007 this may overflow logFileName, in case programName has more than 44 chars
       strcat(logFileName, ".log");
@@ -2484,6 +3799,36 @@ public:
     if (stages < 1) {close(); return true;}
     bool loadParseTreeFile = false;
 
+    char programFileName[fileNameLength];
+    #if ARTI_PLATFORM == ARTI_ARDUINO
+      strcpy(programFileName, "/");
+    #else
+      strcpy(programFileName, "");
+    #endif
+    strcat(programFileName, programName);    // softhack007 this may overflow programFileName, in case programName has more than 43 chars
+    strcat(programFileName, ".wled");
+
+    //WLEDMM compiled program: load it if definition and program did not change since it was compiled
+    char compiledFileName[fileNameLength];
+    strcpy(compiledFileName, programFileName);
+    strcpy(compiledFileName + strlen(compiledFileName) - 5, ".wbc"); // replace .wled
+    uint32_t definitionHash = 0, programHash = 0;
+    bool cacheable = useBytecode && useCache && stages >= 5 && hashFile(definitionName, definitionHash) && hashFile(programFileName, programHash);
+    if (cacheable && loadProgram(compiledFileName, definitionHash, programHash)) 
+    {
+      programCached = true;
+      MEMORY_ARTI("load %s %u bytes, %u functions %u ✓\n", compiledFileName, program->codeSize, program->functionsIndex, FREE_SIZE);
+      machine = new ArtiMachine();
+      if (!execute(0)) 
+      {
+        ERROR_ARTI("Run main failed\n");
+        return false;
+      }
+      setupMillis = millis() - setupStart;
+      MEMORY_ARTI("Run main %u ✓ (%u ms, %u bytes)\n", FREE_SIZE, (unsigned int)setupMillis, (unsigned int)memoryUsage());
+      return !errorOccurred;
+    }
+
     #if ARTI_PLATFORM == ARTI_ARDUINO
       File definitionFile;
       definitionFile = WLED_FS.open(definitionName, "r");
@@ -2538,13 +3883,6 @@ public:
       return false;
     }
 
-    char programFileName[fileNameLength];
-    #if ARTI_PLATFORM == ARTI_ARDUINO
-      strcpy(programFileName, "/");
-    #endif
-    strcat(programFileName, programName);    // softhack007 this may overflow programFileName, in case programName has more than 43 chars
-    strcat(programFileName, ".wled");
-
     #if ARTI_PLATFORM == ARTI_ARDUINO
       File programFile;
       programFile = WLED_FS.open(programFileName, "r");
@@ -2591,6 +3929,8 @@ public:
       char parseTreeName[fileNameLength];
       #if ARTI_PLATFORM == ARTI_ARDUINO
         strcpy(parseTreeName, "/");
+      #else
+        strcpy(parseTreeName, "");
       #endif
       strcat(parseTreeName, programName);
       // if (loadParseTreeFile)
@@ -2709,6 +4049,38 @@ public:
 
     if (stages < 5 || errorOccurred) {close(); return !errorOccurred;}
 
+    //WLEDMM compile to bytecode, if that fails interpret the parse tree
+    if (useBytecode && global_scope != nullptr) 
+    {
+      program = new ArtiProgram();
+      cItemsIndex = 0; cBase = ITEM_NOFOLD; cValueContext = false; cDepth = 0; cMaxDepth = 0; cNesting = 1; cFailed = false;
+      compile(parseTreeJson);
+      for (uint8_t i=0; i<program->functionsIndex && !cFailed; i++)
+        if (program->functions[i].maxStack > arrayLength) compileFail("stack too small for", program->functions[i].name);
+
+      if (!cFailed) 
+      {
+        MEMORY_ARTI("compile %u bytes, %u functions %u ✓\n", program->codeSize, program->functionsIndex, FREE_SIZE);
+        //parse tree and definition not needed anymore
+        delete parseTreeJsonDoc; parseTreeJsonDoc = nullptr;
+        delete definitionJsonDoc; definitionJsonDoc = nullptr;
+        MEMORY_ARTI("free parseTree %u ✓\n", FREE_SIZE);
+
+        if (cacheable) saveProgram(compiledFileName, definitionHash, programHash);
+
+        machine = new ArtiMachine();
+        if (!execute(0)) 
+        {
+          ERROR_ARTI("Run main failed\n");
+          return false;
+        }
+        setupMillis = millis() - setupStart;
+        MEMORY_ARTI("Run main %u ✓ (%u ms, %u bytes)\n", FREE_SIZE, (unsigned int)setupMillis, (unsigned int)memoryUsage());
+        return !errorOccurred;
+      }
+      delete program; program = nullptr;
+    }
+
     //interpret main
     callStack = new CallStack();
     valueStack = new ValueStack();
@@ -2729,7 +4101,8 @@ public:
       return false;
     }
 
-    MEMORY_ARTI("Interpret main %u ✓\n", FREE_SIZE);
+    setupMillis = millis() - setupStart;
+    MEMORY_ARTI("Interpret main %u ✓ (%u ms, %u bytes)\n", FREE_SIZE, (unsigned int)setupMillis, (unsigned int)memoryUsage());
  
     return !errorOccurred;
   } // setup
@@ -2738,6 +4111,8 @@ public:
     MEMORY_ARTI("closing Arti %u\n", FREE_SIZE);
 
     if (callStack != nullptr) {delete callStack; callStack = nullptr;}
+    if (machine != nullptr) {delete machine; machine = nullptr;}
+    if (program != nullptr) {delete program; program = nullptr;}
     if (valueStack != nullptr) {delete valueStack; valueStack = nullptr;}
     if (global_scope != nullptr) {delete global_scope; global_scope = nullptr;}
 
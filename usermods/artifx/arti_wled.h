@@ -23,7 +23,7 @@
 #if ARTI_PLATFORM == ARTI_ARDUINO
   #include "arti.h"
 #else
-  #include "../arti.h"
+  #include "arti.h"
   #include <string.h>
   #include <stdlib.h>
   #include <stdio.h>
@@ -95,6 +95,11 @@ enum Externals
 
 #if ARTI_PLATFORM != ARTI_ARDUINO
   #define PI 3.141592654
+
+  //WLEDMM simulated segment (tools/arti_bench): if hostLeds is set, pixels are written there instead of printed
+  uint32_t *hostLeds = nullptr;
+  uint16_t hostWidth = 2;
+  uint16_t hostHeight = 4;
 #endif
 uint32_t frameTime = 0;
 
@@ -226,18 +231,31 @@ float ARTI::arti_external_function(uint8_t function, float par1, float par2, flo
     switch (function)
     {
       case F_setPixelColor:
+        if (hostLeds) {
+          if (par3 == floatNull)
+            hostLeds[((uint16_t)par1)%(hostWidth*hostHeight)] = (uint32_t)par2;
+          else
+            hostLeds[((uint16_t)par1)%hostWidth + (((uint16_t)par2)%hostHeight) * hostWidth] = (uint32_t)par3;
+          return floatNull;
+        }
         PRINT_ARTI("%s(%f, %f, %f)\n", "setPixelColor", par1, par2, par3);
         return floatNull;
       case F_hsv:
+        if (hostLeds) return ((uint8_t)par1 << 16) | ((uint8_t)par2 << 8) | (uint8_t)par3;
         PRINT_ARTI("%s(%f, %f, %f)\n", "hsv", par1, par2, par3);
         return par1 + par2 + par3;
       case F_rgbw:
+        if (hostLeds) return ((uint8_t)par1 << 16) | ((uint8_t)par2 << 8) | (uint8_t)par3;
         PRINT_ARTI("%s(%f, %f, %f, %f)\n", "rgbw", par1, par2, par3, par4);
         return par1 + par2 + par3 + par4;
 
       case F_setRange:
         return par1 + par2 + par3;
       case F_fill:
+        if (hostLeds) {
+          for (int i = 0; i < hostWidth*hostHeight; i++) hostLeds[i] = (uint32_t)par1;
+          return floatNull;
+        }
         PRINT_ARTI("%s(%f)\n", "fill", par1);
         return floatNull;
       case F_colorBlend:
@@ -407,17 +425,20 @@ float ARTI::arti_get_external_variable(uint8_t variable, float par1, float par2,
     switch (variable)
     {
       case F_ledCount:
+        if (hostLeds) return hostWidth * hostHeight;
         return 3; // used in testing e.g. for i = 1 to ledCount
       case F_width:
-        return 2;
+        return hostWidth;
       case F_height:
-        return 4;
+        return hostHeight;
       case F_leds:
         if (par1 == floatNull) {
           ERROR_ARTI("arti_get_external_variable leds without indices not supported yet (get leds)\n");
           errorOccurred = true;
           return F_leds;
         }
+        else if (hostLeds)
+          return hostLeds[(par2 == floatNull) ? ((uint16_t)par1)%(hostWidth*hostHeight) : ((uint16_t)par1)%hostWidth + (((uint16_t)par2)%hostHeight) * hostWidth];
         else if (par2 == floatNull)
           return par1;
         else
@@ -485,6 +506,8 @@ void ARTI::arti_set_external_variable(float value, uint8_t variable, float par1,
           ERROR_ARTI("arti_set_external_variable leds without indices not supported yet (set leds to %f)\n", value);
           errorOccurred = true;
         }
+        else if (hostLeds)
+          hostLeds[(par2 == floatNull) ? ((uint16_t)par1)%(hostWidth*hostHeight) : ((uint16_t)par1)%hostWidth + (((uint16_t)par2)%hostHeight) * hostWidth] = (uint32_t)value;
         else if (par2 == floatNull)
           RUNLOG_ARTI("arti_set_external_variable: leds(%f) := %f\n", par1, value);
         else
@@ -505,7 +528,43 @@ bool ARTI::loop()
 {
   if (stages < 5) {close(); return true;}
 
-  if (parseTreeJsonDoc == nullptr || parseTreeJsonDoc->isNull()) 
+  #if ARTI_PLATFORM == ARTI_ARDUINO
+    uint16_t width = Segment::maxWidth;
+  #else
+    uint16_t width = hostWidth;
+  #endif
+
+  if (program != nullptr) //WLEDMM run the bytecode
+  {
+    uint8_t renderFrame = program->lookup("renderFrame");
+    uint8_t renderLed = program->lookup("renderLed");
+
+    if (renderFrame != F_NoToken && !execute(renderFrame))
+      return false;
+
+    if (renderLed != F_NoToken) 
+    {
+      uint16_t ledCount = arti_get_external_variable(F_ledCount);
+      if (program->functions[renderLed].nrOfFormals == 2) // 2D
+      {
+        for (int i = 0; i < ledCount; i++)
+          if (!execute(renderLed, i%width, i/width)) return false;
+      }
+      else 
+      {
+        for (int i = 0; i < ledCount; i++)
+          if (!execute(renderLed, i)) return false;
+      }
+    }
+
+    if (renderFrame == F_NoToken && renderLed == F_NoToken) 
+    {
+      ERROR_ARTI("renderFrame or renderLed not found\n");
+      errorOccurred = true;
+      return false;
+    }
+  }
+  else if (parseTreeJsonDoc == nullptr || parseTreeJsonDoc->isNull()) 
   {
     ERROR_ARTI("Loop: No parsetree created\n");
     errorOccurred = true;
@@ -551,8 +610,8 @@ bool ARTI::loop()
       for (int i = 0; i< arti_get_external_variable(F_ledCount); i++)
       {
         if (function_symbol->function_scope->nrOfFormals == 2) {// 2D
-          ar->set(function_symbol->function_scope->symbols[0]->scope_index, i%Segment::maxWidth); // set x
-          ar->set(function_symbol->function_scope->symbols[1]->scope_index, i/Segment::maxWidth); // set y
+          ar->set(function_symbol->function_scope->symbols[0]->scope_index, i%width); // set x
+          ar->set(function_symbol->function_scope->symbols[1]->scope_index, i/width); // set y
         }
         else
           ar->set(function_symbol->function_scope->symbols[0]->scope_index, i); // set x
@@ -128,6 +128,19 @@ class ARTIFXUserMod : public Usermod {
      */
     void addToJsonInfo(JsonObject& root)
     {
+      //WLEDMM setup time and memory of the running program
+      if (!enabled || arti == nullptr) return;
+
+      JsonObject user = root["u"];
+      if (user.isNull()) user = root.createNestedObject("u");
+
+      JsonArray infoArr = user.createNestedArray(F("ARTI-FX setup"));
+      infoArr.add(arti->setupMillis);
+      infoArr.add(arti->programCached ? F(" ms (compiled program loaded)") : F(" ms"));
+
+      infoArr = user.createNestedArray(F("ARTI-FX memory"));
+      infoArr.add(arti->memoryUsage());
+      infoArr.add(F(" bytes"));
     }
 
 
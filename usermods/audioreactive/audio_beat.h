@@ -0,0 +1,227 @@
+#pragma once
+
+/*
+   @title     MoonModules WLED - audioreactive usermod
+   @file      audio_beat.h
+   @repo      https://github.com/MoonModules/WLED, submit changes to this file as PRs to MoonModules/WLED
+   @Authors   https://github.com/MoonModules/WLED/commits/mdev/
+   @Copyright © 2024 Github MoonModules Commit Authors (contact moonmodules@icloud.com for details)
+   @license   Licensed under the EUPL-1.2 or later
+
+*/
+
+// WLEDMM beat and tempo tracking for FFTcode()
+//
+// 1. onset detection: spectral flux = sum of increases of log-compressed band levels. FFT bins are first summed up into BANDS
+//    bands of equal width on a log scale - single bins are too noisy. Flux is then sampled into "onset frames" of a fixed
+//    number of samples (hop size), so the result does not depend on how often the FFT task runs. The local average is
+//    subtracted, so only the attacks remain.
+// 2. tempo: leaky autocorrelation of the onset signal (a few seconds of memory), updated with every onset frame. Periods between
+//    MIN_BPM and MAX_BPM are scored together with their double period (comb), with a mild preference for ~120 BPM that decides
+//    between "half time" and "double time".
+// 3. phase: a beat clock runs at the detected tempo, and onset strength is collected in a histogram over the phase of that clock.
+//    The peak of the histogram is where the beats land - this defines phase 0.
+// Work per FFT batch is one pass over the FFT bins plus BANDS logarithms; per onset frame it is about (2 * 60 / MIN_BPM * frames per second) multiply-adds.
+// This file has no Arduino dependencies, so tools/audio_replay can compile it on the build host.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+class ArBeatTracker {
+  public:
+    static constexpr float MIN_BPM = 60.0f;
+    static constexpr float MAX_BPM = 200.0f;
+    static constexpr unsigned PHASE_BINS = 16;
+    static constexpr unsigned BANDS = 20;
+
+    ArBeatTracker(float sampleRate, uint16_t hopSize, uint16_t firstBin, uint16_t lastBin) :
+      _frameRate(sampleRate / hopSize), _hop(hopSize), _firstBin(firstBin), _lastBin(lastBin),
+      _minLag(unsigned(_frameRate * 60.0f / MAX_BPM)), _maxLag(unsigned(ceilf(_frameRate * 60.0f / MIN_BPM))),
+      _acfLen(2 * _maxLag + 2),
+      _acfDecay(expf(-1.0f / (_frameRate * 6.0f))),     // ~6 seconds memory for tempo
+      _phaseDecay(expf(-1.0f / (_frameRate * 3.0f))) { // ~3 seconds memory for phase
+      // band edges: geometric from firstBin to lastBin, at least one bin per band
+      for (unsigned b = 0; b <= BANDS; b++) {
+        unsigned edge = unsigned(lroundf(firstBin * powf(float(lastBin) / float(firstBin), float(b) / float(BANDS))));
+        if ((b > 0) && (edge <= _bandEdge[b-1])) edge = _bandEdge[b-1] + 1;
+        _bandEdge[b] = edge;
+      }
+    }
+    ~ArBeatTracker() { free(_buffer); }
+
+    // allocate buffers (once)
+    bool begin(void) {
+      if (_buffer) return true;
+      size_t numFloats = BANDS + 2 * _acfLen + (_maxLag + 1);
+      _buffer = (float*) calloc(numFloats, sizeof(float));
+      if (!_buffer) return false;
+      _spectrum = _buffer;
+      _history  = _spectrum + BANDS;
+      _acf      = _history + _acfLen;
+      _prior    = _acf + _acfLen;
+      for (unsigned lag = _minLag; lag <= _maxLag; lag++) {
+        float octaves = log2f(60.0f * _frameRate / float(lag) / 120.0f);
+        _prior[lag] = expf(-0.5f * octaves * octaves);   // log-gaussian around 120 BPM, one octave wide
+      }
+      reset();
+      return true;
+    }
+
+    // forget everything - for example when sound processing was paused
+    void reset(void) {
+      if (!_buffer || (_frames == 0)) return;
+      memset(_spectrum, 0, sizeof(float) * (BANDS + 2 * _acfLen));
+      memset(_phaseHist, 0, sizeof(_phaseHist));
+      _frames = 0; _pos = 0; _pendingSamples = 0; _pendingFlux = 0.0f; _fluxAvg = 0.0f;
+      _lag = 0.0f; _switchFrames = 0; _confidence = 0.0f;
+      _clock = 0.0f; _offset = 0.0f; _phase = 0.0f; _beats = 0;
+    }
+
+    // feed one magnitude spectrum (bins firstBin ... lastBin-1 are used). elapsedSamples = time since last call, in samples.
+    void process(const float* magnitudes, unsigned elapsedSamples) {
+      if (!_buffer) return;
+      float flux = 0.0f;
+      for (unsigned b = 0; b < BANDS; b++) {
+        float sum = 0.0f;
+        for (unsigned i = _bandEdge[b]; i < _bandEdge[b+1]; i++) sum += magnitudes[i];
+        float level = fastLog2(1.0f + sum / float(_bandEdge[b+1] - _bandEdge[b]));
+        if (level > _spectrum[b]) flux += level - _spectrum[b];
+        _spectrum[b] = level;
+      }
+      _pendingFlux = fmaxf(_pendingFlux, flux / float(BANDS));
+
+      // hold the value for all onset frames that have passed. Inserting zeros instead would add a rhythm of its own,
+      // because the FFT task cycle is not a multiple of the onset frame length.
+      _pendingSamples += elapsedSamples;
+      unsigned newFrames = _pendingSamples / _hop;
+      _pendingSamples -= newFrames * _hop;
+      if (newFrames == 0) return;
+      if (newFrames > 8) newFrames = 8;             // we were paused for some time - don't waste time
+      while (newFrames-- > 0) addOnsetFrame(_pendingFlux);
+      _pendingFlux = 0.0f;
+    }
+
+    float bpm(void) const { return (_lag > 0.0f) ? 60.0f * _frameRate / _lag : 0.0f; }   // 0 = no tempo yet
+    float phase(void) const { return _phase; }            // 0 ... <1, 0 = on the beat (as of the newest onset frame)
+    float confidence(void) const { return _confidence; }  // 0 = no rhythm, 1 = very regular beats
+    uint32_t beats(void) const { return _beats; }         // counts beats (phase wrap-arounds)
+    size_t memoryUsed(void) const { return _buffer ? sizeof(float) * (BANDS + 2 * _acfLen + (_maxLag + 1)) : 0; }
+
+  private:
+    const float    _frameRate;      // onset frames per second
+    const uint16_t _hop;            // samples per onset frame
+    const uint16_t _firstBin, _lastBin;
+    uint16_t _bandEdge[BANDS + 1];
+    const unsigned _minLag, _maxLag; // tempo range, in onset frames
+    const unsigned _acfLen;         // autocorrelation up to 2 * _maxLag (comb), plus one for interpolation
+    const float    _acfDecay, _phaseDecay;
+
+    float* _buffer = nullptr;       // one allocation for all arrays below
+    float* _spectrum = nullptr;     // previous log band levels
+    float* _history = nullptr;      // onset signal, ring buffer of _acfLen frames
+    float* _acf = nullptr;          // leaky autocorrelation of onset signal, lag 0 ... _acfLen-1
+    float* _prior = nullptr;        // tempo preference per lag
+    float  _phaseHist[PHASE_BINS] = {0.0f};
+
+    uint32_t _frames = 0;           // onset frames since reset
+    unsigned _pos = 0;              // write position in _history
+    unsigned _pendingSamples = 0;
+    float _pendingFlux = 0.0f;
+    float _fluxAvg = 0.0f;          // local average of flux
+    float _lag = 0.0f;              // beat period in onset frames (0 = unknown)
+    unsigned _switchFrames = 0;     // how long a different tempo has been detected
+    float _confidence = 0.0f;
+    float _clock = 0.0f;            // free-running beat clock, 0 ... <1
+    float _offset = 0.0f;           // where the beats are on the clock
+    float _phase = 0.0f;
+    uint32_t _beats = 0;
+
+    // log2 approximation - exact at powers of 2, piecewise linear in between. Good enough to compress magnitudes.
+    static inline float fastLog2(float x) {
+      union { float f; uint32_t i; } v = { x };
+      return float(v.i) * 1.1920928955078125e-7f - 127.0f;
+    }
+    static inline float wrap(float x) { return x - floorf(x); }   // into 0 ... <1
+
+    void addOnsetFrame(float flux) {
+      float onset = fmaxf(flux - _fluxAvg, 0.0f);
+      _fluxAvg += 0.15f * (flux - _fluxAvg);        // ~80ms at 86 frames/sec
+
+      // update autocorrelation with the new frame
+      _history[_pos] = onset;
+      unsigned idx = _pos;
+      for (unsigned lag = 0; lag < _acfLen; lag++) {
+        _acf[lag] = _acf[lag] * _acfDecay + onset * _history[idx];
+        idx = (idx == 0) ? _acfLen - 1 : idx - 1;
+      }
+      _pos = (_pos + 1 < _acfLen) ? _pos + 1 : 0;
+      _frames++;
+
+      if (_frames > _acfLen) estimateTempo();
+      updatePhase(onset);
+    }
+
+    void estimateTempo(void) {
+      if (_acf[0] < 1e-6f) { _confidence *= 0.98f; return; }   // silence
+      unsigned best = 0;
+      float bestScore = 0.0f, sum = 0.0f;
+      for (unsigned lag = _minLag; lag <= _maxLag; lag++) {
+        float s = _acf[lag] + 0.5f * _acf[2 * lag];
+        sum += s;
+        s *= _prior[lag];
+        if (s > bestScore) { bestScore = s; best = lag; }
+      }
+      if (best == 0) { _confidence *= 0.98f; return; }
+
+      // peak height over average, compared to a perfectly regular pulse (acf[lag] == acf[2*lag] == acf[0]).
+      // Real music rarely gets above 50% of that, while random sounds stay below 10% - so scale by 2.
+      float peak = _acf[best] + 0.5f * _acf[2 * best];
+      float mean = sum / float(_maxLag - _minLag + 1);
+      float conf = fminf(fmaxf(2.0f * (peak - mean) / (1.5f * _acf[0] - mean + 1e-9f), 0.0f), 1.0f);
+      _confidence += 0.05f * (conf - _confidence);
+
+      // parabolic interpolation for a fractional period
+      float lag = float(best);
+      if ((best > _minLag) && (best < _maxLag)) {
+        float l = (_acf[best - 1] + 0.5f * _acf[2 * best - 2]) * _prior[best - 1];
+        float r = (_acf[best + 1] + 0.5f * _acf[2 * best + 2]) * _prior[best + 1];
+        float denom = l - 2.0f * bestScore + r;
+        if (denom < 0.0f) lag += fminf(fmaxf(0.5f * (l - r) / denom, -0.5f), 0.5f);
+      }
+
+      if (_lag <= 0.0f) _lag = lag;                          // first estimate
+      else if (fabsf(lag - _lag) < 0.06f * _lag) {           // same tempo - follow slowly
+        _lag += 0.05f * (lag - _lag);
+        _switchFrames = 0;
+      } else if (++_switchFrames > unsigned(_frameRate)) {   // different tempo for more than one second - switch
+        _lag = lag;
+        _switchFrames = 0;
+      }
+    }
+
+    void updatePhase(float onset) {
+      if (_lag <= 0.0f) return;
+      _clock = wrap(_clock + 1.0f / _lag);
+
+      unsigned bin = unsigned(_clock * PHASE_BINS) % PHASE_BINS;
+      for (unsigned i = 0; i < PHASE_BINS; i++) _phaseHist[i] *= _phaseDecay;
+      _phaseHist[bin] += onset;
+
+      unsigned peak = 0;
+      for (unsigned i = 1; i < PHASE_BINS; i++) if (_phaseHist[i] > _phaseHist[peak]) peak = i;
+      float center = float(peak) + 0.5f;
+      float l = _phaseHist[(peak + PHASE_BINS - 1) % PHASE_BINS], c = _phaseHist[peak], r = _phaseHist[(peak + 1) % PHASE_BINS];
+      float denom = l - 2.0f * c + r;
+      if (denom < 0.0f) center += fminf(fmaxf(0.5f * (l - r) / denom, -0.5f), 0.5f);
+      float target = wrap(center / float(PHASE_BINS));
+
+      float diff = wrap(target - _offset + 0.5f) - 0.5f;    // shortest way around the circle
+      _offset = wrap(_offset + 0.1f * diff);
+
+      float phase = wrap(_clock - _offset);
+      if ((_phase > 0.75f) && (phase < 0.25f)) _beats++;
+      _phase = phase;
+    }
+};
@@ -0,0 +1,366 @@
+#pragma once
+
+/*
+   @title     MoonModules WLED - audioreactive usermod
+   @file      audio_fft.h
+   @repo      https://github.com/MoonModules/WLED, submit changes to this file as PRs to MoonModules/WLED
+   @Authors   https://github.com/MoonModules/WLED/commits/mdev/
+   @Copyright © 2024 Github MoonModules Commit Authors (contact moonmodules@icloud.com for details)
+   @license   Licensed under the EUPL-1.2 or later
+
+*/
+
+// WLEDMM real-input FFT engines for FFTcode()
+//
+// Microphone samples are real numbers, so a full complex FFT wastes half of its work on an imaginary part that is always zero.
+// These engines pack the N real samples into N/2 complex values (even samples -> real, odd samples -> imaginary), run an N/2 point
+// complex FFT and split the result with one "post-twiddle" pass. Twiddle factors and window weights are computed once and kept in tables.
+//
+//   ArRealFFT       - float engine, for boards with FPU (ESP32, -S3)
+//   ArRealFFTFixed  - integer engine (Q15 twiddles, scaled per stage), for boards without FPU (-S2, -C3)
+//
+// The API follows arduinoFFT (dcRemoval, windowing, compute, complexToMagnitude, majorPeak), and results are the same as arduinoFFT 1.9
+// (same window definitions, same peak interpolation). vImag is not needed. After complexToMagnitude(), vReal[0..N-1] holds the
+// magnitudes, with the upper half mirrored like a complex FFT would produce it.
+// This file has no Arduino dependencies, so tools/audio_fft_bench.cpp can compile it on the build host.
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+enum class ArFFTWindow : uint8_t { Rectangle, Hamming, Hann, Triangle, Nuttall, Blackman, Blackman_Nuttall, Blackman_Harris, Flat_top, Welch };
+enum class ArFFTDirection : uint8_t { Reverse, Forward };
+
+// common part: window table, DC removal and peak detection
+class ArFFTBase {
+  protected:
+    float*   _vReal;
+    float    _samplingFrequency;
+    uint16_t _samples;                 // N, power of 2 (8 ... 4096)
+    uint8_t  _power;                   // log2(N/2) = number of complex FFT stages
+    float*   _window = nullptr;        // window weights, first half only (window is symmetric)
+    ArFFTWindow _windowType = ArFFTWindow::Rectangle;
+    bool     _haveWindow = false;
+
+    static uint8_t log2u(uint16_t n) { uint8_t p = 0; while ((1U << p) < n) p++; return p; }
+
+  public:
+    ArFFTBase(float* vReal, uint16_t samples, float samplingFrequency) :
+      _vReal(vReal), _samplingFrequency(samplingFrequency), _samples(samples), _power(log2u(samples) - 1) {}
+    ~ArFFTBase() { free(_window); }
+
+    // remove mean value
+    void dcRemoval(void) {
+      double mean = 0;
+      for (unsigned i = 0; i < _samples; i++) mean += _vReal[i];
+      float dc = mean / _samples;
+      for (unsigned i = 0; i < _samples; i++) _vReal[i] -= dc;
+    }
+
+    // apply window function; weights are computed on first use, and when a different window is requested
+    void windowing(ArFFTWindow windowType, ArFFTDirection dir = ArFFTDirection::Forward) {
+      const unsigned half = _samples >> 1;
+      if (!_window) _window = (float*) malloc(sizeof(float) * half);
+      if (!_window) return;
+      if (!_haveWindow || (windowType != _windowType)) {
+        const double samplesMinusOne = double(_samples) - 1.0;
+        const double twoPi = 2.0 * M_PI;
+        for (unsigned i = 0; i < half; i++) {
+          double ratio = double(i) / samplesMinusOne;
+          double weight = 1.0;
+          switch (windowType) {                                                                 // same definitions as arduinoFFT
+            case ArFFTWindow::Rectangle: weight = 1.0; break;
+            case ArFFTWindow::Hamming:   weight = 0.54 - (0.46 * cos(twoPi * ratio)); break;
+            case ArFFTWindow::Hann:      weight = 0.54 * (1.0 - cos(twoPi * ratio)); break;
+            case ArFFTWindow::Triangle:  weight = 1.0 - ((2.0 * fabs(double(i) - (samplesMinusOne / 2.0))) / samplesMinusOne); break;
+            case ArFFTWindow::Nuttall:   weight = 0.355768 - (0.487396 * cos(twoPi * ratio)) + (0.144232 * cos(2 * twoPi * ratio)) - (0.012604 * cos(3 * twoPi * ratio)); break;
+            case ArFFTWindow::Blackman:  weight = 0.42323 - (0.49755 * cos(twoPi * ratio)) + (0.07922 * cos(2 * twoPi * ratio)); break;
+            case ArFFTWindow::Blackman_Nuttall: weight = 0.3635819 - (0.4891775 * cos(twoPi * ratio)) + (0.1365995 * cos(2 * twoPi * ratio)) - (0.0106411 * cos(3 * twoPi * ratio)); break;
+            case ArFFTWindow::Blackman_Harris:  weight = 0.35875 - (0.48829 * cos(twoPi * ratio)) + (0.14128 * cos(2 * twoPi * ratio)) - (0.01168 * cos(3 * twoPi * ratio)); break;
+            case ArFFTWindow::Flat_top:  weight = 0.2810639 - (0.5208972 * cos(twoPi * ratio)) + (0.1980399 * cos(2 * twoPi * ratio)); break;
+            case ArFFTWindow::Welch:     weight = 1.0 - ((double(i) - samplesMinusOne / 2.0) / (samplesMinusOne / 2.0)) * ((double(i) - samplesMinusOne / 2.0) / (samplesMinusOne / 2.0)); break;
+          }
+          _window[i] = weight;
+        }
+        _windowType = windowType;
+        _haveWindow = true;
+      }
+      for (unsigned i = 0; i < half; i++) {
+        if (dir == ArFFTDirection::Forward) {
+          _vReal[i] *= _window[i];
+          _vReal[_samples - (i + 1)] *= _window[i];
+        } else {
+          _vReal[i] /= _window[i];
+          _vReal[_samples - (i + 1)] /= _window[i];
+        }
+      }
+    }
+
+    // strongest peak (needs magnitudes), with parabolic interpolation - same results as arduinoFFT 1.9
+    void majorPeak(float &frequency, float &value) const {
+      float maxY = 0;
+      unsigned indexOfMaxY = 0;
+      for (unsigned i = 1; i < ((_samples >> 1) + 1U); i++) {
+        if ((_vReal[i-1] < _vReal[i]) && (_vReal[i] > _vReal[i+1])) {
+          if (_vReal[i] > maxY) {
+            maxY = _vReal[i];
+            indexOfMaxY = i;
+          }
+        }
+      }
+      if (indexOfMaxY == 0) { frequency = 0; value = 0; return; }  // no peak (all zero)
+      float denom = _vReal[indexOfMaxY-1] - (2.0f * _vReal[indexOfMaxY]) + _vReal[indexOfMaxY+1];
+      float delta = (denom != 0.0f) ? 0.5f * ((_vReal[indexOfMaxY-1] - _vReal[indexOfMaxY+1]) / denom) : 0.0f;
+      if (indexOfMaxY == (_samples >> 1)) frequency = ((indexOfMaxY + delta) * _samplingFrequency) / _samples;  // improve calculation on edge values
+      else frequency = ((indexOfMaxY + delta) * _samplingFrequency) / (_samples - 1);
+      value = fabsf(denom);
+    }
+};
+
+
+// float engine
+class ArRealFFT : public ArFFTBase {
+  private:
+    float*   _cos = nullptr;           // cos(2*pi*k/N), k = 0 ... N/2-1
+    float*   _sin = nullptr;           // sin(2*pi*k/N)
+    uint16_t* _swap = nullptr;         // bit-reversal swap pairs for the N/2 point FFT
+    uint16_t _numSwaps = 0;
+
+  public:
+    ArRealFFT(float* vReal, uint16_t samples, float samplingFrequency) : ArFFTBase(vReal, samples, samplingFrequency) {}
+    ~ArRealFFT() { free(_cos); free(_sin); free(_swap); }
+
+    // build tables; returns false when out of memory
+    bool begin(void) {
+      if (_cos && _sin && _swap) return true;
+      const unsigned half = _samples >> 1;
+      _cos = (float*) malloc(sizeof(float) * half);
+      _sin = (float*) malloc(sizeof(float) * half);
+      _swap = (uint16_t*) malloc(sizeof(uint16_t) * half);  // upper bound: at most half/2 pairs
+      if (!_cos || !_sin || !_swap) { free(_cos); free(_sin); free(_swap); _cos = _sin = nullptr; _swap = nullptr; return false; }
+      for (unsigned k = 0; k < half; k++) {
+        _cos[k] = cos(2.0 * M_PI * k / _samples);
+        _sin[k] = sin(2.0 * M_PI * k / _samples);
+      }
+      _numSwaps = 0;
+      for (unsigned i = 0, j = 0; i < half; i++) {
+        if (i < j) { _swap[_numSwaps++] = i; _swap[_numSwaps++] = j; }
+        unsigned bit = half >> 1;
+        while (bit & j) { j ^= bit; bit >>= 1; }
+        j |= bit;
+      }
+      return true;
+    }
+
+    // forward FFT. Result is stored as interleaved complex values X[0] ... X[N/2-1], the real value X[N/2] is stored in vReal[1].
+    void compute(ArFFTDirection dir = ArFFTDirection::Forward) {
+      if (!begin() || (dir != ArFFTDirection::Forward)) return;  // only forward transform is needed
+      float* z = _vReal;                                         // N/2 complex values: z[n] = x[2n] + i*x[2n+1]
+      const unsigned half = _samples >> 1;
+
+      // bit-reverse reordering
+      for (unsigned s = 0; s < _numSwaps; s += 2) {
+        unsigned a = 2*_swap[s], b = 2*_swap[s+1];
+        float t = z[a]; z[a] = z[b]; z[b] = t;
+        t = z[a+1]; z[a+1] = z[b+1]; z[b+1] = t;
+      }
+
+      // first two stages combined (twiddles are 1 and -i)
+      for (unsigned i = 0; i < 2*half; i += 8) {
+        float ar = z[i],   ai = z[i+1], br = z[i+2], bi = z[i+3];
+        float cr = z[i+4], ci = z[i+5], dr = z[i+6], di = z[i+7];
+        float s0r = ar + br, s0i = ai + bi, s1r = ar - br, s1i = ai - bi;
+        float s2r = cr + dr, s2i = ci + di, s3r = cr - dr, s3i = ci - di;
+        z[i]   = s0r + s2r; z[i+1] = s0i + s2i;
+        z[i+4] = s0r - s2r; z[i+5] = s0i - s2i;
+        z[i+2] = s1r + s3i; z[i+3] = s1i - s3r;          // s1 + (-i)*s3
+        z[i+6] = s1r - s3i; z[i+7] = s1i + s3r;
+      }
+
+      // remaining radix-2 stages
+      for (unsigned len = 8; len <= half; len <<= 1) {
+        const unsigned step = _samples / len;          // twiddle table stride
+        const unsigned span = len >> 1;
+        for (unsigned j = 0; j < span; j++) {
+          const float wr = _cos[j * step], wi = -_sin[j * step];
+          for (unsigned i = j; i < half; i += len) {
+            float* a = z + 2*i;
+            float* b = z + 2*(i + span);
+            float tr = wr * b[0] - wi * b[1];
+            float ti = wr * b[1] + wi * b[0];
+            b[0] = a[0] - tr; b[1] = a[1] - ti;
+            a[0] += tr;       a[1] += ti;
+          }
+        }
+      }
+
+      // post-twiddle: split N/2 point complex spectrum into spectrum of N real samples
+      float z0r = z[0], z0i = z[1];
+      z[0] = z0r + z0i;                                  // X[0]
+      z[1] = z0r - z0i;                                  // X[N/2]
+      for (unsigned k = 1; k <= (half >> 1); k++) {
+        const unsigned m = half - k;
+        float* p = z + 2*k;
+        float* q = z + 2*m;
+        float er = 0.5f * (p[0] + q[0]), ei = 0.5f * (p[1] - q[1]);    // even part  (Z[k] + conj(Z[m])) / 2
+        float or_ = 0.5f * (p[1] + q[1]), oi = 0.5f * (q[0] - p[0]);   // odd part   (Z[k] - conj(Z[m])) / 2i
+        const float wr = _cos[k], wi = -_sin[k];
+        float tr = wr * or_ - wi * oi;
+        float ti = wr * oi + wi * or_;
+        p[0] = er + tr; p[1] = ei + ti;                  // X[k]   = E + W*O
+        if (m != k) { q[0] = er - tr; q[1] = ti - ei; }  // X[N/2-k] = conj(E - W*O)
+      }
+    }
+
+    // magnitudes of compute() results -> vReal[0..N-1]
+    void complexToMagnitude(void) {
+      const unsigned half = _samples >> 1;
+      float* v = _vReal;
+      float last = fabsf(v[1]);                          // X[N/2] is real
+      v[0] = fabsf(v[0]);
+      for (unsigned k = 1; k < half; k++)                // in place: v[k] is written after v[2k], v[2k+1] were read
+        v[k] = sqrtf(v[2*k] * v[2*k] + v[2*k+1] * v[2*k+1]);
+      v[half] = last;
+      for (unsigned k = 1; k < half; k++) v[_samples - k] = v[k];   // mirror, like a complex FFT
+    }
+
+    static const char* name(void) { return "real"; }
+};
+
+
+// integer engine: samples are converted to int32 with a block scale (max 2^12), twiddles are Q15, and stages are scaled by 1/2 when needed
+// (block floating point). This keeps all products within 32bit. The scale is undone when magnitudes are computed.
+class ArRealFFTFixed : public ArFFTBase {
+  private:
+    int16_t* _cos = nullptr;           // Q15 cos(2*pi*k/N), k = 0 ... N/2-1
+    int16_t* _sin = nullptr;           // Q15 sin(2*pi*k/N)
+    int32_t* _z = nullptr;             // work buffer: N/2 complex values
+    uint16_t* _swap = nullptr;
+    uint16_t _numSwaps = 0;
+    float    _scale = 1.0f;            // magnitude scale factor for the last compute()
+
+    static inline int32_t mulQ15(int32_t a, int32_t w) { return (a * w + (1 << 14)) >> 15; }
+    static inline uint32_t absQ(int32_t a) { return (a < 0) ? -a : a; }
+
+  public:
+    ArRealFFTFixed(float* vReal, uint16_t samples, float samplingFrequency) : ArFFTBase(vReal, samples, samplingFrequency) {}
+    ~ArRealFFTFixed() { free(_cos); free(_sin); free(_z); free(_swap); }
+
+    bool begin(void) {
+      if (_cos && _sin && _z && _swap) return true;
+      const unsigned half = _samples >> 1;
+      _cos = (int16_t*) malloc(sizeof(int16_t) * half);
+      _sin = (int16_t*) malloc(sizeof(int16_t) * half);
+      _z = (int32_t*) malloc(sizeof(int32_t) * _samples);
+      _swap = (uint16_t*) malloc(sizeof(uint16_t) * half);
+      if (!_cos || !_sin || !_z || !_swap) {
+        free(_cos); free(_sin); free(_z); free(_swap);
+        _cos = _sin = nullptr; _z = nullptr; _swap = nullptr;
+        return false;
+      }
+      for (unsigned k = 0; k < half; k++) {
+        _cos[k] = lround(fmin(32767.0, 32768.0 * cos(2.0 * M_PI * k / _samples)));
+        _sin[k] = lround(fmin(32767.0, 32768.0 * sin(2.0 * M_PI * k / _samples)));
+      }
+      _numSwaps = 0;
+      for (unsigned i = 0, j = 0; i < half; i++) {
+        if (i < j) { _swap[_numSwaps++] = i; _swap[_numSwaps++] = j; }
+        unsigned bit = half >> 1;
+        while (bit & j) { j ^= bit; bit >>= 1; }
+        j |= bit;
+      }
+      return true;
+    }
+
+    void compute(ArFFTDirection dir = ArFFTDirection::Forward) {
+      if (!begin() || (dir != ArFFTDirection::Forward)) return;
+      const unsigned half = _samples >> 1;
+      int32_t* z = _z;
+
+      // block scale: largest sample -> below 2^12, so the first two stages (growth up to 4x) cannot overflow
+      float maxAbs = 0.0f;
+      for (unsigned i = 0; i < _samples; i++) maxAbs = fmaxf(maxAbs, fabsf(_vReal[i]));
+      if (maxAbs < 1e-20f) { memset(z, 0, sizeof(int32_t) * _samples); _scale = 0.0f; return; }
+      int exponent;
+      frexpf(maxAbs, &exponent);                          // maxAbs < 2^exponent
+      const float inScale = ldexpf(1.0f, 12 - exponent);
+      for (unsigned i = 0; i < _samples; i++) z[i] = lroundf(_vReal[i] * inScale);
+      unsigned shifts = 0;
+
+      for (unsigned s = 0; s < _numSwaps; s += 2) {
+        unsigned a = 2*_swap[s], b = 2*_swap[s+1];
+        int32_t t = z[a]; z[a] = z[b]; z[b] = t;
+        t = z[a+1]; z[a+1] = z[b+1]; z[b+1] = t;
+      }
+
+      // first two stages combined (twiddles are 1 and -i)
+      uint32_t peakBits = 0;                              // OR of all absolute values -> highest bit of largest value
+      for (unsigned i = 0; i < 2*half; i += 8) {
+        int32_t ar = z[i],   ai = z[i+1], br = z[i+2], bi = z[i+3];
+        int32_t cr = z[i+4], ci = z[i+5], dr = z[i+6], di = z[i+7];
+        int32_t s0r = ar + br, s0i = ai + bi, s1r = ar - br, s1i = ai - bi;
+        int32_t s2r = cr + dr, s2i = ci + di, s3r = cr - dr, s3i = ci - di;
+        z[i]   = s0r + s2r; z[i+1] = s0i + s2i;
+        z[i+4] = s0r - s2r; z[i+5] = s0i - s2i;
+        z[i+2] = s1r + s3i; z[i+3] = s1i - s3r;
+        z[i+6] = s1r - s3i; z[i+7] = s1i + s3r;
+        for (unsigned n = 0; n < 8; n++) peakBits |= absQ(z[i+n]);
+      }
+
+      // remaining stages: block floating point - a stage scales its results by 1/2 only if its input has values >= 2^13.
+      // That keeps magnitudes below 2^15, so Q15 products fit into 32bit.
+      for (unsigned len = 8; len <= half; len <<= 1) {
+        const unsigned step = _samples / len;
+        const unsigned span = len >> 1;
+        const int shift = (peakBits >= 8192) ? 1 : 0;
+        shifts += shift;
+        peakBits = 0;
+        for (unsigned j = 0; j < span; j++) {
+          const int32_t wr = _cos[j * step], wi = -_sin[j * step];
+          for (unsigned i = j; i < half; i += len) {
+            int32_t* a = z + 2*i;
+            int32_t* b = z + 2*(i + span);
+            int32_t tr = mulQ15(b[0], wr) - mulQ15(b[1], wi);
+            int32_t ti = mulQ15(b[1], wr) + mulQ15(b[0], wi);
+            b[0] = (a[0] - tr + shift) >> shift; b[1] = (a[1] - ti + shift) >> shift;
+            a[0] = (a[0] + tr + shift) >> shift; a[1] = (a[1] + ti + shift) >> shift;
+            peakBits |= absQ(a[0]) | absQ(a[1]) | absQ(b[0]) | absQ(b[1]);
+          }
+        }
+      }
+
+      // post-twiddle, computing 2*X to keep the lowest bit
+      int32_t z0r = z[0], z0i = z[1];
+      z[0] = 2 * (z0r + z0i);
+      z[1] = 2 * (z0r - z0i);
+      for (unsigned k = 1; k <= (half >> 1); k++) {
+        const unsigned m = half - k;
+        int32_t* p = z + 2*k;
+        int32_t* q = z + 2*m;
+        int32_t er = p[0] + q[0], ei = p[1] - q[1];
+        int32_t or_ = p[1] + q[1], oi = q[0] - p[0];
+        const int32_t wr = _cos[k], wi = -_sin[k];
+        int32_t tr = mulQ15(or_, wr) - mulQ15(oi, wi);
+        int32_t ti = mulQ15(oi, wr) + mulQ15(or_, wi);
+        p[0] = er + tr; p[1] = ei + ti;
+        if (m != k) { q[0] = er - tr; q[1] = ti - ei; }
+      }
+      _scale = ldexpf(0.5f, shifts) / inScale;
+    }
+
+    void complexToMagnitude(void) {
+      const unsigned half = _samples >> 1;
+      float* v = _vReal;
+      const int32_t* z = _z;
+      v[0] = fabsf(float(z[0])) * _scale;
+      v[half] = fabsf(float(z[1])) * _scale;
+      for (unsigned k = 1; k < half; k++) {
+        float re = z[2*k], im = z[2*k+1];
+        v[k] = sqrtf(re * re + im * im) * _scale;
+      }
+      for (unsigned k = 1; k < half; k++) v[_samples - k] = v[k];
+    }
+
+    static const char* name(void) { return "fixed"; }
+};
@@ -21,8 +21,9 @@
 #include <math.h>
 #endif
 
-#if defined(ARDUINO_ARCH_ESP32) && (defined(WLED_DEBUG) || defined(SR_DEBUG))
+#ifdef ARDUINO_ARCH_ESP32
 #include <esp_timer.h>
+#include <atomic>
 #endif
 
 /*
@@ -130,6 +131,10 @@
 static volatile bool disableSoundProcessing = false;      // if true, sound processing (FFT, filters, AGC) will be suspended. "volatile" as its shared between tasks.
 static uint8_t audioSyncEnabled = AUDIOSYNC_NONE;         // bit field: bit 0 - send, bit 1 - receive, bit 2 - use local if not receiving
 static bool audioSyncSequence = true;                     // if true, the receiver will drop out-of-sequence packets
+static uint8_t audioSyncJitter = 0;                       // WLEDMM receive: jitter buffer in ms (0 = apply packets immediately)
+static uint8_t audioSyncBatch = 1;                        // WLEDMM send: audio frames per UDP packet (1 = compatible with all receivers)
+#define AUDIOSYNC_MAX_JITTER 200                          // ms
+#define AUDIOSYNC_MAX_BATCH  4
 static bool udpSyncConnected = false;         // UDP connection status -> true if connected to multicast group
 
 #define NUM_GEQ_CHANNELS 16                                           // number of frequency channels. Don't change !!
@@ -161,6 +166,11 @@ static float   fftAvg[NUM_GEQ_CHANNELS] = {0.0f};  // Calculated frequency chann
 
 static uint16_t zeroCrossingCount = 0; // number of zero crossings in the current batch of 512 samples
 
+// WLEDMM beat tracking results
+static float beatBpm = 0.0f;           // tempo in beats per minute (0 = unknown)
+static float beatPhase = 0.0f;         // position within the current beat, 0 ... <1 (0 = on the beat). Already compensated for latency.
+static float beatConfidence = 0.0f;    // 0 ... 1: how regular the beats are. Effects should not rely on bpm and phase below ~0.4
+
 // TODO: probably best not used by receive nodes
 static float agcSensitivity = 128;            // AGC sensitivity estimation, based on agc gain (multAgc). calculated by getSensitivity(). range 0..255
 
@@ -181,7 +191,7 @@ static uint16_t decayTime = 300;              // int: decay time in milliseconds
 
 // peak detection
 #ifdef ARDUINO_ARCH_ESP32
-static void detectSamplePeak(void);  // peak detection function (needs scaled FFT results in vReal[]) - no used for 8266 receive-only mode
+static bool detectSamplePeak(void);  // peak detection function (needs scaled FFT results in vReal[]) - no used for 8266 receive-only mode
 #endif
 static void autoResetPeak(void);     // peak auto-reset function
 static uint8_t maxVol = 31;          // (was 10) Reasonable value for constant volume for 'peak detector', as it won't always trigger  (deprecated)
@@ -254,6 +264,19 @@ static uint8_t fftWindow = 0;                             // FFT windowing funct
 static uint8_t doSlidingFFT = 1;                            // 1 = use sliding window FFT (faster & more accurate)
 #endif
 
+// WLEDMM adaptive processing rate - only run the FFT as often as the effects on screen can use it
+#define AR_RATE_IDLE 0                            // no effect uses audio: no FFT, one batch of samples every AR_IDLE_CYCLE ms (volume only)
+#define AR_RATE_HALF 1                            // FFT on every second batch (like -C3), when LEDs are below target fps
+#define AR_RATE_FULL 2                            // FFT on every batch
+#define AR_IDLE_CYCLE 100
+static bool adaptiveRate = true;                  // false: always full rate
+static volatile uint8_t fftRate = AR_RATE_FULL;   // set by loop(), used by FFT task
+static volatile uint32_t fftCount = 0;            // FFTs done (counter)
+static volatile uint32_t fftBusyMicros = 0;       // time used by FFT task for processing, in us (counter)
+static unsigned long lastUMDataRequest = 0;       // millis() when an effect (or other usermod) last asked for audio data
+static float fftPerSecond = 0.0f;                 // FFTs per second, for info page
+static float fftCPUShare = 0.0f;                  // share of one CPU core used by FFT task, in percent
+
 // variables used in effects
 //static int16_t  volumeRaw = 0;       // either sampleRaw or rawSampleAgc depending on soundAgc
 //static float my_magnitude =0.0f;     // FFT_Magnitude, scaled by multAgc
@@ -278,7 +301,7 @@ static float mapf(float x, float in_min, float in_max, float out_min, float out_
 static float fftAddAvg(int from, int to);   // average of several FFT result bins
 void FFTcode(void * parameter);             // audio processing task: read samples, run FFT, fill GEQ channels from FFT results
 static void runMicFilter(uint16_t numSamples, float *sampleBuffer);          // pre-filtering of raw samples (band-pass)
-static void postProcessFFTResults(bool noiseGateOpen, int numberOfChannels, bool i2sFastpath); // post-processing and post-amp of GEQ channels
+static void postProcessFFTResults(bool noiseGateOpen, int numberOfChannels, bool i2sFastpath, uint8_t *results); // post-processing and post-amp of GEQ channels
 
 
 static TaskHandle_t FFT_Task = nullptr;
@@ -343,6 +366,70 @@ static float sampleTime = 0;        // avg (blocked) time for reading I2S sample
 static float filterTime = 0;        // avg time for filtering I2S samples
 #endif
 
+// WLEDMM audio frame: one consistent set of FFT results. The FFT task fills a frame and publishes it in one step;
+// loop() picks up the newest frame and copies it into the variables that effects see through um_data.
+// Both sides run in different tasks (and cores) - the triple buffer below lets them exchange frames without locks or waiting.
+typedef struct AudioFrame {
+  uint32_t sequence = 0;                      // increments with each FFT cycle
+  int64_t  captureTime = 0;                   // esp_timer_get_time() when the last sample of the batch was read
+  int64_t  publishTime = 0;                   // esp_timer_get_time() when the FFT task was done with this frame
+  uint32_t publishMillis = 0;                 // same in millis(), for the delay line
+  float    FFT_MajorPeak = 1.0f;
+  float    FFT_MajPeakSmth = 1.0f;
+  float    FFT_Magnitude = 0.0f;
+  uint16_t zeroCrossingCount = 0;
+  bool     samplePeak = false;                // peak detected in this frame
+  uint8_t  fftResult[NUM_GEQ_CHANNELS] = {0};
+  float    beatBpm = 0.0f;
+  float    beatPhase = 0.0f;                  // beat phase at captureTime
+  float    beatConfidence = 0.0f;
+} audioFrame_t;
+
+class AudioFrameBuffer {
+  private:
+    audioFrame_t _frames[3];
+    std::atomic<uint8_t> _middle{0};          // frame index that was handed over last; bit 7 = not read yet
+    uint8_t _back = 1;                        // owned by writer (FFT task)
+    uint8_t _front = 2;                       // owned by reader (loop)
+    static constexpr uint8_t FRESH = 0x80;
+
+  public:
+    audioFrame_t& back(void) { return _frames[_back]; }                     // writer: fill this frame, then publish()
+    void publish(void) { _back = _middle.exchange(_back | FRESH) & 0x03; }  // never blocks, an unread frame is simply replaced
+    bool fetch(void) {                                                      // reader: true if a new frame is available in front()
+      if ((_middle.load() & FRESH) == 0) return false;
+      _front = _middle.exchange(_front) & 0x03;
+      return true;
+    }
+    const audioFrame_t& front(void) const { return _frames[_front]; }
+};
+static AudioFrameBuffer audioFrames;
+static uint32_t lastFrameSequence = 0;      // sequence of the last frame seen by loop()
+static int64_t  pendingCaptureTime = 0;     // capture time of the newest frame not yet shown on LEDs (0 = none)
+static int64_t  pendingApplyTime = 0;       // time when that frame was handed to effects
+static float    audioLatency = 0.0f;        // avg time from sample capture to LED update, in ms
+static float    showLatency = 0.0f;         // estimated time for sending LED data, in ms
+static float    beatFramePhase = 0.0f;      // beat phase of the newest frame ...
+static int64_t  beatFrameTime = 0;          // ... and its capture time
+static uint32_t framesSkipped = 0;          // FFT frames replaced before loop() could use them
+
+// WLEDMM audio-to-light latency per stage, in ms (smoothed)
+static struct {
+  float fft = 0.0f;       // capture -> frame published: filters, FFT, post-processing
+  float queue = 0.0f;     // published -> handed to effects: waiting for loop(), plus delay line
+  float render = 0.0f;    // handed to effects -> LED update starts
+} stageLatency;
+
+// WLEDMM delay line: holds back FFT results, to align lights with the audible sound (e.g. far away from the speakers)
+// The FFT task publishes at most one frame per FFT_MIN_CYCLE on average, so AUDIO_DELAY_FRAMES covers AUDIO_DELAY_MAX at the fastest
+// cycle (8ms with sliding FFT -> 64 frames). If frames still come faster for a moment, the oldest one is released a bit early.
+#define AUDIO_DELAY_MAX    500                 // ms
+#define AUDIO_DELAY_FRAMES (AUDIO_DELAY_MAX / FFT_MIN_CYCLE + 2)
+static uint16_t audioDelay = 0;                // extra delay in ms (config) - 0 = off
+static audioFrame_t *delayLine = nullptr;      // ring buffer, allocated while audioDelay > 0
+static uint8_t delayHead = 0;                  // oldest frame
+static uint8_t delayCount = 0;                 // number of frames waiting
+
 // FFT Task variables (filtering and post-processing)
 static float   lastFftCalc[NUM_GEQ_CHANNELS] = {0.0f};                // backup of last FFT channels (before postprocessing)
 
@@ -375,6 +462,8 @@ constexpr SRate_t SAMPLE_RATE = 18000;          // 18Khz; Physical sample time -
 //#define FFT_MIN_CYCLE 30                      // minimum time before FFT task is repeated.
 #endif
 
+static_assert(AUDIO_DELAY_FRAMES <= 255, "delayHead and delayCount are uint8_t");
+
 // FFT Constants
 constexpr uint16_t samplesFFT = 512;            // Samples in an FFT batch - This value MUST ALWAYS be a power of 2
 constexpr uint16_t samplesFFT_2 = 256;          // meaningful part of FFT results - only the "lower half" contains useful information.
@@ -395,6 +484,29 @@ constexpr float binWidth = SAMPLE_RATE / (float)samplesFFT; // frequency range o
 #endif
 
 
+// WLEDMM FFT engine - build option -D UM_AUDIOREACTIVE_FFT_ENGINE=n
+#define AR_FFT_ENGINE_ARDUINOFFT 0     // arduinoFFT library (complex FFT, vImag is all zero)
+#define AR_FFT_ENGINE_REAL       1     // real-input FFT from audio_fft.h, float (default on boards with FPU)
+#define AR_FFT_ENGINE_FIXED      2     // real-input FFT from audio_fft.h, integer (default on -S2 and -C3, which don't have a FPU)
+#ifndef UM_AUDIOREACTIVE_FFT_ENGINE
+  #if defined(CONFIG_IDF_TARGET_ESP32S2) || defined(CONFIG_IDF_TARGET_ESP32C3)
+    #define UM_AUDIOREACTIVE_FFT_ENGINE AR_FFT_ENGINE_FIXED
+  #else
+    #define UM_AUDIOREACTIVE_FFT_ENGINE AR_FFT_ENGINE_REAL
+  #endif
+#endif
+
+#if UM_AUDIOREACTIVE_FFT_ENGINE != AR_FFT_ENGINE_ARDUINOFFT
+#include "audio_fft.h"
+typedef ArFFTWindow FFTWindow;       // same window names as arduinoFFT, so FFTcode() works with all engines
+typedef ArFFTDirection FFTDirection;
+#if UM_AUDIOREACTIVE_FFT_ENGINE == AR_FFT_ENGINE_FIXED
+typedef ArRealFFTFixed ArFFTEngine;
+#else
+typedef ArRealFFT ArFFTEngine;
+#endif
+#endif
+
 // Create FFT object
 // lib_deps += https://github.com/kosme/arduinoFFT#develop @ 1.9.2
 #if  !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3)
@@ -404,7 +516,11 @@ constexpr float binWidth = SAMPLE_RATE / (float)samplesFFT; // frequency range o
 #endif
 #define sqrt(x) sqrtf(x)             // little hack that reduces FFT time by 10-50% on ESP32 (as alternative to FFT_SQRT_APPROXIMATION)
 #define sqrt_internal sqrtf          // see https://github.com/kosme/arduinoFFT/pull/83
+#if UM_AUDIOREACTIVE_FFT_ENGINE == AR_FFT_ENGINE_ARDUINOFFT
 #include <arduinoFFT.h>
+#endif
+
+#include "audio_beat.h"              // WLEDMM beat and tempo tracking
 
 // Helper functions
 
@@ -452,7 +568,9 @@ static bool alocateFFTBuffers(void) {
   if (vReal) free(vReal); // should not happen
   if (vImag) free(vImag); // should not happen
   if ((vReal = (float*) calloc(sizeof(float), samplesFFT)) == nullptr) return false; // calloc or die
-  if ((vImag = (float*) calloc(sizeof(float), samplesFFT)) == nullptr) return false;
+#if UM_AUDIOREACTIVE_FFT_ENGINE == AR_FFT_ENGINE_ARDUINOFFT
+  if ((vImag = (float*) calloc(sizeof(float), samplesFFT)) == nullptr) return false; // real-input engines don't need imaginary parts
+#endif
 #ifdef FFT_MAJORPEAK_HUMAN_EAR
   if (pinkFactors) free(pinkFactors);
   if ((pinkFactors = (float*) calloc(sizeof(float), samplesFFT)) == nullptr) return false;
@@ -500,7 +618,15 @@ void FFTcode(void * parameter)
   // see https://www.freertos.org/vtaskdelayuntil.html
   const TickType_t xFrequency = FFT_MIN_CYCLE * portTICK_PERIOD_MS;  
   const TickType_t xFrequencyDouble = FFT_MIN_CYCLE * portTICK_PERIOD_MS * 2;  
+  const TickType_t xFrequencyIdle = AR_IDLE_CYCLE * portTICK_PERIOD_MS;
   static bool isFirstRun = false;
+  // results of this task - effects get them through audioFrames
+  static float taskMajorPeak = 1.0f;
+  static float taskMajPeakSmth = 1.0f;
+  static float taskMagnitude = 0.0f;
+  static uint32_t frameSequence = 0;
+  unsigned beatSamples = 0;          // time since last beat tracker update, in samples
+  unsigned long lastBeatMillis = 0;
 
 #ifdef FFT_USE_SLIDING_WINDOW
   static float* oldSamples = nullptr; // previous 50% of samples
@@ -511,11 +637,18 @@ void FFTcode(void * parameter)
 #endif
 
   bool success = true;
+#if UM_AUDIOREACTIVE_FFT_ENGINE == AR_FFT_ENGINE_ARDUINOFFT
   if ((vReal == nullptr) || (vImag == nullptr)) success = alocateFFTBuffers(); // allocate sample buffers on first run
+#else
+  if (vReal == nullptr) success = alocateFFTBuffers();                          // allocate sample buffers on first run
+#endif
   if (success == false) { disableSoundProcessing = true; return; }             // no memory -> die
 
   // create FFT object - we have to do if after allocating buffers
-#if defined(FFT_LIB_REV) && FFT_LIB_REV > 0x19
+#if UM_AUDIOREACTIVE_FFT_ENGINE != AR_FFT_ENGINE_ARDUINOFFT
+  static ArFFTEngine FFT(vReal, samplesFFT, SAMPLE_RATE);
+  if (!FFT.begin()) { disableSoundProcessing = true; return; }                 // twiddle tables: no memory -> die
+#elif defined(FFT_LIB_REV) && FFT_LIB_REV > 0x19
   // arduinoFFT 2.x has a slightly different API
   static ArduinoFFT<float> FFT = ArduinoFFT<float>( vReal, vImag, samplesFFT, SAMPLE_RATE, true);
 #else
@@ -529,6 +662,10 @@ void FFTcode(void * parameter)
   static ArduinoFFT<float> FFT = ArduinoFFT<float>( vReal, vImag, samplesFFT, SAMPLE_RATE, windowWeighingFactors);
 #endif
 
+  // WLEDMM beat tracker: onset frames of 1/2 batch, spectral flux up to 8Khz. Not essential - runs without it when out of memory.
+  static ArBeatTracker beatTracker(SAMPLE_RATE, samplesFFT_2, 1, min(unsigned(8000.0f / binWidth), unsigned(samplesFFT_2)));
+  if (!beatTracker.begin()) { DEBUGSR_PRINTLN(F("AR: no memory for beat tracking.")); }
+
   #ifdef FFT_MAJORPEAK_HUMAN_EAR
   // pre-compute pink noise scaling table
   for(uint_fast16_t binInd = 0; binInd < samplesFFT; binInd++) {
@@ -551,6 +688,8 @@ void FFTcode(void * parameter)
       #ifdef FFT_USE_SLIDING_WINDOW
         haveOldSamples = false;
       #endif
+      beatTracker.reset();
+      beatSamples = 0; lastBeatMillis = 0;
       vTaskDelayUntil( &xLastWakeTime, xFrequency);        // release CPU, and let I2S fill its buffers
       continue;
     }
@@ -590,6 +729,11 @@ void FFTcode(void * parameter)
 #else
     if (audioSource) audioSource->getSamples(vReal, samplesFFT);
 #endif
+    int64_t captureTime = esp_timer_get_time();   // WLEDMM newest sample has just arrived
+    // beat tracking needs the real time between batches - I2S drops samples when we are too slow to read them
+    unsigned long beatMillis = millis();
+    if (lastBeatMillis > 0) beatSamples += (uint64_t(beatMillis - lastBeatMillis) * SAMPLE_RATE + 500ULL) / 1000ULL;  // 64bit - 32bit overflows after ~3 minutes
+    lastBeatMillis = beatMillis;
 
 #if defined(WLED_DEBUG) || defined(SR_DEBUG)|| defined(SR_STATS)
     // debug info in case that stack usage changes
@@ -625,13 +769,6 @@ void FFTcode(void * parameter)
     }
 #endif
 
-#if defined(WLEDMM_FASTPATH) && !defined(CONFIG_IDF_TARGET_ESP32S2) && !defined(CONFIG_IDF_TARGET_ESP32C3) && defined(ARDUINO_ARCH_ESP32)
-    // experimental - be nice to LED update task (trying to avoid flickering) - dual core only
-#if FFTTASK_PRIORITY > 1
-    if (strip.isServicing()) delay(1);
-#endif
-#endif
-
     // normal mode: filter everything
     float *samplesStart = vReal;
     uint16_t sampleCount = samplesFFT;
@@ -662,8 +799,10 @@ void FFTcode(void * parameter)
     start = esp_timer_get_time(); // start measuring FFT time
 #endif
 
+#if UM_AUDIOREACTIVE_FFT_ENGINE == AR_FFT_ENGINE_ARDUINOFFT
     // set imaginary parts to 0
     memset(vImag, 0, sizeof(float) * samplesFFT);
+#endif
 
     #ifdef FFT_USE_SLIDING_WINDOW
     memcpy(oldSamples, vReal+samplesFFT_2, sizeof(float) * samplesFFT_2);  // copy last 50% to buffer (for sliding window FFT)
@@ -691,7 +830,6 @@ void FFTcode(void * parameter)
       }
     }
     newZeroCrossingCount = (newZeroCrossingCount*2)/3; // reduce value so it typically stays below 256
-    zeroCrossingCount = newZeroCrossingCount; // update only once, to avoid that effects pick up an intermediate value
 
     // release highest sample to volume reactive effects early - not strictly necessary here - could also be done at the end of the function
     // early release allows the filters (getSample() and agcAvg()) to work with fresh values - we will have matching gain and noise gate values when we want to process the FFT results.
@@ -717,9 +855,16 @@ void FFTcode(void * parameter)
 
     float wc = 1.0; // FFT window correction factor, relative to Blackman_Harris
 
+    // WLEDMM adaptive rate: half rate skips every second FFT, idle behaves like silence
+    uint8_t rate = adaptiveRate ? fftRate : AR_RATE_FULL;
+    bool halfRate = skipSecondFFT || (rate == AR_RATE_HALF);
+    bool noiseGateOpen = (rate != AR_RATE_IDLE) && (fabsf(volumeSmth) > 0.25f);   // idle: same as silence - FFT results decay to zero
+    bool fftCycle = (halfRate == false) || (isFirstRun == true);
+    bool runFFT = noiseGateOpen && fftCycle;
+
     // run FFT (takes 3-5ms on ESP32)
-    if (fabsf(volumeSmth) > 0.25f) { // noise gate open
-      if ((skipSecondFFT == false) || (isFirstRun == true)) {
+    if (noiseGateOpen) { // noise gate open
+      if (fftCycle) {
         // run FFT (takes 2-3ms on ESP32, ~12ms on ESP32-S2, ~30ms on -C3)
         if (doDCRemoval) FFT.dcRemoval();                                            // remove DC offset
         switch(fftWindow) {                                                          // apply FFT window
@@ -756,8 +901,8 @@ void FFTcode(void * parameter)
         FFT.complexToMagnitude();                                   // Compute magnitudes
         vReal[0] = 0;   // The remaining DC offset on the signal produces a strong spike on position 0 that should be eliminated to avoid issues.
 
-        float last_majorpeak = FFT_MajorPeak;
-        float last_magnitude = FFT_Magnitude;
+        float last_majorpeak = taskMajorPeak;
+        float last_magnitude = taskMagnitude;
 
         #ifdef FFT_MAJORPEAK_HUMAN_EAR
         // scale FFT results
@@ -767,27 +912,27 @@ void FFTcode(void * parameter)
 
         #if defined(FFT_LIB_REV) && FFT_LIB_REV > 0x19
           // arduinoFFT 2.x has a slightly different API
-          FFT.majorPeak(&FFT_MajorPeak, &FFT_Magnitude);
+          FFT.majorPeak(&taskMajorPeak, &taskMagnitude);
         #else
-          FFT.majorPeak(FFT_MajorPeak, FFT_Magnitude);                // let the effects know which freq was most dominant
+          FFT.majorPeak(taskMajorPeak, taskMagnitude);                // find the most dominant freq
         #endif
-        FFT_Magnitude *= wc;  // apply correction factor
+        taskMagnitude *= wc;  // apply correction factor
 
-        if (FFT_MajorPeak < (SAMPLE_RATE /  samplesFFT)) {FFT_MajorPeak = 1.0f; FFT_Magnitude = 0;}                  // too low - use zero
-        if (FFT_MajorPeak > (0.42f * SAMPLE_RATE)) {FFT_MajorPeak = last_majorpeak; FFT_Magnitude = last_magnitude;} // too high - keep last peak
+        if (taskMajorPeak < (SAMPLE_RATE /  samplesFFT)) {taskMajorPeak = 1.0f; taskMagnitude = 0;}                  // too low - use zero
+        if (taskMajorPeak > (0.42f * SAMPLE_RATE)) {taskMajorPeak = last_majorpeak; taskMagnitude = last_magnitude;} // too high - keep last peak
 
         #ifdef FFT_MAJORPEAK_HUMAN_EAR
         // undo scaling - we want unmodified values for FFTResult[] computations
         for(uint_fast16_t binInd = 0; binInd < samplesFFT; binInd++)
           vReal[binInd] *= 1.0f/pinkFactors[binInd];
         //fix peak magnitude
-        if ((FFT_MajorPeak > (binWidth/1.25f)) && (FFT_MajorPeak < (SAMPLE_RATE/2.2f)) && (FFT_Magnitude > 4.0f)) {
-          unsigned peakBin = constrain((int)((FFT_MajorPeak + binWidth/2.0f) / binWidth), 0, samplesFFT -1);
-          FFT_Magnitude *= fmaxf(1.0f/pinkFactors[peakBin], 1.0f);
+        if ((taskMajorPeak > (binWidth/1.25f)) && (taskMajorPeak < (SAMPLE_RATE/2.2f)) && (taskMagnitude > 4.0f)) {
+          unsigned peakBin = constrain((int)((taskMajorPeak + binWidth/2.0f) / binWidth), 0, samplesFFT -1);
+          taskMagnitude *= fmaxf(1.0f/pinkFactors[peakBin], 1.0f);
         }
         #endif
-        FFT_MajorPeak = constrain(FFT_MajorPeak, 1.0f, 11025.0f);   // restrict value to range expected by effects
-        FFT_MajPeakSmth = FFT_MajPeakSmth + 0.42 * (FFT_MajorPeak - FFT_MajPeakSmth);   // I like this "swooping peak" look
+        taskMajorPeak = constrain(taskMajorPeak, 1.0f, 11025.0f);   // restrict value to range expected by effects
+        taskMajPeakSmth = taskMajPeakSmth + 0.42 * (taskMajorPeak - taskMajPeakSmth);   // I like this "swooping peak" look
 
       } else { // skip second run --> clear fft results, keep peaks
         memset(vReal, 0, sizeof(float) * samplesFFT); 
@@ -798,16 +943,20 @@ void FFTcode(void * parameter)
 
     } else { // noise gate closed - only clear results as FFT was skipped. MIC samples are still valid when we do this.
       memset(vReal, 0, sizeof(float) * samplesFFT);
-      FFT_MajorPeak = 1;
-      FFT_Magnitude = 0.001;
+      taskMajorPeak = 1;
+      taskMagnitude = 0.001;
     }
 
-    if ((skipSecondFFT == false) || (isFirstRun == true)) {
+    if (fftCycle) {
       for (int i = 0; i < samplesFFT; i++) {
         float t = fabsf(vReal[i]);                      // just to be sure - values in fft bins should be positive any way
         vReal[i] = t / 16.0f;                           // Reduce magnitude. Want end result to be scaled linear and ~4096 max.
       } // for()
 
+      if (rate != AR_RATE_IDLE) beatTracker.process(vReal, beatSamples);  // WLEDMM onset detection and tempo tracking
+      else beatTracker.reset();
+      beatSamples = 0;
+
       // mapping of FFT result bins to frequency channels
       //if (fabsf(sampleAvg) > 0.25f) { // noise gate open
       if (fabsf(volumeSmth) > 0.25f) { // noise gate open
@@ -887,10 +1036,11 @@ void FFTcode(void * parameter)
     // post-processing of frequency channels (pink noise adjustment, AGC, smoothing, scaling)
     if (pinkIndex > MAX_PINK) pinkIndex = MAX_PINK;
 
+    audioFrame_t &frame = audioFrames.back();
 #ifdef FFT_USE_SLIDING_WINDOW
-    postProcessFFTResults((fabsf(volumeSmth) > 0.25f)? true : false, NUM_GEQ_CHANNELS, usingOldSamples);    // this function modifies fftCalc, fftAvg and fftResult
+    postProcessFFTResults(noiseGateOpen, NUM_GEQ_CHANNELS, usingOldSamples, frame.fftResult);    // this function modifies fftCalc, fftAvg and frame.fftResult
 #else
-    postProcessFFTResults((fabsf(volumeSmth) > 0.25f)? true : false, NUM_GEQ_CHANNELS, false);    // this function modifies fftCalc, fftAvg and fftResult
+    postProcessFFTResults(noiseGateOpen, NUM_GEQ_CHANNELS, false, frame.fftResult);    // this function modifies fftCalc, fftAvg and frame.fftResult
 #endif
 
 #if defined(WLED_DEBUG) || defined(SR_DEBUG)|| defined(SR_STATS)
@@ -903,12 +1053,29 @@ void FFTcode(void * parameter)
     }
 #endif
 
-    // run peak detection
-    autoResetPeak();
-    detectSamplePeak();
-
-    haveNewFFTResult = true;
-    
+    // run peak detection, and hand over all results to loop() in one step
+    frame.samplePeak = detectSamplePeak();
+    frame.FFT_MajorPeak = taskMajorPeak;
+    frame.FFT_MajPeakSmth = taskMajPeakSmth;
+    frame.FFT_Magnitude = taskMagnitude;
+    frame.zeroCrossingCount = newZeroCrossingCount;
+    frame.beatBpm = beatTracker.bpm();
+    frame.beatPhase = beatTracker.phase();
+    frame.beatConfidence = beatTracker.confidence();
+    frame.captureTime = captureTime;
+    frame.publishTime = esp_timer_get_time();
+    frame.publishMillis = millis();
+    frame.sequence = ++frameSequence;
+    audioFrames.publish();
+    fftBusyMicros += uint32_t(frame.publishTime - captureTime);  // WLEDMM statistics for adaptive rate
+    if (runFFT) fftCount++;
+
+    if (rate == AR_RATE_IDLE) {
+      #ifdef FFT_USE_SLIDING_WINDOW
+        haveOldSamples = false;                              // next batch is not continuous
+      #endif
+      vTaskDelayUntil( &xLastWakeTime, xFrequencyIdle);      // nobody needs FFT results - sleep longer
+    } else
     #if !defined(I2S_GRAB_ADC1_COMPLETELY)    
     if ((audioSource == nullptr) || (audioSource->getType() != AudioSource::Type_I2SAdc))  // the "delay trick" does not help for analog ADC
     #endif
@@ -918,7 +1085,7 @@ void FFTcode(void * parameter)
         vTaskDelayUntil( &xLastWakeTime, xFrequencyDouble); // we need a double wait when no old data was used
       } else
   #endif
-      if ((skipSecondFFT == false) || (fabsf(volumeSmth) < 0.25f)) {
+      if ((halfRate == false) || (fabsf(volumeSmth) < 0.25f)) {
         vTaskDelayUntil( &xLastWakeTime, xFrequency);        // release CPU, and let I2S fill its buffers
       } else if (isFirstRun == true) {
         vTaskDelayUntil( &xLastWakeTime, xFrequencyDouble);  // release CPU after performing FFT in "skip second run" mode
@@ -963,7 +1130,7 @@ static void runMicFilter(uint16_t numSamples, float *sampleBuffer)          // p
   }
 }
 
-static void postProcessFFTResults(bool noiseGateOpen, int numberOfChannels, bool i2sFastpath) // post-processing and post-amp of GEQ channels
+static void postProcessFFTResults(bool noiseGateOpen, int numberOfChannels, bool i2sFastpath, uint8_t *results) // post-processing and post-amp of GEQ channels
 {
     for (int i=0; i < numberOfChannels; i++) {
 
@@ -1048,21 +1215,21 @@ static void postProcessFFTResults(bool noiseGateOpen, int numberOfChannels, bool
         break;
       }
 
-      // Now, let's dump it all into fftResult. Need to do this, otherwise other routines might grab fftResult values prematurely.
+      // Now, let's dump it all into the audio frame. Effects will see it once the frame is published.
       if (soundAgc > 0) {  // apply extra "GEQ Gain" if set by user
         float post_gain = (float)inputLevel/128.0f;
         if (post_gain < 1.0f) post_gain = ((post_gain -1.0f) * 0.8f) +1.0f;
         currentResult *= post_gain;
       }
-      fftResult[i] = max(min((int)(currentResult+0.5f), 255), 0);  // +0.5 for proper rounding
+      results[i] = max(min((int)(currentResult+0.5f), 255), 0);  // +0.5 for proper rounding
     }
 }
 ////////////////////
 // Peak detection //
 ////////////////////
 
-// peak detection is called from FFT task when vReal[] contains valid FFT results
-static void detectSamplePeak(void) {
+// peak detection is called from FFT task when vReal[] contains valid FFT results. Returns true when a peak was found.
+static bool detectSamplePeak(void) {
   bool havePeak = false;
 #if 1
   // softhack007: this code continuously triggers while volume in the selected bin is above a certain threshold. So it does not detect peaks - it detects volume in a frequency bin.
@@ -1083,13 +1250,178 @@ static void detectSamplePeak(void) {
   }
 #endif
 
-  if (havePeak) {
+  return havePeak;
+}
+
+#endif
+
+#ifdef ARDUINO_ARCH_ESP32
+// WLEDMM make the newest FFT task results visible to effects - only called from loop(), so effects never see partial updates
+static void applyAudioFrame(const audioFrame_t &frame) {
+  memcpy(fftResult, frame.fftResult, sizeof(fftResult));
+  FFT_MajorPeak = frame.FFT_MajorPeak;
+  FFT_MajPeakSmth = frame.FFT_MajPeakSmth;
+  FFT_Magnitude = frame.FFT_Magnitude;
+  zeroCrossingCount = frame.zeroCrossingCount;
+  if (frame.samplePeak) {
     samplePeak    = true;
     timeOfPeak    = millis();
     udpSamplePeak = true;
   }
+  if ((lastFrameSequence > 0) && (frame.sequence > lastFrameSequence + 1)) framesSkipped += frame.sequence - lastFrameSequence - 1;
+  lastFrameSequence = frame.sequence;
+  // latency statistics - the last stage is measured when the LEDs are updated
+  int64_t now = esp_timer_get_time();
+  if ((frame.publishTime >= frame.captureTime) && (now >= frame.publishTime)) {
+    stageLatency.fft   += 0.1f * (float(frame.publishTime - frame.captureTime) / 1000.0f - stageLatency.fft);
+    stageLatency.queue += 0.1f * (float(now - frame.publishTime) / 1000.0f - stageLatency.queue);
+  }
+  beatBpm = frame.beatBpm;
+  beatConfidence = frame.beatConfidence;
+  beatFramePhase = frame.beatPhase;
+  beatFrameTime = frame.captureTime;
+  pendingCaptureTime = frame.captureTime;
+  pendingApplyTime = now;
+  haveNewFFTResult = true;
+}
+
+// WLEDMM pick up new results from FFT task. With audioDelay > 0, frames wait in the delay line first.
+static void processAudioFrames(void) {
+  bool haveFrame = audioFrames.fetch();
+  if (audioDelay > 0 && !delayLine) {
+    delayLine = (audioFrame_t*) calloc(AUDIO_DELAY_FRAMES, sizeof(audioFrame_t));
+    delayHead = delayCount = 0;
+  }
+  if ((audioDelay == 0) || !delayLine) {               // no delay (or no memory for it)
+    if (delayLine) { free(delayLine); delayLine = nullptr; delayCount = 0; }
+    if (haveFrame) applyAudioFrame(audioFrames.front());
+    return;
+  }
+
+  if (haveFrame) {
+    if (delayCount >= AUDIO_DELAY_FRAMES) {            // full - release oldest frame early
+      applyAudioFrame(delayLine[delayHead]);
+      delayHead = (delayHead + 1) % AUDIO_DELAY_FRAMES;
+      delayCount--;
+    }
+    delayLine[(delayHead + delayCount) % AUDIO_DELAY_FRAMES] = audioFrames.front();
+    delayCount++;
+  }
+  uint32_t now = millis();
+  while ((delayCount > 0) && (now - delayLine[delayHead].publishMillis >= audioDelay)) {
+    applyAudioFrame(delayLine[delayHead]);
+    delayHead = (delayHead + 1) % AUDIO_DELAY_FRAMES;
+    delayCount--;
+  }
+}
+
+// WLEDMM estimated time needed to send one frame to the LEDs, in ms. Single-wire digital outputs transmit in parallel at 800kbit/s.
+static float estimateShowTime(void) {
+  unsigned maxBits = 0;
+  for (unsigned b = 0; b < busses.getNumBusses(); b++) {
+    Bus *bus = busses.getBus(b);
+    if (!bus || !IS_DIGITAL(bus->getType()) || IS_2PIN(bus->getType()) || (bus->getType() == TYPE_HUB75MATRIX)) continue;
+    maxBits = max(maxBits, unsigned(bus->getLength()) * (bus->hasWhite() ? 32U : 24U));
+  }
+  return (maxBits > 0) ? float(maxBits) * 0.00125f + 0.3f : 0.0f;   // 1.25us per bit, plus reset pulse
+}
+
+// WLEDMM age of the captured sound when capture is done: on average, samples are half a FFT batch plus half a DMA block old
+static constexpr float inputLatency(void) { return float(samplesFFT/2 + BLOCK_SIZE/2) * 1000.0f / float(SAMPLE_RATE); }
+
+// WLEDMM the beat tracker's phase belongs to the sound at capture time. Move it forward to the time when LEDs will show the next frame
+// (minus the delay line), so beat-synced effects are on time instead of late.
+static void updateBeatPhase(void) {
+  if ((beatBpm <= 0.0f) || (beatFrameTime == 0)) { beatPhase = 0.0f; return; }
+  float ahead = float(esp_timer_get_time() - beatFrameTime) / 1000.0f + inputLatency() + stageLatency.render + showLatency - float(audioDelay);
+  float phase = beatFramePhase + ahead * beatBpm / 60000.0f;
+  beatPhase = phase - floorf(phase);
+}
+
+// WLEDMM true if an effect of an active segment uses audio - effects declare this with the 'v' (volume) or 'f' (frequency) flag in their _data string
+static bool effectsUseAudio(void) {
+  for (unsigned i = 0; i < strip.getSegmentsNum(); i++) {
+    Segment &seg = strip.getSegment(i);
+    if (!seg.isActive() || !seg.on) continue;
+    const char *data = strip.getModeData(seg.mode);
+    unsigned field = 0;
+    for (char c = pgm_read_byte(data); c != '\0'; c = pgm_read_byte(++data)) {
+      if (c == '@') { field = 1; continue; }       // sliders start after '@'
+      if (field == 0) continue;                    // effect name
+      if (c == ';') { if (++field > 4) break; continue; }
+      if ((field == 4) && ((c == 'v') || (c == 'f'))) return true;  // 4th field = flags
+    }
+  }
+  return false;
 }
 
+// WLEDMM adaptive processing rate, decided in loop() and used by the FFT task:
+// * idle when nothing needs audio data - no effect with audio flags, no other usermod asking for um_data, not sending sound sync.
+//   Wakes up immediately when um_data is requested (for example an audio palette, or an ARTI-FX program).
+// * on single-core boards, FFT and LEDs compete for the same CPU - go to half rate while LEDs are below target fps, and try full rate
+//   again after some time with enough headroom. Dual-core boards run the FFT task on the other core, so they always use full rate.
+static void updateProcessingRate(void) {
+  static unsigned long lastCheck = 0;
+  static unsigned long lastStats = 0;
+#if defined(CONFIG_IDF_TARGET_ESP32S2) || defined(CONFIG_IDF_TARGET_ESP32C3) || defined(CONFIG_FREERTOS_UNICORE)
+  static unsigned long slowSince = 0;        // LEDs below target fps since ...
+  static unsigned long fastSince = 0;        // LEDs at target fps since ...
+  static unsigned long lastRaise = 0;
+  static unsigned raiseWait = 5;             // seconds at target fps before trying full rate again
+#endif
+  static uint32_t lastFftCount = 0, lastBusyMicros = 0;
+  unsigned long now = millis();
+  bool recentRequest = (lastUMDataRequest > 0) && (now - lastUMDataRequest < 2000);
+
+  if (!adaptiveRate) fftRate = AR_RATE_FULL;
+  else if ((fftRate == AR_RATE_IDLE) && recentRequest) fftRate = AR_RATE_FULL;   // wake up without waiting for the next check
+  else if (now - lastCheck >= 1000) {
+    lastCheck = now;
+    if (!recentRequest && !(audioSyncEnabled & AUDIOSYNC_SEND) && !effectsUseAudio()) {
+      if (fftRate != AR_RATE_IDLE) {
+        DEBUGSR_PRINTLN(F("AR: no effect uses audio - processing paused."));
+      }
+      fftRate = AR_RATE_IDLE;
+    } else {
+      if (fftRate == AR_RATE_IDLE) fftRate = AR_RATE_FULL;
+#if defined(CONFIG_IDF_TARGET_ESP32S2) || defined(CONFIG_IDF_TARGET_ESP32C3) || defined(CONFIG_FREERTOS_UNICORE)
+      unsigned targetFps = strip.getTargetFps();
+      if ((targetFps == FPS_UNLIMITED_AC) || (targetFps >= FPS_UNLIMITED)) targetFps = WLED_FPS;
+      unsigned fps = strip.getFps();           // 0 = no LED updates at all - that's headroom, too
+      bool slow = (fps > 0) && (fps * 100 < targetFps * 85);
+      bool fast = (fps == 0) || (fps * 100 >= targetFps * 95);
+      if (!slow) slowSince = 0; else if (slowSince == 0) slowSince = now;
+      if (!fast) fastSince = 0; else if (fastSince == 0) fastSince = now;
+      if ((fftRate == AR_RATE_FULL) && (slowSince > 0) && (now - slowSince >= 2000)) {
+        fftRate = AR_RATE_HALF;
+        if ((lastRaise > 0) && (now - lastRaise < 30000)) raiseWait = min(raiseWait * 2, 60U);  // raising did not work - wait longer next time
+        fastSince = 0;
+        DEBUGSR_PRINTF("AR: LEDs at %u fps (target %u) - FFT at half rate.\n", fps, targetFps);
+      } else if ((fftRate == AR_RATE_HALF) && (fastSince > 0) && (now - fastSince >= raiseWait * 1000UL)) {
+        fftRate = AR_RATE_FULL;
+        lastRaise = now;
+        slowSince = 0;
+        DEBUGSR_PRINTF("AR: LEDs at %u fps (target %u) - FFT at full rate.\n", fps, targetFps);
+      }
+      if ((lastRaise > 0) && (now - lastRaise > 300000)) raiseWait = 5;   // stable for 5 minutes - forget the history
+#else
+      fftRate = AR_RATE_FULL;
+#endif
+    }
+  }
+
+  // statistics for info page
+  if (now - lastStats >= 2000) {
+    uint32_t count = fftCount, busy = fftBusyMicros;
+    if (lastStats > 0) {
+      float seconds = float(now - lastStats) / 1000.0f;
+      fftPerSecond = float(count - lastFftCount) / seconds;
+      fftCPUShare = float(busy - lastBusyMicros) / (seconds * 10000.0f);   // us per s -> percent
+    }
+    lastFftCount = count; lastBusyMicros = busy;
+    lastStats = now;
+  }
+}
 #endif
 
 static void autoResetPeak(void) {
@@ -1100,6 +1432,175 @@ static void autoResetPeak(void) {
   }
 }
 
+// WLEDMM jitter buffer for UDP sound sync receive.
+// Packets are sorted by their (8bit) frameCounter, and each frame is played at a fixed time after its "nominal" arrival time.
+// The nominal time comes from a model of the sender: frames are sent with a constant period, and the earliest arrivals show the
+// network delay without jitter. With delay = 0, frames are played as soon as they arrive (late frames are dropped, like before).
+typedef struct SyncFrame {
+  uint32_t seq = 0;                           // frameCounter, extended to 32bit
+  float    volumeSmth = 0.0f;
+  float    volumeRaw = 0.0f;
+  float    FFT_Magnitude = 0.0f;
+  float    FFT_MajorPeak = 1.0f;
+  float    soundPressure = 0.0f;
+  uint16_t zeroCrossingCount = 0;
+  bool     samplePeak = false;
+  uint8_t  fftResult[NUM_GEQ_CHANNELS] = {0};
+} syncFrame_t;
+
+class SyncJitterBuffer {
+  public:
+    static constexpr unsigned SIZE = 16;      // frames - more than enough for AUDIOSYNC_MAX_JITTER with 20ms send interval
+
+    void reset(void) {
+      for (unsigned i = 0; i < SIZE; i++) _valid[i] = false;
+      _started = false;
+      _period = 20.0f;                        // standard send interval, until we have measured it
+      _periodKnown = false;
+      _jitter = 0.0f;
+    }
+
+    // add a received frame. Returns false for duplicates and frames that came too late. Call for the newest frame of a packet last.
+    bool insert(const syncFrame_t &frame, uint8_t counter, unsigned long now, bool lastInPacket) {
+      if (!_started || (now - _lastArrival > 1000)) start(counter, now);      // first packet, or sender was gone for some time
+      int delta = int8_t(counter - uint8_t(_highest));
+      if ((delta > 64) || (delta < -int(SIZE))) { start(counter, now); delta = 0; }   // sender restarted
+      uint32_t seq = _highest + delta;
+      _lastArrival = now;
+
+      unsigned slot = seq % SIZE;
+      if ((seq < _nextPlay) || (_valid[slot] && (_frames[slot].seq == seq))) {
+        stats.dropped++;
+        if (lastInPacket) { _packetFrames = 0; }
+        return false;
+      }
+      while (seq >= _nextPlay + SIZE) skipOne();                             // no space - give up on the oldest frames
+      _frames[slot] = frame;
+      _frames[slot].seq = seq;
+      _valid[slot] = true;
+      stats.received++;
+      if (seq > _highest) _highest = seq;
+      _packetFrames++;
+      if (lastInPacket) {
+        _batch = _packetFrames;
+        _packetFrames = 0;
+        updateTiming(seq, now);
+      }
+      return true;
+    }
+
+    // next frame that should be played at time "now" (or nullptr). Missing frames are skipped when their time has passed.
+    const syncFrame_t* pop(unsigned long now, unsigned delayMs) {
+      while (_started && (_nextPlay <= _highest)) {
+        if (late(now, _nextPlay, delayMs) < 0.0f) return nullptr;             // not yet
+        unsigned slot = _nextPlay % SIZE;
+        if (_valid[slot] && (_frames[slot].seq == _nextPlay)) {
+          _valid[slot] = false;
+          _nextPlay++;
+          stats.played++;
+          return &_frames[slot];
+        }
+        skipOne();
+      }
+      return nullptr;
+    }
+
+    // the frame that will be played next, if already received
+    const syncFrame_t* peek(void) const {
+      unsigned slot = _nextPlay % SIZE;
+      return (_started && _valid[slot] && (_frames[slot].seq == _nextPlay)) ? &_frames[slot] : nullptr;
+    }
+
+    // how long ago frame "seq" should have been played (negative = in the future), in ms.
+    // With batching, the older frames of a packet were sent late - the delay is extended by the batch length to play them evenly.
+    float late(unsigned long now, uint32_t seq, unsigned delayMs) const {
+      float delay = (delayMs > 0) ? float(delayMs) + float(_batch - 1) * _period : 0.0f;
+      return float(long(now - _anchorTime)) - (float(int32_t(seq - _anchorSeq)) * _period + _minOffset + delay);
+    }
+
+    unsigned depth(void) const { unsigned n = 0; for (unsigned i = 0; i < SIZE; i++) if (_valid[i]) n++; return n; }
+    float period(void) const { return _period; }
+    float jitter(void) const { return _jitter; }                                // ms, smoothed like RFC 3550
+    struct Stats {                            // frame statistics - reset by caller
+      uint32_t received = 0;
+      uint32_t played = 0;
+      uint32_t lost = 0;                      // never arrived, or arrived after their time
+      uint32_t dropped = 0;                   // duplicates and late arrivals
+    } stats;
+
+  private:
+    syncFrame_t _frames[SIZE];
+    bool     _valid[SIZE] = {false};
+    bool     _started = false;
+    uint32_t _highest = 0;                    // newest frame received
+    uint32_t _nextPlay = 0;                   // next frame to play
+    unsigned long _lastArrival = 0;
+    unsigned _batch = 1;                      // frames per packet
+    unsigned _packetFrames = 0;
+    // sender model: frame "seq" arrives at _anchorTime + (seq - _anchorSeq) * _period + _minOffset (plus jitter)
+    unsigned long _anchorTime = 0;
+    uint32_t _anchorSeq = 0;
+    bool     _anchorValid = false;
+    float    _period = 20.0f;                 // ms between frames
+    bool     _periodKnown = false;
+    float    _minOffset = 0.0f;               // earliest arrival seen, relative to the anchor
+    float    _lastTransit = 0.0f;
+    float    _jitter = 0.0f;
+    unsigned long _spanTime = 0;              // start of period measurement
+    uint32_t _spanSeq = 0;
+    uint32_t _measureSeq = 0;                 // last period update
+
+    void start(uint8_t counter, unsigned long now) {
+      for (unsigned i = 0; i < SIZE; i++) _valid[i] = false;
+      _highest = _nextPlay = 256 + counter;   // +256 so that "older" frames don't go below 0
+      _anchorTime = _spanTime = now;
+      _anchorSeq = _spanSeq = _measureSeq = _highest;
+      _anchorValid = false;                   // the arrival time belongs to the last frame of a packet - see updateTiming()
+      _minOffset = _lastTransit = 0.0f;
+      _batch = 1; _packetFrames = 0;
+      _started = true;
+    }
+
+    void skipOne(void) {
+      unsigned slot = _nextPlay % SIZE;
+      if (_valid[slot] && (_frames[slot].seq == _nextPlay)) _valid[slot] = false;
+      else stats.lost++;
+      _nextPlay++;
+    }
+
+    void updateTiming(uint32_t seq, unsigned long now) {
+      if (!_anchorValid) {
+        _anchorTime = _spanTime = now;
+        _anchorSeq = _spanSeq = _measureSeq = seq;
+        _anchorValid = true;
+      }
+      // measure send period over all frames since start, so jitter matters less and less
+      uint32_t span = seq - _spanSeq;
+      if ((int32_t(span) > 0) && (int32_t(seq - _measureSeq) >= (_periodKnown ? 32 : 8))) {
+        float measured = float(now - _spanTime) / float(span);
+        if ((measured >= 4.0f) && (measured <= 100.0f)) {
+          // move the anchor to this frame first, so that changing the period does not shift the current schedule
+          float expected = float(int32_t(seq - _anchorSeq)) * _period;
+          float remainder = expected - floorf(expected);
+          _anchorTime += long(floorf(expected));
+          _anchorSeq = seq;
+          _minOffset += remainder;
+          _lastTransit += remainder;
+          _period = measured;
+          _periodKnown = true;
+        }
+        _measureSeq = seq;
+      }
+
+      // transit time relative to the model
+      float transit = float(long(now - _anchorTime)) - float(int32_t(seq - _anchorSeq)) * _period;
+      if (transit < _minOffset) _minOffset = transit;                          // faster than ever - network delay is lower
+      else _minOffset += 0.02f;                                                 // slowly forget, to follow clock drift
+      _jitter += (fabsf(transit - _lastTransit) - _jitter) / 16.0f;
+      _lastTransit = transit;
+    }
+};
+
 ////////////////////
 // usermod class  //
 ////////////////////
@@ -1184,7 +1685,7 @@ class AudioReactive : public Usermod {
       double FFT_MajorPeak;   //  08 Bytes
     };
 
-    #define UDPSOUND_MAX_PACKET 96 // max packet size for audiosync, with a bit of "headroom"
+    #define UDPSOUND_MAX_PACKET (AUDIOSYNC_MAX_BATCH * sizeof(audioSyncPacket) + 8) // max packet size for audiosync, with a bit of "headroom"
 
     // set your config variables to their boot default value (this can also be done in readFromConfig() or a constructor if you prefer)
   #if defined(SR_ENABLE_DEFAULT) || defined(UM_AUDIOREACTIVE_ENABLE)
@@ -1228,6 +1729,15 @@ class AudioReactive : public Usermod {
     // used to feed "Info" Page
     unsigned long last_UDPTime = 0;    // time of last valid UDP sound sync datapacket
     int receivedFormat = 0;            // last received UDP sound sync format - 0=none, 1=v1 (0.13.x), 2=v2 (0.14.x)
+
+    // WLEDMM jitter buffer for receiving
+    SyncJitterBuffer syncBuffer;
+    syncFrame_t syncCurrent;           // frame that is playing now
+    bool syncPlaying = false;          // syncCurrent is valid
+    bool syncDirectData = false;       // a packet was used without the jitter buffer (v1 format, or sequence checking off)
+    float syncLoss = 0.0f;             // lost frames in %
+    float syncDepth = 0.0f;            // average number of frames waiting in the buffer
+    unsigned long syncStatsTime = 0;
     float maxSample5sec = 0.0f;        // max sample (after AGC) in last 5 seconds 
     unsigned long sampleMaxTimer = 0;  // last time maxSample5sec was reset
     #define CYCLE_SAMPLEMAX 3500       // time window for merasuring
@@ -1723,12 +2233,21 @@ class AudioReactive : public Usermod {
       transmitData.FFT_Magnitude = my_magnitude;
       transmitData.FFT_MajorPeak = FFT_MajorPeak;
 
+      frameCounter++;
+
+      // WLEDMM optionally collect several frames, and send them in one packet
+      static audioSyncPacket batch[AUDIOSYNC_MAX_BATCH];
+      static unsigned batchCount = 0;
+      unsigned batchSize = constrain(audioSyncBatch, 1, AUDIOSYNC_MAX_BATCH);
+      memcpy(&batch[batchCount], &transmitData, sizeof(transmitData));
+      batchCount++;
+      if (batchCount < batchSize) return;
+
       if (fftUdp.beginMulticastPacket() != 0) { // beginMulticastPacket returns 0 in case of error
-        fftUdp.write(reinterpret_cast<uint8_t *>(&transmitData), sizeof(transmitData));
+        fftUdp.write(reinterpret_cast<uint8_t *>(batch), batchCount * sizeof(audioSyncPacket));
         fftUdp.endPacket();
       }
-      
-      frameCounter++;
+      batchCount = 0;
     } // transmitAudioData()
 #endif
     static bool isValidUdpSyncVersion(const char *header) {
@@ -1738,35 +2257,55 @@ class AudioReactive : public Usermod {
       return strncmp_P(header, UDP_SYNC_HEADER_v1, 6) == 0;
     }
 
-    bool decodeAudioData(int packetSize, uint8_t *fftBuff) {
+    bool decodeAudioData(int packetSize, uint8_t *fftBuff, bool lastInPacket = true) {
       if((0 == packetSize) || (nullptr == fftBuff)) return false; // sanity check
       //audioSyncPacket *receivedPacket = reinterpret_cast<audioSyncPacket*>(fftBuff);
       audioSyncPacket receivedPacket;
       memset(&receivedPacket, 0, sizeof(receivedPacket));                                  // start clean
       memcpy(&receivedPacket, fftBuff, min((unsigned)packetSize, (unsigned)sizeof(receivedPacket))); // don't violate alignment - thanks @willmmiles
 
-      // validate sequence, discard out-of-sequence packets
       static uint8_t lastFrameCounter = 0;
       // add info for UI
       if ((receivedPacket.frameCounter > 0) && (lastFrameCounter > 0)) receivedFormat = 3; // v2+
       else receivedFormat = 2; // v2
-      // check sequence
-      bool sequenceOK = false;
-      if(receivedPacket.frameCounter > lastFrameCounter) sequenceOK = true;                  // sequence OK
-      if((lastFrameCounter < 12) && (receivedPacket.frameCounter > 248)) sequenceOK = false; // prevent sequence "roll-back" due to late packets (1->254)
-      if((lastFrameCounter > 248) && (receivedPacket.frameCounter < 12)) sequenceOK = true;  // handle roll-over (255 -> 0)
-      if(audioSyncSequence == false) sequenceOK = true;                                       // sequence checking disabled by user
-      if((sequenceOK == false) && (receivedPacket.frameCounter != 0)) {                      // always accept "0" - its the legacy value
-        DEBUGSR_PRINTF("Skipping audio frame out of order or duplicated - %u vs %u\n", lastFrameCounter, receivedPacket.frameCounter);
-        return false;   // reject out-of sequence frame
+      lastFrameCounter = receivedPacket.frameCounter;
+
+      syncFrame_t frame;
+      frame.volumeSmth = fmaxf(receivedPacket.sampleSmth, 0.0f);
+      frame.volumeRaw  = fmaxf(receivedPacket.sampleRaw, 0.0f);
+      frame.samplePeak = receivedPacket.samplePeak >0 ? true:false;
+      //These values are only computed by ESP32
+      for (int i = 0; i < NUM_GEQ_CHANNELS; i++) frame.fftResult[i] = receivedPacket.fftResult[i];
+      frame.FFT_Magnitude = fmaxf(receivedPacket.FFT_Magnitude, 0.0f);
+      frame.FFT_MajorPeak = constrain(receivedPacket.FFT_MajorPeak, 1.0f, 11025.0f);  // restrict value to range expected by effects
+      frame.zeroCrossingCount = receivedPacket.zeroCrossingCount;
+
+      // WLEDMM extract soundPressure
+      if ((receivedPacket.pressure[0] != 0) || (receivedPacket.pressure[1] != 0)) {
+        // found something in gap "reserved2"
+        frame.soundPressure  = float(receivedPacket.pressure[1]) / 256.0f; // fractional part
+        frame.soundPressure += float(receivedPacket.pressure[0]);          // integer part
+      } else {
+        frame.soundPressure = frame.volumeSmth; // fallback
       }
-      else {
-        lastFrameCounter = receivedPacket.frameCounter;
+
+      // WLEDMM frames with sequence number go through the jitter buffer - it puts them in order, and drops duplicate or late frames
+      if (audioSyncSequence && (receivedPacket.frameCounter != 0)) {          // "0" is the legacy value - no sequence
+        bool accepted = syncBuffer.insert(frame, receivedPacket.frameCounter, millis(), lastInPacket);
+        if (!accepted) {
+          DEBUGSR_PRINTF("Skipping audio frame out of order or duplicated - %u\n", receivedPacket.frameCounter);
+        }
+        return accepted;
       }
+      applySyncFrame(frame, true);                                             // sequence checking disabled by user - use immediately
+      syncDirectData = true;
+      return true;
+    }
 
-      // update samples for effects
-      volumeSmth   = fmaxf(receivedPacket.sampleSmth, 0.0f);
-      volumeRaw    = fmaxf(receivedPacket.sampleRaw, 0.0f);
+    // update samples for effects from a received frame. newFrame = false when only interpolating between frames.
+    void applySyncFrame(const syncFrame_t &frame, bool newFrame) {
+      volumeSmth   = frame.volumeSmth;
+      volumeRaw    = frame.volumeRaw;
 #ifdef ARDUINO_ARCH_ESP32
       // update internal samples
       sampleRaw    = volumeRaw;
@@ -1778,31 +2317,63 @@ class AudioReactive : public Usermod {
       // Only change samplePeak IF it's currently false.
       // If it's true already, then the animation still needs to respond.
       autoResetPeak();
-      if (!samplePeak) {
-            samplePeak = receivedPacket.samplePeak >0 ? true:false;
+      if (newFrame && !samplePeak) {
+            samplePeak = frame.samplePeak;
             if (samplePeak) timeOfPeak = millis();
             //userVar1 = samplePeak;
       }
-      //These values are only computed by ESP32
-      for (int i = 0; i < NUM_GEQ_CHANNELS; i++) fftResult[i] = receivedPacket.fftResult[i];
-      my_magnitude  = fmaxf(receivedPacket.FFT_Magnitude, 0.0f);
+      memcpy(fftResult, frame.fftResult, sizeof(fftResult));
+      my_magnitude  = frame.FFT_Magnitude;
       FFT_Magnitude = my_magnitude;
-      FFT_MajorPeak = constrain(receivedPacket.FFT_MajorPeak, 1.0f, 11025.0f);  // restrict value to range expected by effects
+      FFT_MajorPeak = frame.FFT_MajorPeak;
 #ifdef ARDUINO_ARCH_ESP32
-      FFT_MajPeakSmth = FFT_MajPeakSmth + 0.42f * (FFT_MajorPeak - FFT_MajPeakSmth); // simulate smooth value
+      if (newFrame) FFT_MajPeakSmth = FFT_MajPeakSmth + 0.42f * (FFT_MajorPeak - FFT_MajPeakSmth); // simulate smooth value
 #endif
       agcSensitivity = 128.0f; // substitute - V2 format does not include this value
-      zeroCrossingCount = receivedPacket.zeroCrossingCount;
-
-      // WLEDMM extract soundPressure
-      if ((receivedPacket.pressure[0] != 0) || (receivedPacket.pressure[1] != 0)) {
-        // found something in gap "reserved2"
-        soundPressure  = float(receivedPacket.pressure[1]) / 256.0f; // fractional part
-        soundPressure += float(receivedPacket.pressure[0]);          // integer part
-      } else {
-        soundPressure = volumeSmth; // fallback
-      }
+      zeroCrossingCount = frame.zeroCrossingCount;
+      soundPressure = frame.soundPressure;
+    }
 
+    // WLEDMM play frames from the jitter buffer when their time has come, and interpolate between frames.
+    // Returns true when new values for effects are available.
+    bool playSyncFrames(void) {
+      unsigned long now = millis();
+      bool newFrame = false;
+      bool peak = false;
+      while (const syncFrame_t *frame = syncBuffer.pop(now, audioSyncJitter)) {
+        peak |= frame->samplePeak;          // keep peaks of frames that we are skipping
+        syncCurrent = *frame;
+        newFrame = true;
+      }
+
+      // statistics for "Info"
+      if (newFrame) syncDepth += 0.05f * (float(syncBuffer.depth()) - syncDepth);
+      if (now - syncStatsTime > 2000) {
+        uint32_t expected = syncBuffer.stats.played + syncBuffer.stats.lost;
+        if (expected > 0) syncLoss = 0.5f * syncLoss + 0.5f * (100.0f * float(syncBuffer.stats.lost) / float(expected));
+        syncBuffer.stats = SyncJitterBuffer::Stats();
+        syncStatsTime = now;
+      }
+
+      if (newFrame) { syncCurrent.samplePeak = peak; syncPlaying = true; }
+      if (!syncPlaying) return false;
+
+      const syncFrame_t *next = (audioSyncJitter > 0) ? syncBuffer.peek() : nullptr;
+      if (next == nullptr) {                // nothing to interpolate - keep current values
+        if (newFrame) applySyncFrame(syncCurrent, true);
+        return newFrame;
+      }
+      float span = float(next->seq - syncCurrent.seq) * syncBuffer.period();
+      float t = constrain(syncBuffer.late(now, syncCurrent.seq, audioSyncJitter) / span, 0.0f, 1.0f);
+      syncFrame_t mix = syncCurrent;
+      mix.volumeSmth    += t * (next->volumeSmth - syncCurrent.volumeSmth);
+      mix.volumeRaw     += t * (next->volumeRaw - syncCurrent.volumeRaw);
+      mix.FFT_Magnitude += t * (next->FFT_Magnitude - syncCurrent.FFT_Magnitude);
+      mix.FFT_MajorPeak += t * (next->FFT_MajorPeak - syncCurrent.FFT_MajorPeak);
+      mix.soundPressure += t * (next->soundPressure - syncCurrent.soundPressure);
+      for (int i = 0; i < NUM_GEQ_CHANNELS; i++)
+        mix.fftResult[i] = roundf(float(syncCurrent.fftResult[i]) + t * (float(next->fftResult[i]) - float(syncCurrent.fftResult[i])));
+      applySyncFrame(mix, newFrame);
       return true;
     }
 
@@ -1834,6 +2405,7 @@ class AudioReactive : public Usermod {
       FFT_MajorPeak = constrain(receivedPacket->FFT_MajorPeak, 1.0, 11025.0);  // restrict value to range expected by effects
       soundPressure = volumeSmth; // substitute - V1 format does not include this value
       agcSensitivity = 128.0f; // substitute - V1 format does not include this value
+      syncDirectData = true;
     }
 
     bool receiveAudioData()   // check & process new data. return TRUE in case that new audio data was received. 
@@ -1867,9 +2439,16 @@ class AudioReactive : public Usermod {
         fftUdp.read(fftUdpBuffer, packetSize);
 
         // VERIFY THAT THIS IS A COMPATIBLE PACKET
-        if (packetSize == sizeof(audioSyncPacket) && (isValidUdpSyncVersion((const char *)fftUdpBuffer))) {
+        // WLEDMM a v2 packet may contain several frames ("batch" setting of the sender)
+        if ((packetSize % sizeof(audioSyncPacket) == 0) && (packetSize <= AUDIOSYNC_MAX_BATCH * sizeof(audioSyncPacket))
+            && (isValidUdpSyncVersion((const char *)fftUdpBuffer))) {
           receivedFormat = 2;
-          haveFreshData = decodeAudioData(packetSize, fftUdpBuffer);
+          unsigned frames = packetSize / sizeof(audioSyncPacket);
+          for (unsigned i = 0; i < frames; i++) {
+            uint8_t *frame = fftUdpBuffer + i * sizeof(audioSyncPacket);
+            if (!isValidUdpSyncVersion((const char *)frame)) break;
+            haveFreshData |= decodeAudioData(sizeof(audioSyncPacket), frame, i+1 == frames);
+          }
           //DEBUGSR_PRINTLN("Finished parsing UDP Sync Packet v2");
         } else {
           if (packetSize == sizeof(audioSyncPacket_v1) && (isValidUdpSyncVersion_v1((const char *)fftUdpBuffer))) {
@@ -1903,7 +2482,7 @@ class AudioReactive : public Usermod {
         // usermod exchangeable data
         // we will assign all usermod exportable data here as pointers to original variables or arrays and allocate memory for pointers
         um_data = new um_data_t;
-        um_data->u_size = 12;
+        um_data->u_size = 15;
         um_data->u_type = new um_types_t[um_data->u_size];
         um_data->u_data = new void*[um_data->u_size];
         um_data->u_data[0] = &volumeSmth;      //*used (New)
@@ -1935,6 +2514,12 @@ class AudioReactive : public Usermod {
         um_data->u_type[10] = UMT_FLOAT;
         um_data->u_data[11] = &zeroCrossingCount; // for auto playlist usermod
         um_data->u_type[11] = UMT_UINT16;
+        um_data->u_data[12] = &beatBpm;        // new - beat tracking (stays 0 on 8266 and in audio sync receive mode)
+        um_data->u_type[12] = UMT_FLOAT;
+        um_data->u_data[13] = &beatPhase;      // new
+        um_data->u_type[13] = UMT_FLOAT;
+        um_data->u_data[14] = &beatConfidence; // new
+        um_data->u_type[14] = UMT_FLOAT;
       }
 
 #ifdef ARDUINO_ARCH_ESP32
@@ -2068,6 +2653,12 @@ class AudioReactive : public Usermod {
           if (i2c_scl >= 0) sclPin = -1;
           if (audioSource) audioSource->initialize(i2swsPin, i2ssdPin, i2sckPin, mclkPin);
           break;
+        case 10:
+          DEBUGSR_PRINTLN(F("AR: WAV file replay (/audio.wav)"));
+          audioSource = new WavFileSource(SAMPLE_RATE, BLOCK_SIZE);
+          delay(100);
+          if (audioSource) audioSource->initialize();
+          break;
 
           case 255: // falls through
           case 254: // dummy "network receive only" driver
@@ -2275,6 +2866,10 @@ class AudioReactive : public Usermod {
         // run filters, and repeat in case of loop delays (hick-up compensation)
         if (userloopDelay <2) userloopDelay = 0;      // minor glitch, no problem
         if (userloopDelay >200) userloopDelay = 200;  // limit number of filter re-runs  
+        processAudioFrames();                 // pick up new results from FFT task
+        updateBeatPhase();
+        updateProcessingRate();               // adapt FFT rate to effects and LED frame rate
+
         do {
           getSample();                        // run microphone sampling filters
           agcAvg(t_now - userloopDelay);      // Calculated the PI adjusted value as sampleAvg
@@ -2318,9 +2913,11 @@ class AudioReactive : public Usermod {
           // Only run the audio listener code if we're in Receive mode
           static float syncVolumeSmth = 0;
           bool have_new_sample = false;
-          if (millis() - lastTime > delayMs) {
-            have_new_sample = receiveAudioData();
-            if (have_new_sample) {
+          if ((audioSyncJitter > 0) || (millis() - lastTime > delayMs)) {
+            // WLEDMM with jitter buffer, read all packets as soon as they arrive - arrival times are needed for timing
+            unsigned maxPackets = (audioSyncJitter > 0) ? 4 : 1;
+            for (unsigned i = 0; i < maxPackets; i++) {
+              if (!receiveAudioData()) break;
               last_UDPTime = millis();
               useNetworkAudio = true;  // UDP input arrived - use it
             }
@@ -2330,6 +2927,8 @@ class AudioReactive : public Usermod {
             fftUdp.flush(); // WLEDMM: Flush this if we haven't read it. Does not work on 8266.
 #endif
           }
+          have_new_sample = playSyncFrames() || syncDirectData;
+          syncDirectData = false;
           if (useNetworkAudio) {
             if (have_new_sample) syncVolumeSmth = volumeSmth;   // remember received sample
             else volumeSmth = syncVolumeSmth;                   // restore originally received sample for next run of dynamics limiter
@@ -2346,6 +2945,8 @@ class AudioReactive : public Usermod {
           && ((millis() - last_UDPTime) > 25000)) {   // close connection after 25sec idle
         udpSyncConnected = false;
         receivedFormat = 0;
+        syncBuffer.reset();
+        syncPlaying = false;
         fftUdp.stop();
         volumeSmth =0.0f;
         volumeRaw =0;
@@ -2411,6 +3012,7 @@ class AudioReactive : public Usermod {
     {
       if (!data || !enabled) return false; // no pointer provided by caller or not enabled -> exit
       *data = um_data;
+      lastUMDataRequest = millis();        // WLEDMM someone uses audio data - keep processing at full rate
       return true;
     }
 
@@ -2431,6 +3033,13 @@ class AudioReactive : public Usermod {
       sampleRaw = 0; rawSampleAgc = 0;
       my_magnitude = 0; FFT_Magnitude = 0; FFT_MajorPeak = 1;
       multAgc = 1;
+      audioFrames.fetch();                  // WLEDMM drop results from before the reset
+      lastFrameSequence = 0; framesSkipped = 0;
+      pendingCaptureTime = 0; audioLatency = 0.0f;
+      stageLatency.fft = stageLatency.queue = stageLatency.render = 0.0f;
+      delayCount = 0;
+      beatBpm = 0.0f; beatPhase = 0.0f; beatConfidence = 0.0f; beatFrameTime = 0;
+      syncBuffer.reset(); syncPlaying = false;
       // reset FFT data
       memset(fftCalc, 0, sizeof(fftCalc)); 
       memset(fftAvg, 0, sizeof(fftAvg)); 
@@ -2486,6 +3095,7 @@ class AudioReactive : public Usermod {
       volumeRaw = 0; volumeSmth = 0;
       for(int i=(init?0:1); i<NUM_GEQ_CHANNELS; i+=2) fftResult[i] = 16; // make a tiny pattern
       autoResetPeak();
+      syncBuffer.reset(); syncPlaying = false;
 
       if (init) {
         if (udpSyncConnected) {   // close UDP sync connection (if open)
@@ -2607,6 +3217,8 @@ class AudioReactive : public Usermod {
             // audio source successfully configured
             if (audioSource->getType() == AudioSource::Type_I2SAdc) {
               infoArr.add(F("ADC analog"));
+            } else if (audioSource->getType() == AudioSource::Type_File) {
+              infoArr.add(F("WAV file"));
             } else {
               if (dmType != 51)
                 infoArr.add(F("I2S digital"));
@@ -2648,6 +3260,38 @@ class AudioReactive : public Usermod {
           infoArr.add(roundf(multAgc*100.0f) / 100.0f);
           infoArr.add("x");
         }
+        // WLEDMM time from sound to light: estimated input and LED transmit time, measured processing time
+        if ((audioLatency > 0.0f) && (disableSoundProcessing == false) && !(audioSyncEnabled == AUDIOSYNC_REC)) {
+          float showTime = estimateShowTime();
+          infoArr = user.createNestedArray(F("Audio latency"));
+          infoArr.add(roundf((inputLatency() + audioLatency + showTime)*10.0f) / 10.0f);
+          if (framesSkipped > 0) {
+            char skipped[32];
+            snprintf_P(skipped, sizeof(skipped), PSTR(" ms (%u frames skipped)"), unsigned(framesSkipped));
+            infoArr.add(skipped);
+          } else infoArr.add(" ms");
+
+          char stages[96];
+          snprintf_P(stages, sizeof(stages), PSTR("mic %.1f + FFT %.1f + %s %.1f + effects %.1f + LEDs %.1f ms"),
+                     inputLatency(), stageLatency.fft, (audioDelay > 0) ? "delay" : "wait", stageLatency.queue, stageLatency.render, showTime);
+          infoArr = user.createNestedArray(F("Latency stages"));
+          infoArr.add(stages);
+        }
+        // WLEDMM beat tracking
+        if ((disableSoundProcessing == false) && !(audioSyncEnabled == AUDIOSYNC_REC)) {
+          infoArr = user.createNestedArray(F("Tempo"));
+          if (beatBpm > 0.0f) {
+            char tempo[32];
+            snprintf_P(tempo, sizeof(tempo), PSTR("%.1f BPM (%u%% sure)"), beatBpm, unsigned(roundf(beatConfidence * 100.0f)));
+            infoArr.add(tempo);
+          } else infoArr.add(F("no beat"));
+          // WLEDMM adaptive processing rate
+          infoArr = user.createNestedArray(F("Audio processing"));
+          char load[48];
+          const char *rateName = (!adaptiveRate || (fftRate == AR_RATE_FULL)) ? "full" : (fftRate == AR_RATE_HALF) ? "half" : "idle";
+          snprintf_P(load, sizeof(load), PSTR("%.1f FFT/s, %.1f%% CPU (%s)"), fftPerSecond, fftCPUShare, rateName);
+          infoArr.add(load);
+        }
 #endif
         // UDP Sound Sync status
         infoArr = user.createNestedArray(F("UDP Sound Sync"));
@@ -2655,6 +3299,11 @@ class AudioReactive : public Usermod {
           if (audioSyncEnabled & AUDIOSYNC_SEND) {
             infoArr.add(F("send mode"));
             if ((udpSyncConnected) && (millis() - lastTime < AUDIOSYNC_IDLE_MS)) infoArr.add(F(" v2+"));
+            if (audioSyncBatch > 1) {
+              char batch[24];
+              snprintf_P(batch, sizeof(batch), PSTR(" (%u frames/packet)"), unsigned(audioSyncBatch));
+              infoArr.add(batch);
+            }
           } else if (audioSyncEnabled == AUDIOSYNC_REC) {
               infoArr.add(F("receive mode"));
           } else if (audioSyncEnabled == AUDIOSYNC_REC_PLUS) {
@@ -2671,6 +3320,14 @@ class AudioReactive : public Usermod {
               else infoArr.add(F(" v2"));
             }
         }
+        // WLEDMM jitter buffer statistics
+        if ((audioSyncEnabled & AUDIOSYNC_REC) && udpSyncConnected && (receivedFormat >= 2) && audioSyncSequence
+            && (millis() - last_UDPTime < AUDIOSYNC_IDLE_MS)) {
+          infoArr = user.createNestedArray(F("UDP sync quality"));
+          char quality[64];
+          snprintf_P(quality, sizeof(quality), PSTR("loss %.1f%%, jitter %.1f ms, buffer %.1f frames"), syncLoss, syncBuffer.jitter(), syncDepth);
+          infoArr.add(quality);
+        }
 
         #if defined(WLED_DEBUG) || defined(SR_DEBUG) || defined(SR_STATS)
         #ifdef ARDUINO_ARCH_ESP32
@@ -2686,6 +3343,11 @@ class AudioReactive : public Usermod {
         infoArr.add(roundf(filterTime)/100.0f);
         infoArr.add(" ms");
 
+#if UM_AUDIOREACTIVE_FFT_ENGINE != AR_FFT_ENGINE_ARDUINOFFT
+        infoArr = user.createNestedArray(F("FFT engine"));
+        infoArr.add(ArFFTEngine::name());
+#endif
+
         infoArr = user.createNestedArray(F("FFT time"));
         infoArr.add(roundf(fftTime)/100.0f);
 
@@ -2824,6 +3486,7 @@ class AudioReactive : public Usermod {
 #ifdef FFT_USE_SLIDING_WINDOW
       poweruser[F("I2S_FastPath")] = doSlidingFFT;
 #endif
+      poweruser[F("adaptive_rate")] = adaptiveRate;
       JsonObject freqScale = top.createNestedObject("frequency");
       freqScale[F("scale")] = FFTScalingMode;
       freqScale[F("profile")] = pinkIndex; //WLEDMM
@@ -2832,11 +3495,18 @@ class AudioReactive : public Usermod {
       dynLim[F("limiter")] = limiterOn;
       dynLim[F("rise")] = attackTime;
       dynLim[F("fall")] = decayTime;
+#ifdef ARDUINO_ARCH_ESP32
+      dynLim[F("delay")] = audioDelay;
+#endif
 
       JsonObject sync = top.createNestedObject("sync");
       sync[F("port")] = audioSyncPort;
       sync[F("mode")] = audioSyncEnabled;
       sync[F("check_sequence")] = audioSyncSequence;
+      sync[F("jitter_buffer")] = audioSyncJitter;
+#ifdef ARDUINO_ARCH_ESP32
+      sync[F("batch")] = audioSyncBatch;
+#endif
     }
 
 
@@ -2910,6 +3580,7 @@ class AudioReactive : public Usermod {
 #ifdef FFT_USE_SLIDING_WINDOW
       configComplete &= getJsonValue(top["experiments"][F("I2S_FastPath")], doSlidingFFT);
 #endif
+      configComplete &= getJsonValue(top["experiments"][F("adaptive_rate")], adaptiveRate);
 
       configComplete &= getJsonValue(top["frequency"][F("scale")], FFTScalingMode);
       configComplete &= getJsonValue(top["frequency"][F("profile")], pinkIndex);  //WLEDMM
@@ -2917,10 +3588,20 @@ class AudioReactive : public Usermod {
       configComplete &= getJsonValue(top["dynamics"][F("limiter")], limiterOn);
       configComplete &= getJsonValue(top["dynamics"][F("rise")],  attackTime);
       configComplete &= getJsonValue(top["dynamics"][F("fall")],  decayTime);
+#ifdef ARDUINO_ARCH_ESP32
+      configComplete &= getJsonValue(top["dynamics"][F("delay")], audioDelay);
+      audioDelay = min(audioDelay, uint16_t(AUDIO_DELAY_MAX));
+#endif
 
       configComplete &= getJsonValue(top["sync"][F("port")], audioSyncPort);
       configComplete &= getJsonValue(top["sync"][F("mode")], audioSyncEnabled);
       configComplete &= getJsonValue(top["sync"][F("check_sequence")], audioSyncSequence);
+      configComplete &= getJsonValue(top["sync"][F("jitter_buffer")], audioSyncJitter);
+      audioSyncJitter = min(audioSyncJitter, uint8_t(AUDIOSYNC_MAX_JITTER));
+#ifdef ARDUINO_ARCH_ESP32
+      configComplete &= getJsonValue(top["sync"][F("batch")], audioSyncBatch);
+      audioSyncBatch = constrain(audioSyncBatch, 1, AUDIOSYNC_MAX_BATCH);
+#endif
 
       // WLEDMM notify user when a reboot is necessary
       #ifdef ARDUINO_ARCH_ESP32
@@ -3016,6 +3697,11 @@ class AudioReactive : public Usermod {
       #else
         oappend(SET_F("addOption(dd,'ES8311 ☾',9);"));
       #endif
+      #if SR_DMTYPE==10
+        oappend(SET_F("addOption(dd,'WAV file /audio.wav ☾ (⎌)',10);"));
+      #else
+        oappend(SET_F("addOption(dd,'WAV file /audio.wav ☾',10);"));
+      #endif
       #ifdef SR_SQUELCH
         oappend(SET_F("addInfo(ux+':config:squelch',1,'<i>&#9100; ")); oappendi(SR_SQUELCH); oappend("</i>');");  // 0 is field type, 1 is actual field
       #endif
@@ -3066,6 +3752,10 @@ class AudioReactive : public Usermod {
       oappend(SET_F("addOption(dd,'On  (⎌)',1);"));
       oappend(SET_F("addInfo(ux+':'+xx+':I2S_FastPath',1,'☾');"));
 #endif
+      oappend(SET_F("dd=addDropdown(ux,xx+':adaptive_rate');"));
+      oappend(SET_F("addOption(dd,'Off',0);"));
+      oappend(SET_F("addOption(dd,'On  (⎌)',1);"));
+      oappend(SET_F("addInfo(ux+':'+xx+':adaptive_rate',1,'pause FFT when no effect uses audio');"));
 
       oappend(SET_F("dd=addDropdown(ux,'dynamics:limiter');"));
       oappend(SET_F("addOption(dd,'Off',0);"));
@@ -3073,6 +3763,9 @@ class AudioReactive : public Usermod {
       oappend(SET_F("addInfo(ux+':dynamics:limiter',0,' On ');"));  // 0 is field type, 1 is actual field
       oappend(SET_F("addInfo(ux+':dynamics:rise',1,'ms <i>(&#x266A; effects only)</i>');"));
       oappend(SET_F("addInfo(ux+':dynamics:fall',1,'ms <i>(&#x266A; effects only)</i>');"));
+#ifdef ARDUINO_ARCH_ESP32
+      oappend(SET_F("addInfo(ux+':dynamics:delay',1,'ms <i>(align lights to sound; max 500)</i>');"));
+#endif
 
       oappend(SET_F("dd=addDropdown(ux,'frequency:scale');"));
       oappend(SET_F("addOption(dd,'None',0);"));
@@ -3153,7 +3846,13 @@ class AudioReactive : public Usermod {
       oappend(SET_F("addOption(dd,'Off',0);"));
       oappend(SET_F("addOption(dd,'On',1);"));
 
-      oappend(SET_F("addInfo(ux+':sync:check_sequence',1,'<i>when receiving</i> ☾<br> Sync audio data with other WLEDs');"));  // must append this to the last field of 'sync'
+      oappend(SET_F("addInfo(ux+':sync:check_sequence',1,'<i>when receiving</i>');"));
+#ifdef ARDUINO_ARCH_ESP32
+      oappend(SET_F("addInfo(ux+':sync:jitter_buffer',1,'ms <i>when receiving (0 = off)</i>');"));
+      oappend(SET_F("addInfo(ux+':sync:batch',1,'frames per packet <i>when sending</i> ☾<br> Sync audio data with other WLEDs');"));  // must append this to the last field of 'sync'
+#else
+      oappend(SET_F("addInfo(ux+':sync:jitter_buffer',1,'ms <i>when receiving (0 = off)</i> ☾<br> Sync audio data with other WLEDs');"));  // must append this to the last field of 'sync'
+#endif
 
       oappend(SET_F("addInfo(ux+':digitalmic:type',1,'<i>requires reboot!</i>');"));  // 0 is field type, 1 is actual field
 #ifdef ARDUINO_ARCH_ESP32
@@ -3202,13 +3901,22 @@ class AudioReactive : public Usermod {
 
     /*
      * handleOverlayDraw() is called just before every show() (LED strip update frame) after effects have set the colors.
-     * Use this to blank out some LEDs or set them to a different color regardless of the set effect mode.
-     * Commonly used for custom clocks (Cronixie, 7 segment)
+     * WLEDMM used to measure the time from audio capture to the first LED update that shows it.
      */
-    //void handleOverlayDraw()
-    //{
-      //strip.setPixelColor(0, RGBW32(0,0,0,0)) // set the first pixel to black
-    //}
+#ifdef ARDUINO_ARCH_ESP32
+    void handleOverlayDraw()
+    {
+      showLatency = estimateShowTime();
+      if (pendingCaptureTime == 0) return;
+      int64_t now = esp_timer_get_time();
+      float latency = float(now - pendingCaptureTime) / 1000.0f;
+      float render = float(now - pendingApplyTime) / 1000.0f;
+      pendingCaptureTime = 0;
+      if ((latency < 0.0f) || (latency > 1000.0f + AUDIO_DELAY_MAX) || (render < 0.0f)) return;   // clock glitch or stale frame
+      audioLatency = (audioLatency < 0.01f) ? latency : audioLatency + 0.1f * (latency - audioLatency); // smooth
+      stageLatency.render += 0.1f * (render - stageLatency.render);
+    }
+#endif
 
    
     /*
@@ -164,7 +164,7 @@ class AudioSource {
     virtual bool isInitialized(void) {return(_initialized);}
 
     /* identify Audiosource type - I2S-ADC or I2S-digital */
-    typedef enum{Type_unknown=0, Type_I2SAdc=1, Type_I2SDigital=2} AudioSourceType;
+    typedef enum{Type_unknown=0, Type_I2SAdc=1, Type_I2SDigital=2, Type_File=3} AudioSourceType;
     virtual AudioSourceType getType(void) {return(Type_I2SDigital);}               // default is "I2S digital source" - ADC type overrides this method
  
   protected:
@@ -392,35 +392,38 @@ class I2SSource : public AudioSource {
         esp_err_t err;
         size_t bytes_read = 0;        /* Counter variable to check if we actually got enough data */
 
-        memset(buffer, 0, sizeof(float) * num_samples);  // clear output buffer
         I2S_datatype *newSamples = newSampleBuffer; // use global input buffer
-        if (num_samples > I2S_SAMPLES_MAX) num_samples = I2S_SAMPLES_MAX; // protect the buffer from overflow
+        if (num_samples > I2S_SAMPLES_MAX) { // protect the buffer from overflow
+          memset(buffer + I2S_SAMPLES_MAX, 0, sizeof(float) * (num_samples - I2S_SAMPLES_MAX));
+          num_samples = I2S_SAMPLES_MAX;
+        }
 
         err = i2s_read(AR_I2S_PORT, (void *)newSamples, num_samples * sizeof(I2S_datatype), &bytes_read, portMAX_DELAY);
         if (err != ESP_OK) {
           DEBUGSR_PRINTF("Failed to get samples: %d\n", err);
+          memset(buffer, 0, sizeof(float) * num_samples);  // clear output buffer
           return;
         }
 
         // For correct operation, we need to read exactly sizeof(samples) bytes from i2s
         if (bytes_read != (num_samples * sizeof(I2S_datatype))) {
           DEBUGSR_PRINTF("Failed to get enough samples: wanted: %d read: %d\n", num_samples * sizeof(I2S_datatype), bytes_read);
+          memset(buffer, 0, sizeof(float) * num_samples);  // clear output buffer
           return;
         }
 
-        // Store samples in sample buffer and update DC offset
-        for (int i = 0; i < num_samples; i++) {
-
-          newSamples[i] = postProcessSample(newSamples[i]);  // perform postprocessing (needed for ADC samples)
-          
-          float currSample = 0.0f;
+        // WLEDMM convert and scale in one step. The factor is exact: dividing by 65536 only changes the exponent.
 #ifdef I2S_SAMPLE_DOWNSCALE_TO_16BIT
-              currSample = (float) newSamples[i] / 65536.0f;      // 32bit input -> 16bit; keeping lower 16bits as decimal places
+        const float scale = _sampleScale / 65536.0f;      // 32bit input -> 16bit; keeping lower 16bits as decimal places
 #else
-              currSample = (float) newSamples[i];                 // 16bit input -> use as-is
+        const float scale = _sampleScale;                 // 16bit input -> use as-is
 #endif
-          buffer[i] = currSample;
-          buffer[i] *= _sampleScale;                              // scale samples
+        if (getType() == Type_I2SAdc) {
+          // perform postprocessing (needed for ADC samples)
+          for (unsigned i = 0; i < num_samples; i++) buffer[i] = float(postProcessSample(newSamples[i])) * scale;
+        } else {
+          // digital microphones: no postprocessing - skip the (virtual) function call
+          for (unsigned i = 0; i < num_samples; i++) buffer[i] = float(newSamples[i]) * scale;
         }
       }
     }
@@ -1174,4 +1177,148 @@ class SPH0654 : public I2SSource {
 #endif
     }
 };
+
+/* WAV file replay
+   Reads a recording from the file system instead of a microphone - for reproducible tests and benchmarks of the audio processing.
+   Supports PCM (8, 16, 24, 32bit) and 32bit float WAV files; only the first channel is used. Files without RIFF header are read as
+   16bit mono PCM at the FFT sample rate. Other sample rates are converted with linear interpolation.
+   Samples are delivered at the same pace as I2S would deliver them. At the end, the file starts again.
+*/
+class WavFileSource : public AudioSource {
+  public:
+    WavFileSource(SRate_t sampleRate, int blockSize, float sampleScale = 1.0f, const char* path = "/audio.wav") :
+      AudioSource(sampleRate, blockSize, sampleScale, true), _path(path)
+    {}
+
+    void initialize(int8_t = I2S_PIN_NO_CHANGE, int8_t = I2S_PIN_NO_CHANGE, int8_t = I2S_PIN_NO_CHANGE, int8_t = I2S_PIN_NO_CHANGE) {
+      DEBUGSR_PRINTF("WavFileSource:: initialize(%s).\n", _path);
+      _file = WLED_FS.open(_path, "r");
+      if (!_file) {
+        ERRORSR_PRINTF("AR: cannot open %s\n", _path);
+        return;
+      }
+      if (!parseHeader()) {
+        ERRORSR_PRINTF("AR: %s - unsupported format\n", _path);
+        _file.close();
+        return;
+      }
+      DEBUGSR_PRINTF("AR: %s - %u Hz, %u bit, %u channel(s), %u bytes\n", _path, unsigned(_fileRate), _bits, _channels, unsigned(_dataSize));
+      _step = float(_fileRate) / float(_sampleRate);
+      _pos = 1.0f;
+      _samplesOut = 0;
+      _loops = 0;
+      _bufPos = _bufLen = 0;
+      _initialized = true;
+    }
+
+    void deinitialize() {
+      _initialized = false;
+      if (_file) _file.close();
+    }
+
+    void getSamples(float *buffer, uint16_t num_samples) {
+      memset(buffer, 0, sizeof(float) * num_samples);
+      if (!_initialized) return;
+
+      // wait until a microphone would have recorded these samples
+      if (_samplesOut == 0) _startTime = millis();
+      unsigned long due = _startTime + (unsigned long)(((_samplesOut + num_samples) * 1000ULL) / _sampleRate);
+      while (long(due - millis()) > 0) vTaskDelay(1);
+      // like I2S, only keep the last 8 DMA blocks - older samples are lost when the FFT task falls behind
+      uint64_t recorded = (uint64_t(millis() - _startTime) * _sampleRate) / 1000ULL;
+      if (recorded > _samplesOut + num_samples + 8 * _blockSize) {
+        uint64_t lost = recorded - (_samplesOut + num_samples + 8 * _blockSize);
+        _pos += float(lost) * _step;
+        _samplesOut += lost;
+      }
+
+      for (unsigned i = 0; i < num_samples; i++) {
+        while (_pos >= 1.0f) {                           // linear interpolation between _prev and _next
+          _prev = _next;
+          if (!readSample(_next)) { _next = 0.0f; break; }
+          _pos -= 1.0f;
+        }
+        buffer[i] = (_prev + (_next - _prev) * _pos) * _sampleScale;
+        _pos += _step;
+      }
+      _samplesOut += num_samples;
+    }
+
+    AudioSourceType getType(void) {return(Type_File);}
+    unsigned getLoopCount(void) {return(_loops);}      // number of times the file was played completely
+
+  private:
+    static uint32_t le32(const uint8_t* p) {return(p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24));}
+    static uint16_t le16(const uint8_t* p) {return(p[0] | (p[1] << 8));}
+
+    bool parseHeader(void) {
+      uint8_t hdr[40];
+      _format = 1; _channels = 1; _bits = 16; _fileRate = _sampleRate;
+      _dataStart = 0; _dataSize = _file.size();
+      if ((_file.read(hdr, 12) != 12) || memcmp(hdr, "RIFF", 4) || memcmp(hdr + 8, "WAVE", 4)) {
+        _file.seek(0);                                   // no header: raw 16bit mono
+        return (_dataSize >= 2);
+      }
+      bool haveFormat = false;
+      while (_file.read(hdr, 8) == 8) {
+        uint32_t chunkSize = le32(hdr + 4);
+        if (!memcmp(hdr, "fmt ", 4)) {
+          if ((chunkSize < 16) || (_file.read(hdr, 16) != 16)) return false;
+          _format = le16(hdr); _channels = le16(hdr + 2); _fileRate = le32(hdr + 4); _bits = le16(hdr + 14);
+          if (chunkSize >= 26 && _format == 0xFFFE) {    // WAVE_FORMAT_EXTENSIBLE: sub format
+            if (_file.read(hdr, 10) != 10) return false;
+            _format = le16(hdr + 8);
+            chunkSize -= 10;
+          }
+          _file.seek(_file.position() + chunkSize - 16 + (chunkSize & 1));
+          haveFormat = true;
+        } else if (!memcmp(hdr, "data", 4)) {
+          _dataStart = _file.position();
+          _dataSize = min(chunkSize, uint32_t(_file.size() - _dataStart));
+          break;
+        } else _file.seek(_file.position() + chunkSize + (chunkSize & 1));
+      }
+      if (!haveFormat || (_dataStart == 0) || (_channels == 0) || (_fileRate == 0)) return false;
+      if (_format == 3) return (_bits == 32);
+      return (_format == 1) && ((_bits == 8) || (_bits == 16) || (_bits == 24) || (_bits == 32));
+    }
+
+    // next sample of first channel, scaled like 16bit I2S samples. newSampleBuffer is used as read buffer.
+    bool readSample(float &value) {
+      const unsigned frameSize = _channels * (_bits / 8);
+      if (_bufPos + frameSize > _bufLen) {
+        uint32_t pos = _file.position();
+        if (pos + frameSize > _dataStart + _dataSize) {  // end of recording - start again
+          _file.seek(_dataStart);
+          pos = _dataStart;
+          _loops++;
+        }
+        uint32_t len = min(uint32_t(sizeof(newSampleBuffer) / frameSize) * frameSize, ((_dataStart + _dataSize - pos) / frameSize) * frameSize);
+        _bufLen = (len > 0) ? _file.read((uint8_t*)newSampleBuffer, len) : 0;
+        _bufPos = 0;
+        if (_bufLen < frameSize) return false;
+      }
+      const uint8_t* frame = (const uint8_t*)newSampleBuffer + _bufPos;
+      _bufPos += frameSize;
+      switch (_bits) {
+        case 8:  value = (int(frame[0]) - 128) * 256.0f; break;
+        case 16: value = int16_t(le16(frame)); break;
+        case 24: value = int32_t((uint32_t(frame[0]) << 8) | (uint32_t(frame[1]) << 16) | (uint32_t(frame[2]) << 24)) / 65536.0f; break;
+        default:
+          if (_format == 3) { float f; memcpy(&f, frame, 4); value = f * 32768.0f; }
+          else value = int32_t(le32(frame)) / 65536.0f;
+      }
+      return true;
+    }
+
+    const char* _path;
+    File _file;
+    uint32_t _dataStart = 0, _dataSize = 0, _fileRate = 0;
+    uint16_t _format = 1, _channels = 1, _bits = 16;
+    float _step = 1.0f, _pos = 1.0f, _prev = 0.0f, _next = 0.0f;
+    uint64_t _samplesOut = 0;
+    unsigned long _startTime = 0;
+    unsigned _loops = 0;
+    unsigned _bufPos = 0, _bufLen = 0;             // read buffer position and fill level
+};
 #endif
@@ -9004,7 +9004,65 @@ void WS2812FX::addEffect(uint8_t id, mode_ptr mode_fn, const char *mode_name) {
     _mode.push_back(mode_fn);
     _modeData.push_back(mode_name);
     if (_modeCount < _mode.size()) _modeCount++;
+    id = _modeData.size() - 1;
+  }
+  if (!_modeMeta.empty()) indexModeData(id); // WLEDMM effect added after setupEffectData() (usermods)
+}
+
+// WLEDMM keys in MODE_DEF_* order
+static const char _modeDefaultKeys[MODE_DEF_COUNT][4] PROGMEM = { "sx", "ix", "c1", "c2", "c3", "o1", "o2", "o3", "m12", "si", "rev", "mi", "rY", "mY", "pal" };
+
+// WLEDMM parse effect data once so name, UI data and defaults can be looked up without scanning the string again
+void WS2812FX::indexModeData(uint8_t id) {
+  if (id >= _modeData.size()) return;
+  if (_modeMeta.size() <= id) _modeMeta.resize(id+1);
+  mode_meta_t &meta = _modeMeta[id];
+  memset(&meta, 0, sizeof(meta));
+
+  char lineBuffer[256] = { '\0' };
+  strncpy_P(lineBuffer, _modeData[id], sizeof(lineBuffer)-1);
+  meta.len = strlen(lineBuffer);
+  char *dataPtr = strchr(lineBuffer, '@');
+  meta.nameLen = dataPtr ? dataPtr - lineBuffer : min(meta.len, (uint16_t)255);
+  meta.dataOfs = dataPtr ? dataPtr - lineBuffer + 1 : 0;
+
+  // defaults are "key=value" pairs in the last section (same as extractModeDefaults())
+  char *defaults = strrchr(lineBuffer, ';');
+  if (!defaults) return;
+  int16_t values[MODE_DEF_COUNT];
+  for (char *key = defaults+1; key && *key; ) {
+    char *next = strchr(key, ',');
+    if (next) *next++ = '\0';
+    char *value = strchr(key, '=');
+    if (value) {
+      *value++ = '\0';
+      for (size_t k = 0; k < MODE_DEF_COUNT; k++) {
+        if (strcmp_P(key, _modeDefaultKeys[k]) || (meta.defMask & (1U << k))) continue;
+        meta.defMask |= 1U << k;
+        values[k] = atoi(value);
+        break;
+      }
+    }
+    key = next;
   }
+  meta.defIndex = _modeDefaults.size();
+  for (size_t k = 0; k < MODE_DEF_COUNT; k++) if (meta.defMask & (1U << k)) _modeDefaults.push_back(values[k]);
+}
+
+int8_t WS2812FX::getModeDefaultKey(const char *key) {
+  for (size_t k = 0; k < MODE_DEF_COUNT; k++) if (!strcmp_P(key, _modeDefaultKeys[k])) return k;
+  return -1;
+}
+
+const char *WS2812FX::getModeDefaultKeyName(uint8_t key) {
+  return key < MODE_DEF_COUNT ? _modeDefaultKeys[key] : PSTR("");
+}
+
+// WLEDMM default value of an effect parameter (MODE_DEF_*), -1 if the effect does not set it
+int16_t WS2812FX::getModeDefault(uint8_t id, uint8_t key) const {
+  const mode_meta_t *meta = getModeMeta(id);
+  if (!meta || key >= MODE_DEF_COUNT || !(meta->defMask & (1U << key))) return -1;
+  return _modeDefaults[meta->defIndex + __builtin_popcount(meta->defMask & ((1U << key) - 1))];
 }
 
 void WS2812FX::setupEffectData() {
@@ -9236,4 +9294,10 @@ void WS2812FX::setupEffectData() {
 
 #endif // WLED_DISABLE_2D
 
+  // WLEDMM index all effect data once
+  unsigned long t0 = micros();
+  _modeDefaults.reserve(3 * _modeData.size());
+  for (size_t i = 0; i < _modeData.size(); i++) indexModeData(i);
+  _modeDefaults.shrink_to_fit();
+  _modeMetaTime = micros() - t0;
 }
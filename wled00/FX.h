@@ -350,6 +350,33 @@ typedef enum mapping1D2D {
   M12_sPinwheel = 7 //WLEDMM Pinwheel
 } mapping1D2D_t;
 
+// WLEDMM keys of the defaults section in effect data ("Name@sliders;colors;palette;flags;defaults"), see WS2812FX::getModeDefault()
+#define MODE_DEF_SX    0
+#define MODE_DEF_IX    1
+#define MODE_DEF_C1    2
+#define MODE_DEF_C2    3
+#define MODE_DEF_C3    4
+#define MODE_DEF_O1    5
+#define MODE_DEF_O2    6
+#define MODE_DEF_O3    7
+#define MODE_DEF_M12   8
+#define MODE_DEF_SI    9
+#define MODE_DEF_REV  10
+#define MODE_DEF_MI   11
+#define MODE_DEF_RY   12
+#define MODE_DEF_MY   13
+#define MODE_DEF_PAL  14
+#define MODE_DEF_COUNT 15
+
+// WLEDMM effect data parsed once when the effect is added, 8 bytes per effect
+typedef struct ModeMeta {
+  uint16_t len;      // length of the data string, 0 = empty
+  uint16_t defMask;  // MODE_DEF_* keys present in the defaults section
+  uint16_t defIndex; // first value in WS2812FX::_modeDefaults (in MODE_DEF_* order)
+  uint8_t  nameLen;  // name is data[0 .. nameLen)
+  uint8_t  dataOfs;  // UI data starts after '@' at data[dataOfs], 0 = name only
+} mode_meta_t;
+
 // segment, 72 bytes
 typedef struct Segment {
   public:
@@ -878,6 +905,7 @@ class WS2812FX {  // 96 bytes
       WS2812FX::instance = this;
       _mode.reserve(_modeCount);     // allocate memory to prevent initial fragmentation (does not increase size())
       _modeData.reserve(_modeCount); // allocate memory to prevent initial fragmentation (does not increase size())
+      _modeMeta.reserve(_modeCount); // WLEDMM
       if (_mode.capacity() <= 1 || _modeData.capacity() <= 1) _modeCount = 1; // memory allocation failed only show Solid
       else setupEffectData();
     }
@@ -889,6 +917,8 @@ class WS2812FX {  // 96 bytes
       if (customMappingTable) delete[] customMappingTable;
       _mode.clear();
       _modeData.clear();
+      _modeMeta.clear(); // WLEDMM
+      _modeDefaults.clear();
       _segments.clear();
 #ifndef WLED_DISABLE_2D
       panel.clear();
@@ -928,6 +958,9 @@ class WS2812FX {  // 96 bytes
     void fill(uint32_t c) { for (int i = 0; i < getLengthTotal(); i++) setPixelColor(i, c); } // fill whole strip with color (inline)
     void addEffect(uint8_t id, mode_ptr mode_fn, const char *mode_name); // add effect to the list; defined in FX.cpp
     void setupEffectData(void); // add default effects to the list; defined in FX.cpp
+    int16_t getModeDefault(uint8_t id, uint8_t key) const; // WLEDMM indexed default value of effect, -1 if not set; defined in FX.cpp
+    static int8_t getModeDefaultKey(const char *key); // WLEDMM MODE_DEF_* for "sx", "ix", ..., -1 if not indexed; defined in FX.cpp
+    static const char *getModeDefaultKeyName(uint8_t key); // WLEDMM PROGMEM name of MODE_DEF_* key; defined in FX.cpp
 
     // outsmart the compiler :) by correctly overloading
     inline void setPixelColor(int n, uint8_t r, uint8_t g, uint8_t b, uint8_t w = 0) { setPixelColor(n, RGBW32(r,g,b,w)); }
@@ -998,6 +1031,12 @@ class WS2812FX {  // 96 bytes
     const char **
       getModeDataSrc(void) { return &(_modeData[0]); } // vectors use arrays for underlying data
 
+    const mode_meta_t *
+      getModeMeta(uint8_t id = 0) const { return (id<_modeCount && id<_modeMeta.size()) ? &_modeMeta[id] : nullptr; } // WLEDMM nullptr if not indexed
+
+    uint32_t getModeMetaTime(void) const { return _modeMetaTime; } // WLEDMM us spent indexing effect data at boot
+    size_t getModeMetaSize(void) const { return _modeMeta.capacity()*sizeof(mode_meta_t) + _modeDefaults.capacity()*sizeof(int16_t); } // WLEDMM
+
     Segment&        getSegment(uint8_t id) __attribute__((pure));
     inline Segment& getFirstSelectedSeg(void) { return _segments[getFirstSelectedSegId()]; }
     inline Segment& getMainSegment(void)      { return _segments[getMainSegmentId()]; }
@@ -1109,6 +1148,11 @@ class WS2812FX {  // 96 bytes
     uint8_t                  _modeCount;
     std::vector<mode_ptr>    _mode;     // SRAM footprint: 4 bytes per element
     std::vector<const char*> _modeData; // mode (effect) name and its slider control data array
+    std::vector<mode_meta_t> _modeMeta; // WLEDMM parsed _modeData, see indexModeData()
+    std::vector<int16_t>     _modeDefaults; // WLEDMM default values referenced by _modeMeta
+    uint32_t                 _modeMetaTime = 0;
+
+    void indexModeData(uint8_t id); // WLEDMM defined in FX.cpp
 
     show_callback _callback;
 
@@ -596,26 +596,26 @@ void Segment::setMode(uint8_t fx, bool loadDefaults, bool sliderDefaultsOnly) {
       //markForReset(); // transition will handle this
       mode = fx;
 
-      // load default values from effect string
+      // load default values from effect string (WLEDMM parsed once in WS2812FX::indexModeData())
       if (loadDefaults) {
         int16_t sOpt;
-        sOpt = extractModeDefaults(fx, "sx");   speed     = (sOpt >= 0) ? sOpt : DEFAULT_SPEED;
-        sOpt = extractModeDefaults(fx, "ix");   intensity = (sOpt >= 0) ? sOpt : DEFAULT_INTENSITY;
-        sOpt = extractModeDefaults(fx, "c1");   custom1   = (sOpt >= 0) ? sOpt : DEFAULT_C1;
-        sOpt = extractModeDefaults(fx, "c2");   custom2   = (sOpt >= 0) ? sOpt : DEFAULT_C2;
-        sOpt = extractModeDefaults(fx, "c3");   custom3   = (sOpt >= 0) ? sOpt : DEFAULT_C3;
-        sOpt = extractModeDefaults(fx, "o1");   check1    = (sOpt >= 0) ? (bool)sOpt : false;
-        sOpt = extractModeDefaults(fx, "o2");   check2    = (sOpt >= 0) ? (bool)sOpt : false;
-        sOpt = extractModeDefaults(fx, "o3");   check3    = (sOpt >= 0) ? (bool)sOpt : false;
+        sOpt = strip.getModeDefault(fx, MODE_DEF_SX);   speed     = (sOpt >= 0) ? sOpt : DEFAULT_SPEED;
+        sOpt = strip.getModeDefault(fx, MODE_DEF_IX);   intensity = (sOpt >= 0) ? sOpt : DEFAULT_INTENSITY;
+        sOpt = strip.getModeDefault(fx, MODE_DEF_C1);   custom1   = (sOpt >= 0) ? sOpt : DEFAULT_C1;
+        sOpt = strip.getModeDefault(fx, MODE_DEF_C2);   custom2   = (sOpt >= 0) ? sOpt : DEFAULT_C2;
+        sOpt = strip.getModeDefault(fx, MODE_DEF_C3);   custom3   = (sOpt >= 0) ? sOpt : DEFAULT_C3;
+        sOpt = strip.getModeDefault(fx, MODE_DEF_O1);   check1    = (sOpt >= 0) ? (bool)sOpt : false;
+        sOpt = strip.getModeDefault(fx, MODE_DEF_O2);   check2    = (sOpt >= 0) ? (bool)sOpt : false;
+        sOpt = strip.getModeDefault(fx, MODE_DEF_O3);   check3    = (sOpt >= 0) ? (bool)sOpt : false;
         if (!sliderDefaultsOnly) {
           //WLEDMM: return to old setting if not explicitly set
-          sOpt = extractModeDefaults(fx, "m12");  if (sOpt >= 0) {if (oldMap==-1) oldMap = map1D2D; map1D2D   = constrain(sOpt, 0, 7);} else {if (oldMap!=-1) map1D2D = oldMap; oldMap = -1;}
-          sOpt = extractModeDefaults(fx, "si");   if (sOpt >= 0) {if (oldSim==-1) oldSim = soundSim; soundSim  = constrain(sOpt, 0, 1);} else {if (oldSim!=-1) soundSim = oldSim; oldSim = -1;}
-          sOpt = extractModeDefaults(fx, "rev");  if (sOpt >= 0) reverse   = (bool)sOpt;
-          sOpt = extractModeDefaults(fx, "mi");   if (sOpt >= 0) mirror    = (bool)sOpt; // NOTE: setting this option is a risky business
-          sOpt = extractModeDefaults(fx, "rY");   if (sOpt >= 0) reverse_y = (bool)sOpt;
-          sOpt = extractModeDefaults(fx, "mY");   if (sOpt >= 0) mirror_y  = (bool)sOpt; // NOTE: setting this option is a risky business
-          sOpt = extractModeDefaults(fx, "pal");  if (sOpt >= 0) {if (oldPalette==-1) oldPalette = palette; setPalette(sOpt);} else {if (oldPalette!=-1) setPalette(oldPalette); oldPalette = -1;}
+          sOpt = strip.getModeDefault(fx, MODE_DEF_M12);  if (sOpt >= 0) {if (oldMap==-1) oldMap = map1D2D; map1D2D   = constrain(sOpt, 0, 7);} else {if (oldMap!=-1) map1D2D = oldMap; oldMap = -1;}
+          sOpt = strip.getModeDefault(fx, MODE_DEF_SI);   if (sOpt >= 0) {if (oldSim==-1) oldSim = soundSim; soundSim  = constrain(sOpt, 0, 1);} else {if (oldSim!=-1) soundSim = oldSim; oldSim = -1;}
+          sOpt = strip.getModeDefault(fx, MODE_DEF_REV);  if (sOpt >= 0) reverse   = (bool)sOpt;
+          sOpt = strip.getModeDefault(fx, MODE_DEF_MI);   if (sOpt >= 0) mirror    = (bool)sOpt; // NOTE: setting this option is a risky business
+          sOpt = strip.getModeDefault(fx, MODE_DEF_RY);   if (sOpt >= 0) reverse_y = (bool)sOpt;
+          sOpt = strip.getModeDefault(fx, MODE_DEF_MY);   if (sOpt >= 0) mirror_y  = (bool)sOpt; // NOTE: setting this option is a risky business
+          sOpt = strip.getModeDefault(fx, MODE_DEF_PAL);  if (sOpt >= 0) {if (oldPalette==-1) oldPalette = palette; setPalette(sOpt);} else {if (oldPalette!=-1) setPalette(oldPalette); oldPalette = -1;}
         }
       }
       /*if (!fadeTransition)*/ markForReset(); // WLEDMM quickfix for effect "double startup" bug.
@@ -1853,10 +1853,9 @@ void WS2812FX::finalizeInit(void)
   }
 
   //segments are created in makeAutoSegments();
-  DEBUG_PRINTLN(F("Loading custom palettes"));
-  loadCustomPalettes(); // (re)load all custom palettes
-  DEBUG_PRINTLN(F("Loading custom ledmaps"));
-  deserializeMap();     // (re)load default ledmap
+  // WLEDMM custom palettes and ledmap are (re)loaded from WLED::loop(), so first light at boot does not wait for the file system
+  reloadPalettes = true;
+  loadLedmap = true;
   _isServicing = false;        // WLEDMM
   suspendStripService = false; // WLEDMM ready, run !
 }
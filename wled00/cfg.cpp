@@ -22,6 +22,7 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   // String temp;
   // serializeJson(doc, temp);
   DEBUG_PRINTF("deserializeConfig\n");
+  configRevision++; // WLEDMM invalidates cached settings.js
 
   bool needsSave = false;
   //int rev_major = doc["rev"][0]; // 1
@@ -456,6 +457,9 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   JsonObject if_live_dmx = if_live[F("dmx")];
   CJSON(e131Universe, if_live_dmx[F("uni")]);
   CJSON(e131SkipOutOfSequence, if_live_dmx[F("seqskip")]);
+  CJSON(e131FrameSync, if_live_dmx[F("fsync")]);
+  CJSON(e131FrameTimeout, if_live_dmx[F("fsto")]);
+  if (e131FrameTimeout < 5 || e131FrameTimeout > 1000) e131FrameTimeout = 40;
   CJSON(DMXAddress, if_live_dmx[F("addr")]);
   if (!DMXAddress || DMXAddress > 510) DMXAddress = 1;
   CJSON(DMXSegmentSpacing, if_live_dmx[F("dss")]);
@@ -645,6 +649,24 @@ bool deserializeConfig(JsonObject doc, bool fromFS) {
   return (doc["sv"] | true);
 }
 
+// WLEDMM config load/save timing, reported in /json/info "cfgload"
+static struct {
+  uint32_t readUs;       // boot: read and parse cfg.json
+  uint32_t applyUs;      // boot: deserializeConfig()
+  uint32_t saveUs;       // last serializeConfig()
+  uint32_t apiApplyUs;   // last deserializeConfig() from /json/cfg
+} cfgStats;
+
+void serializeConfigStats(JsonObject root)
+{
+  root[F("read")]  = cfgStats.readUs;
+  root[F("apply")] = cfgStats.applyUs;
+  root[F("save")]  = cfgStats.saveUs;
+  root[F("api")]   = cfgStats.apiApplyUs;
+}
+
+void recordConfigApplyTime(uint32_t us) { cfgStats.apiApplyUs = us; }
+
 void deserializeConfigFromFS() {
   bool success = deserializeConfigSec();
   if (!success) { //if file does not exist, try reading from EEPROM
@@ -658,7 +680,9 @@ void deserializeConfigFromFS() {
 
   DEBUG_PRINTLN(F("Reading settings from /cfg.json..."));
 
+  unsigned long t0 = micros();
   success = readObjectFromFile("/cfg.json", nullptr, &doc);
+  cfgStats.readUs = micros() - t0;
   if (!success) { // if file does not exist, optionally try reading from EEPROM and then save defaults to FS
     releaseJSONBufferLock();
     #ifdef WLED_ADD_EEPROM_SUPPORT
@@ -679,13 +703,16 @@ void deserializeConfigFromFS() {
 
   // NOTE: This routine deserializes *and* applies the configuration
   //       Therefore, must also initialize ethernet from this function
+  t0 = micros();
   bool needsSave = deserializeConfig(doc.as<JsonObject>(), true);
+  cfgStats.applyUs = micros() - t0;
   releaseJSONBufferLock();
 
   if (needsSave) serializeConfig(); // usermods required new parameters
 }
 
 void serializeConfig() {
+  configRevision++; // WLEDMM
   serializeConfigSec();
 
   DEBUG_PRINTLN(F("Writing settings to /cfg.json..."));
@@ -957,6 +984,8 @@ void serializeConfig() {
   JsonObject if_live_dmx = if_live.createNestedObject("dmx");
   if_live_dmx[F("uni")] = e131Universe;
   if_live_dmx[F("seqskip")] = e131SkipOutOfSequence;
+  if_live_dmx[F("fsync")] = e131FrameSync;
+  if_live_dmx[F("fsto")] = e131FrameTimeout;
   if_live_dmx[F("e131prio")] = e131Priority;
   if_live_dmx[F("addr")] = DMXAddress;
   if_live_dmx[F("dss")] = DMXSegmentSpacing;
@@ -1107,9 +1136,11 @@ void serializeConfig() {
   //WLEDMM add USER_PRINT
   DEBUG_PRINTF("serializeConfig\n");
 
+  unsigned long t0 = micros();
   File f = WLED_FS.open("/cfg.json", "w");
   if (f) serializeJson(doc, f);
   f.close();
+  cfgStats.saveUs = micros() - t0;
   releaseJSONBufferLock();
 
   doSerializeConfig = false;
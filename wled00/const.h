@@ -451,6 +451,15 @@
   #endif
 #endif
 
+// number of packets buffered between UDP receive callbacks and the main loop (power of 2, ~1.5KB each)
+#ifndef WLED_UDP_RX_QUEUE_LEN
+  #ifdef ESP8266
+    #define WLED_UDP_RX_QUEUE_LEN 2
+  #else
+    #define WLED_UDP_RX_QUEUE_LEN 8
+  #endif
+#endif
+
 #ifndef ABL_MILLIAMPS_DEFAULT
   #define ABL_MILLIAMPS_DEFAULT 1500   // auto lower brightness to stay close to milliampere limit WLEDMM: min 1500 for 1024leds
 #else
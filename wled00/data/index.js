@@ -441,7 +441,7 @@ function presetError(empty)
 	if (hasBackup) gId('bck').value = bckstr;
 }
 
-function loadPresets(callback = null)
+function loadPresets(callback = null, retry = 0)
 {
 	// 1st boot (because there is a callback)
 	if (callback && pmt == pmtLS && pmt > 0) {
@@ -462,10 +462,17 @@ function loadPresets(callback = null)
 	})
 	.then(res => {
 		if (res.status=="404") return {"0":{}};
+		if (res.status=="503" && retry < 5) return null; // WLEDMM preset store busy, try again
 		//if (!res.ok) showErrorToast();
 		return res.json();
 	})
 	.then(json => {
+		if (!json) {
+			let cb = callback;
+			callback = null;
+			setTimeout(()=>{loadPresets(cb, retry+1);}, 250*(retry+1));
+			return;
+		}
 		pJson = json;
 		pmtLast = pmt;
 		populatePresets();
@@ -2309,7 +2316,7 @@ function toggleLiveview()
 	}
 
 	gId('buttonSr').className = (isLv) ? "active":"";
-	if (ws && ws.readyState === WebSocket.OPEN) ws.send(`{"lv":${isLv}}`);
+	if (ws && ws.readyState === WebSocket.OPEN) ws.send(`{"lv":${isLv?3:false}}`); //WLEDMM 3 = delta frames
 }
 
 //WLEDMM create and delete iFrame for peek (isLv is true if create)
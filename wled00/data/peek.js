@@ -1,3 +1,28 @@
+//WLEDMM live preview frames (see ws.cpp): v1 = 1D raw RGB, v2 = 2D raw RGB, v3 = delta/RLE against the previous frame
+var lvPx = null; // v3 frame state
+function lvDecode(d) {
+	if (d[0] != 76) return null; //'L'
+	if (d[1] == 1) return {w: (d.length-2)/3, h: 0, px: d.subarray(2)};
+	if (d[1] == 2) return {w: d[2], h: d[3], px: d.subarray(4)};
+	if (d[1] != 3) return null;
+	let w = (d[2]<<8) | d[3], h = (d[4]<<8) | d[5];
+	let n = w * Math.max(h,1) * 3;
+	if (!lvPx || lvPx.length != n) lvPx = new Uint8Array(n);
+	let p = 0, i = 7;
+	while (i < d.length) {
+		let op = d[i++], cnt = (op & 63) + 1;
+		if (cnt == 64) { cnt = 64 + ((d[i]<<8) | d[i+1]); i += 2; }
+		cnt *= 3;
+		switch (op & 192) {
+			case 0: p += cnt; break; // SKIP
+			case 64: lvPx.set(d.subarray(i, i+cnt), p); i += cnt; p += cnt; break; // LITERAL
+			case 128: for (let e = p+cnt; p < e; p += 3) lvPx.set(d.subarray(i, i+3), p); i += 3; break; // REPEAT
+			default: return null;
+		}
+	}
+	return {w: w, h: h, px: lvPx};
+}
+
 function peek(c) {
 	// Check for canvas support
 	var ctx = c.getContext('2d');
@@ -8,11 +33,11 @@ function peek(c) {
 			ws = top.window.ws;
 		} catch (e) {}
 		if (ws && ws.readyState === WebSocket.OPEN) {
-			ws.send("{'lv':true}");
+			ws.send("{'lv':3}");
 		} else {
 			ws = new WebSocket((window.location.protocol == "https:"?"wss":"ws")+"://"+document.location.host+"/ws");
 			ws.onopen = ()=>{
-				ws.send("{'lv':true}");
+				ws.send("{'lv':3}");
 			}
 		}
 		ws.binaryType = "arraybuffer";
@@ -20,13 +45,14 @@ function peek(c) {
 			// function processWSData(e) {
 			try {
 				if (toString.call(e.data) === '[object ArrayBuffer]') {
-					let leds = new Uint8Array(e.data);
-					if (leds[0] != 76 || leds[1] != 2 || !ctx) return; //'L', set in ws.cpp
-					let mW = leds[2]; // matrix width
-					let mH = leds[3]; // matrix height
+					let f = lvDecode(new Uint8Array(e.data));
+					if (!f || !f.h || !ctx) return; // 2D only
+					let leds = f.px;
+					let mW = f.w; // matrix width
+					let mH = f.h; // matrix height
 					let pPL = Math.min(c.width / mW, c.height / mH); // pixels per LED (width of circle)
 					let lOf = Math.floor((c.width - pPL*mW)/2); //left offset (to center matrix)
-					var i = 4; //same offset as in ws.cpp
+					var i = 0;
 					ctx.clearRect(0, 0, c.width, c.height); //WLEDMM
 					function colorAmp(color) {
 						if (color == 0) return 0;
@@ -0,0 +1,95 @@
+#ifndef WLED_DDP_CODEC_H
+#define WLED_DDP_CODEC_H
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Compressed realtime pixel stream, carried in DDP packets with the customer defined data type bit set
+ * (DDP_TYPE_COMPRESSED_RGB 0x8B / DDP_TYPE_COMPRESSED_RGBW 0x9B).
+ * channelOffset of the DDP header is the first pixel times channels per pixel, like uncompressed DDP.
+ * Every packet is self-contained, so a lost packet only affects the pixels it covers.
+ *
+ * payload:  [flags] [paletteSize] [palette: paletteSize * channels bytes] [ops...]
+ *   flags        bit 0: keyframe (packet covers every pixel of its range), bits 1-7 must be 0
+ *   paletteSize  0: pixel values are literal RGB(W), 1-255: pixel values are 1 byte palette indices
+ * op byte:  [2 bit opcode][6 bit count]  count 0-62 means 1-63 pixels, 63 means 64 + following 16 bit big endian value
+ *   00 SKIP     advance by count pixels (unchanged since the previous frame)
+ *   01 LITERAL  count pixel values follow
+ *   10 REPEAT   one pixel value follows, written count times
+ *   11          reserved
+ *
+ * Reference encoder and host benchmark: tools/ddp_codec.py, tools/ddp_codec_bench.cpp
+ */
+
+#define DDPZ_FLAG_KEYFRAME 0x01
+#define DDPZ_OP_SKIP       0x00
+#define DDPZ_OP_LITERAL    0x40
+#define DDPZ_OP_REPEAT     0x80
+#define DDPZ_OP_MASK       0xC0
+#define DDPZ_COUNT_MASK    0x3F
+
+// decode one packet payload, setPixel(index, r, g, b, w) is called for every pixel written
+// pixels: number of pixels that can be written (index < pixels), ops that run past it make the packet malformed
+// returns the number of pixels written, or -1 for malformed data (pixels decoded up to the error are kept)
+template<typename SetPixelFn>
+int ddpzDecode(const uint8_t* data, size_t len, uint32_t start, uint32_t pixels, uint8_t channels, SetPixelFn setPixel) {
+  if (len < 2 || (data[0] & ~DDPZ_FLAG_KEYFRAME) || channels < 3 || channels > 4 || start > pixels) return -1;
+  const uint8_t* end = data + len;
+  const uint8_t* p = data + 2;
+  const unsigned paletteSize = data[1];
+  const uint8_t* palette = p;
+  if (paletteSize) {
+    if ((size_t)(end - p) < paletteSize * channels) return -1;
+    p += paletteSize * channels;
+  }
+  const unsigned valueSize = paletteSize ? 1 : channels;
+  uint32_t pos = start;
+  int written = 0;
+
+  while (p < end) {
+    const uint8_t op = *p++;
+    uint32_t count = op & DDPZ_COUNT_MASK;
+    if (count == DDPZ_COUNT_MASK) {
+      if (end - p < 2) return -1;
+      count = 64 + ((p[0] << 8) | p[1]);
+      p += 2;
+    } else count++;
+    if (count > pixels - pos) return -1;   // past the end of the strip
+
+    switch (op & DDPZ_OP_MASK) {
+      case DDPZ_OP_SKIP:
+        pos += count;
+        break;
+      case DDPZ_OP_LITERAL:
+        if ((size_t)(end - p) < count * valueSize) return -1;
+        for (uint32_t i = 0; i < count; i++, p += valueSize) {
+          const uint8_t* c = p;
+          if (paletteSize) {
+            if (*p >= paletteSize) return -1;
+            c = palette + *p * channels;
+          }
+          setPixel(pos++, c[0], c[1], c[2], channels > 3 ? c[3] : 0);
+        }
+        written += count;
+        break;
+      case DDPZ_OP_REPEAT:
+        {
+          if ((size_t)(end - p) < valueSize) return -1;
+          const uint8_t* c = p;
+          if (paletteSize) {
+            if (*p >= paletteSize) return -1;
+            c = palette + *p * channels;
+          }
+          p += valueSize;
+          for (uint32_t i = 0; i < count; i++) setPixel(pos++, c[0], c[1], c[2], channels > 3 ? c[3] : 0);
+          written += count;
+        }
+        break;
+      default:
+        return -1;
+    }
+  }
+  return written;
+}
+
+#endif
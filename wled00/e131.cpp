@@ -1,13 +1,205 @@
 #include "wled.h"
+#include "ddp_codec.h"
 
 #define MAX_3_CH_LEDS_PER_UNIVERSE 170
 #define MAX_4_CH_LEDS_PER_UNIVERSE 128
 #define MAX_CHANNELS_PER_UNIVERSE 512
 
+#define ARTSYNC_TIMEOUT 4000 // Art-Net 4: revert to non-synchronous output if no ArtSync was received for 4 seconds
+
 /*
  * E1.31 handler
  */
 
+// number of consecutive universes (starting at e131Universe) used by the current DMX mode
+static uint16_t getDMXUniverseCount() {
+  switch (DMXMode) {
+    case DMX_MODE_DISABLED:
+      return 0;
+
+    case DMX_MODE_SINGLE_RGB:
+    case DMX_MODE_SINGLE_DRGB:
+    case DMX_MODE_PRESET:
+    case DMX_MODE_EFFECT:
+    case DMX_MODE_EFFECT_W:
+    case DMX_MODE_EFFECT_SEGMENT:
+    case DMX_MODE_EFFECT_SEGMENT_W:
+      return 1;  // 1 universe is enough
+
+    case DMX_MODE_MULTIPLE_DRGB:
+    case DMX_MODE_MULTIPLE_RGB:
+    case DMX_MODE_MULTIPLE_RGBW:
+      {
+        bool is4Chan = (DMXMode == DMX_MODE_MULTIPLE_RGBW);
+        const uint16_t dmxChannelsPerLed = is4Chan ? 4 : 3;
+        const uint16_t dimmerOffset = (DMXMode == DMX_MODE_MULTIPLE_DRGB) ? 1 : 0;
+        const uint16_t dmxLenOffset = (DMXAddress == 0) ? 0 : 1; // For legacy DMX start address 0
+        const uint16_t ledsInFirstUniverse = (((MAX_CHANNELS_PER_UNIVERSE - DMXAddress) + dmxLenOffset) - dimmerOffset) / dmxChannelsPerLed;
+        const uint16_t totalLen = strip.getLengthTotal();
+        uint16_t count = 1;
+
+        if (totalLen > ledsInFirstUniverse) {
+          const uint16_t ledsPerUniverse = is4Chan ? MAX_4_CH_LEDS_PER_UNIVERSE : MAX_3_CH_LEDS_PER_UNIVERSE;
+          const uint16_t remainLED = totalLen - ledsInFirstUniverse;
+
+          count += (remainLED / ledsPerUniverse);
+
+          if ((remainLED % ledsPerUniverse) > 0) {
+            count++;
+          }
+
+          if (count > E131_MAX_UNIVERSE_COUNT) {
+            count = E131_MAX_UNIVERSE_COUNT;
+          }
+        }
+        return count;
+      }
+
+    default:
+      DEBUG_PRINTLN(F("unknown E1.31 DMX mode"));
+      return 0;  // nothing to do
+  }
+}
+
+/*
+ * Frame assembler for multi-universe DMX modes
+ * Universes belonging to one frame are buffered and applied together, so the strip never shows a frame
+ * where only some universes have been updated. A frame is committed when
+ *  - all configured universes were received (no sync source active),
+ *  - an ArtSync / E1.31 sync packet arrives (sync source active, Art-Net 4 & E1.31-2016),
+ *  - a universe of the next frame arrives (previous frame is shown partially, or dropped if a sync source is active),
+ *  - e131FrameTimeout ms passed since the first universe of the frame arrived.
+ * Sequence numbers are only used as frame key once the sender proved to use one sequence number for all universes of a frame.
+ */
+#if E131_MAX_UNIVERSE_COUNT > 32
+  #error "E1.31 frame assembler supports up to 32 universes"
+#endif
+
+static struct {
+  uint8_t* data = nullptr;                       // E131_MAX_UNIVERSE_COUNT slots of MAX_CHANNELS_PER_UNIVERSE+1 bytes
+  uint16_t channels[E131_MAX_UNIVERSE_COUNT] = {0};
+  uint32_t received = 0;                         // bitmap of universes received for the pending frame
+  unsigned long frameStart = 0;                  // arrival of the first universe of the pending frame
+  unsigned long lastSync = 0;                    // arrival of the last sync packet (0 = no sync source seen)
+  uint16_t syncUniverse = 0;                     // E1.31 synchronization universe announced by the sender
+  uint8_t seq = 0;                               // sequence number of the pending frame
+  uint8_t mde = REALTIME_MODE_E131;
+  bool seqMismatch = false;                      // universes of the pending frame carry different sequence numbers
+  bool seqIsFrameKey = false;                    // sender uses one sequence number per frame
+} dmxFrame;
+
+// the network task (assembleDMXFrame(), handleDMXSync()) and the main loop (handleE131FrameTimeout()) both commit frames
+#ifdef ARDUINO_ARCH_ESP32
+static SemaphoreHandle_t dmxFrameMux = xSemaphoreCreateMutex();
+#define DMXFrameLock()   xSemaphoreTake(dmxFrameMux, portMAX_DELAY)
+#define DMXFrameUnlock() xSemaphoreGive(dmxFrameMux)
+#else
+// ESP8266: network callbacks never run while loop() is running
+#define DMXFrameLock()
+#define DMXFrameUnlock()
+#endif
+
+static inline bool isMultiUniverseMode() {
+  return DMXMode == DMX_MODE_MULTIPLE_RGB || DMXMode == DMX_MODE_MULTIPLE_DRGB || DMXMode == DMX_MODE_MULTIPLE_RGBW;
+}
+
+static inline bool dmxSyncActive() {
+  return dmxFrame.lastSync && (millis() - dmxFrame.lastSync < ARTSYNC_TIMEOUT);
+}
+
+// apply all buffered universes of the pending frame at once
+static void commitDMXFrame() {
+  const uint32_t received = dmxFrame.received;
+  if (!received) return;
+  const uint16_t universes = getDMXUniverseCount();
+  const uint32_t complete = (universes >= 32) ? UINT32_MAX : ((1U << universes) - 1);
+
+  for (unsigned i = 0; i < E131_MAX_UNIVERSE_COUNT; i++) {
+    if (!(received & (1U << i))) continue;
+    handleDMXData(e131Universe + i, dmxFrame.channels[i], dmxFrame.data + i * (MAX_CHANNELS_PER_UNIVERSE+1), dmxFrame.mde, i);
+  }
+  if ((received & complete) == complete) e131FramesComplete++;
+  else                                   e131FramesPartial++;
+  dmxFrame.received = 0;
+  dmxFrame.seqIsFrameKey = !dmxFrame.seqMismatch;
+}
+
+static void dropDMXFrame() {
+  if (!dmxFrame.received) return;
+  e131FramesDropped++;
+  dmxFrame.received = 0;
+}
+
+// buffer one universe; returns false if the universe should be applied immediately instead
+static bool assembleDMXFrame(uint16_t dmxChannels, uint8_t* e131_data, uint8_t mde, uint8_t previousUniverses, uint8_t seq) {
+  if (!dmxFrame.data) {
+    #if defined(ARDUINO_ARCH_ESP32) && defined(BOARD_HAS_PSRAM)
+    if (psramFound()) dmxFrame.data = (uint8_t*) ps_malloc(E131_MAX_UNIVERSE_COUNT * (MAX_CHANNELS_PER_UNIVERSE+1));
+    else
+    #endif
+    dmxFrame.data = (uint8_t*) malloc(E131_MAX_UNIVERSE_COUNT * (MAX_CHANNELS_PER_UNIVERSE+1));
+    if (!dmxFrame.data) {
+      DEBUG_PRINTLN(F("E1.31 frame assembler: not enough memory."));
+      return false;
+    }
+  }
+  DMXFrameLock();
+  const uint32_t bit = 1U << previousUniverses;
+  const bool syncActive = dmxSyncActive();
+  if (dmxFrame.received) {
+    bool nextFrame = (dmxFrame.received & bit) || (dmxFrame.seqIsFrameKey && seq != dmxFrame.seq) || (mde != dmxFrame.mde);
+    if (nextFrame) {
+      if (syncActive) dropDMXFrame();  // the sync for this frame never arrived
+      else            commitDMXFrame();
+    } else if (seq != dmxFrame.seq) {
+      dmxFrame.seqMismatch = true;
+    }
+  }
+  if (!dmxFrame.received) {
+    dmxFrame.frameStart = millis();
+    dmxFrame.seq = seq;
+    dmxFrame.mde = mde;
+    dmxFrame.seqMismatch = false;
+  }
+
+  const uint16_t channels = min(dmxChannels, (uint16_t)MAX_CHANNELS_PER_UNIVERSE);
+  const uint16_t startCode = (mde == REALTIME_MODE_E131) ? 1 : 0;  // E1.31 data includes the start code, Art-Net data does not
+  memcpy(dmxFrame.data + previousUniverses * (MAX_CHANNELS_PER_UNIVERSE+1), e131_data, channels + startCode);
+  dmxFrame.channels[previousUniverses] = channels;
+  dmxFrame.received |= bit;
+
+  if (!syncActive) {
+    const uint16_t universes = getDMXUniverseCount();
+    const uint32_t complete = (universes >= 32) ? UINT32_MAX : ((1U << universes) - 1);
+    if ((dmxFrame.received & complete) == complete) commitDMXFrame();
+  }
+  DMXFrameUnlock();
+  return true;
+}
+
+// ArtSync or E1.31 synchronization packet received: show the pending frame
+static void handleDMXSync(IPAddress clientIP, uint16_t syncUniverse) {
+  if (!e131FrameSync || !isMultiUniverseMode()) return;
+  if (realtimeIP[0] != 0 && !(clientIP == realtimeIP)) return; // Art-Net 4: ignore ArtSync from other controllers
+  if (syncUniverse && dmxFrame.syncUniverse && syncUniverse != dmxFrame.syncUniverse) return;
+  DMXFrameLock();
+  dmxFrame.lastSync = millis();
+  commitDMXFrame();
+  DMXFrameUnlock();
+}
+
+// called from main loop: show partial frames when universes (or the sync packet) went missing
+void handleE131FrameTimeout() {
+  if (!e131FrameSync || !dmxFrame.received || (millis() - dmxFrame.frameStart < e131FrameTimeout)) return;
+  DMXFrameLock();  // check again, the network task may have committed the frame meanwhile
+  if (dmxFrame.received && (millis() - dmxFrame.frameStart >= e131FrameTimeout)) commitDMXFrame();
+  DMXFrameUnlock();
+}
+
+bool getE131FrameSyncActive() {
+  return e131FrameSync && dmxSyncActive();
+}
+
 //DDP protocol support, called by handleE131Packet
 //handles RGB data only
 void handleDDPPacket(e131_packet_t* p) {
@@ -37,9 +229,17 @@ void handleDDPPacket(e131_packet_t* p) {
   realtimeLock(realtimeTimeoutMs, REALTIME_MODE_DDP);
 
   if (!realtimeOverride || (realtimeMode && useMainSegmentOnly)) {
-    for (uint16_t i = start; i < stop; i++) {
-      setRealtimePixel(i, data[c], data[c+1], data[c+2], ddpChannelsPerLed >3 ? data[c+3] : 0);
-      c += ddpChannelsPerLed;
+    if (p->dataType & DDP_TYPE_CUSTOM) {
+      // compressed stream: only changed pixel runs / RLE keyframes, pixels not covered keep their previous value
+      if ((p->dataType & ~0b00111000) != (DDP_TYPE_COMPRESSED_RGB & ~0b00111000)) return; // unknown customer defined type
+      if (ddpzDecode(data + c, htons(p->dataLen), start, strip.getLengthTotal(), ddpChannelsPerLed, setRealtimePixel) < 0) {
+        DEBUG_PRINTLN(F("DDP: malformed compressed packet."));
+      }
+    } else {
+      for (uint16_t i = start; i < stop; i++) {
+        setRealtimePixel(i, data[c], data[c+1], data[c+2], ddpChannelsPerLed >3 ? data[c+3] : 0);
+        c += ddpChannelsPerLed;
+      }
     }
   }
 
@@ -58,7 +258,13 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
   uint8_t* e131_data = nullptr;
   uint8_t seq = 0, mde = REALTIME_MODE_E131;
 
-  if (protocol == P_ARTNET)
+  if (protocol == P_ARTNET_SYNC) {
+    handleDMXSync(clientIP, 0);
+    return;
+  } else if (protocol == P_E131_SYNC) {
+    handleDMXSync(clientIP, htons(p->sync_universe));
+    return;
+  } else if (protocol == P_ARTNET)
   {
     if (p->art_opcode == ARTNET_OPCODE_OPPOLL) {
       handleArtnetPollReply(clientIP);
@@ -111,6 +317,17 @@ void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol){
   // update status info
   realtimeIP = clientIP;
 
+  if (e131FrameSync && isMultiUniverseMode()) {
+    if (protocol == P_E131) {
+      uint16_t syncUniverse = htons(p->sync_address);
+      if (syncUniverse) {
+        dmxFrame.syncUniverse = syncUniverse;
+        if (!dmxFrame.lastSync) dmxFrame.lastSync = millis(); // sender announced synchronization, wait for its sync packets
+      }
+    }
+    if (assembleDMXFrame(dmxChannels, e131_data, mde, previousUniverses, seq)) return;
+  }
+
   handleDMXData(uni, dmxChannels, e131_data, mde, previousUniverses);
 }
 
@@ -345,55 +562,11 @@ void handleArtnetPollReply(IPAddress ipAddress) {
   ArtPollReply artnetPollReply;
   prepareArtnetPollReply(&artnetPollReply);
 
-  uint16_t startUniverse = e131Universe;
-  uint16_t endUniverse = e131Universe;
-
-  switch (DMXMode) {
-    case DMX_MODE_DISABLED:
-      return;  // nothing to do
-      break;
-
-    case DMX_MODE_SINGLE_RGB:
-    case DMX_MODE_SINGLE_DRGB:
-    case DMX_MODE_PRESET:
-    case DMX_MODE_EFFECT:
-    case DMX_MODE_EFFECT_W:
-    case DMX_MODE_EFFECT_SEGMENT:
-    case DMX_MODE_EFFECT_SEGMENT_W:
-      break;  // 1 universe is enough
+  uint16_t universes = getDMXUniverseCount();
+  if (universes == 0) return;  // nothing to do
 
-    case DMX_MODE_MULTIPLE_DRGB:
-    case DMX_MODE_MULTIPLE_RGB:
-    case DMX_MODE_MULTIPLE_RGBW:
-      {
-        bool is4Chan = (DMXMode == DMX_MODE_MULTIPLE_RGBW);
-        const uint16_t dmxChannelsPerLed = is4Chan ? 4 : 3;
-        const uint16_t dimmerOffset = (DMXMode == DMX_MODE_MULTIPLE_DRGB) ? 1 : 0;
-        const uint16_t dmxLenOffset = (DMXAddress == 0) ? 0 : 1; // For legacy DMX start address 0
-        const uint16_t ledsInFirstUniverse = (((MAX_CHANNELS_PER_UNIVERSE - DMXAddress) + dmxLenOffset) - dimmerOffset) / dmxChannelsPerLed;
-        const uint16_t totalLen = strip.getLengthTotal();
-
-        if (totalLen > ledsInFirstUniverse) {
-          const uint16_t ledsPerUniverse = is4Chan ? MAX_4_CH_LEDS_PER_UNIVERSE : MAX_3_CH_LEDS_PER_UNIVERSE;
-          const uint16_t remainLED = totalLen - ledsInFirstUniverse;
-
-          endUniverse += (remainLED / ledsPerUniverse);
-
-          if ((remainLED % ledsPerUniverse) > 0) {
-            endUniverse++;
-          }
-
-          if ((endUniverse - startUniverse) > E131_MAX_UNIVERSE_COUNT) {
-            endUniverse = startUniverse + E131_MAX_UNIVERSE_COUNT - 1;
-          }
-        }
-        break;
-      }
-    default:
-      DEBUG_PRINTLN(F("unknown E1.31 DMX mode"));
-      return;  // nothing to do
-      break;
-  }
+  uint16_t startUniverse = e131Universe;
+  uint16_t endUniverse = e131Universe + universes - 1;
 
   for (uint16_t i = startUniverse; i <= endUniverse; ++i) {
     sendArtnetPollReply(&artnetPollReply, ipAddress, i);
@@ -532,9 +705,7 @@ void sendArtnetPollReply(ArtPollReply *reply, IPAddress ipAddress, uint16_t port
     pollReplyCount = 0;
   }
 
-  notifierUdp.beginPacket(ipAddress, ARTNET_DEFAULT_PORT);
-  notifierUdp.write(reply->raw, sizeof(ArtPollReply));
-  notifierUdp.endPacket();
+  notifierUdp.writeTo(reply->raw, sizeof(ArtPollReply), ipAddress, ARTNET_DEFAULT_PORT);
 
   reply->reply_bind_index++;
 }
@@ -26,6 +26,8 @@ bool deserializeConfig(JsonObject doc, bool fromFS = false);
 void deserializeConfigFromFS();
 bool deserializeConfigSec();
 void serializeConfig();
+void serializeConfigStats(JsonObject root); // WLEDMM
+void recordConfigApplyTime(uint32_t us);    // WLEDMM
 void serializeConfigSec();
 
 template<typename DestType>
@@ -82,6 +84,8 @@ void handleDMXInput();
 //e131.cpp
 void handleE131Packet(e131_packet_t* p, IPAddress clientIP, byte protocol);
 void handleDMXData(uint16_t uni, uint16_t dmxChannels, uint8_t* e131_data, uint8_t mde, uint8_t previousUniverses);
+void handleE131FrameTimeout();
+bool getE131FrameSyncActive();
 void handleArtnetPollReply(IPAddress ipAddress);
 void prepareArtnetPollReply(ArtPollReply* reply);
 void sendArtnetPollReply(ArtPollReply* reply, IPAddress ipAddress, uint16_t portAddress);
@@ -95,6 +99,12 @@ bool readObjectFromFile(const char* file, const char* key, JsonDocument* dest);
 void updateFSInfo();
 void closeFile();
 void invalidateFileNameCache();   // WLEDMM call when new files were uploaded
+void initPresetIndex();           // WLEDMM
+void invalidatePresetIndex();     // WLEDMM
+bool presetLogPending();          // WLEDMM preset changes not yet merged into presets.json
+size_t presetLogBytes();          // WLEDMM
+void discardPresetLog();          // WLEDMM presets.json was replaced
+void handlePresetLog();           // WLEDMM
 
 //hue.cpp
 void handleHue();
@@ -144,6 +154,13 @@ void handleIR();
 #include "src/dependencies/json/AsyncJson-v6.h"
 #include "FX.h"
 
+bool setSegmentName(Segment& seg, const char* name);   // WLEDMM shared with compiled presets
+void setSegmentGeometry(Segment& seg, bool newSeg, uint16_t start, int stop, uint16_t startY, uint16_t stopY,
+                        uint16_t grp, uint16_t spc, int offset, uint8_t soundSim, uint8_t map1D2D, uint8_t set);
+bool colorFromJson(JsonVariant col, uint32_t& color);
+void setSegmentColors(Segment& seg, const uint32_t* col, uint8_t valid);
+void setSegmentOrientation(Segment& seg, bool sel, bool rev, bool mi, bool rY, bool mY, bool tp);
+void finishSegmentUpdate(Segment& seg, Segment& prev);
 bool deserializeSegment(JsonObject elem, byte it, byte presetId = 0);
 bool deserializeState(JsonObject root, byte callMode = CALL_MODE_DIRECT_CHANGE, byte presetId = 0);
 void serializeSegment(JsonObject& root, Segment& seg, byte id, bool forPreset = false, bool segmentBounds = true);
@@ -217,6 +234,8 @@ void unloadPlaylist();
 int16_t loadPlaylist(JsonObject playlistObject, byte presetId = 0);
 void handlePlaylist();
 void serializePlaylist(JsonObject obj);
+void playlistPresetApplied(byte preset); // WLEDMM
+void serializePlaylistStats(JsonObject root); // WLEDMM
 
 //presets.cpp
 bool presetsSavePending(void);    // WLEDMM true if presetToSave, playlistSave or saveLedmap
@@ -231,6 +250,15 @@ inline void saveTemporaryPreset() {savePreset(255);};
 void deletePreset(byte index);
 bool getPresetName(byte index, String& name);
 
+//presets_bin.cpp
+void invalidateCompiledPresets();                    // WLEDMM call when presets.json changes
+void compilePreset(byte index, JsonObject fdo);      // WLEDMM
+bool isPresetCompiled(byte index);
+bool applyCompiledPreset(byte index, bool& changePreset);
+bool prefetchPreset(byte index);
+void recordPresetJsonTime(unsigned long us);
+void serializePresetBinStats(JsonObject root);
+
 //remote.cpp
 void handleRemote();
 
@@ -244,6 +272,9 @@ void notify(byte callMode, bool followUp=false);
 uint8_t realtimeBroadcast(uint8_t type, IPAddress client, uint16_t length, uint8_t *buffer, uint8_t bri=255, bool isRGBW=false, uint8_t artnet_outouts=1, uint16_t artnet_leds_per_output=1, uint8_t artnet_fps_limit=1);
 void realtimeLock(uint32_t timeoutMs, byte md = REALTIME_MODE_GENERIC);
 void exitRealtime();
+void initUdpReceivers(bool withRgb, bool withSupp);
+uint8_t getUdpRxQueueDepth();
+void flushUdpRxQueue();
 void handleNotifications();
 void setRealtimePixel(uint16_t i, byte r, byte g, byte b, byte w);
 void refreshNodeList();
@@ -368,15 +399,31 @@ bool updateVal(const char* req, const char* key, byte* val, byte minv=0, byte ma
 void oappendUseDeflate(bool OnOff); // enable / disable string squeezing
 bool oappend(const char* txt); // append new c string to temp buffer efficiently
 bool oappendi(int i);          // append new number to temp buffer efficiently
+struct OappendBlock;           // WLEDMM oappend() output collected in a list of small blocks
+bool oappendBegin();           // WLEDMM send following oappend() output to blocks instead of obuf
+OappendBlock* oappendEnd(bool &complete); // WLEDMM stop collecting, returns blocks (free with oappendFree())
+size_t oappendRead(const OappendBlock* blocks, uint8_t* buf, size_t maxLen, size_t index);
+void oappendFree(OappendBlock* blocks);
 void sappend(char stype, const char* key, int val);
 void sappends(char stype, const char* key, char* val);
 void prepareHostname(char* hostname);
 bool isAsterisksOnly(const char* str, byte maxLen)  __attribute__((pure));
 bool requestJSONBufferLock(uint8_t module=255);
 void releaseJSONBufferLock();
+bool tryRequestJSONBufferLock(uint8_t module=255);        // WLEDMM
+JsonDocument* requestJSONArena(uint8_t module=255);       // WLEDMM
+void serializedJSONArena(JsonDocument* arena);            // WLEDMM
+void releaseJSONArena(JsonDocument* arena);               // WLEDMM
+DeserializationError validateJsonCommand(const uint8_t* data, size_t len, bool& verbose); // WLEDMM
+bool queueJsonCommand(const uint8_t* data, size_t len, uint32_t wsClient = 0); // WLEDMM
+void handleQueuedJson();                                  // WLEDMM
+void serializeJSONLockStats(JsonObject root);             // WLEDMM
 uint8_t extractModeName(uint8_t mode, const char *src, char *dest, uint8_t maxLen);
 uint8_t extractModeSlider(uint8_t mode, uint8_t slider, char *dest, uint8_t maxLen, uint8_t *var = nullptr);
 int16_t extractModeDefaults(uint8_t mode, const char *segVar);
+void serializeModeMetaStats(JsonObject root);
+void bootMark(const char* phase); // WLEDMM boot profiler, phase is a PSTR
+void serializeBootProfile(JsonObject root);
 void checkSettingsPIN(const char *pin);
 uint16_t  __attribute__((pure)) crc16(const unsigned char* data_p, size_t length);   // WLEDMM: added attribute pure
 
@@ -472,6 +519,7 @@ void serveSettingsJS(AsyncWebServerRequest* request);
 void handleWs();
 void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data, size_t len);
 void sendDataWs(AsyncWebSocketClient * client = nullptr);
+bool handleWsJson(AsyncWebSocketClient * client, uint8_t* data, size_t len, bool queued); // WLEDMM
 
 //xml.cpp
 void XML_response(AsyncWebServerRequest *request, char* dest = nullptr);
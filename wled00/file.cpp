@@ -8,6 +8,7 @@
 #if WLED_FS != LITTLEFS && ESP_IDF_VERSION_MAJOR < 4
   #include "esp_spiffs.h"
 #endif
+#include <memory>
 #endif
 
 //WLEDMM seems that 256 is indeed the optimal buffer length
@@ -33,6 +34,536 @@ static volatile size_t knownLargestSpace = MAX_SPACE;
 
 static File f; // don't export to other cpp files
 
+/*
+ * WLEDMM preset index: id -> (offset, length) of each preset object in presets.json, so reading or replacing a preset
+ * is a single seek instead of scanning the file with bufferedFind(). Built at boot (initPresetIndex()) or on first use,
+ * updated by writeObjectToFile(), rebuilt when the file size no longer matches (upload, edit, external changes).
+ */
+#define PRESET_INDEX_SIZE 251            // ids 0-250, the temporary preset 255 lives in tmp.json
+#define PRESET_INDEX_READ_MAX 8192       // presets up to this size are read in one piece
+static uint32_t* presetIdxOffset = nullptr; // position of the opening '{', 0 = no such preset
+static uint16_t* presetIdxLength = nullptr; // length including the closing '}', 0 = too long for the index (use bufferedFind)
+static size_t presetIdxFileSize = 0;
+static bool presetIdxValid = false;
+static bool presetIdxWriting = false;       // writeObjectToFile() is updating presets.json through the index
+static bool presetIdxDirty = false;         // file size must be taken again once the file is closed
+static bool presetCacheStale = false;       // presets.json was replaced behind the back of getPresetCache()
+
+static bool isPresetsFile(const char* file) {
+  return file && strcmp_P(file, PSTR("/presets.json")) == 0;
+}
+
+static int presetIdFromKey(const char* key) {  // key is "<id>":
+  if (!key || key[0] != '"' || !isdigit(key[1])) return -1;
+  int id = atoi(key+1);
+  return (id < PRESET_INDEX_SIZE) ? id : -1;
+}
+
+static void setPresetIndex(const char* key, size_t offset, size_t len) {
+  if (!presetIdxWriting) return;
+  int id = presetIdFromKey(key);
+  if (id < 0) return;
+  presetIdxOffset[id] = offset;
+  presetIdxLength[id] = (len <= UINT16_MAX) ? len : 0;
+  presetIdxDirty = true;
+}
+
+void invalidatePresetIndex() {
+  presetIdxValid = false;
+}
+
+// scans the root object of presets.json once, keeping track of strings so braces inside names do not count
+static bool buildPresetIndex(File& file) {
+  unsigned long t0 = micros();
+  if (!presetIdxOffset) {
+    presetIdxOffset = (uint32_t*) malloc(PRESET_INDEX_SIZE * sizeof(uint32_t));
+    presetIdxLength = (uint16_t*) malloc(PRESET_INDEX_SIZE * sizeof(uint16_t));
+    if (!presetIdxOffset || !presetIdxLength) {
+      free(presetIdxOffset); presetIdxOffset = nullptr;
+      free(presetIdxLength); presetIdxLength = nullptr;
+      return false;
+    }
+  }
+  memset(presetIdxOffset, 0, PRESET_INDEX_SIZE * sizeof(uint32_t));
+  memset(presetIdxLength, 0, PRESET_INDEX_SIZE * sizeof(uint16_t));
+
+  byte buf[FS_BUFSIZE];
+  size_t pos = 0, objStart = 0;
+  unsigned depth = 0, count = 0;
+  bool inString = false, escape = false, inKey = false, expectValue = false;
+  int key = -1, objKey = -1;
+  file.seek(0);
+  while (file.available()) {
+    size_t len = file.read(buf, FS_BUFSIZE);
+    for (size_t i = 0; i < len; i++, pos++) {
+      const char c = buf[i];
+      if (inString) {
+        if (escape) escape = false;
+        else if (c == '\\') escape = true;
+        else if (c == '"') inString = inKey = false;
+        else if (inKey) key = (isdigit(c) && key >= 0 && key < 1000) ? key*10 + (c - '0') : 1000;
+        continue;
+      }
+      switch (c) {
+        case '"':
+          inString = true;
+          if (depth == 1 && !expectValue) { inKey = true; key = 0; }
+          break;
+        case ':':
+          if (depth == 1) expectValue = true;
+          break;
+        case ',':
+          if (depth == 1) expectValue = false;
+          break;
+        case '{': case '[':
+          if (++depth == 2 && expectValue && c == '{') { objStart = pos; objKey = key; }
+          break;
+        case '}': case ']':
+          if (depth == 2 && objKey >= 0 && objKey < PRESET_INDEX_SIZE && objStart) {
+            presetIdxOffset[objKey] = objStart;
+            presetIdxLength[objKey] = (pos - objStart + 1 <= UINT16_MAX) ? pos - objStart + 1 : 0;
+            count++;
+          }
+          if (depth == 2) objKey = -1;
+          if (depth) depth--;
+          break;
+      }
+    }
+  }
+  presetIdxFileSize = file.size();
+  presetIdxValid = true;
+  DEBUG_PRINTF("Preset index: %u presets in %u bytes, built in %lu us.\n", count, presetIdxFileSize, micros() - t0);
+  return true;
+}
+
+static bool presetIndexReady(File& file) {
+  if (presetIdxValid && presetIdxOffset && file.size() == presetIdxFileSize) return true;
+  return buildPresetIndex(file);
+}
+
+#if defined(ARDUINO_ARCH_ESP32) && !defined(WLED_DISABLE_PRESET_LOG)
+/*
+ * WLEDMM preset log: saving or deleting a preset appends one record to presets.log instead of rewriting presets.json,
+ * so every save is a single append and a power cut can at most lose the record being written (its CRC will not match).
+ * record: [0xA5] [crc16 of id, length and payload, LE] [id] [payload length, LE, 0 = deleted] [payload: preset JSON]
+ * The newest record of an id wins. handlePresetLog() merges the log into presets.json in small steps once saving has
+ * been idle for a while; until then /presets.json is served as a merged view so UI and backups see the current presets.
+ */
+#define WLED_PRESET_LOG
+#define PRESET_LOG_FILE         "/presets.log"
+#define PRESET_LOG_TMP          "/presets.tmp"
+#define PRESET_LOG_MAGIC        0xA5
+#define PRESET_LOG_HEADER       6
+#define PRESET_LOG_COMPACT_IDLE 30000  // ms without saves before the log is merged
+#define PRESET_LOG_COMPACT_SIZE 16384  // merge sooner once the log is this large
+#define PRESET_LOG_STEP_BYTES   1024   // preset bytes copied per compaction step
+
+static uint32_t* presetLogOffset = nullptr;  // payload position of the newest record per id, 0 = not in the log
+static uint16_t* presetLogLength = nullptr;  // payload length, 0 = deleted
+static size_t presetLogSize = 0;             // end of the last valid record
+static unsigned long presetLogTime = 0;      // last append (or failed compaction attempt)
+static unsigned long compactBackoff = 1000;  // retry delay for urgent compaction
+static bool presetLogDamaged = false;        // the log ends with a torn record, merge before appending again
+static volatile bool presetLogCompactNow = false;
+static volatile bool presetLogDiscard = false;  // presets.json was replaced by an upload
+static int compactId = -1;                   // next id to copy while compaction runs, -1 = idle
+static size_t compactLogSize = 0;            // log size when compaction started
+static unsigned long compactStart = 0;
+static File compactFile;
+static uint32_t* compactIdxOffset = nullptr; // preset index of the merged file, installed once it replaces presets.json
+static uint16_t* compactIdxLength = nullptr;
+static SemaphoreHandle_t presetStoreMux = xSemaphoreCreateMutex(); // between loop() and the web server task
+
+static bool lockPresetStore(unsigned long timeout) {
+  return xSemaphoreTake(presetStoreMux, pdMS_TO_TICKS(timeout)) == pdTRUE;
+}
+
+static void unlockPresetStore() {
+  xSemaphoreGive(presetStoreMux);
+}
+
+static bool allocPresetLogIndex() {
+  if (presetLogOffset) return true;
+  presetLogOffset = (uint32_t*) calloc(PRESET_INDEX_SIZE, sizeof(uint32_t));
+  presetLogLength = (uint16_t*) calloc(PRESET_INDEX_SIZE, sizeof(uint16_t));
+  if (presetLogOffset && presetLogLength) return true;
+  free(presetLogOffset); presetLogOffset = nullptr;
+  free(presetLogLength); presetLogLength = nullptr;
+  return false;
+}
+
+static void resetPresetLog() {
+  if (presetLogOffset) memset(presetLogOffset, 0, PRESET_INDEX_SIZE * sizeof(uint32_t));
+  if (presetLogLength) memset(presetLogLength, 0, PRESET_INDEX_SIZE * sizeof(uint16_t));
+  presetLogSize = 0;
+  presetLogDamaged = false;
+  presetLogCompactNow = false;
+}
+
+bool presetLogPending() {
+  return presetLogSize > 0 || presetLogDamaged;
+}
+
+size_t presetLogBytes() {
+  return presetLogSize;
+}
+
+void discardPresetLog() {
+  presetLogDiscard = true; // may be called from the web server task, loop() does the work
+}
+
+static void abortCompaction() {
+  compactFile.close();
+  WLED_FS.remove(PRESET_LOG_TMP);
+  free(compactIdxOffset); compactIdxOffset = nullptr;
+  free(compactIdxLength); compactIdxLength = nullptr;
+  compactId = -1;
+}
+
+static void applyPresetLogDiscard() {
+  if (!presetLogDiscard || !lockPresetStore(250)) return;
+  if (doCloseFile) closeFile();
+  if (compactId >= 0) abortCompaction();
+  WLED_FS.remove(PRESET_LOG_FILE);
+  resetPresetLog();
+  presetLogDiscard = false;
+  unlockPresetStore();
+  DEBUG_PRINTLN(F("Preset log discarded."));
+}
+
+// reads all records, stops at the first one that is incomplete or fails its CRC
+static void replayPresetLog() {
+  File lf = WLED_FS.open(PRESET_LOG_FILE, "r");
+  if (!lf) return;
+  if (!allocPresetLogIndex()) { lf.close(); return; }
+  unsigned long t0 = micros();
+  const size_t size = lf.size();
+  size_t pos = 0;
+  unsigned count = 0;
+  uint8_t head[PRESET_LOG_HEADER];
+  uint8_t* rec = nullptr;  // id, length and payload, contiguous for crc16()
+  size_t recSize = 0;
+  while (pos + PRESET_LOG_HEADER <= size) {
+    if (lf.read(head, PRESET_LOG_HEADER) != PRESET_LOG_HEADER || head[0] != PRESET_LOG_MAGIC) break;
+    const uint8_t id = head[3];
+    const size_t len = head[4] | (head[5] << 8);
+    if (id >= PRESET_INDEX_SIZE || pos + PRESET_LOG_HEADER + len > size) break;
+    if (recSize < len + 3) {
+      free(rec);
+      rec = (uint8_t*) malloc(len + 3);
+      recSize = rec ? len + 3 : 0;
+      if (!rec) break;
+    }
+    memcpy(rec, head + 3, 3);
+    if (lf.read(rec + 3, len) != len) break;
+    if (crc16(rec, len + 3) != (head[1] | (head[2] << 8))) break;
+    presetLogOffset[id] = pos + PRESET_LOG_HEADER;
+    presetLogLength[id] = len;
+    pos += PRESET_LOG_HEADER + len;
+    count++;
+  }
+  free(rec);
+  presetLogSize = pos;
+  presetLogDamaged = (pos < size);
+  lf.close();
+  if (presetLogDamaged) USER_PRINTF("Preset log: damaged record at %u ignored.\n", (unsigned)pos);
+  DEBUG_PRINTF("Preset log: %u records in %u bytes, replayed in %lu us.\n", count, (unsigned)pos, micros() - t0);
+}
+
+static bool appendPresetLog(uint8_t id, JsonDocument* content, size_t len) {
+  applyPresetLogDiscard();
+  if (!allocPresetLogIndex() || len > UINT16_MAX) return false;
+  uint8_t* rec = (uint8_t*) malloc(PRESET_LOG_HEADER + len + 1); // serializeJson() adds a terminating 0
+  if (!rec) return false;
+  rec[0] = PRESET_LOG_MAGIC;
+  rec[3] = id;
+  rec[4] = len & 0xFF;
+  rec[5] = len >> 8;
+  if (len) serializeJson(*content, (char*)rec + PRESET_LOG_HEADER, len + 1);
+  const uint16_t crc = crc16(rec + 3, len + 3);
+  rec[1] = crc & 0xFF;
+  rec[2] = crc >> 8;
+
+  bool ok = false;
+  if (lockPresetStore(250)) {
+    if (doCloseFile) closeFile();
+    updateFSInfo();
+    if (presetIdxFileSize + presetLogSize + len + 9000 > fsBytesTotal - fsBytesUsed) { // keep room for one compaction
+      errorFlag = ERR_FS_QUOTA;
+    } else if ((f = WLED_FS.open(PRESET_LOG_FILE, "a"))) {
+      const size_t pos = f.size();
+      ok = (f.write(rec, PRESET_LOG_HEADER + len) == PRESET_LOG_HEADER + len);
+      if (ok && pos == presetLogSize) {
+        presetLogOffset[id] = pos + PRESET_LOG_HEADER;
+        presetLogLength[id] = len;
+        presetLogSize = pos + PRESET_LOG_HEADER + len;
+      } else {
+        ok = false;
+        presetLogDamaged = true; // garbage at the end of the log, merge it away soon
+      }
+      presetLogTime = millis();
+      doCloseFile = true;
+    }
+    unlockPresetStore();
+  }
+  free(rec);
+  DEBUGFS_PRINTF("Preset %u logged (%u bytes): %s\n", id, (unsigned)len, ok ? "ok" : "failed");
+  return ok;
+}
+
+// 1 if read, 0 if the log says the preset was deleted, -1 if the log does not know this preset
+static int readPresetFromLog(uint16_t id, JsonDocument* dest) {
+  applyPresetLogDiscard();
+  if (!presetLogOffset || !presetLogOffset[id]) return -1;
+  const size_t len = presetLogLength[id];
+  if (!len) { dest->clear(); return 0; }
+  if (doCloseFile) closeFile();
+  f = WLED_FS.open(PRESET_LOG_FILE, "r");
+  if (!f) return -1;
+  f.seek(presetLogOffset[id]);
+  char* buf = (char*) malloc(len);
+  if (buf) {
+    if (f.read((uint8_t*)buf, len) == len) deserializeJson(*dest, (const char*)buf, len);
+    else dest->clear();
+    free(buf);
+  } else deserializeJson(*dest, f); // stops at the end of the object
+  f.close();
+  return dest->isNull() ? 0 : 1;
+}
+
+// where the current version of a preset lives; len 0 means presets.json holds it but it is too long for the index
+static bool locatePreset(uint8_t id, bool& inLog, size_t& offset, size_t& len) {
+  inLog = presetLogOffset && presetLogOffset[id];
+  if (inLog) {
+    offset = presetLogOffset[id];
+    len = presetLogLength[id];
+    return len > 0;
+  }
+  if (!presetIdxValid || !presetIdxOffset || !presetIdxOffset[id]) return false;
+  offset = presetIdxOffset[id];
+  len = presetIdxLength[id];
+  return true;
+}
+
+static size_t presetKeyLength(uint8_t id) {  // ,"<id>":
+  return (id >= 100 ? 3 : id >= 10 ? 2 : 1) + 4;
+}
+
+// presets.json with the log applied, as one buffer (PSRAM if available); nullptr if it cannot be assembled right now
+// runs in the web server task: never waits for the preset store, the client retries on 503
+static uint8_t* buildPresetView(size_t& size) {
+  if (doCloseFile || !lockPresetStore(0)) return nullptr; // busy, or loop() has not closed the last append yet
+  unsigned long t0 = millis();
+  File pf = WLED_FS.open("/presets.json", "r");
+  File lf = WLED_FS.open(PRESET_LOG_FILE, "r");
+  bool ok = !doCloseFile && compactId < 0 && (!pf || (presetIdxValid && pf.size() == presetIdxFileSize));
+
+  size = 8; // {"0":{}}
+  bool inLog;
+  size_t offset, len;
+  for (unsigned id = 1; ok && id < PRESET_INDEX_SIZE; id++) {
+    if (!locatePreset(id, inLog, offset, len)) continue;
+    if (!len) ok = false;
+    else size += presetKeyLength(id) + len;
+  }
+
+  uint8_t* view = nullptr;
+  if (ok) {
+    #if defined(BOARD_HAS_PSRAM)
+    if (psramFound()) view = (uint8_t*) ps_malloc(size + 1);
+    else
+    #endif
+    view = (uint8_t*) malloc(size + 1);
+  }
+  if (view) {
+    char* p = (char*) view;
+    p += sprintf_P(p, PSTR("{\"0\":{}"));
+    for (unsigned id = 1; ok && id < PRESET_INDEX_SIZE; id++) {
+      if (!locatePreset(id, inLog, offset, len)) continue;
+      File& src = inLog ? lf : pf;
+      p += sprintf_P(p, PSTR(",\"%u\":"), id);
+      ok = src && src.seek(offset) && src.read((uint8_t*)p, len) == len && *p == '{';
+      p += len;
+    }
+    *p = '}';
+    if (!ok) { free(view); view = nullptr; }
+  }
+  pf.close();
+  lf.close();
+  unlockPresetStore();
+  DEBUG_PRINTF("Preset view: %u bytes in %lu ms%s.\n", (unsigned)size, millis() - t0, view ? "" : " failed");
+  return view;
+}
+
+static bool servePresetView(AsyncWebServerRequest* request, const String& contentType) {
+  size_t size = 0;
+  uint8_t* view = buildPresetView(size);
+  if (!view) {
+    presetLogCompactNow = true; // merging removes the need for the view
+    AsyncWebServerResponse* response = request->beginResponse(503, "application/json", F("{\"error\":3}"));
+    response->addHeader(F("Retry-After"), F("1"));
+    request->send(response);
+    return true;
+  }
+  std::shared_ptr<uint8_t> data(view, free); // released together with the response
+  AsyncWebServerResponse* response = request->beginResponse(contentType, size, [data, size](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+    size_t n = (size - index < maxLen) ? size - index : maxLen;
+    memcpy(buffer, data.get() + index, n);
+    return n;
+  });
+  if (request->hasArg(F("download"))) response->addHeader(F("Content-Disposition"), F("attachment; filename=\"presets.json\""));
+  request->send(response);
+  return true;
+}
+
+// length of the object starting at offset, for presets too long for the index
+static size_t measurePresetObject(File& src, size_t offset) {
+  if (!src || !src.seek(offset)) return 0;
+  byte buf[FS_BUFSIZE];
+  size_t pos = offset;
+  unsigned depth = 0;
+  bool inString = false, escape = false;
+  while (src.available()) {
+    size_t len = src.read(buf, FS_BUFSIZE);
+    for (size_t i = 0; i < len; i++, pos++) {
+      const char c = buf[i];
+      if (inString) {
+        if (escape) escape = false;
+        else if (c == '\\') escape = true;
+        else if (c == '"') inString = false;
+      } else if (c == '"') inString = true;
+      else if (c == '{' || c == '[') depth++;
+      else if ((c == '}' || c == ']') && depth && --depth == 0) return pos - offset + 1;
+    }
+  }
+  return 0;
+}
+
+static bool copyPresetToCompactFile(File& src, uint8_t id, size_t offset, size_t len) {
+  if (!src || !src.seek(offset) || src.peek() != '{') return false;
+  compactFile.printf(",\"%u\":", id);
+  compactIdxOffset[id] = compactFile.position();
+  compactIdxLength[id] = (len <= UINT16_MAX) ? len : 0;
+  byte buf[FS_BUFSIZE];
+  while (len) {
+    size_t block = (len < FS_BUFSIZE) ? len : FS_BUFSIZE;
+    if (src.read(buf, block) != block || compactFile.write(buf, block) != block) return false;
+    len -= block;
+  }
+  return true;
+}
+
+// one step of merging the log into presets.json; returns true when compaction has finished or was given up
+static bool presetLogCompactStep() {
+  if (!lockPresetStore(0)) return false;
+  if (doCloseFile) closeFile();
+  bool done = false, failed = false;
+  File pf = WLED_FS.open("/presets.json", "r");
+
+  if (compactId < 0) {
+    updateFSInfo();
+    compactIdxOffset = (uint32_t*) calloc(PRESET_INDEX_SIZE, sizeof(uint32_t));
+    compactIdxLength = (uint16_t*) calloc(PRESET_INDEX_SIZE, sizeof(uint16_t));
+    if ((pf && !presetIndexReady(pf)) || presetIdxFileSize + presetLogSize + 4096 > fsBytesTotal - fsBytesUsed
+        || !compactIdxOffset || !compactIdxLength || !(compactFile = WLED_FS.open(PRESET_LOG_TMP, "w"))) {
+      abortCompaction();
+      failed = true;
+    } else {
+      compactFile.print(F("{\"0\":{}"));
+      compactId = 1;
+      compactLogSize = presetLogSize;
+      compactStart = millis();
+    }
+  } else if (presetLogDiscard || presetLogSize != compactLogSize || (pf && pf.size() != presetIdxFileSize)) {
+    abortCompaction(); // presets changed underneath, start over later
+    done = true;
+  } else if (compactId < PRESET_INDEX_SIZE) {
+    File lf = WLED_FS.open(PRESET_LOG_FILE, "r");
+    size_t copied = 0;
+    while (!failed && compactId < PRESET_INDEX_SIZE && copied < PRESET_LOG_STEP_BYTES) {
+      const uint8_t id = compactId++;
+      bool inLog;
+      size_t offset, len;
+      if (!locatePreset(id, inLog, offset, len)) continue;
+      if (!len) len = measurePresetObject(pf, offset);
+      failed = !len || !copyPresetToCompactFile(inLog ? lf : pf, id, offset, len);
+      copied += len;
+    }
+    lf.close();
+    if (failed) abortCompaction();
+  } else {
+    compactFile.print('}');
+    const size_t compactSize = compactFile.position();
+    compactFile.close();
+    pf.close();
+    if (!WLED_FS.rename(PRESET_LOG_TMP, "/presets.json")) { // SPIFFS does not replace existing files
+      WLED_FS.remove("/presets.json");                     // initPresetsFile() finishes this after a power cut
+      WLED_FS.rename(PRESET_LOG_TMP, "/presets.json");
+    }
+    WLED_FS.remove(PRESET_LOG_FILE);
+    resetPresetLog();
+    free(presetIdxOffset); presetIdxOffset = compactIdxOffset; compactIdxOffset = nullptr; // offsets recorded while copying
+    free(presetIdxLength); presetIdxLength = compactIdxLength; compactIdxLength = nullptr;
+    presetIdxFileSize = compactSize;
+    presetIdxValid = true;
+    presetCacheStale = true; // PSRAM copy of presets.json is re-read on the next request, not now
+    compactId = -1;
+    compactBackoff = 1000;
+    USER_PRINTF("Preset log merged into presets.json in %lu ms.\n", millis() - compactStart);
+    done = true;
+  }
+  pf.close();
+
+  if (failed) {
+    presetLogCompactNow = false;
+    presetLogTime = millis();
+    compactBackoff = min(compactBackoff * 2, (unsigned long)PRESET_LOG_COMPACT_IDLE);
+    DEBUG_PRINTLN(F("Preset log: compaction failed."));
+    done = true;
+  }
+  unlockPresetStore();
+  return done;
+}
+
+// merges the whole log right away, for writes that must go to presets.json directly; false if that did not work
+static bool mergePresetLog() {
+  applyPresetLogDiscard();
+  for (unsigned attempt = 0; attempt < 2 && presetLogPending(); attempt++) {
+    while (!presetLogCompactStep()) delay(1);
+  }
+  return !presetLogPending();
+}
+
+// background step in loop(): merges the log once saving has been idle for a while
+void handlePresetLog() {
+  applyPresetLogDiscard();
+  if (compactId < 0) {
+    if (!presetLogPending() || presetsActionPending()) return;
+    bool urgent = presetLogDamaged || presetLogCompactNow || presetLogSize >= PRESET_LOG_COMPACT_SIZE;
+    if (millis() - presetLogTime < (urgent ? compactBackoff : PRESET_LOG_COMPACT_IDLE)) return;
+  }
+  presetLogCompactStep();
+}
+#else
+bool presetLogPending() { return false; }
+size_t presetLogBytes() { return 0; }
+void discardPresetLog() {}
+void handlePresetLog() {}
+#endif
+
+void initPresetIndex() {
+  #ifdef WLED_PRESET_LOG
+  WLED_FS.remove(PRESET_LOG_TMP); // unfinished compaction, the log still has everything
+  #endif
+  File file = WLED_FS.open("/presets.json", "r");
+  if (file) buildPresetIndex(file);
+  file.close();
+  #ifdef WLED_PRESET_LOG
+  replayPresetLog();
+  if (presetLogDamaged) while (!presetLogCompactStep()); // never append behind a torn record
+  #endif
+}
+
 //wrapper to find out how long closing takes
 void closeFile() {
   #ifdef ARDUINO_ARCH_ESP32
@@ -50,6 +581,12 @@ void closeFile() {
   f.close();
   DEBUGFS_PRINTF("took %d ms\n", millis() - s);
   doCloseFile = false;
+  if (presetIdxDirty) { // WLEDMM index is up to date, only the file size changed
+    presetIdxDirty = false;
+    File file = WLED_FS.open("/presets.json", "r");
+    presetIdxFileSize = file ? file.size() : 0;
+    file.close();
+  }
 }
 
 //find() that reads and buffers data from file stream in 256-byte blocks.
@@ -185,6 +722,27 @@ static void writeSpace(size_t l)
   if (knownLargestSpace < l) knownLargestSpace = l;
 }
 
+// WLEDMM pos is just after key, or at the '{' of its object (preset index). Whitespace between comma, key and object is
+// allowed (pretty printed or uploaded files). Moves pos back to the comma before key, or to key if it is the first object.
+// false if the bytes before pos are not key
+static bool findKeyStart(size_t& pos, const char* key) {
+  const size_t keyLen = strlen(key);
+  char buf[64];
+  const size_t from = (pos > sizeof(buf)) ? pos - sizeof(buf) : 0;
+  const size_t n = pos - from;
+  f.seek(from);
+  if (f.read((uint8_t*)buf, n) != n) return false;
+  size_t i = n;
+  while (i && isspace(buf[i-1])) i--;
+  if (i < keyLen || memcmp(buf + i - keyLen, key, keyLen) != 0) return false;
+  i -= keyLen;
+  const size_t keyStart = i;
+  while (i && isspace(buf[i-1])) i--;
+  if (i == 0 && from > 0) return false; // too much whitespace to see the comma
+  pos = from + ((i && buf[i-1] == ',') ? i - 1 : keyStart);
+  return true;
+}
+
 bool appendObjectToFile(const char* key, JsonDocument* content, uint32_t s, uint32_t contentLen = 0)
 {
   #ifdef WLED_DEBUG_FS
@@ -211,6 +769,7 @@ bool appendObjectToFile(const char* key, JsonDocument* content, uint32_t s, uint
   if (bufferedFindSpace(contentLen + strlen(key) + 1)) {
     if (f.position() > 2) f.write(','); //add comma if not first object
     f.print(key);
+    setPresetIndex(key, f.position(), contentLen); // WLEDMM
     serializeJson(*content, f);
     DEBUGFS_PRINTF("Inserted, took %d ms (total %d)", millis() - s1, millis() - s);
     doCloseFile = true;
@@ -251,9 +810,11 @@ bool appendObjectToFile(const char* key, JsonDocument* content, uint32_t s, uint
   } else { //file content is not valid JSON object
     f.seek(0, SeekSet);
     f.print('{'); //start JSON
+    presetIdxValid = false; // WLEDMM rebuild from the new content
   }
 
   f.print(key);
+  setPresetIndex(key, f.position(), contentLen); // WLEDMM
 
   //Append object
   serializeJson(*content, f);
@@ -266,6 +827,14 @@ bool appendObjectToFile(const char* key, JsonDocument* content, uint32_t s, uint
 
 bool writeObjectToFileUsingId(const char* file, uint16_t id, JsonDocument* content)
 {
+  if (isPresetsFile(file)) invalidateCompiledPresets(); // WLEDMM
+  #ifdef WLED_PRESET_LOG
+  if (isPresetsFile(file) && id < PRESET_INDEX_SIZE) { // WLEDMM
+    const size_t len = content->isNull() ? 0 : measureJson(*content);
+    if (len <= UINT16_MAX) return appendPresetLog(id, content, len);
+    if (!mergePresetLog()) return false; // too large for a log record, presets.json must be current before writing it
+  }
+  #endif
   char objKey[10];
   sprintf(objKey, "\"%d\":", id);
   return writeObjectToFile(file, objKey, content);
@@ -281,6 +850,7 @@ bool writeObjectToFile(const char* file, const char* key, JsonDocument* content)
   #endif
 
   size_t pos = 0;
+  if (doCloseFile) closeFile(); // WLEDMM finish the previous write (and its index update) first
   f = WLED_FS.open(file, "r+");
   if (!f && !WLED_FS.exists(file)) { f = WLED_FS.open(file, "w+");
     if(f) { DEBUG_PRINTF(PSTR("FILE '%s' open to write, size =%d\n"), file, (int)f.size());} // WLEDMM additional debug message
@@ -290,16 +860,26 @@ bool writeObjectToFile(const char* file, const char* key, JsonDocument* content)
     return false;
   }
 
-  if (!bufferedFind(key)) //key does not exist in file
-  {
-    return appendObjectToFile(key, content, s);
-  }
+  // WLEDMM locate the old object through the preset index if possible
+  presetIdxWriting = isPresetsFile(file) && presetIdFromKey(key) >= 0 && presetIndexReady(f);
+  int id = presetIdxWriting ? presetIdFromKey(key) : -1;
+  size_t pos2 = 0;
+  if (id >= 0 && presetIdxOffset[id] && presetIdxLength[id]) {
+    pos = presetIdxOffset[id];
+    pos2 = pos + presetIdxLength[id];
+    f.seek(pos2);
+  } else {
+    if ((id >= 0 && !presetIdxOffset[id]) || !bufferedFind(key)) //key does not exist in file
+    {
+      return appendObjectToFile(key, content, s);
+    }
 
-  //an object with this key already exists, replace or delete it
-  pos = f.position();
-  //measure out end of old object
-  bufferedFindObjectEnd();
-  size_t pos2 = f.position();
+    //an object with this key already exists, replace or delete it
+    pos = f.position();
+    //measure out end of old object
+    bufferedFindObjectEnd();
+    pos2 = f.position();
+  }
 
   uint32_t oldLen = pos2 - pos;
   DEBUGFS_PRINTF("Old obj len %d\n", oldLen);
@@ -318,14 +898,32 @@ bool writeObjectToFile(const char* file, const char* key, JsonDocument* content)
     f.seek(pos);
     serializeJson(*content, f);
     writeSpace(pos2 - f.position());
+    setPresetIndex(key, pos, contentLen); // WLEDMM
   } else if (contentLen && bufferedFindSpace(contentLen - oldLen, false)) { //enough leading spaces to replace
     DEBUGFS_PRINTLN(F("replace (trailing)"));
     f.seek(pos);
     serializeJson(*content, f);
+    setPresetIndex(key, pos, contentLen); // WLEDMM
   } else {
     DEBUGFS_PRINTLN(F("delete"));
-    pos -= strlen(key);
-    if (pos > 3) pos--; //also delete leading comma if not first object
+    setPresetIndex(key, 0, 0); // WLEDMM
+    // WLEDMM also delete the key and the leading comma if not first object
+    if (!findKeyStart(pos, key)) {
+      if (id >= 0) {
+        // unexpected bytes before the indexed object: find the key by scanning, as without the index
+        f.seek(0);
+        if (!bufferedFind(key)) {
+          DEBUGFS_PRINTLN(F("Key not found, file not changed."));
+          presetIdxValid = false;
+          doCloseFile = true;
+          return false;
+        }
+        pos = f.position();
+        bufferedFindObjectEnd();
+        pos2 = f.position();
+      }
+      if (!findKeyStart(pos, key)) pos -= strlen(key); // key is right before pos, comma too far away
+    }
     f.seek(pos);
     writeSpace(pos2 - pos);
     if (contentLen) return appendObjectToFile(key, content, s, contentLen);
@@ -336,8 +934,49 @@ bool writeObjectToFile(const char* file, const char* key, JsonDocument* content)
   return true;
 }
 
+// WLEDMM returns 1 if read, 0 if there is no such preset, -1 if the index cannot answer (caller falls back to scanning)
+static int readPresetUsingIndex(const char* file, uint16_t id, JsonDocument* dest)
+{
+  if (doCloseFile) closeFile();
+  unsigned long t0 = micros();
+  f = WLED_FS.open(file, "r");
+  if (!f) return -1;
+  if (!presetIndexReady(f)) { f.close(); return -1; }
+  if (!presetIdxOffset[id]) {
+    f.close();
+    dest->clear();
+    DEBUGFS_PRINTLN(F("Obj not found (index)."));
+    return 0;
+  }
+  const size_t len = presetIdxLength[id];
+  if (!len) { f.close(); return -1; } // too long for the index
+
+  f.seek(presetIdxOffset[id]);
+  char* buf = (len <= PRESET_INDEX_READ_MAX) ? (char*) malloc(len) : nullptr;
+  if (buf) {
+    size_t got = f.read((uint8_t*)buf, len);
+    if (got != len || buf[0] != '{') { free(buf); f.close(); invalidatePresetIndex(); return -1; } // stale index
+    deserializeJson(*dest, (const char*)buf, len); // const: ArduinoJson copies strings, buf can be freed
+    free(buf);
+  } else {
+    if (f.peek() != '{') { f.close(); invalidatePresetIndex(); return -1; }
+    deserializeJson(*dest, f);
+  }
+  f.close();
+  DEBUG_PRINTF("Preset %u read in %lu us (%u bytes at %u).\n", id, micros() - t0, len, presetIdxOffset[id]);
+  return 1;
+}
+
 bool readObjectFromFileUsingId(const char* file, uint16_t id, JsonDocument* dest)
 {
+  if (isPresetsFile(file) && id < PRESET_INDEX_SIZE) {
+    #ifdef WLED_PRESET_LOG
+    int logged = readPresetFromLog(id, dest);
+    if (logged >= 0) return logged;
+    #endif
+    int found = readPresetUsingIndex(file, id, dest);
+    if (found >= 0) return found;
+  }
   char objKey[10];
   sprintf(objKey, "\"%d\":", id);
   return readObjectFromFile(file, objKey, dest);
@@ -425,7 +1064,8 @@ static const uint8_t *getPresetCache(size_t &size) {
   //if (presetsModifiedTime != presetsCachedTime) DEBUG_PRINTLN(F("getPresetCache(): presetsModifiedTime changed."));
   //if (presetsCachedValidate != cacheInvalidate) DEBUG_PRINTLN(F("getPresetCache(): cacheInvalidate changed."));
 
-  if ((presetsModifiedTime != presetsCachedTime) || (presetsCachedValidate != cacheInvalidate)) {
+  if ((presetsModifiedTime != presetsCachedTime) || (presetsCachedValidate != cacheInvalidate) || presetCacheStale) {
+    presetCacheStale = false;
     if (presetsCached) {
       free(presetsCached);
       presetsCached = nullptr;
@@ -463,6 +1103,8 @@ static bool haveSkinFile = true;
 static bool haveICOFile = true;
 static bool haveCpalFile = true;
 void invalidateFileNameCache() { // reset "file not found" cache
+  invalidatePresetIndex(); // WLEDMM
+  invalidateCompiledPresets(); // WLEDMM
   haveLedmapFile = true;
   haveIndexFile = true;
   haveSkinFile = true;
@@ -500,6 +1142,10 @@ bool handleFileRead(AsyncWebServerRequest* request, String path){
     return true;
   }*/
 
+  #ifdef WLED_PRESET_LOG
+  if (path.endsWith("/presets.json") && presetLogPending()) return servePresetView(request, contentType); // WLEDMM
+  #endif
+
   #if defined(BOARD_HAS_PSRAM) && (defined(WLED_USE_PSRAM) || defined(WLED_USE_PSRAM_JSON))
   if (path.endsWith("/presets.json")) {
     size_t psize;
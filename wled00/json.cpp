@@ -14,6 +14,7 @@
 // begin WLEDMM
 #ifdef ARDUINO_ARCH_ESP32
 #include <Esp.h>
+#include <memory>
 // get the right RTC.H for each MCU
 #if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(4, 0, 0)
 #if CONFIG_IDF_TARGET_ESP32S2
@@ -49,6 +50,131 @@
 
 static bool inDeepCall = false; // WLEDMM needed so that recursive deserializeSegment() does not remove locks too early
 
+// WLEDMM streamed /json/eff and /json/fxdata responses (see JsonStream below)
+static uint32_t jsonStreamCount = 0;   // responses served
+
+// WLEDMM segment changes shared by deserializeSegment() and compiled presets (presets_bin.cpp)
+
+// sets or clears (name == nullptr) the segment name; returns false if there is no name now (empty or 32+ chars)
+bool setSegmentName(Segment& seg, const char* name)
+{
+  if (seg.name) { //clear old name
+    delete[] seg.name;
+    seg.name = nullptr;
+  }
+  size_t len = 0;
+  if (name != nullptr) len = strlen(name);
+  if (len == 0 || len >= 32) return false;
+  seg.name = new char[len+1];
+  if (seg.name) strlcpy(seg.name, name, len+1);
+  return true;
+}
+
+// bounds, grouping, spacing, offset and mapping; offset INT32_MAX keeps the current offset
+void setSegmentGeometry(Segment& seg, bool newSeg, uint16_t start, int stop, uint16_t startY, uint16_t stopY,
+                        uint16_t grp, uint16_t spc, int offset, uint8_t soundSim, uint8_t map1D2D, uint8_t set)
+{
+  uint16_t of = seg.offset;
+
+  //WLEDMM jMap
+  if (map1D2D == M12_jMap && !seg.jMap)
+    seg.createjMap();
+  if (map1D2D != M12_jMap && seg.jMap)
+    seg.deletejMap();
+
+  if ((spc>0 && spc!=seg.spacing) || seg.map1D2D!=map1D2D) seg.markForBlank(); // clear spacing gaps // WLEDMM softhack007: this line sometimes crashes with "Stack canary watchpoint triggered (async_tcp)"
+
+  seg.map1D2D  = constrain(map1D2D, 0, 7);
+  seg.soundSim = constrain(soundSim, 0, 1);
+  seg.set = constrain(set, 0, 3);
+
+  uint16_t len = 1;
+  if (stop > start) len = stop - start;
+  if (offset != INT32_MAX) {
+    int offsetAbs = abs(offset);
+    if (offsetAbs > len - 1) offsetAbs %= len;
+    if (offset < 0) offsetAbs = len - offsetAbs;
+    of = offsetAbs;
+  }
+  if (stop > start && of > len -1) of = len -1;
+  seg.setUp(start, stop, grp, spc, of, startY, stopY);
+  if (newSeg) seg.refreshLightCapabilities(); // fix for #3403
+}
+
+// one entry of a "col" array; false if it is empty or invalid (the color is kept)
+bool colorFromJson(JsonVariant col, uint32_t& color)
+{
+  int rgbw[] = {0,0,0,0};
+  JsonArray colX = col;
+  if (colX.isNull()) {
+    byte brgbw[] = {0,0,0,0};
+    const char* hexCol = col;
+    if (hexCol == nullptr) { //Kelvin color temperature (or invalid), e.g 2400
+      int kelvin = col | -1;
+      if (kelvin <  0) return false;
+      if (kelvin >  0) colorKtoRGB(kelvin, brgbw);
+    } else { //HEX string, e.g. "FFAA00"
+      if (!colorFromHexString(brgbw, hexCol)) return false;
+    }
+    for (size_t c = 0; c < 4; c++) rgbw[c] = brgbw[c];
+  } else { //Array of ints (RGB or RGBW color), e.g. [255,160,0]
+    if (colX.size() == 0) return false; //do nothing on empty array
+    copyArray(colX, rgbw, 4);
+  }
+  color = RGBW32(rgbw[0],rgbw[1],rgbw[2],rgbw[3]);
+  return true;
+}
+
+// sets col[i] for each bit i of valid
+void setSegmentColors(Segment& seg, const uint32_t* col, uint8_t valid)
+{
+  if (seg.getLightCapabilities() & 3) {
+    // segment has RGB or White
+    for (size_t i = 0; i < 3; i++) {
+      if (!(valid & (1 << i))) continue;
+      seg.setColor(i, col[i]);
+      if (seg.mode == FX_MODE_STATIC) strip.trigger(); //instant refresh
+    }
+  } else {
+    // non RGB & non White segment (usually On/Off bus)
+    seg.setColor(0, ULTRAWHITE);
+    seg.setColor(1, BLACK);
+  }
+}
+
+void setSegmentOrientation(Segment& seg, bool sel, bool rev, bool mi, bool rY, bool mY, bool tp)
+{
+  #ifndef WLED_DISABLE_2D
+  bool reverse  = seg.reverse;
+  bool mirror   = seg.mirror;
+  #endif
+  seg.selected  = sel;
+  seg.reverse   = rev;
+  seg.mirror    = mi;
+  #ifndef WLED_DISABLE_2D
+  bool reverse_y = seg.reverse_y;
+  bool mirror_y  = seg.mirror_y;
+  seg.reverse_y  = rY;
+  seg.mirror_y   = mY;
+  seg.transpose  = tp;
+  if (seg.is2D() && (seg.map1D2D == M12_pArc || seg.map1D2D == M12_sCircle) && (reverse != seg.reverse || reverse_y != seg.reverse_y || mirror != seg.mirror || mirror_y != seg.mirror_y)) seg.markForBlank(); // clear entire segment (in case of Arc 1D to 2D expansion) WLEDMM: also Circle
+  #endif
+}
+
+// send UDP/WS if segment options changed (except selection; will also deselect current preset)
+void finishSegmentUpdate(Segment& seg, Segment& prev)
+{
+  uint8_t diffresult = seg.differs(prev)  & 0x7F;
+  if (diffresult > 0) {
+    stateChanged = true;
+    if ((seg.on == false) && (prev.on == true) && (prev.freeze == false)) prev.fill(BLACK); // WLEDMM: force BLACK if segment was turned off
+    if (diffresult & (SEG_DIFFERS_BOUNDS | SEG_DIFFERS_GSO | SEG_DIFFERS_OPT)) {   // WLEDMM bouds, grouping, or options changed (mirror, reverse, transpose, mapping)
+      if (!seg.freeze) seg.markForBlank();
+      if (prev.isActive() && (diffresult & (SEG_DIFFERS_BOUNDS | SEG_DIFFERS_GSO)) && !prev.freeze && !seg.freeze) prev.fill(BLACK);   // WLEDMM fingers crossed
+    }
+  }
+}
+
 // WLEDMM caution - this function may run outside of arduino loop context (async_tcp with priority=3)
 bool deserializeSegment(JsonObject elem, byte it, byte presetId)
 {
@@ -137,61 +263,19 @@ bool deserializeSegment(JsonObject elem, byte it, byte presetId)
 
   if (elem["n"]) {
     // name field exists
-    if (seg.name) { //clear old name
-      delete[] seg.name;
-      seg.name = nullptr;
-    }
-
-    const char * name = elem["n"].as<const char*>();
-    size_t len = 0;
-    if (name != nullptr) len = strlen(name);
-    if (len > 0 && len < 32) {
-      seg.name = new char[len+1];
-      if (seg.name) strlcpy(seg.name, name, len+1);
-    } else {
-      // but is empty (already deleted above)
-      elem.remove("n");
-    }
+    if (!setSegmentName(seg, elem["n"].as<const char*>())) elem.remove("n"); // but is empty (old name deleted)
   } else if (start != seg.start || stop != seg.stop) {
     // clearing or setting segment without name field
-    if (seg.name) {
-      delete[] seg.name;
-      seg.name = nullptr;
-    }
+    setSegmentName(seg, nullptr);
   }
 
   uint16_t grp = elem["grp"] | seg.grouping;
   uint16_t spc = elem[F("spc")] | seg.spacing;
-  uint16_t of  = seg.offset;
   uint8_t  soundSim = elem["si"] | seg.soundSim;
   uint8_t  map1D2D  = elem["m12"] | seg.map1D2D;
-
-  //WLEDMM jMap
-  if (map1D2D == M12_jMap && !seg.jMap)
-    seg.createjMap();
-  if (map1D2D != M12_jMap && seg.jMap)
-    seg.deletejMap();
-
-  if ((spc>0 && spc!=seg.spacing) || seg.map1D2D!=map1D2D) seg.markForBlank(); // clear spacing gaps // WLEDMM softhack007: this line sometimes crashes with "Stack canary watchpoint triggered (async_tcp)"
-
-  seg.map1D2D  = constrain(map1D2D, 0, 7);
-  seg.soundSim = constrain(soundSim, 0, 1);
-
-  uint8_t set = elem[F("set")] | seg.set;
-  seg.set = constrain(set, 0, 3);
-
-  uint16_t len = 1;
-  if (stop > start) len = stop - start;
+  uint8_t  set = elem[F("set")] | seg.set;
   int offset = elem[F("of")] | INT32_MAX;
-  if (offset != INT32_MAX) {
-    int offsetAbs = abs(offset);
-    if (offsetAbs > len - 1) offsetAbs %= len;
-    if (offset < 0) offsetAbs = len - offsetAbs;
-    of = offsetAbs;
-  }
-  if (stop > start && of > len -1) of = len -1;
-  seg.setUp(start, stop, grp, spc, of, startY, stopY);
-	if (newSeg) seg.refreshLightCapabilities(); // fix for #3403
+  setSegmentGeometry(seg, newSeg, start, stop, startY, stopY, grp, spc, offset, soundSim, map1D2D, set);
 
   if (seg.reset && seg.stop == 0) {
     if (iAmGroot) suspendStripService = false; // WLEDMM release lock
@@ -224,44 +308,11 @@ bool deserializeSegment(JsonObject elem, byte it, byte presetId)
   JsonArray colarr = elem["col"];
   if (!colarr.isNull())
   {
-    if (seg.getLightCapabilities() & 3) {
-      // segment has RGB or White
-      for (size_t i = 0; i < 3; i++)
-      {
-        int rgbw[] = {0,0,0,0};
-        bool colValid = false;
-        JsonArray colX = colarr[i];
-        if (colX.isNull()) {
-          byte brgbw[] = {0,0,0,0};
-          const char* hexCol = colarr[i];
-          if (hexCol == nullptr) { //Kelvin color temperature (or invalid), e.g 2400
-            int kelvin = colarr[i] | -1;
-            if (kelvin <  0) continue;
-            if (kelvin == 0) seg.setColor(i, 0);
-            if (kelvin >  0) colorKtoRGB(kelvin, brgbw);
-            colValid = true;
-          } else { //HEX string, e.g. "FFAA00"
-            colValid = colorFromHexString(brgbw, hexCol);
-          }
-          for (size_t c = 0; c < 4; c++) rgbw[c] = brgbw[c];
-        } else { //Array of ints (RGB or RGBW color), e.g. [255,160,0]
-          byte sz = colX.size();
-          if (sz == 0) continue; //do nothing on empty array
-
-          copyArray(colX, rgbw, 4);
-          colValid = true;
-        }
-
-        if (!colValid) continue;
-
-        seg.setColor(i, RGBW32(rgbw[0],rgbw[1],rgbw[2],rgbw[3]));
-        if (seg.mode == FX_MODE_STATIC) strip.trigger(); //instant refresh
-      }
-    } else {
-      // non RGB & non White segment (usually On/Off bus)
-      seg.setColor(0, ULTRAWHITE);
-      seg.setColor(1, BLACK);
-    }
+    uint32_t col[3] = {0,0,0};
+    uint8_t colValid = 0;
+    for (size_t i = 0; i < 3; i++)
+      if (colorFromJson(colarr[i], col[i])) colValid |= 1 << i;
+    setSegmentColors(seg, col, colValid);
   }
 
   // lx parser
@@ -276,21 +327,8 @@ bool deserializeSegment(JsonObject elem, byte it, byte presetId)
   }
   #endif
 
-  #ifndef WLED_DISABLE_2D
-  bool reverse  = seg.reverse;
-  bool mirror   = seg.mirror;
-  #endif
-  seg.selected  = elem["sel"] | seg.selected;
-  seg.reverse   = elem["rev"] | seg.reverse;
-  seg.mirror    = elem["mi"]  | seg.mirror;
-  #ifndef WLED_DISABLE_2D
-  bool reverse_y = seg.reverse_y;
-  bool mirror_y  = seg.mirror_y;
-  seg.reverse_y  = elem["rY"]  | seg.reverse_y;
-  seg.mirror_y   = elem["mY"]  | seg.mirror_y;
-  seg.transpose  = elem[F("tp")] | seg.transpose;
-  if (seg.is2D() && (seg.map1D2D == M12_pArc || seg.map1D2D == M12_sCircle) && (reverse != seg.reverse || reverse_y != seg.reverse_y || mirror != seg.mirror || mirror_y != seg.mirror_y)) seg.markForBlank(); // clear entire segment (in case of Arc 1D to 2D expansion) WLEDMM: also Circle
-  #endif
+  setSegmentOrientation(seg, elem["sel"] | seg.selected, elem["rev"] | seg.reverse, elem["mi"] | seg.mirror,
+                        elem["rY"] | seg.reverse_y, elem["mY"] | seg.mirror_y, elem[F("tp")] | seg.transpose);
 
   byte fx = seg.mode;
   byte last = strip.getModeCount();
@@ -382,16 +420,7 @@ bool deserializeSegment(JsonObject elem, byte it, byte presetId)
     seg.map1D2D = oldMap1D2D; // restore mapping
     strip.trigger(); // force segment update
   }
-  // send UDP/WS if segment options changed (except selection; will also deselect current preset)
-  uint8_t diffresult = seg.differs(prev)  & 0x7F;
-  if (diffresult > 0) {
-    stateChanged = true;
-    if ((seg.on == false) && (prev.on == true) && (prev.freeze == false)) prev.fill(BLACK); // WLEDMM: force BLACK if segment was turned off
-    if (diffresult & (SEG_DIFFERS_BOUNDS | SEG_DIFFERS_GSO | SEG_DIFFERS_OPT)) {   // WLEDMM bouds, grouping, or options changed (mirror, reverse, transpose, mapping)
-      if (!seg.freeze) seg.markForBlank();
-      if (prev.isActive() && (diffresult & (SEG_DIFFERS_BOUNDS | SEG_DIFFERS_GSO)) && !prev.freeze && !seg.freeze) prev.fill(BLACK);   // WLEDMM fingers crossed
-    }
-  }
+  finishSegmentUpdate(seg, prev);
 
   if (iAmGroot) suspendStripService = false; // WLEDMM release lock
   return true;
@@ -985,8 +1014,52 @@ void serializeInfo(JsonObject root)
     root[F("lip")] = realtimeIP.toString();
   }
 
+  JsonObject udpRx = root.createNestedObject(F("udprx"));
+  udpRx["q"]         = getUdpRxQueueDepth();
+  udpRx[F("qmax")]   = udpRxMaxDepth;
+  udpRx[F("drop")]   = udpRxDropped;
+  udpRx[F("lat")]    = udpRxLatency;     // us
+  udpRx[F("latmax")] = udpRxLatencyMax;  // us
+
+  if (e131FrameSync) {
+    JsonObject dmxFrames = root.createNestedObject(F("dmxframes"));
+    dmxFrames[F("ok")]   = e131FramesComplete;
+    dmxFrames[F("part")] = e131FramesPartial;
+    dmxFrames[F("drop")] = e131FramesDropped;
+    dmxFrames[F("sync")] = getE131FrameSyncActive();
+  }
+
+  JsonObject jsonLock = root.createNestedObject(F("jsonlock")); // WLEDMM JSON buffer contention
+  serializeJSONLockStats(jsonLock);
+
+  JsonObject jsonStream = root.createNestedObject(F("jstream")); // WLEDMM streamed /json/eff and /json/fxdata responses
+  jsonStream[F("n")]    = jsonStreamCount;
+
+  JsonObject bootProfile = root.createNestedObject(F("boot")); // WLEDMM startup phases, ms since power-on
+  serializeBootProfile(bootProfile);
+
+  JsonObject cfgLoad = root.createNestedObject(F("cfgload")); // WLEDMM config load/save, times in us
+  serializeConfigStats(cfgLoad);
+
+  JsonObject fxMeta = root.createNestedObject(F("fxmeta")); // WLEDMM effect data index
+  serializeModeMetaStats(fxMeta);
+
+  JsonObject presetBinStats = root.createNestedObject(F("pbin")); // WLEDMM compiled presets
+  serializePresetBinStats(presetBinStats);
+
+  if (currentPlaylist >= 0) {
+    JsonObject playlistStats = root.createNestedObject(F("plstat")); // WLEDMM playlist switch latency
+    serializePlaylistStats(playlistStats);
+  }
+
   #ifdef WLED_ENABLE_WEBSOCKETS
   root[F("ws")] = ws.count();
+  JsonObject wsStats = root.createNestedObject(F("wsstats")); // WLEDMM
+  wsStats[F("bc")] = wsBroadcasts;
+  wsStats[F("bytes")] = wsBytesSent;
+  wsStats[F("coal")] = wsCoalesced;
+  wsStats[F("hit")] = wsCacheHits;
+  wsStats[F("patch")] = wsPatchesSent;
   #else
   root[F("ws")] = -1;
   #endif
@@ -1023,6 +1096,7 @@ void serializeInfo(JsonObject root)
   fs_info["u"] = fsBytesUsed / 1000;
   fs_info["t"] = fsBytesTotal / 1000;
   fs_info[F("pmt")] = presetsModifiedTime;
+  fs_info[F("plog")] = presetLogBytes(); // WLEDMM preset log not yet merged into presets.json
 
   root[F("ndc")] = nodeListEnabled ? (int)Nodes.size() : -1;
 
@@ -1412,58 +1486,133 @@ void serializeNodes(JsonObject root)
   }
 }
 
+// WLEDMM copies effect name or UI data (after '@') into lineBuffer using the effect index, false for empty entries
+static bool getModeString(uint8_t mode, bool data, char *lineBuffer, size_t maxLen)
+{
+  const char *src = strip.getModeData(mode);
+  const mode_meta_t *meta = strip.getModeMeta(mode);
+  if (!meta) { // not indexed
+    strncpy_P(lineBuffer, src, maxLen-1);
+    lineBuffer[maxLen-1] = '\0';
+    if (lineBuffer[0] == 0) return false;
+    char* dataPtr = strchr(lineBuffer,'@');
+    if (!data)        { if (dataPtr) *dataPtr = 0; } // terminate mode data after name
+    else if (dataPtr) memmove(lineBuffer, dataPtr+1, strlen(dataPtr+1)+1);
+    else              lineBuffer[0] = 0;
+    return true;
+  }
+  if (meta->len == 0) return false;
+  size_t len = data ? (meta->dataOfs ? meta->len - meta->dataOfs : 0) : meta->nameLen;
+  len = min(len, maxLen-1);
+  memcpy_P(lineBuffer, src + (data ? meta->dataOfs : 0), len);
+  lineBuffer[len] = '\0';
+  return true;
+}
+
 // deserializes mode data string into JsonArray
 void serializeModeData(JsonArray fxdata)
 {
-  char lineBuffer[192] = { 0 };
+  char lineBuffer[256] = { 0 };
   for (size_t i = 0; i < strip.getModeCount(); i++) {
-    strncpy_P(lineBuffer, strip.getModeData(i), sizeof(lineBuffer)-1);
-    if (lineBuffer[0] != 0) {
-      char* dataPtr = strchr(lineBuffer,'@');
-      if (dataPtr) fxdata.add(dataPtr+1);
-      else         fxdata.add("");
-    }
+    if (getModeString(i, true, lineBuffer, sizeof(lineBuffer))) fxdata.add(lineBuffer);
   }
 }
 
 // deserializes mode names string into JsonArray
 // also removes effect data extensions (@...) from deserialized names
 void serializeModeNames(JsonArray arr) {
-  char lineBuffer[192] = { 0 };
+  char lineBuffer[256] = { 0 };
   for (size_t i = 0; i < strip.getModeCount(); i++) {
-    strncpy_P(lineBuffer, strip.getModeData(i), sizeof(lineBuffer)-1);
-    if (lineBuffer[0] != 0) {
-      char* dataPtr = strchr(lineBuffer,'@');
-      if (dataPtr) *dataPtr = 0; // terminate mode data after name
-      arr.add(lineBuffer);
-    }
+    if (getModeString(i, false, lineBuffer, sizeof(lineBuffer))) arr.add(lineBuffer);
   }
 }
 
 // Global buffer locking response helper class (to make sure lock is released when AsyncJsonResponse is destroyed)
 class LockedJsonResponse: public AsyncJsonResponse {
   bool _holding_lock;
+  JsonDocument* _arena; // WLEDMM doc or a pool arena, see requestJSONArena()
   public:
   // WARNING: constructor assumes requestJSONBufferLock() was successfully acquired externally/prior to constructing the instance
   // Not a good practice with C++. Unfortunately AsyncJsonResponse only has 2 constructors - for dynamic buffer or existing buffer,
   // with existing buffer it clears its content during construction
   // if the lock was not acquired (using JSONBufferGuard class) previous implementation still cleared existing buffer
-  inline LockedJsonResponse(JsonDocument* doc, bool isArray) : AsyncJsonResponse(doc, isArray), _holding_lock(true) {};
+  inline LockedJsonResponse(JsonDocument* doc, bool isArray) : AsyncJsonResponse(doc, isArray), _holding_lock(true), _arena(doc) {};
 
   virtual size_t _fillBuffer(uint8_t *buf, size_t maxLen) { 
     size_t result = AsyncJsonResponse::_fillBuffer(buf, maxLen);
     // Release lock as soon as we're done filling content
     if (((result + _sentLength) >= (_contentLength)) && _holding_lock) {
-      releaseJSONBufferLock();
+      releaseJSONArena(_arena);
       _holding_lock = false;
     }
     return result;
   }
 
   // destructor will remove JSON buffer lock when response is destroyed in AsyncWebServer
-  virtual ~LockedJsonResponse() { if (_holding_lock) releaseJSONBufferLock(); };
+  virtual ~LockedJsonResponse() { if (_holding_lock) releaseJSONArena(_arena); };
+};
+
+// WLEDMM chunked writer for /json/eff and /json/fxdata: the effect list is written element by element straight from the
+// mode table, so these responses need no JsonDocument and do not hold the JSON buffer while a slow client downloads.
+class JsonStream {
+  public:
+  JsonStream(bool data) : _data(data) {}
+
+  size_t fill(uint8_t* buf, size_t maxLen) {
+    size_t n = 0;
+    while (n < maxLen && (_pos < _lineLen || nextLine())) {
+      size_t k = min(maxLen - n, (size_t)(_lineLen - _pos)); // an element larger than the chunk continues in the next one
+      memcpy(buf + n, _line + _pos, k);
+      n += k; _pos += k;
+    }
+    return n; // 0 ends the chunked response
+  }
+
+  private:
+  bool     _data;          // effect data instead of names
+  size_t   _pos = 0;       // position in _line
+  uint16_t _mode = 0;      // next effect to emit
+  uint8_t  _list = 0;      // 0 = '[' not written yet, 1 = elements, 2 = ']' written
+  bool     _first = true;  // no separator before the first element
+  uint16_t _lineLen = 0;
+  char     _line[256];     // one array element: separator, quoted and escaped string
+
+  // same output as serializeModeNames()/serializeModeData(), one element at a time
+  bool nextLine() {
+    _pos = 0; _lineLen = 0;
+    if (_list == 0) { _line[_lineLen++] = '['; _list = 1; return true; }
+    if (_list == 2) return false;
+    char value[192];
+    while (_mode < strip.getModeCount()) {
+      if (!getModeString(_mode++, _data, value, sizeof(value))) continue;
+      if (!_first) _line[_lineLen++] = ',';
+      _first = false;
+      _line[_lineLen++] = '"';
+      for (const char* c = value; *c && _lineLen < sizeof(_line) - 8; c++) {
+        if (*c == '"' || *c == '\\') { _line[_lineLen++] = '\\'; _line[_lineLen++] = *c; }
+        else if ((uint8_t)*c < 0x20) _lineLen += snprintf_P(_line + _lineLen, 7, PSTR("\\u%04x"), (uint8_t)*c);
+        else _line[_lineLen++] = *c;
+      }
+      _line[_lineLen++] = '"';
+      return true;
+    }
+    _line[_lineLen++] = ']';
+    _list = 2;
+    return true;
+  }
 };
 
+// WLEDMM effects and fxdata as a chunked response from JsonStream
+static void serveJsonStream(AsyncWebServerRequest* request, byte subJson)
+{
+  std::shared_ptr<JsonStream> stream = std::make_shared<JsonStream>(subJson == JSON_PATH_FXDATA);
+  AsyncWebServerResponse* response = request->beginChunkedResponse("application/json", [stream](uint8_t* buf, size_t maxLen, size_t index) -> size_t {
+    return stream->fill(buf, maxLen);
+  });
+  jsonStreamCount++;
+  request->send(response);
+}
+
 void serveJson(AsyncWebServerRequest* request)
 {
   byte subJson = 0;
@@ -1508,13 +1657,19 @@ void serveJson(AsyncWebServerRequest* request)
     return;
   }
 
-  if (!requestJSONBufferLock(17)) {
+  if (subJson == JSON_PATH_EFFECTS || subJson == JSON_PATH_FXDATA) {
+    serveJsonStream(request, subJson); // WLEDMM no JSON buffer while sending
+    return;
+  }
+
+  JsonDocument* arena = requestJSONArena(17); // WLEDMM PSRAM arena if available, doc otherwise
+  if (!arena) {
     request->send(503, "application/json", F("{\"error\":3}"));
     return;
   }
-  // releaseJSONBufferLock() will be called when "response" is destroyed (from AsyncWebServer)
+  // releaseJSONArena() will be called when "response" is destroyed (from AsyncWebServer)
   // make sure you delete "response" if no "request->send(response);" is made
-  LockedJsonResponse *response = new LockedJsonResponse(&doc, subJson==JSON_PATH_FXDATA || subJson==JSON_PATH_EFFECTS); // will clear and convert JsonDocument into JsonArray if necessary
+  LockedJsonResponse *response = new LockedJsonResponse(arena, false);
 
   JsonVariant lDoc = response->getRoot();
 
@@ -1529,10 +1684,6 @@ void serveJson(AsyncWebServerRequest* request)
     case JSON_PATH_PALETTES:
       serializePalettes(lDoc, request); break;
       //serializePalettes(lDoc, request->hasParam("page") ? request->getParam("page")->value().toInt() : 0); break;
-    case JSON_PATH_EFFECTS:
-      serializeModeNames(lDoc); break;
-    case JSON_PATH_FXDATA:
-      serializeModeData(lDoc.as<JsonArray>()); break;
     case JSON_PATH_NETWORKS:
       serializeNetworks(lDoc); break;
     default: //all
@@ -1552,6 +1703,7 @@ void serveJson(AsyncWebServerRequest* request)
   DEBUG_PRINTF("JSON buffer size: %u for request: %d (%s)\n", lDoc.memoryUsage(), subJson, url.c_str());
 
   response->setLength();
+  serializedJSONArena(arena); // WLEDMM the arena keeps the content while sending, doc is no longer needed
   request->send(response);
 }
 
@@ -1560,6 +1712,13 @@ void serveJson(AsyncWebServerRequest* request)
 
 #warning "JSON Live enabled"
 
+static inline char* hexByte(char* buf, uint8_t v) {  // WLEDMM two upper case hex digits
+  const uint8_t hi = v >> 4, lo = v & 0x0F;
+  *buf++ = hi < 10 ? '0' + hi : 'A' - 10 + hi;
+  *buf++ = lo < 10 ? '0' + lo : 'A' - 10 + lo;
+  return buf;
+}
+
 bool serveLiveLeds(AsyncWebServerRequest* request, uint32_t wsClient)
 {
   #ifdef WLED_ENABLE_WEBSOCKETS
@@ -1582,7 +1741,12 @@ bool serveLiveLeds(AsyncWebServerRequest* request, uint32_t wsClient)
   }
 #endif
 
-  DynamicBuffer buffer(9 + (9*MAX_LIVE_LEDS) + 7 + 5 + 6 + 5 + 6 + 5 + 2);  
+  size_t count = (used + n -1) / n;  // WLEDMM size for the pixels actually sent (a matrix can exceed MAX_LIVE_LEDS with n=2)
+  DynamicBuffer buffer(9 + (9*count) + 7 + 5 + 6 + 5 + 6 + 5 + 2);  
+  if (!buffer.data()) {
+    if (request) request->send(503, "application/json", F("{\"error\":3}"));
+    return false;
+  }
   char* buf = buffer.data();      // assign buffer for oappnd() functions
   strncpy_P(buffer.data(), PSTR("{\"leds\":["), buffer.size());
   buf += 9; // sizeof(PSTR()) from last line
@@ -1603,7 +1767,13 @@ bool serveLiveLeds(AsyncWebServerRequest* request, uint32_t wsClient)
       g = qadd8(w, G(c));
       b = qadd8(w, B(c));
     }
-    buf += sprintf_P(buf, PSTR("\"%06X\","), RGBW32(r,g,b,0));
+    // WLEDMM write "RRGGBB", directly instead of sprintf_P() per pixel
+    *buf++ = '"';
+    buf = hexByte(buf, r);
+    buf = hexByte(buf, g);
+    buf = hexByte(buf, b);
+    *buf++ = '"';
+    *buf++ = ',';
   }
   buf--;  // remove last comma
   buf += sprintf_P(buf, PSTR("],\"n\":%d"), n);
@@ -101,6 +101,7 @@ void stateUpdated(byte callMode) {
   //call for notifier -> 0: init 1: direct change 2: button 3: notification 4: nightlight 5: other (No notification)
   //                     6: fx changed 7: hue 8: preset cycle 9: blynk 10: alexa 11: ws send only 12: button preset
   setValuesFromFirstSelectedSeg();
+  stateRevision++; // WLEDMM invalidates cached WS state messages
 
   if (bri != briOld || stateChanged) {
     if (stateChanged) currentPreset = 0; //something changed, so we are no longer in the preset
@@ -109,6 +110,7 @@ void stateUpdated(byte callMode) {
     if (bri != briOld && nodeBroadcastEnabled) sendSysInfoUDP(); // update on state
 
     //set flag to update ws and mqtt
+    if (interfaceUpdateCallMode) wsCoalesced++; // WLEDMM merged into the pending update
     interfaceUpdateCallMode = callMode;
     stateChanged = false;
   } else {
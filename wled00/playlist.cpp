@@ -8,6 +8,7 @@ typedef struct PlaylistEntry {
   uint8_t preset; //ID of the preset to apply
   uint16_t dur;   //Duration of the entry (in tenths of seconds)
   uint16_t tr;    //Duration of the transition TO this entry (in tenths of seconds)
+  uint32_t lat;   //WLEDMM time from the entry start until its preset was applied, last run (in microseconds)
 } ple;
 
 byte           playlistRepeat = 1;        //how many times to repeat the playlist (0 = infinitely)
@@ -19,6 +20,13 @@ byte           playlistLen;               //number of playlist entries
 int8_t         playlistIndex = -1;
 uint16_t       playlistEntryDur = 0;      //duration of the current entry in tenths of seconds
 
+// WLEDMM the next entry's preset is read and compiled while the current entry runs, so the switch needs no file access
+#define PLAYLIST_PREFETCH_DELAY 250       // ms after an entry started, gives handlePresets() time to apply it first
+static bool           playlistPrefetched = false;
+static int16_t        playlistSwitchIndex = -1; // entry whose preset is waiting to be applied
+static unsigned long  playlistSwitchStart = 0;  // micros() when that entry started
+static uint16_t       playlistPrefetchCount = 0;
+
 //values we need to keep about the parent playlist while inside sub-playlist
 //int8_t         parentPlaylistIndex = -1;
 //byte           parentPlaylistRepeat = 0;
@@ -56,6 +64,8 @@ void unloadPlaylist() {
   currentPlaylist = playlistIndex = -1;
   playlistLen = playlistEntryDur = playlistOptions = 0;
   playlistSuspended = false;  // WLEDMM
+  playlistSwitchIndex = -1;   // WLEDMM
+  playlistPrefetchCount = 0;  // WLEDMM
   DEBUG_PRINTLN(F("Playlist unloaded."));
 }
 
@@ -75,6 +85,7 @@ int16_t loadPlaylist(JsonObject playlistObj, byte presetId) {
   for (int ps : presets) {
     if (it >= playlistLen) break;
     playlistEntries[it].preset = ps;
+    playlistEntries[it].lat = 0;
     it++;
   }
 
@@ -127,6 +138,24 @@ int16_t loadPlaylist(JsonObject playlistObj, byte presetId) {
 }
 
 
+// preset of the entry after the current one, 0 if it cannot be known yet (shuffle) or there is none
+static byte nextPlaylistPreset() {
+  int next = playlistIndex + 1;
+  if (next >= playlistLen) {
+    if (playlistRepeat == 1) return playlistEndPreset;
+    if (playlistOptions & PL_OPTION_SHUFFLE) return 0; // order is decided at roll-over
+    next = 0;
+  }
+  return playlistEntries[next].preset;
+}
+
+// WLEDMM called by handlePresets() after applying a preset, measures the switch latency of the playlist entry
+void playlistPresetApplied(byte preset) {
+  if (playlistSwitchIndex < 0 || playlistEntries == nullptr || playlistSwitchIndex >= playlistLen) return;
+  if (playlistEntries[playlistSwitchIndex].preset == preset) playlistEntries[playlistSwitchIndex].lat = micros() - playlistSwitchStart;
+  playlistSwitchIndex = -1;
+}
+
 void handlePlaylist() {
   static unsigned long presetCycledTime = 0;
   // if fileDoc is not null JSON buffer is in use so just quit
@@ -158,8 +187,16 @@ if (millis() - presetCycledTime > (100 * playlistEntryDur) || doAdvancePlaylist)
     jsonTransitionOnce = true;
     transitionDelayTemp = playlistEntries[playlistIndex].tr * 100;
     playlistEntryDur = playlistEntries[playlistIndex].dur;
+    playlistSwitchIndex = playlistIndex; // WLEDMM
+    playlistSwitchStart = micros();
+    playlistPrefetched = false;
     applyPreset(playlistEntries[playlistIndex].preset);
     doAdvancePlaylist = false;
+  } else if (!playlistPrefetched && playlistIndex >= 0 && millis() - presetCycledTime > PLAYLIST_PREFETCH_DELAY && !presetsActionPending()) {
+    // WLEDMM idle time within the current entry: get the next preset ready
+    byte next = nextPlaylistPreset();
+    if (next == 0 || next == playlistEntries[playlistIndex].preset) playlistPrefetched = true;
+    else if (prefetchPreset(next)) { playlistPrefetched = true; playlistPrefetchCount++; }
   }
 }
 
@@ -178,3 +215,17 @@ void serializePlaylist(JsonObject sObj) {
     transition.add(playlistEntries[i].tr);
   }
 }
+
+// WLEDMM switch latency of each entry (in playlist order) for /json/info
+void serializePlaylistStats(JsonObject root) {
+  if (playlistEntries == nullptr) return;
+  root["id"] = currentPlaylist;
+  root["i"] = playlistIndex;
+  root[F("pf")] = playlistPrefetchCount;
+  JsonArray ps = root.createNestedArray("ps");
+  JsonArray lat = root.createNestedArray(F("lat"));
+  for (int i=0; i<playlistLen; i++) {
+    ps.add(playlistEntries[i].preset);
+    lat.add(playlistEntries[i].lat);
+  }
+}
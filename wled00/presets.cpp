@@ -112,6 +112,9 @@ bool getPresetName(byte index, String& name)
 void initPresetsFile()
 {
   if (WLED_FS.exists(getFileName())) return;
+  #ifdef ARDUINO_ARCH_ESP32
+  if (WLED_FS.rename("/presets.tmp", getFileName())) return; // WLEDMM preset log compaction was cut off after removing the old file
+  #endif
 
   StaticJsonDocument<64> doc;
   JsonObject sObj = doc.to<JsonObject>();
@@ -223,15 +226,35 @@ void handlePresets()
 
   if (force) return; // something went wrong with force option (most likely WS request), quit and wait for async load
 */
-  // allocate buffer
-  if (!requestJSONBufferLock(9)) return;  // will also assign fileDoc
-
-  presetToApply = 0; //clear request for preset
-  callModeToApply = 0;
+  // WLEDMM presets applied before are kept in compiled form, no file access or JSON parsing needed.
+  // The buffer is only held to keep JSON requests from changing segments meanwhile, so never wait for it here:
+  // if a request is using it, the preset is applied on the next loop.
+  if (tmpPreset < 255 && isPresetCompiled(tmpPreset)) {
+    if (!tryRequestJSONBufferLock(9)) return;
+    presetToApply = 0; //clear request for preset
+    callModeToApply = 0;
+    DEBUG_PRINT(F("Applying compiled preset: "));
+    DEBUG_PRINTLN(tmpPreset);
+    if (applyCompiledPreset(tmpPreset, changePreset)) {
+      if (changePreset) currentPreset = tmpPreset;
+      releaseJSONBufferLock();
+      if (changePreset) notify(tmpMode);
+      stateUpdated(tmpMode);
+      updateInterfaces(tmpMode);
+      playlistPresetApplied(tmpPreset);
+      return;
+    }
+  } else {
+    // allocate buffer
+    if (!requestJSONBufferLock(9)) return;  // will also assign fileDoc
+    presetToApply = 0; //clear request for preset
+    callModeToApply = 0;
+  }
   byte presetErrorFlag = ERR_NONE;
 
   DEBUG_PRINT(F("Applying preset: "));
   DEBUG_PRINTLN(tmpPreset);
+  unsigned long presetT0 = micros(); // WLEDMM
 
   #ifdef ARDUINO_ARCH_ESP32
   if (tmpPreset==255 && tmpRAMbuffer!=nullptr) {
@@ -244,6 +267,9 @@ void handlePresets()
     if ((errorFlag == ERR_FS_PLOAD) || (errorFlag == ERR_JSON)) errorFlag = ERR_NONE;  // WLEDMM only reset our own error
     if (presetErrorFlag == ERR_FS_PLOAD) errorFlag = presetErrorFlag;
   }
+  #ifdef WLED_DEBUG
+  unsigned long presetT1 = micros();
+  #endif
   fdo = fileDoc->as<JsonObject>();
 
   //HTTP API commands
@@ -257,11 +283,14 @@ void handlePresets()
     changePreset = true;
   } else {
     if (!fdo["seg"].isNull() || !fdo["on"].isNull() || !fdo["bri"].isNull() || !fdo["nl"].isNull() || !fdo["ps"].isNull() || !fdo[F("playlist")].isNull()) changePreset = true;
+    if (!presetErrorFlag && tmpPreset < 255) compilePreset(tmpPreset, fdo); // WLEDMM before deserializeState() modifies it
     if (!(tmpMode == CALL_MODE_BUTTON_PRESET && fdo["ps"].is<const char *>() && strchr(fdo["ps"].as<const char *>(),'~') != strrchr(fdo["ps"].as<const char *>(),'~')))
       fdo.remove("ps"); // remove load request for presets to prevent recursive crash (if not called by button and contains preset cycling string "1~5~")
     deserializeState(fdo, CALL_MODE_NO_NOTIFY, tmpPreset); // may change presetToApply by calling applyPreset()
+    if (!presetErrorFlag && tmpPreset < 255) recordPresetJsonTime(micros() - presetT0); // WLEDMM
   }
   if (!presetErrorFlag && tmpPreset < 255 && changePreset) currentPreset = tmpPreset;
+  DEBUG_PRINTF("Preset %u: load %lu us, apply %lu us.\n", tmpPreset, presetT1 - presetT0, micros() - presetT1); // WLEDMM
 
   #if defined(ARDUINO_ARCH_ESP32)
   //Aircoookie recommended not to delete buffer
@@ -275,6 +304,7 @@ void handlePresets()
   if (changePreset) notify(tmpMode); // force UDP notification
   stateUpdated(tmpMode);  // was colorUpdated() if anything breaks
   updateInterfaces(tmpMode);
+  playlistPresetApplied(tmpPreset); // WLEDMM
 }
 
 //called from handleSet(PS=) [network callback (fileDoc==nullptr), IR (irrational), deserializeState, UDP] and deserializeState() [network callback (filedoc!=nullptr)]
@@ -0,0 +1,465 @@
+#include "wled.h"
+
+/*
+ * WLEDMM compiled presets: the first time a preset is applied from presets.json, its content is translated into
+ * plain structs (segment bounds, colors, effect, palette, sliders, options) and kept in RAM (PSRAM if available).
+ * Applying it again skips the file read, JSON parsing and key lookups of deserializeState()/deserializeSegment().
+ *
+ * Only presets made of keys listed below are compiled, which covers presets saved from the UI. Anything else
+ * (HTTP API "win", playlists, nightlight, usermod keys, random/relative values like "r" or "~", "i" pixel arrays)
+ * keeps going through JSON. applyPresetBinSegment() uses the same segment helpers as deserializeSegment() (json.cpp).
+ * The cache is dropped whenever presets.json changes.
+ */
+
+#ifndef WLED_DISABLE_PRESET_BIN
+
+#if defined(ARDUINO_ARCH_ESP32) && defined(BOARD_HAS_PSRAM)
+  #define PRESET_BIN_BUDGET_PSRAM (128*1024)
+#endif
+#ifdef ARDUINO_ARCH_ESP32
+  #define PRESET_BIN_BUDGET (16*1024)
+#else
+  #define PRESET_BIN_BUDGET (4*1024)
+#endif
+#define PRESET_BIN_COUNT 251
+
+// members set by a segment entry (PresetBinSeg::has) and values of boolean members (PresetBinSeg::bools)
+#define PBS_ID     0x00000001
+#define PBS_START  0x00000002
+#define PBS_STOP   0x00000004
+#define PBS_STARTY 0x00000008
+#define PBS_STOPY  0x00000010
+#define PBS_NAME   0x00000020
+#define PBS_GRP    0x00000040
+#define PBS_SPC    0x00000080
+#define PBS_OF     0x00000100
+#define PBS_SI     0x00000200
+#define PBS_M12    0x00000400
+#define PBS_SET    0x00000800
+#define PBS_BRI    0x00001000
+#define PBS_CCT    0x00002000
+#define PBS_COL    0x00004000
+#define PBS_FX     0x00008000
+#define PBS_SX     0x00010000
+#define PBS_IX     0x00020000
+#define PBS_PAL    0x00040000
+#define PBS_C1     0x00080000
+#define PBS_C2     0x00100000
+#define PBS_C3     0x00200000
+#define PBS_ON     0x00400000  // from here on: booleans, value in bools
+#define PBS_FRZ    0x00800000
+#define PBS_SEL    0x01000000
+#define PBS_REV    0x02000000
+#define PBS_MI     0x04000000
+#define PBS_RY     0x08000000
+#define PBS_MY     0x10000000
+#define PBS_TP     0x20000000
+#define PBS_O1     0x40000000
+#define PBS_O2     0x80000000  // no bit left for "o3", see PresetBinSeg::o3
+
+typedef struct PresetBinSeg {
+  uint32_t has;
+  uint32_t bools;
+  uint32_t col[3];
+  int      stop;
+  int      offset;
+  uint16_t start, startY, stopY;
+  uint16_t name;      // offset in the name pool
+  uint8_t  colValid;  // bit i: col[i] is set
+  uint8_t  id, grp, spc, si, m12, set, bri, cct, fx, sx, ix, pal, c1, c2, c3;
+  uint8_t  o3;        // 0 = not set, 1 = false, 2 = true
+} PresetBinSeg;
+
+// preset flags
+#define PB_ON         0x0001
+#define PB_ON_VALUE   0x0002
+#define PB_BRI        0x0004
+#define PB_TRANSITION 0x0008
+#define PB_MAINSEG    0x0010
+#define PB_LEDMAP     0x0020
+#define PB_SEG        0x0040
+#define PB_CHANGES    0x0080  // handlePresets() sets currentPreset and notifies
+#define PB_NOT_MATRIX 0x0100  // contains 1D bounds that deserializeSegment() converts on matrix setups
+
+typedef struct PresetBin {
+  size_t   size;      // allocation, including segments and name pool
+  int      transition;
+  uint16_t flags;
+  uint8_t  bri, mainseg, ledmap;
+  uint8_t  segCount;
+  PresetBinSeg seg[]; // followed by the name pool
+} PresetBin;
+
+static PresetBin* presetBin[PRESET_BIN_COUNT] = {nullptr};
+static size_t presetBinBytes = 0;
+static volatile bool presetBinStale = false; // may be set from the web server task
+static uint16_t presetBinCount = 0;
+static uint32_t presetBinRejected[(PRESET_BIN_COUNT + 31) / 32] = {0}; // content that cannot be compiled, or no such preset
+static uint32_t presetBinHits = 0, presetBinMisses = 0;
+static uint32_t presetJsonAvgUs = 0, presetBinAvgUs = 0; // moving averages of load + apply time
+
+void invalidateCompiledPresets() {
+  presetBinStale = true;
+}
+
+static void freeCompiledPresets() {
+  for (size_t i = 0; i < PRESET_BIN_COUNT; i++) {
+    free(presetBin[i]);
+    presetBin[i] = nullptr;
+  }
+  presetBinBytes = 0;
+  presetBinCount = 0;
+  memset(presetBinRejected, 0, sizeof(presetBinRejected));
+  presetBinStale = false;
+}
+
+static bool isPresetRejected(byte index) {
+  return presetBinRejected[index / 32] & (1UL << (index % 32));
+}
+
+// remembers presets that must go through JSON, so prefetching does not read them again until presets.json changes
+static void rejectPreset(byte index) {
+  presetBinRejected[index / 32] |= 1UL << (index % 32);
+}
+
+static size_t presetBinBudget() {
+  #ifdef PRESET_BIN_BUDGET_PSRAM
+  if (psramFound()) return PRESET_BIN_BUDGET_PSRAM;
+  #endif
+  return PRESET_BIN_BUDGET;
+}
+
+static void* presetBinAlloc(size_t size) {
+  #ifdef PRESET_BIN_BUDGET_PSRAM
+  if (psramFound()) return ps_malloc(size);
+  #endif
+  return malloc(size);
+}
+
+// ArduinoJson "value | default" only takes values of the default's type, anything else leaves the member as it is
+template<typename T> static bool takeValue(JsonVariant v, T& out, uint32_t& has, uint32_t bit) {
+  if (!v.is<T>()) return false;
+  out = v.as<T>();
+  has |= bit;
+  return true;
+}
+
+// getVal() semantics for numbers: negative values are ignored, others are truncated to a byte; strings cannot be compiled
+static bool takeByte(JsonVariant v, uint8_t& out, uint32_t& has, uint32_t bit, bool& ok) {
+  if (v.isNull()) return false;
+  if (!v.is<int>()) { if (v.is<const char*>()) ok = false; return false; }
+  if (v.as<int>() < 0) return false;
+  out = v.as<int>();
+  has |= bit;
+  return true;
+}
+
+static void takeBool(JsonVariant v, PresetBinSeg& s, uint32_t bit, bool& ok) {
+  if (v.is<bool>()) {
+    s.has |= bit;
+    if (v.as<bool>()) s.bools |= bit;
+  } else if (v.is<const char*>()) ok = false; // "t" toggles
+}
+
+static bool compileSegment(JsonObject elem, PresetBinSeg& s, char* names, size_t& namePos) {
+  static const char* const known[] = {
+    "id","start","stop","startY","stopY","n","grp","spc","of","si","m12","set","bri","on","frz","cct","col",
+    "sel","rev","mi","rY","mY","tp","fx","sx","ix","pal","c1","c2","c3","o1","o2","o3"
+  };
+  for (JsonPair kv : elem) {
+    bool found = false;
+    for (size_t i = 0; i < sizeof(known)/sizeof(known[0]) && !found; i++) found = !strcmp(kv.key().c_str(), known[i]);
+    if (!found) return false; // len, rpt, i, reset, fxdef, c1x, lx, ...
+  }
+  memset(&s, 0, sizeof(s));
+  bool ok = true;
+  takeValue<uint8_t>(elem["id"], s.id, s.has, PBS_ID);
+  takeValue<uint16_t>(elem["start"], s.start, s.has, PBS_START);
+  takeValue<int>(elem["stop"], s.stop, s.has, PBS_STOP);
+  takeValue<uint16_t>(elem["startY"], s.startY, s.has, PBS_STARTY);
+  takeValue<uint16_t>(elem["stopY"], s.stopY, s.has, PBS_STOPY);
+  if (elem["n"]) { // same test as deserializeSegment(): "", non-strings and names of 32+ chars clear the name
+    const char* name = elem["n"].as<const char*>();
+    size_t len = name ? strlen(name) : 0;
+    if (len >= 32) len = 0;
+    s.has |= PBS_NAME;
+    s.name = namePos;
+    if (names) { if (len) memcpy(names + namePos, name, len); names[namePos + len] = '\0'; }
+    namePos += len + 1;
+  }
+  takeValue<uint8_t>(elem["grp"], s.grp, s.has, PBS_GRP);
+  takeValue<uint8_t>(elem[F("spc")], s.spc, s.has, PBS_SPC);
+  takeValue<int>(elem[F("of")], s.offset, s.has, PBS_OF);
+  takeValue<uint8_t>(elem["si"], s.si, s.has, PBS_SI);
+  takeValue<uint8_t>(elem["m12"], s.m12, s.has, PBS_M12);
+  takeValue<uint8_t>(elem[F("set")], s.set, s.has, PBS_SET);
+  takeByte(elem["bri"], s.bri, s.has, PBS_BRI, ok);
+  takeBool(elem["on"], s, PBS_ON, ok);
+  takeBool(elem["frz"], s, PBS_FRZ, ok);
+  takeValue<uint8_t>(elem["cct"], s.cct, s.has, PBS_CCT);
+
+  JsonArray colarr = elem["col"];
+  if (!colarr.isNull()) {
+    s.has |= PBS_COL;
+    for (size_t i = 0; i < 3; i++)
+      if (colorFromJson(colarr[i], s.col[i])) s.colValid |= 1 << i;
+  }
+
+  takeBool(elem["sel"], s, PBS_SEL, ok);
+  takeBool(elem["rev"], s, PBS_REV, ok);
+  takeBool(elem["mi"], s, PBS_MI, ok);
+  takeBool(elem["rY"], s, PBS_RY, ok);
+  takeBool(elem["mY"], s, PBS_MY, ok);
+  takeBool(elem[F("tp")], s, PBS_TP, ok);
+  takeByte(elem["fx"], s.fx, s.has, PBS_FX, ok);
+  takeByte(elem["sx"], s.sx, s.has, PBS_SX, ok);
+  takeByte(elem["ix"], s.ix, s.has, PBS_IX, ok);
+  takeByte(elem["pal"], s.pal, s.has, PBS_PAL, ok);
+  takeByte(elem["c1"], s.c1, s.has, PBS_C1, ok);
+  takeByte(elem["c2"], s.c2, s.has, PBS_C2, ok);
+  takeByte(elem["c3"], s.c3, s.has, PBS_C3, ok);
+  takeBool(elem["o1"], s, PBS_O1, ok);
+  takeBool(elem["o2"], s, PBS_O2, ok);
+  if (elem["o3"].is<bool>()) s.o3 = elem["o3"].as<bool>() ? 2 : 1;
+  else if (elem["o3"].is<const char*>()) ok = false;
+  return ok;
+}
+
+// called by handlePresets() with the preset content before it is applied; presets containing "ps" are not compiled
+void compilePreset(byte index, JsonObject fdo) {
+  if (presetBinStale) freeCompiledPresets();
+  if (index == 0 || index >= PRESET_BIN_COUNT || presetBin[index] || isPresetRejected(index)) return;
+  unsigned long t0 = micros();
+  for (JsonPair kv : fdo) {
+    const char* key = kv.key().c_str();
+    if (strcmp(key, "on") && strcmp(key, "bri") && strcmp_P(key, PSTR("transition")) && strcmp_P(key, PSTR("mainseg"))
+        && strcmp(key, "seg") && strcmp_P(key, PSTR("ledmap")) && strcmp(key, "n") && strcmp_P(key, PSTR("ql"))) { rejectPreset(index); return; }
+  }
+  uint32_t dummy = 0;
+  uint8_t briCheck;
+  bool ok = fdo["on"].isNull() || fdo["on"].is<bool>(); // "t" toggles
+  takeByte(fdo["bri"], briCheck, dummy, 0, ok);
+  JsonVariant segVar = fdo["seg"];
+  if (!segVar.isNull() && !segVar.is<JsonArray>()) ok = false; // single object applies to selected segments
+  JsonArray segs = segVar.as<JsonArray>();
+  const size_t segCount = segs.isNull() ? 0 : segs.size();
+  if (!ok || segCount > 255) { rejectPreset(index); return; }
+
+  // first pass: validate and measure the name pool
+  PresetBinSeg tmp;
+  size_t namePool = 0;
+  bool notMatrix = false;
+  for (JsonObject elem : segs) {
+    if (elem.isNull() || !compileSegment(elem, tmp, nullptr, namePool)) { rejectPreset(index); return; }
+    if (!elem["start"].isNull() && !elem["stop"].isNull() && elem["startY"].isNull() && elem["stopY"].isNull()) notMatrix = true;
+  }
+  if (notMatrix && strip.isMatrix) return;
+
+  const size_t size = sizeof(PresetBin) + segCount * sizeof(PresetBinSeg) + namePool;
+  if (presetBinBytes + size > presetBinBudget()) return;
+  PresetBin* pb = (PresetBin*) presetBinAlloc(size);
+  if (!pb) return;
+  memset(pb, 0, sizeof(PresetBin));
+  pb->size = size;
+  pb->segCount = segCount;
+  char* names = (char*)&pb->seg[segCount];
+  namePool = 0;
+  size_t i = 0;
+  for (JsonObject elem : segs) compileSegment(elem, pb->seg[i++], names, namePool);
+
+  if (fdo["on"].is<bool>()) pb->flags |= PB_ON | (fdo["on"].as<bool>() ? PB_ON_VALUE : 0);
+  if (takeByte(fdo["bri"], pb->bri, dummy, 0, ok)) pb->flags |= PB_BRI;
+  if (fdo[F("transition")].is<int>() && fdo[F("transition")].as<int>() >= 0) {
+    pb->transition = fdo[F("transition")].as<int>();
+    pb->flags |= PB_TRANSITION;
+  }
+  if (takeValue<uint8_t>(fdo[F("mainseg")], pb->mainseg, dummy, 0)) pb->flags |= PB_MAINSEG;
+  if (takeValue<uint8_t>(fdo[F("ledmap")], pb->ledmap, dummy, 0)) pb->flags |= PB_LEDMAP;
+  if (!segVar.isNull()) pb->flags |= PB_SEG;
+  if (!segVar.isNull() || !fdo["on"].isNull() || !fdo["bri"].isNull()) pb->flags |= PB_CHANGES;
+  if (notMatrix) pb->flags |= PB_NOT_MATRIX;
+
+  presetBin[index] = pb;
+  presetBinBytes += size;
+  presetBinCount++;
+  DEBUG_PRINTF("Preset %u compiled: %u segments, %u bytes in %lu us.\n", index, (unsigned)segCount, (unsigned)size, micros() - t0);
+}
+
+// reads and compiles a preset without applying it, so the next applyPreset() of it needs no file access
+// returns false if the JSON buffer is busy and it should be tried again later
+bool prefetchPreset(byte index) {
+  if (presetBinStale) freeCompiledPresets();
+  if (index == 0 || index >= PRESET_BIN_COUNT || presetBin[index] || isPresetRejected(index)) return true;
+  if (!tryRequestJSONBufferLock(24)) return false; // do not wait, try again on the next loop
+  unsigned long t0 = micros();
+  if (readObjectFromFileUsingId("/presets.json", index, fileDoc)) compilePreset(index, fileDoc->as<JsonObject>());
+  else rejectPreset(index);
+  releaseJSONBufferLock();
+  DEBUG_PRINTF("Preset %u prefetched in %lu us%s.\n", index, micros() - t0, presetBin[index] ? "" : " (not compilable)");
+  return true;
+}
+
+// applies a compiled segment through the same helpers deserializeSegment() uses
+static bool applyPresetBinSegment(const PresetBinSeg& s, const char* names, byte it) {
+  #define HAS(bit) (s.has & (bit))
+  #define BOOLVAL(bit, dflt) (HAS(bit) ? (bool)(s.bools & (bit)) : (dflt))
+  byte id = HAS(PBS_ID) ? s.id : it;
+  if (id >= strip.getMaxSegments()) return false;
+
+  bool newSeg = false;
+  int stop = HAS(PBS_STOP) ? s.stop : -1;
+  if (id >= strip.getSegmentsNum()) {
+    if (stop <= 0) return false; // ignore empty/inactive segments
+    strip.appendSegment(Segment(0, strip.getLengthTotal()));
+    id = strip.getSegmentsNum()-1;
+    newSeg = true;
+  }
+
+  Segment& seg = strip.getSegment(id);
+  Segment prev = seg; // backup to tell what changed
+
+  uint16_t start = HAS(PBS_START) ? s.start : seg.start;
+  if (stop < 0) stop = seg.stop;
+  uint16_t startY = HAS(PBS_STARTY) ? s.startY : seg.startY;
+  uint16_t stopY  = HAS(PBS_STOPY)  ? s.stopY  : seg.stopY;
+
+  if (HAS(PBS_NAME)) setSegmentName(seg, names + s.name);
+  else if (start != seg.start || stop != seg.stop) setSegmentName(seg, nullptr);
+
+  setSegmentGeometry(seg, newSeg, start, stop, startY, stopY,
+                     HAS(PBS_GRP) ? s.grp : seg.grouping, HAS(PBS_SPC) ? s.spc : seg.spacing, HAS(PBS_OF) ? s.offset : INT32_MAX,
+                     HAS(PBS_SI) ? s.si : seg.soundSim, HAS(PBS_M12) ? s.m12 : seg.map1D2D, HAS(PBS_SET) ? s.set : seg.set);
+
+  if (seg.reset && seg.stop == 0) {
+    if (id == strip.getMainSegmentId()) strip.setMainSegmentId(0);
+    return true; // segment was deleted
+  }
+
+  if (HAS(PBS_BRI)) {
+    if (s.bri > 0) seg.setOpacity(s.bri);
+    seg.setOption(SEG_OPTION_ON, s.bri);
+  }
+  seg.setOption(SEG_OPTION_ON, BOOLVAL(PBS_ON, seg.on));
+  seg.freeze = BOOLVAL(PBS_FRZ, seg.freeze);
+  seg.setCCT(HAS(PBS_CCT) ? s.cct : seg.cct);
+
+  if (HAS(PBS_COL)) setSegmentColors(seg, s.col, s.colValid);
+
+  setSegmentOrientation(seg, BOOLVAL(PBS_SEL, seg.selected), BOOLVAL(PBS_REV, seg.reverse), BOOLVAL(PBS_MI, seg.mirror),
+                        BOOLVAL(PBS_RY, seg.reverse_y), BOOLVAL(PBS_MY, seg.mirror_y), BOOLVAL(PBS_TP, seg.transpose));
+
+  if (HAS(PBS_FX) && s.fx != seg.mode) seg.setMode(s.fx, false, false);
+  if (HAS(PBS_SX)) seg.speed = s.sx;
+  if (HAS(PBS_IX)) seg.intensity = s.ix;
+  if (HAS(PBS_PAL) && (seg.getLightCapabilities() & 1)) seg.setPalette(s.pal);
+  if (HAS(PBS_C1)) seg.custom1 = s.c1;
+  if (HAS(PBS_C2)) seg.custom2 = s.c2;
+  if (HAS(PBS_C3)) seg.custom3 = constrain(s.c3, 0, 31);
+  seg.check1 = BOOLVAL(PBS_O1, seg.check1);
+  seg.check2 = BOOLVAL(PBS_O2, seg.check2);
+  if (s.o3) seg.check3 = (s.o3 == 2);
+
+  finishSegmentUpdate(seg, prev);
+  return true;
+  #undef BOOLVAL
+  #undef HAS
+}
+
+// compiled form of a preset that applies to this setup, nullptr if there is none
+static const PresetBin* compiledPreset(byte index) {
+  if (presetBinStale) freeCompiledPresets();
+  if (index == 0 || index >= PRESET_BIN_COUNT) return nullptr;
+  const PresetBin* pb = presetBin[index];
+  if (!pb || ((pb->flags & PB_NOT_MATRIX) && strip.isMatrix)) return nullptr;
+  return pb;
+}
+
+// true if applyCompiledPreset() can apply the preset, counts a miss otherwise
+bool isPresetCompiled(byte index) {
+  if (compiledPreset(index)) return true;
+  presetBinMisses++;
+  return false;
+}
+
+// applies a compiled preset like deserializeState(fdo, CALL_MODE_NO_NOTIFY, index) would; false if it is not compiled
+bool applyCompiledPreset(byte index, bool& changePreset) {
+  const PresetBin* pb = compiledPreset(index);
+  if (!pb) return false;
+  unsigned long t0 = micros();
+
+  bool onBefore = bri;
+  if (pb->flags & PB_BRI) bri = pb->bri;
+  bool on = (pb->flags & PB_ON) ? (pb->flags & PB_ON_VALUE) : (bri > 0);
+  if (!on != !bri) toggleOnOff();
+  if (bri && !onBefore) { // unfreeze all segments when turning on
+    for (size_t s=0; s < strip.getSegmentsNum(); s++) strip.getSegment(s).freeze = false;
+    if (realtimeMode && !realtimeOverride && useMainSegmentOnly) strip.getMainSegment().freeze = true;
+  }
+  if ((pb->flags & PB_TRANSITION) && currentPlaylist < 0) { // playlist transition times take precedence
+    transitionDelay = pb->transition;
+    transitionDelay *= 100;
+    transitionDelayTemp = transitionDelay;
+  }
+
+  suspendStripService = true; // lock out strip updates while segments change
+  if (strip.isServicing()) strip.waitUntilIdle();
+  strip.setTransition(transitionDelayTemp);
+
+  if (!realtimeMode) strip.setMainSegmentId((pb->flags & PB_MAINSEG) ? pb->mainseg : strip.getMainSegmentId());
+  if (realtimeMode && useMainSegmentOnly) strip.getMainSegment().freeze = !realtimeOverride;
+
+  const char* names = (const char*)&pb->seg[pb->segCount];
+  size_t deleted = 0;
+  for (size_t i = 0; i < pb->segCount; i++) {
+    const PresetBinSeg& s = pb->seg[i];
+    if (applyPresetBinSegment(s, names, i) && (s.has & PBS_STOP) && s.stop == 0) deleted++;
+  }
+  if (strip.getSegmentsNum() > 3 && deleted >= strip.getSegmentsNum()/2U) strip.purgeSegments();
+
+  // usermods see the top level keys of the preset, as from deserializeState(); usermod keys are never compiled
+  StaticJsonDocument<JSON_OBJECT_SIZE(6) + 32> umDoc; // + copies of the flash string keys
+  JsonObject umRoot = umDoc.to<JsonObject>();
+  if (pb->flags & PB_ON) umRoot["on"] = (bool)(pb->flags & PB_ON_VALUE);
+  if (pb->flags & PB_BRI) umRoot["bri"] = pb->bri;
+  if (pb->flags & PB_TRANSITION) umRoot[F("transition")] = pb->transition;
+  if (pb->flags & PB_MAINSEG) umRoot[F("mainseg")] = pb->mainseg;
+  if (pb->flags & PB_LEDMAP) umRoot[F("ledmap")] = pb->ledmap;
+  usermods.readFromJsonState(umRoot);
+
+  if (pb->flags & PB_LEDMAP) loadedLedmap = pb->ledmap;
+  loadLedmap = loadedLedmap>=0;
+
+  stateUpdated(CALL_MODE_NO_NOTIFY);
+  suspendStripService = false;
+
+  changePreset = pb->flags & PB_CHANGES;
+  presetBinHits++;
+  unsigned long t = micros() - t0;
+  presetBinAvgUs = presetBinAvgUs ? (presetBinAvgUs * 7 + t) / 8 : t;
+  DEBUG_PRINTF("Preset %u applied from compiled form in %lu us.\n", index, t);
+  return true;
+}
+
+// load + apply time of presets that went through JSON, for comparison with compiled ones
+void recordPresetJsonTime(unsigned long us) {
+  presetJsonAvgUs = presetJsonAvgUs ? (presetJsonAvgUs * 7 + us) / 8 : us;
+}
+
+void serializePresetBinStats(JsonObject root) {
+  root["n"] = presetBinCount;
+  root[F("bytes")] = presetBinBytes;
+  root[F("hit")] = presetBinHits;
+  root[F("miss")] = presetBinMisses;
+  root[F("json")] = presetJsonAvgUs;  // us, file read + parse + deserializeState()
+  root[F("bin")] = presetBinAvgUs;    // us, compiled apply
+}
+
+#else
+void invalidateCompiledPresets() {}
+void compilePreset(byte, JsonObject) {}
+bool isPresetCompiled(byte) { return false; }
+bool applyCompiledPreset(byte, bool&) { return false; }
+bool prefetchPreset(byte) { return true; }
+void recordPresetJsonTime(unsigned long) {}
+void serializePresetBinStats(JsonObject) {}
+#endif
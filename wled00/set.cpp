@@ -20,6 +20,7 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
 
   //0: menu 1: wifi 2: leds 3: ui 4: sync 5: time 6: sec 7: DMX 8: usermods 9: N/A 10: 2D
   if (subPage <1 || subPage >10 || !correctPIN) return;
+  configRevision++; // WLEDMM invalidates cached settings.js
 
   // WLEDMM: before changing bus, ledmap, strip or 2D settings, make sure our strip is _not_ servicing effects in parallel
   if ((subPage == 2) || (subPage == 3) || (subPage == 10)) {
@@ -346,6 +347,9 @@ void handleSettingsSet(AsyncWebServerRequest *request, byte subPage)
     receiveDirect = request->hasArg(F("RD"));
     useMainSegmentOnly = request->hasArg(F("MO"));
     e131SkipOutOfSequence = request->hasArg(F("ES"));
+    e131FrameSync = request->hasArg(F("EF"));
+    t = request->arg(F("EFT")).toInt();
+    if (t >= 5 && t <= 1000) e131FrameTimeout = t;
     e131Multicast = request->hasArg(F("EM"));
     t = request->arg(F("EP")).toInt();
     if (t > 0) e131Port = t;
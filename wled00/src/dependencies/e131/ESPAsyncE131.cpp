@@ -110,8 +110,15 @@ void ESPAsyncE131::parsePacket(AsyncUDPPacket _packet) {
 	if (protocol == P_ARTNET) {
 		if (memcmp(sbuff->art_id, ESPAsyncE131::ART_ID, sizeof(sbuff->art_id)))
 			error = true; //not "Art-Net"
-		if (sbuff->art_opcode != ARTNET_OPCODE_OPDMX && sbuff->art_opcode != ARTNET_OPCODE_OPPOLL)
-			error = true; //not a DMX or poll packet
+		if (sbuff->art_opcode != ARTNET_OPCODE_OPDMX && sbuff->art_opcode != ARTNET_OPCODE_OPPOLL && sbuff->art_opcode != ARTNET_OPCODE_OPSYNC)
+			error = true; //not a DMX, poll or sync packet
+		else if (sbuff->art_opcode == ARTNET_OPCODE_OPSYNC)
+			protocol = P_ARTNET_SYNC;
+	} else if (htonl(sbuff->root_vector) == E131_VECTOR_ROOT_EXTENDED) { //E1.31 extended packet
+		if (htonl(sbuff->sync_vector) == E131_VECTOR_EXTENDED_SYNC)
+			protocol = P_E131_SYNC;
+		else
+			error = true; //universe discovery is not supported
 	} else { //E1.31 error handling
 		if (htonl(sbuff->root_vector) != ESPAsyncE131::VECTOR_ROOT)
 			error = true;
@@ -126,6 +133,12 @@ void ESPAsyncE131::parsePacket(AsyncUDPPacket _packet) {
   if (error && _packet.localPort() == DDP_DEFAULT_PORT) { //DDP packet
     error = false;
     protocol = P_DDP;
+    // WLEDMM the header must fit in the received packet, a dataLen beyond the packet is clamped to the received data
+    size_t headerLen = (sbuff->flags & DDP_TIMECODE_FLAG) ? 14 : 10;
+    if (_packet.length() < headerLen)
+      error = true;
+    else if (headerLen + htons(sbuff->dataLen) > _packet.length())
+      sbuff->dataLen = htons(_packet.length() - headerLen);
   }
 
   if (!error) {
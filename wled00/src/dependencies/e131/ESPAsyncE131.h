@@ -55,14 +55,23 @@ typedef struct ip_addr ip4_addr_t;
 
 #define DDP_TYPE_RGB24  0x0B // 00 001 011 (RGB , 8 bits per channel, 3 channels)
 #define DDP_TYPE_RGBW32 0x1B // 00 011 011 (RGBW, 8 bits per channel, 4 channels)
+#define DDP_TYPE_CUSTOM 0x80 // 1x xxx xxx (customer defined)
+#define DDP_TYPE_COMPRESSED_RGB  0x8B // 10 001 011 (WLED compressed RGB, see ddp_codec.h)
+#define DDP_TYPE_COMPRESSED_RGBW 0x9B // 10 011 011 (WLED compressed RGBW)
 
 #define ARTNET_OPCODE_OPDMX 0x5000
 #define ARTNET_OPCODE_OPPOLL 0x2000
 #define ARTNET_OPCODE_OPPOLLREPLY 0x2100
+#define ARTNET_OPCODE_OPSYNC 0x5200
+
+#define E131_VECTOR_ROOT_EXTENDED 0x00000008  // E1.31-2016: extended (synchronization / discovery) packet
+#define E131_VECTOR_EXTENDED_SYNC 0x00000001  // E1.31-2016: universe synchronization packet
 
 #define P_E131   0
 #define P_ARTNET 1
 #define P_DDP    2
+#define P_E131_SYNC   3   // E1.31 universe synchronization packet
+#define P_ARTNET_SYNC 4   // ArtSync packet
 
 // E1.31 Packet Offsets
 #define E131_ROOT_PREAMBLE_SIZE 0
@@ -105,7 +114,7 @@ typedef union {
       uint32_t frame_vector;
       uint8_t  source_name[64];
       uint8_t  priority;
-      uint16_t reserved;
+      uint16_t sync_address;    // E1.31-2016 synchronization universe (0 = not synchronized), "reserved" in E1.31-2009
       uint8_t  sequence_number;
       uint8_t  options;
       uint16_t universe;
@@ -132,6 +141,15 @@ typedef union {
     uint8_t  art_data[512];
   } __attribute__((packed));
 
+  struct { //E1.31 synchronization packet (E1.31-2016: 6.3)
+      uint8_t  sync_root_layer[38];
+      uint16_t sync_flength;
+      uint32_t sync_vector;
+      uint8_t  sync_sequence_number;
+      uint16_t sync_universe;
+      uint16_t sync_reserved;
+  } __attribute__((packed));
+
   struct { //DDP Header
     uint8_t flags;
     uint8_t sequenceNum;
@@ -1,4 +1,6 @@
 #include "wled.h"
+#include <atomic>
+#include <new>
 
 /*
  * UDP sync notifier / Realtime / Hyperion / TPM2.NET
@@ -141,10 +143,7 @@ void notify(byte callMode, bool followUp)
   IPAddress broadcastIp;
   broadcastIp = ~uint32_t(Network.subnetMask()) | uint32_t(Network.gatewayIP());
 
-  if (0 != notifierUdp.beginPacket(broadcastIp, udpPort)) { // WLEDMM beginPacket == 0 --> error
-    notifierUdp.write(udpOut, WLEDPACKETSIZE);
-    notifierUdp.endPacket();
-  }
+  notifierUdp.writeTo(udpOut, WLEDPACKETSIZE, broadcastIp, udpPort);
   notificationSentCallMode = callMode;
   notificationSentTime = millis();
   notificationCount = followUp ? notificationCount + 1 : 0;
@@ -205,30 +204,112 @@ void exitRealtime() {
 
 #define TMP2NET_OUT_PORT 65442
 
-void sendTPM2Ack() {
-  if (0 != notifierUdp.beginPacket(notifierUdp.remoteIP(), TMP2NET_OUT_PORT)) {  // WLEDMM beginPacket == 0 --> error
-    uint8_t response_ack = 0xac;
-    notifierUdp.write(&response_ack, 1);
-    notifierUdp.endPacket();
+void sendTPM2Ack(IPAddress client) {
+  uint8_t response_ack = 0xac;
+  notifierUdp.writeTo(&response_ack, 1, client, TMP2NET_OUT_PORT);
+}
+
+/*
+ * UDP receive queue
+ * Packets for the notifier, node info and raw RGB (Hyperion) ports are received by AsyncUDP callbacks
+ * (network task on ESP32, SYS context on ESP8266) and queued for the main loop. The queue is a
+ * single-producer/single-consumer ring: only the network callbacks advance udpRxHead and only
+ * handleNotifications() advances udpRxTail, so no lock is needed.
+ */
+#define UDP_RX_NOTIFIER  0
+#define UDP_RX_NOTIFIER2 1
+#define UDP_RX_RGB       2
+
+#define UDP_RX_BATCH     WLED_UDP_RX_QUEUE_LEN // max. packets handled per main loop iteration
+
+typedef struct UdpRxSlot {
+  unsigned long rxTime;             // micros() when the packet arrived
+  IPAddress     remoteIP;
+  uint16_t      len;
+  uint8_t       source;             // UDP_RX_NOTIFIER, UDP_RX_NOTIFIER2 or UDP_RX_RGB
+  uint8_t       data[UDP_IN_MAXSIZE+1];
+} udp_rx_slot_t;
+
+static_assert((WLED_UDP_RX_QUEUE_LEN & (WLED_UDP_RX_QUEUE_LEN - 1)) == 0, "WLED_UDP_RX_QUEUE_LEN must be a power of 2");
+
+static udp_rx_slot_t* udpRxQueue = nullptr;
+static std::atomic<uint8_t> udpRxHead(0);   // next slot to write (network task)
+static std::atomic<uint8_t> udpRxTail(0);   // next slot to read (main loop)
+
+// discard unread packets (main loop only)
+void flushUdpRxQueue() {
+  udpRxTail.store(udpRxHead.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+uint8_t getUdpRxQueueDepth() {
+  return udpRxHead.load(std::memory_order_acquire) - udpRxTail.load(std::memory_order_acquire);
+}
+
+static void queueUdpPacket(AsyncUDPPacket& packet, uint8_t source) {
+  size_t len = packet.length();
+  if (len == 0 || len > UDP_IN_MAXSIZE || !udpRxQueue) return;
+  if (source == UDP_RX_RGB && !receiveDirect) return;
+  if (source != UDP_RX_RGB && !(receiveNotifications || receiveDirect)) return;
+
+  uint8_t head = udpRxHead.load(std::memory_order_relaxed);
+  uint8_t depth = head - udpRxTail.load(std::memory_order_acquire);
+  if (depth >= WLED_UDP_RX_QUEUE_LEN) { udpRxDropped++; return; } // main loop is behind
+  if (depth + 1 > udpRxMaxDepth) udpRxMaxDepth = depth + 1;
+
+  udp_rx_slot_t& slot = udpRxQueue[head & (WLED_UDP_RX_QUEUE_LEN - 1)];
+  slot.rxTime   = micros();
+  slot.remoteIP = packet.remoteIP();
+  slot.len      = len;
+  slot.source   = source;
+  memcpy(slot.data, packet.data(), len);
+  udpRxHead.store(head + 1, std::memory_order_release);
+}
+
+static bool initUdpRxQueue() {
+  if (udpRxQueue) return true;
+  #if defined(ARDUINO_ARCH_ESP32) && defined(BOARD_HAS_PSRAM)
+  if (psramFound()) udpRxQueue = (udp_rx_slot_t*) ps_malloc(WLED_UDP_RX_QUEUE_LEN * sizeof(udp_rx_slot_t));
+  else
+  #endif
+  udpRxQueue = (udp_rx_slot_t*) malloc(WLED_UDP_RX_QUEUE_LEN * sizeof(udp_rx_slot_t));
+  if (!udpRxQueue) {
+    USER_PRINTLN(F("UDP receive queue: not enough memory."));
+    return false;
   }
+  for (size_t i = 0; i < WLED_UDP_RX_QUEUE_LEN; i++) new (&udpRxQueue[i].remoteIP) IPAddress();
+  udpRxHead.store(0); udpRxTail.store(0);
+  return true;
 }
 
-#ifdef ARDUINO_ARCH_ESP32
-// WLEDMM don't use dynamic arrays for receiving UDP. ESP32 has enough RAM, and handleNotifications() is only called from main loop, so one static buffer should be enough.
-static uint8_t lbuf[UDP_IN_MAXSIZE+1];
-static uint8_t udpIn[UDP_IN_MAXSIZE+1];
-// WLEDMM end
-#endif
+// start listening on notifier, raw RGB and node info ports (called from initInterfaces / initAP)
+void initUdpReceivers(bool withRgb, bool withSupp) {
+  udpConnected = udpRgbConnected = udp2Connected = false;
+  if (!initUdpRxQueue()) return;
+  notifierUdp.close(); rgbUdp.close(); notifier2Udp.close();
+  udpConnected = notifierUdp.listen(udpPort);
+  if (!udpConnected) return;
+  notifierUdp.onPacket([](AsyncUDPPacket& packet) { queueUdpPacket(packet, UDP_RX_NOTIFIER); });
+  if (withRgb) {
+    udpRgbConnected = rgbUdp.listen(udpRgbPort);
+    if (udpRgbConnected) rgbUdp.onPacket([](AsyncUDPPacket& packet) { queueUdpPacket(packet, UDP_RX_RGB); });
+  }
+  if (withSupp) {
+    udp2Connected = notifier2Udp.listen(udpPort2);
+    if (udp2Connected) notifier2Udp.onPacket([](AsyncUDPPacket& packet) { queueUdpPacket(packet, UDP_RX_NOTIFIER2); });
+  }
+}
+
+static void handleUdpPacket(udp_rx_slot_t& pkt, bool& showPending);
 
 void handleNotifications()
 {
-  IPAddress localIP;
-
   //send second notification if enabled
   if(udpConnected && (notificationCount < udpNumRetries) && ((millis()-notificationSentTime) > 250)){
     notify(notificationSentCallMode,true);
   }
 
+  handleE131FrameTimeout();
+
   if (e131NewData && millis() - strip.getLastShow() > 15)
   {
     e131NewData = false;
@@ -239,86 +320,65 @@ void handleNotifications()
   if (realtimeMode && millis() > realtimeTimeout) exitRealtime();
 
   //receive UDP notifications
-  if (!udpConnected) return;
+  if (!udpConnected || !udpRxQueue) return;
+
+  // drain the receive queue; realtime frames received in one batch are shown once
+  bool showPending = false;
+  unsigned long firstRx = 0;
+  for (size_t n = 0; n < UDP_RX_BATCH; n++) {
+    uint8_t tail = udpRxTail.load(std::memory_order_relaxed);
+    if (tail == udpRxHead.load(std::memory_order_acquire)) break; // queue empty
+    udp_rx_slot_t& pkt = udpRxQueue[tail & (WLED_UDP_RX_QUEUE_LEN - 1)];
+    bool wasPending = showPending;
+    handleUdpPacket(pkt, showPending);
+    if (showPending && !wasPending) firstRx = pkt.rxTime;
+    udpRxTail.store(tail + 1, std::memory_order_release);
+  }
 
-  bool isSupp = false;
-#ifdef ARDUINO_ARCH_ESP32
-  notifierUdp.flush();
-#endif
-  int packetSize = notifierUdp.parsePacket();    // WLEDMM function returns int, not size_t
-  if ((packetSize < 1) && udp2Connected) {
-#ifdef ARDUINO_ARCH_ESP32
-    notifier2Udp.flush();
-#endif
-    packetSize = notifier2Udp.parsePacket();
-    isSupp = true;
+  if (showPending) {
+    strip.show();
+    unsigned long latency = micros() - firstRx;
+    udpRxLatency = (udpRxLatency * 7 + latency) / 8; // smoothed receive-to-show latency
+    if (latency > udpRxLatencyMax) udpRxLatencyMax = latency;
   }
-  if (packetSize < 1) packetSize = 0; // WLEDMM
+}
+
+static void handleUdpPacket(udp_rx_slot_t& pkt, bool& showPending)
+{
+  uint8_t* udpIn = pkt.data;
+  int packetSize = pkt.len;
+  bool isSupp = (pkt.source == UDP_RX_NOTIFIER2);
 
   //hyperion / raw RGB
-  if (!packetSize && udpRgbConnected) {
-#ifdef ARDUINO_ARCH_ESP32
-    rgbUdp.flush();
-#endif
-    packetSize = rgbUdp.parsePacket();
-    if (packetSize) {
-#ifdef ARDUINO_ARCH_ESP32
-      if (!receiveDirect) {rgbUdp.flush(); notifierUdp.flush(); notifier2Udp.flush(); return;}
-      if (packetSize > UDP_IN_MAXSIZE || packetSize < 3) {rgbUdp.flush(); notifierUdp.flush(); notifier2Udp.flush(); return;}
-#else
-      if (!receiveDirect) {return;}
-      if (packetSize > UDP_IN_MAXSIZE || packetSize < 3) {return;}
-#endif
-      realtimeIP = rgbUdp.remoteIP();
-      DEBUG_PRINTLN(rgbUdp.remoteIP());
-      #ifndef ARDUINO_ARCH_ESP32
-      uint8_t lbuf[packetSize+1]; // WLEDMM: use global buffer on ESP32
-      #endif
-      rgbUdp.read(lbuf, packetSize);
-      realtimeLock(realtimeTimeoutMs, REALTIME_MODE_HYPERION);
-#ifdef ARDUINO_ARCH_ESP32
-      if (realtimeOverride && !(realtimeMode && useMainSegmentOnly)) {notifierUdp.flush(); notifier2Udp.flush(); return;}
-#else
-      if (realtimeOverride && !(realtimeMode && useMainSegmentOnly)) {return;}
-#endif
-      uint16_t id = 0;
-      uint16_t totalLen = strip.getLengthTotal();
-      for (int i = 0; i < packetSize -2; i += 3)
-      {
-        setRealtimePixel(id, lbuf[i], lbuf[i+1], lbuf[i+2], 0);
-        id++; if (id >= totalLen) break;
-      }
-      if (!(realtimeMode && useMainSegmentOnly)) strip.show();
-      return;
+  if (pkt.source == UDP_RX_RGB) {
+    if (!receiveDirect) return;
+    if (packetSize < 3) return;
+    realtimeIP = pkt.remoteIP;
+    DEBUG_PRINTLN(realtimeIP);
+    realtimeLock(realtimeTimeoutMs, REALTIME_MODE_HYPERION);
+    if (realtimeOverride && !(realtimeMode && useMainSegmentOnly)) return;
+    uint16_t id = 0;
+    uint16_t totalLen = strip.getLengthTotal();
+    for (int i = 0; i < packetSize -2; i += 3)
+    {
+      setRealtimePixel(id, udpIn[i], udpIn[i+1], udpIn[i+2], 0);
+      id++; if (id >= totalLen) break;
     }
+    if (!(realtimeMode && useMainSegmentOnly)) showPending = true;
+    return;
   }
 
-#ifdef ARDUINO_ARCH_ESP32
-  if (!(receiveNotifications || receiveDirect)) {notifierUdp.flush(); notifier2Udp.flush(); return;}
-#else
-  if (!(receiveNotifications || receiveDirect)) {return;}
-#endif
+  if (!(receiveNotifications || receiveDirect)) return;
 
-  localIP = Network.localIP();
   //notifier and UDP realtime
-#ifdef ARDUINO_ARCH_ESP32
-  if (!packetSize || packetSize > UDP_IN_MAXSIZE) {notifierUdp.flush(); notifier2Udp.flush(); return;}
-  if (!isSupp && notifierUdp.remoteIP() == localIP) {notifierUdp.flush(); notifier2Udp.flush(); return;} //don't process broadcasts we send ourselves
-#else
-  if (!packetSize || packetSize > UDP_IN_MAXSIZE) {return;}
-  if (!isSupp && notifierUdp.remoteIP() == localIP) {return;} //don't process broadcasts we send ourselves
-#endif
+  IPAddress localIP = Network.localIP();
+  if (!isSupp && pkt.remoteIP == localIP) return; //don't process broadcasts we send ourselves
 
-  #ifndef ARDUINO_ARCH_ESP32
-  uint8_t udpIn[packetSize +1];  // WLEDMM: use global buffer on ESP32
-  #endif
-  uint16_t len;
-  if (isSupp) len = notifier2Udp.read(udpIn, packetSize);
-  else        len =  notifierUdp.read(udpIn, packetSize);
+  uint16_t len = packetSize;
 
   // WLED nodes info notifications
   if (isSupp && udpIn[0] == 255 && udpIn[1] == 1 && len >= 40) {
-    if (!nodeListEnabled || notifier2Udp.remoteIP() == localIP) return;
+    if (!nodeListEnabled || pkt.remoteIP == localIP) return;
 
     uint8_t unit = udpIn[39];
     NodesMap::iterator it = Nodes.find(unit);
@@ -515,11 +575,11 @@ void handleNotifications()
     //if the number of LEDs in your installation doesn't allow that, please include padding bytes at the end of the last packet
     byte tpmType = udpIn[1];
     if (tpmType == 0xaa) { //TPM2.NET polling, expect answer
-      sendTPM2Ack(); return;
+      sendTPM2Ack(pkt.remoteIP); return;
     }
     if (tpmType != 0xda) return; //return if notTPM2.NET data
 
-    realtimeIP = (isSupp) ? notifier2Udp.remoteIP() : notifierUdp.remoteIP();
+    realtimeIP = pkt.remoteIP;
     realtimeLock(realtimeTimeoutMs, REALTIME_MODE_TPM2NET);
     if (realtimeOverride && !(realtimeMode && useMainSegmentOnly)) return;
 
@@ -542,7 +602,7 @@ void handleNotifications()
     if (tpmPacketCount == numPackets) //reset packet count and show if all packets were received
     {
       tpmPacketCount = 0;
-      strip.show();
+      showPending = true;
     }
     return;
   }
@@ -550,7 +610,7 @@ void handleNotifications()
   //UDP realtime: 1 warls 2 drgb 3 drgbw
   if (udpIn[0] > 0 && udpIn[0] < 5)
   {
-    realtimeIP = (isSupp) ? notifier2Udp.remoteIP() : notifierUdp.remoteIP();
+    realtimeIP = pkt.remoteIP;
     DEBUG_PRINTLN(realtimeIP);
     if (packetSize < 2) return;
 
@@ -607,7 +667,7 @@ void handleNotifications()
         id++;
       }
     }
-    strip.show();
+    showPending = true;
     return;
   }
 
@@ -719,11 +779,7 @@ void sendSysInfoUDP()
   for (size_t i=0; i<sizeof(uint32_t); i++)
     data[40+i] = (build>>(8*i)) & 0xFF;
 
-  IPAddress broadcastIP(255, 255, 255, 255);
-  if (0 != notifier2Udp.beginPacket(broadcastIP, udpPort2)) {  // WLEDMM beginPacket == 0 --> error
-    notifier2Udp.write(data, sizeof(data));
-    notifier2Udp.endPacket();
-  }
+  notifier2Udp.broadcastTo(data, sizeof(data), udpPort2);
 }
 
 
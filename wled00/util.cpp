@@ -1,6 +1,7 @@
 #include "wled.h"
 #include "fcn_declare.h"
 #include "const.h"
+#include <atomic>  // WLEDMM JSON command queue
 
 
 //helper to get int value at a position in string
@@ -147,6 +148,106 @@ bool oappendi(int i)
 static bool squeezeStrings = false;
 void oappendUseDeflate(bool OnOff) { squeezeStrings = OnOff; }
 
+// WLEDMM settings.js output is collected in a list of small blocks instead of one SETTINGS_STACK_BUF_SIZE buffer,
+// so large configurations are neither truncated nor need a big allocation (or async_tcp stack).
+// obuf/olen point into the last block; when it is full the last OAPPEND_KEEP bytes move to the next block,
+// so callers can still step back with "olen -= 2".
+#define OAPPEND_BLOCK_SIZE 1024
+#define OAPPEND_KEEP 16
+struct OappendBlock {
+  OappendBlock* next;
+  uint16_t      len;
+  char          data[OAPPEND_BLOCK_SIZE+1];
+};
+static OappendBlock *oblockFirst = nullptr, *oblockLast = nullptr;
+static bool oblockFailed = false;
+
+static OappendBlock* oappendNewBlock()
+{
+  OappendBlock* block = nullptr;
+  #if defined(ARDUINO_ARCH_ESP32) && defined(BOARD_HAS_PSRAM)
+  if (psramFound()) block = (OappendBlock*) ps_malloc(sizeof(OappendBlock)); else
+  #endif
+  block = (OappendBlock*) malloc(sizeof(OappendBlock));
+  if (!block) {
+    USER_PRINTLN(F("oappend() error: no memory for next block."));
+    errorFlag = ERR_LOW_AJAX_MEM;
+    oblockFailed = true;
+    return nullptr;
+  }
+  block->next = nullptr;
+  block->len = 0;
+  block->data[0] = '\0';
+  return block;
+}
+
+bool oappendBegin()
+{
+  oappendFree(oblockFirst); // leftover from an aborted run
+  oblockFailed = false;
+  oblockFirst = oblockLast = oappendNewBlock();
+  obuf = oblockFirst ? oblockFirst->data : nullptr;
+  olen = 0;
+  return oblockFirst != nullptr;
+}
+
+OappendBlock* oappendEnd(bool &complete)
+{
+  OappendBlock* blocks = oblockFirst;
+  if (oblockLast) oblockLast->len = olen;
+  complete = !oblockFailed;
+  oblockFirst = oblockLast = nullptr;
+  obuf = nullptr;
+  olen = 0;
+  return blocks;
+}
+
+// copies output starting at index (bytes already sent), for chunked responses
+size_t oappendRead(const OappendBlock* blocks, uint8_t* buf, size_t maxLen, size_t index)
+{
+  size_t n = 0;
+  for (const OappendBlock* block = blocks; block && n < maxLen; block = block->next) {
+    if (index >= block->len) { index -= block->len; continue; }
+    size_t k = min((size_t)(block->len - index), maxLen - n);
+    memcpy(buf + n, block->data + index, k);
+    n += k;
+    index = 0;
+  }
+  return n;
+}
+
+void oappendFree(OappendBlock* blocks)
+{
+  while (blocks) {
+    OappendBlock* next = blocks->next;
+    free(blocks);
+    blocks = next;
+  }
+}
+
+static bool oappendBlocks(const char* txt, size_t len)
+{
+  while (len) {
+    if (olen >= OAPPEND_BLOCK_SIZE) {
+      OappendBlock* block = oblockFailed ? nullptr : oappendNewBlock();
+      if (!block) return false;
+      memcpy(block->data, obuf + olen - OAPPEND_KEEP, OAPPEND_KEEP); // keep tail for "olen -= x"
+      oblockLast->len = olen - OAPPEND_KEEP;
+      oblockLast->next = block;
+      oblockLast = block;
+      obuf = block->data;
+      olen = OAPPEND_KEEP;
+    }
+    size_t k = min(len, (size_t)(OAPPEND_BLOCK_SIZE - olen));
+    memcpy(obuf + olen, txt, k);
+    olen += k;
+    obuf[olen] = '\0';
+    txt += k;
+    len -= k;
+  }
+  return true;
+}
+
 bool oappend(const char* txt)
 {
   String str = squeezeStrings ? String(txt) : String("");
@@ -160,6 +261,7 @@ bool oappend(const char* txt)
   const char* finalTxt = squeezeStrings ? str.c_str() : txt;
 
   size_t len = strlen(finalTxt);
+  if (oblockLast && obuf == oblockLast->data) return oappendBlocks(finalTxt, len); // WLEDMM
   if ((obuf == nullptr) || (olen + len >= SETTINGS_STACK_BUF_SIZE)) { // sanity checks
 	  if (obuf == nullptr) { USER_PRINTLN(F("oappend() error: obuf == nullptr."));
 	  } else {
@@ -212,6 +314,33 @@ bool isAsterisksOnly(const char* str, byte maxLen)
 }
 
 
+//threading/network callback details: https://github.com/Aircoookie/WLED/pull/2336#discussion_r762276994
+// WLEDMM lock wait statistics per module id (the argument of requestJSONBufferLock(), 255 and above share the last slot)
+#define JSON_LOCK_MODULES 32
+static uint16_t jsonLockWaitMax[JSON_LOCK_MODULES] = {0};   // ms
+static uint32_t jsonLockWaitSum[JSON_LOCK_MODULES] = {0};   // ms
+static uint16_t jsonLockCount[JSON_LOCK_MODULES] = {0};     // waits longer than 0 ms
+static uint16_t jsonLockFailed[JSON_LOCK_MODULES] = {0};
+static uint32_t jsonQueued = 0, jsonArenaUses = 0;
+
+static void recordJSONLockWait(uint8_t module, unsigned long waited, bool failed) {
+  const uint8_t m = min(module, uint8_t(JSON_LOCK_MODULES-1));
+  if (failed) jsonLockFailed[m]++;
+  if (waited == 0) return;
+  jsonLockWaitMax[m] = max(jsonLockWaitMax[m], (uint16_t)min(waited, 65535UL));
+  jsonLockWaitSum[m] += waited;
+  jsonLockCount[m]++;
+}
+
+static void lockJSONBuffer(uint8_t module) {
+  jsonBufferLock = module ? module : 255;
+  DEBUG_PRINT(F("JSON buffer locked. ("));
+  DEBUG_PRINT(jsonBufferLock);
+  DEBUG_PRINTLN(")");
+  fileDoc = &doc;  // used for applying presets (presets.cpp)
+  doc.clear();
+}
+
 //threading/network callback details: https://github.com/Aircoookie/WLED/pull/2336#discussion_r762276994
 bool requestJSONBufferLock(uint8_t module)
 {
@@ -223,18 +352,22 @@ bool requestJSONBufferLock(uint8_t module)
     USER_PRINT(F("ERROR: Locking JSON buffer failed! (still locked by "));
     USER_PRINT(jsonBufferLock);
     USER_PRINTLN(")");
+    recordJSONLockWait(module, millis()-now, true);
     return false; // waiting time-outed
   }
+  recordJSONLockWait(module, millis()-now, false);
 
-  jsonBufferLock = module ? module : 255;
-  DEBUG_PRINT(F("JSON buffer locked. ("));
-  DEBUG_PRINT(jsonBufferLock);
-  DEBUG_PRINTLN(")");
-  fileDoc = &doc;  // used for applying presets (presets.cpp)
-  doc.clear();
+  lockJSONBuffer(module);
   return true;
 }
 
+// WLEDMM same as requestJSONBufferLock() but returns immediately if the buffer is in use
+bool tryRequestJSONBufferLock(uint8_t module)
+{
+  if (jsonBufferLock) return false;
+  lockJSONBuffer(module);
+  return true;
+}
 
 void releaseJSONBufferLock()
 {
@@ -245,6 +378,143 @@ void releaseJSONBufferLock()
   jsonBufferLock = 0;
 }
 
+// WLEDMM pool of additional JSON arenas in PSRAM, used for API responses (serveJson()) that are sent after serialization.
+// Holding doc also keeps state changes (deserializeState(), presets) out, so doc is locked while the response is
+// serialized into an arena. Once serialized, serializedJSONArena() releases doc and only the arena is held while sending.
+// Everything that changes state or uses fileDoc (presets, playlists, ledmaps, config) keeps using doc.
+#if defined(ARDUINO_ARCH_ESP32) && defined(BOARD_HAS_PSRAM) && defined(WLED_USE_PSRAM_JSON)
+#define JSON_ARENAS 2
+static PSRAMDynamicJsonDocument* jsonArenas[JSON_ARENAS] = {nullptr};
+static volatile uint8_t jsonArenaLock[JSON_ARENAS] = {0};   // only taken while holding doc
+static volatile bool jsonArenaHoldsDoc[JSON_ARENAS] = {false};
+#else
+#define JSON_ARENAS 0
+#endif
+
+JsonDocument* requestJSONArena(uint8_t module)
+{
+  if (!requestJSONBufferLock(module)) return nullptr;
+  #if JSON_ARENAS > 0
+  if (psramFound()) {
+    for (size_t i = 0; i < JSON_ARENAS; i++) {
+      if (jsonArenaLock[i]) continue;
+      if (!jsonArenas[i]) {
+        jsonArenas[i] = new PSRAMDynamicJsonDocument(JSON_BUFFER_SIZE); // allocated once on first use
+        if (jsonArenas[i] && jsonArenas[i]->capacity() == 0) { delete jsonArenas[i]; jsonArenas[i] = nullptr; }
+      }
+      if (!jsonArenas[i]) break;
+      jsonArenaLock[i] = module ? module : 255;
+      jsonArenaHoldsDoc[i] = true;
+      jsonArenas[i]->clear();
+      jsonArenaUses++;
+      return jsonArenas[i];
+    }
+  }
+  #endif
+  return &doc;
+}
+
+// the response is serialized: state may change again
+void serializedJSONArena(JsonDocument* arena)
+{
+  #if JSON_ARENAS > 0
+  for (size_t i = 0; i < JSON_ARENAS; i++) {
+    if (arena != jsonArenas[i] || !jsonArenaHoldsDoc[i]) continue;
+    jsonArenaHoldsDoc[i] = false;
+    releaseJSONBufferLock();
+  }
+  #endif
+}
+
+void releaseJSONArena(JsonDocument* arena)
+{
+  if (arena == &doc) { releaseJSONBufferLock(); return; }
+  #if JSON_ARENAS > 0
+  serializedJSONArena(arena);
+  for (size_t i = 0; i < JSON_ARENAS; i++) if (arena == jsonArenas[i]) jsonArenaLock[i] = 0;
+  #endif
+}
+
+// WLEDMM parses a command before it is queued, so malformed JSON is rejected right away. Only "v" is kept, to see whether
+// the caller waits for the new state. NoMemory: "v" has a large value, the command has to wait for doc instead.
+DeserializationError validateJsonCommand(const uint8_t* data, size_t len, bool& verbose)
+{
+  StaticJsonDocument<16> filter;
+  filter["v"] = true;
+  StaticJsonDocument<64> keep;
+  DeserializationError error = deserializeJson(keep, data, len, DeserializationOption::Filter(filter));
+  if (!error && !keep.is<JsonObject>()) error = DeserializationError::InvalidInput;
+  verbose = keep.containsKey("v");
+  return error;
+}
+
+// WLEDMM JSON commands that arrived while doc was locked, applied from loop() by handleQueuedJson() instead of being rejected.
+// Producers are the network callbacks (HTTP /json/state without "v", WS messages), the consumer is loop().
+#define JSON_QUEUE_LEN 4  // must be a power of 2
+typedef struct {
+  char*    data;
+  size_t   len;
+  uint32_t wsClient;  // 0 = HTTP API
+} json_queue_entry_t;
+static json_queue_entry_t jsonQueue[JSON_QUEUE_LEN];
+static std::atomic<uint8_t> jsonQueueHead{0}, jsonQueueTail{0};
+
+bool queueJsonCommand(const uint8_t* data, size_t len, uint32_t wsClient)
+{
+  const uint8_t head = jsonQueueHead.load(std::memory_order_relaxed);
+  if (((head + 1) & (JSON_QUEUE_LEN-1)) == jsonQueueTail.load(std::memory_order_acquire)) return false; // full
+  char* copy = nullptr;
+  #if defined(ARDUINO_ARCH_ESP32) && defined(BOARD_HAS_PSRAM)
+  if (psramFound()) copy = (char*) ps_malloc(len + 1); else
+  #endif
+  copy = (char*) malloc(len + 1);
+  if (!copy) return false;
+  memcpy(copy, data, len);
+  copy[len] = '\0';
+  jsonQueue[head] = {copy, len, wsClient};
+  jsonQueueHead.store((head + 1) & (JSON_QUEUE_LEN-1), std::memory_order_release);
+  jsonQueued++;
+  return true;
+}
+
+void handleQueuedJson()
+{
+  const uint8_t tail = jsonQueueTail.load(std::memory_order_relaxed);
+  if (tail == jsonQueueHead.load(std::memory_order_acquire)) return;
+  json_queue_entry_t& e = jsonQueue[tail];
+  #ifdef WLED_ENABLE_WEBSOCKETS
+  if (e.wsClient) {
+    if (!handleWsJson(ws.client(e.wsClient), (uint8_t*)e.data, e.len, true)) return; // still busy, try again next loop
+  } else
+  #endif
+  {
+    if (!tryRequestJSONBufferLock(20)) return;
+    DeserializationError error = deserializeJson(doc, e.data, e.len);
+    JsonObject root = doc.as<JsonObject>();
+    if (!error && !root.isNull()) deserializeState(root);
+    releaseJSONBufferLock();
+  }
+  free(e.data);
+  e.data = nullptr;
+  jsonQueueTail.store((tail + 1) & (JSON_QUEUE_LEN-1), std::memory_order_release);
+}
+
+void serializeJSONLockStats(JsonObject root)
+{
+  root[F("queued")] = jsonQueued;
+  root[F("arena")] = jsonArenaUses;
+  JsonArray waits = root.createNestedArray(F("wait")); // [module, waits, avg ms, max ms, failed]
+  for (size_t m = 0; m < JSON_LOCK_MODULES; m++) {
+    if (!jsonLockCount[m] && !jsonLockFailed[m]) continue;
+    JsonArray w = waits.createNestedArray();
+    w.add(m == JSON_LOCK_MODULES-1 ? 255 : m);
+    w.add(jsonLockCount[m]);
+    w.add(jsonLockCount[m] ? jsonLockWaitSum[m] / jsonLockCount[m] : 0);
+    w.add(jsonLockWaitMax[m]);
+    w.add(jsonLockFailed[m]);
+  }
+}
+
 
 // extracts effect mode (or palette) name from names serialized string
 // caller must provide large enough buffer for name (including SR extensions)!
@@ -252,6 +522,13 @@ uint8_t extractModeName(uint8_t mode, const char *src, char *dest, uint8_t maxLe
 {
   if (src == JSON_mode_names || src == nullptr) {
     if (mode < strip.getModeCount()) {
+      const mode_meta_t *meta = strip.getModeMeta(mode); // WLEDMM name length from the effect index
+      if (meta) {
+        size_t len = min((size_t)meta->nameLen, (size_t)maxLen);
+        memcpy_P(dest, strip.getModeData(mode), len);
+        dest[len] = 0; // terminate string
+        return strlen(dest);
+      }
       char lineBuffer[256] = { '\0' };
       //strcpy_P(lineBuffer, (const char*)pgm_read_dword(&(WS2812FX::_modeData[mode])));
       strncpy_P(lineBuffer, strip.getModeData(mode), sizeof(lineBuffer)/sizeof(char)-1);
@@ -305,73 +582,81 @@ uint8_t extractModeName(uint8_t mode, const char *src, char *dest, uint8_t maxLe
 
 
 // extracts effect slider data (1st group after @)
+// WLEDMM works on the UI data part only (located by the effect index) instead of copying the whole string into a String
 uint8_t extractModeSlider(uint8_t mode, uint8_t slider, char *dest, uint8_t maxLen, uint8_t *var)
 {
   dest[0] = '\0'; // start by clearing buffer
 
   if (mode < strip.getModeCount()) {
-    String lineBuffer = FPSTR(strip.getModeData(mode));
-    if (lineBuffer.length() > 0) {
-      int16_t start = lineBuffer.indexOf('@');
-      int16_t stop  = lineBuffer.indexOf(';', start);
-      if (start>0 && stop>0) {
-        String names = lineBuffer.substring(start, stop); // include @
-        int16_t nameBegin = 1, nameEnd, nameDefault;
-        if (slider < 10) {
-          for (size_t i=0; i<=slider; i++) {
-            const char *tmpstr;
-            dest[0] = '\0'; //clear dest buffer
-            if (nameBegin == 0) break; // there are no more names
-            nameEnd = names.indexOf(',', nameBegin);
-            if (i == slider) {
-              nameDefault = names.indexOf('=', nameBegin); // find default value
-              if (nameDefault > 0 && var && ((nameEnd>0 && nameDefault<nameEnd) || nameEnd<0)) {
-                *var = (uint8_t)atoi(names.substring(nameDefault+1).c_str());
-              }
-              if (names.charAt(nameBegin) == '!') {
-                switch (slider) {
-                  case  0: tmpstr = PSTR("FX Speed");     break;
-                  case  1: tmpstr = PSTR("FX Intensity"); break;
-                  case  2: tmpstr = PSTR("FX Custom 1");  break;
-                  case  3: tmpstr = PSTR("FX Custom 2");  break;
-                  case  4: tmpstr = PSTR("FX Custom 3");  break;
-                  default: tmpstr = PSTR("FX Custom");    break;
-                }
-                strncpy_P(dest, tmpstr, maxLen); // copy the name into buffer (replacing previous)
-                dest[maxLen-1] = '\0';
-              } else {
-                if (nameEnd<0) tmpstr = names.substring(nameBegin).c_str(); // did not find ",", last name?
-                else           tmpstr = names.substring(nameBegin, nameEnd).c_str();
-                strlcpy(dest, tmpstr, maxLen); // copy the name into buffer (replacing previous)
+    char lineBuffer[256] = { '\0' };
+    const char *data = strip.getModeData(mode);
+    const mode_meta_t *meta = strip.getModeMeta(mode);
+    char *names = nullptr; // slider names after '@'
+    if (meta) {
+      if (meta->len == 0) return 0;
+      if (meta->dataOfs > 1) { strncpy_P(lineBuffer, data + meta->dataOfs, sizeof(lineBuffer)-1); names = lineBuffer; }
+    } else {
+      strncpy_P(lineBuffer, data, sizeof(lineBuffer)-1);
+      if (lineBuffer[0] == '\0') return 0;
+      names = strchr(lineBuffer, '@');
+      if (names == lineBuffer) names = nullptr; // name required
+      else if (names) names++;
+    }
+    char *stop = names ? strchr(names, ';') : nullptr;
+    if (stop) {
+      *stop = '\0';
+      if (slider < 10) {
+        const char *nameBegin = names;
+        for (size_t i=0; i<=slider; i++) {
+          dest[0] = '\0'; //clear dest buffer
+          if (!nameBegin) break; // there are no more names
+          const char *nameEnd = strchr(nameBegin, ',');
+          if (i == slider) {
+            const char *nameDefault = strchr(nameBegin, '='); // find default value
+            if (nameDefault && var && (!nameEnd || nameDefault < nameEnd)) *var = (uint8_t)atoi(nameDefault+1);
+            if (*nameBegin == '!') {
+              const char *tmpstr;
+              switch (slider) {
+                case  0: tmpstr = PSTR("FX Speed");     break;
+                case  1: tmpstr = PSTR("FX Intensity"); break;
+                case  2: tmpstr = PSTR("FX Custom 1");  break;
+                case  3: tmpstr = PSTR("FX Custom 2");  break;
+                case  4: tmpstr = PSTR("FX Custom 3");  break;
+                default: tmpstr = PSTR("FX Custom");    break;
               }
-            }
-            nameBegin = nameEnd+1; // next name (if "," is not found it will be 0)
-          } // next slider
-        } else if (slider == 255) {
-          // palette
-          strlcpy(dest, "pal", maxLen);
-          names = lineBuffer.substring(stop+1); // stop has index of color slot names
-          nameBegin = names.indexOf(';'); // look for palette
-          if (nameBegin >= 0) {
-            nameEnd = names.indexOf(';', nameBegin+1);
-            if (!isdigit(names[nameBegin+1])) nameBegin = names.indexOf('=', nameBegin+1); // look for default value
-            if (nameEnd >= 0 && nameBegin > nameEnd) nameBegin = -1;
-            if (nameBegin >= 0 && var) {
-              *var = (uint8_t)atoi(names.substring(nameBegin+1).c_str());
+              strncpy_P(dest, tmpstr, maxLen); // copy the name into buffer (replacing previous)
+              dest[maxLen-1] = '\0';
+            } else if (maxLen) {
+              size_t len = nameEnd ? nameEnd - nameBegin : strlen(nameBegin); // did not find ",", last name?
+              len = min(len, (size_t)maxLen-1);
+              memcpy(dest, nameBegin, len); // copy the name into buffer (replacing previous)
+              dest[len] = '\0';
             }
           }
+          nameBegin = nameEnd ? nameEnd+1 : nullptr; // next name
+        } // next slider
+      } else if (slider == 255) {
+        // palette
+        strlcpy(dest, "pal", maxLen);
+        const char *palette = strchr(stop+1, ';'); // stop has index of color slot names, look for palette
+        if (palette) {
+          const char *paletteEnd = strchr(palette+1, ';');
+          const char *value = palette;
+          if (!isdigit(palette[1])) value = strchr(palette+1, '='); // look for default value
+          if (paletteEnd && value > paletteEnd) value = nullptr;
+          if (value && var) *var = (uint8_t)atoi(value+1);
         }
-        // we have slider name (including default value) in the dest buffer
-        for (size_t i=0; i<strlen(dest); i++) if (dest[i]=='=') { dest[i]='\0'; break; } // truncate default value
+      }
+      // we have slider name (including default value) in the dest buffer
+      for (size_t i=0; i<strlen(dest); i++) if (dest[i]=='=') { dest[i]='\0'; break; } // truncate default value
 
-      } else {
-        // defaults to just speed and intensity since there is no slider data
-        switch (slider) {
-          case 0:  strncpy_P(dest, PSTR("FX Speed"), maxLen); break;
-          case 1:  strncpy_P(dest, PSTR("FX Intensity"), maxLen); break;
-        }
-        dest[maxLen] = '\0'; // strncpy does not necessarily null terminate string
+    } else {
+      // defaults to just speed and intensity since there is no slider data
+      switch (slider) {
+        case 0:  strncpy_P(dest, PSTR("FX Speed"), maxLen); break;
+        case 1:  strncpy_P(dest, PSTR("FX Intensity"), maxLen); break;
       }
+      dest[maxLen] = '\0'; // strncpy does not necessarily null terminate string
     }
     return strlen(dest);
   }
@@ -380,7 +665,8 @@ uint8_t extractModeSlider(uint8_t mode, uint8_t slider, char *dest, uint8_t maxL
 
 
 // extracts mode parameter defaults from last section of mode data (e.g. "Juggle@!,Trail;!,!,;!;sx=16,ix=240,1d")
-int16_t extractModeDefaults(uint8_t mode, const char *segVar)
+// WLEDMM only used for keys that are not in the effect index
+static int16_t parseModeDefaults(uint8_t mode, const char *segVar)
 {
   if (mode < strip.getModeCount()) {
     char lineBuffer[256] = { '\0' };
@@ -400,6 +686,68 @@ int16_t extractModeDefaults(uint8_t mode, const char *segVar)
   return -1;
 }
 
+int16_t extractModeDefaults(uint8_t mode, const char *segVar)
+{
+  int8_t key = WS2812FX::getModeDefaultKey(segVar);
+  if (key >= 0 && strip.getModeMeta(mode)) return strip.getModeDefault(mode, key);
+  return parseModeDefaults(mode, segVar);
+}
+
+// WLEDMM effect index size and cost, compared with parsing the effect string for every lookup
+void serializeModeMetaStats(JsonObject root)
+{
+  static uint32_t parseNs = 0, indexNs = 0; // per default load of one effect (all keys), measured once
+  if (parseNs == 0 && strip.getModeCount() > 1) {
+    const size_t samples = min((size_t)16, (size_t)strip.getModeCount());
+    const uint8_t step = strip.getModeCount() / samples;
+    char key[4];
+    int32_t sum = 0;
+    unsigned long t0 = micros();
+    for (size_t i = 0; i < samples; i++) for (size_t k = 0; k < MODE_DEF_COUNT; k++) {
+      strncpy_P(key, WS2812FX::getModeDefaultKeyName(k), sizeof(key));
+      sum += parseModeDefaults(i * step, key);
+    }
+    unsigned long t1 = micros();
+    for (size_t i = 0; i < samples; i++) for (size_t k = 0; k < MODE_DEF_COUNT; k++) sum -= strip.getModeDefault(i * step, k);
+    unsigned long t2 = micros();
+    parseNs = max(1UL, (t1 - t0) * 1000UL / samples);
+    indexNs = (t2 - t1) * 1000UL / samples;
+    if (sum) DEBUG_PRINTLN(F("Effect index differs from effect data!"));
+  }
+  root[F("n")]     = strip.getModeCount();
+  root[F("bytes")] = strip.getModeMetaSize();
+  root[F("boot")]  = strip.getModeMetaTime();
+  root[F("parse")] = parseNs;
+  root[F("idx")]   = indexNs;
+}
+
+
+// WLEDMM boot profiler: time since power-on at the end of each startup phase
+#define BOOT_PHASES 16
+static struct {
+  const char* name; // PSTR
+  uint32_t    us;
+} bootPhases[BOOT_PHASES];
+static uint8_t bootPhaseCount = 0;
+
+void bootMark(const char* phase)
+{
+  if (bootPhaseCount >= BOOT_PHASES) return;
+  bootPhases[bootPhaseCount].name = phase;
+  bootPhases[bootPhaseCount].us   = micros();
+  bootPhaseCount++;
+}
+
+void serializeBootProfile(JsonObject root)
+{
+  JsonArray phases = root.createNestedArray(F("phase"));
+  JsonArray ms     = root.createNestedArray(F("ms"));
+  for (size_t i = 0; i < bootPhaseCount; i++) {
+    phases.add(FPSTR(bootPhases[i].name));
+    ms.add((bootPhases[i].us + 500) / 1000);
+  }
+}
+
 
 void checkSettingsPIN(const char* pin) {
   if (!pin) return;
@@ -480,6 +828,9 @@ um_data_t* simulateSound(uint8_t simulationId)
   static uint16_t volumeRaw;
   static float    my_magnitude;
   static uint16_t zeroCrossingCount = 0; // number of zero crossings in the current batch of 512 samples
+  static float    beatBpm = 120.0f;       // WLEDMM beat tracking
+  static float    beatPhase = 0.0f;
+  static float    beatConfidence = 1.0f;
 
   //arrays
   uint8_t *fftResult;
@@ -494,7 +845,7 @@ um_data_t* simulateSound(uint8_t simulationId)
     // NOTE!!!
     // This may change as AudioReactive usermod may change
     um_data = new um_data_t;
-    um_data->u_size = 12;
+    um_data->u_size = 15;
     um_data->u_type = new um_types_t[um_data->u_size];
     um_data->u_data = new void*[um_data->u_size];
     um_data->u_data[0] = &volumeSmth;
@@ -509,6 +860,9 @@ um_data_t* simulateSound(uint8_t simulationId)
     um_data->u_data[9]  = &volumeSmth;    // dummy (soundPressure)
     um_data->u_data[10] = &volumeSmth;    // dummy (agcSensitivity)
     um_data->u_data[11] = &zeroCrossingCount;
+    um_data->u_data[12] = &beatBpm;
+    um_data->u_data[13] = &beatPhase;
+    um_data->u_data[14] = &beatConfidence;
   } else {
     // get arrays from um_data
     fftResult =  (uint8_t*)um_data->u_data[2];
@@ -576,6 +930,7 @@ um_data_t* simulateSound(uint8_t simulationId)
   my_magnitude = 10000.0f / 8.0f; //no idea if 10000 is a good value for FFT_Magnitude ???
   if (volumeSmth < 1 ) my_magnitude = 0.001f;             // noise gate closed - mute
   zeroCrossingCount = floorf(FFT_MajorPeak / 36.0f); // 9Khz max frequency => 255 zero crossings
+  beatPhase = float(ms % 500) / 500.0f;               // steady 120 BPM
 
   return um_data;
 }
@@ -107,6 +107,16 @@ void WLED::reset()
   ESP.restart();
 }
 
+// WLEDMM load the custom palettes requested by finalizeInit(); UI settings (set.cpp) and "rmcpal" call loadCustomPalettes() directly
+static void handleReloadPalettes() {
+  static bool bootPalettes = true;
+  if (!reloadPalettes) return;
+  reloadPalettes = false;
+  strip.loadCustomPalettes();
+  if (bootPalettes) bootMark(PSTR("palettes"));
+  bootPalettes = false;
+}
+
 #if defined(ARDUINO_ARCH_ESP32) && defined(WLEDMM_FASTPATH)
 #define yield() {}  // WLEDMM yield() is completely unnecessary on esp32. See https://github.com/espressif/arduino-esp32/issues/1385
 #endif
@@ -211,6 +221,8 @@ void WLED::loop()
     #endif
 
     handlePresets();
+    handleQueuedJson(); // WLEDMM JSON API commands that arrived while the buffer was locked
+    handlePresetLog();  // WLEDMM merge logged preset changes into presets.json when idle
     yield();
 
 #if defined(_MoonModules_WLED_) && defined(WLEDMM_FASTPATH)
@@ -321,7 +333,11 @@ void WLED::loop()
     if (!strip.deserializeMap(loadedLedmap) && strip.isMatrix) strip.setUpMatrix(); //WLEDMM: always if nonexistent:  && loadedLedmap == 0
     strip.enumerateLedmaps(); //WLEDMM
     loadLedmap = false;
+    static bool bootLedmap = true;
+    if (bootLedmap) bootMark(PSTR("ledmap"));
+    bootLedmap = false;
   }
+  handleReloadPalettes(); // WLEDMM deferred from finalizeInit()
 
   yield();
   #if defined(ARDUINO_ARCH_ESP32) && defined(WLEDMM_PROTECT_SERVICE)  // WLEDMM experimental: pause handleWs while strip/segment data might be inconsistent
@@ -453,6 +469,7 @@ void WLED::setup()
   #endif
   Serial.begin(115200);
   if (!Serial) delay(1000); // WLEDMM make sure that Serial has initalized
+  bootMark(PSTR("serial"));
 
   #ifdef ARDUINO_ARCH_ESP32
   #if defined(WLED_DEBUG) && (defined(CONFIG_IDF_TARGET_ESP32S2) || defined(CONFIG_IDF_TARGET_ESP32C3) || ARDUINO_USB_CDC_ON_BOOT)
@@ -676,6 +693,7 @@ void WLED::setup()
   USER_PRINTLN();
   DEBUG_PRINTLN(F("Registering usermods ..."));
   registerUsermods();
+  bootMark(PSTR("register"));
 
   DEBUG_PRINT(F("heap ")); DEBUG_PRINTLN(ESP.getFreeHeap());
   #ifdef ARDUINO_ARCH_ESP32
@@ -702,7 +720,9 @@ void WLED::setup()
 #else
   initPresetsFile();
 #endif
+  initPresetIndex(); // WLEDMM
   updateFSInfo();
+  bootMark(PSTR("fs"));
 
   USER_PRINT(F("done Mounting FS; "));
   USER_PRINT(((fsBytesTotal-fsBytesUsed)/1024)); USER_PRINTLN(F(" kB free.\n"));
@@ -716,6 +736,7 @@ void WLED::setup()
 
   DEBUG_PRINTLN(F("Reading config"));
   deserializeConfigFromFS();
+  bootMark(PSTR("config"));
 
 #if defined(STATUSLED) && STATUSLED>=0
   if (!pinManager.isPinAllocated(STATUSLED)) {
@@ -727,13 +748,23 @@ void WLED::setup()
 
   DEBUG_PRINTLN(F("Initializing strip"));
   beginStrip();
+  bootMark(PSTR("strip"));
   DEBUG_PRINT(F("heap ")); DEBUG_PRINTLN(ESP.getFreeHeap());
 
   USER_PRINTLN(F("\nUsermods setup ..."));
   userSetup();
   usermods.setup();
+  bootMark(PSTR("usermods"));
   DEBUG_PRINT(F("heap ")); DEBUG_PRINTLN(ESP.getFreeHeap());
 
+  // WLEDMM first light: apply the boot preset and show a frame now, not after web server and network are up.
+  // Must come after usermods.setup() - usermods (audioreactive) ignore preset data and provide no data to effects before.
+  // A boot preset may select a custom palette, which Segment::setPalette() replaces with palette 0 while none are loaded.
+  if (presetsActionPending()) handleReloadPalettes();
+  handlePresets();
+  strip.service();
+  bootMark(PSTR("light"));
+
   if (strcmp(clientSSID, DEFAULT_CLIENT_SSID) == 0)
     showWelcomePage = true;
   WiFi.persistent(false);
@@ -791,6 +822,7 @@ void WLED::setup()
   // HTTP server page init
   DEBUG_PRINTLN(F("initServer"));
   initServer();
+  bootMark(PSTR("server"));
   DEBUG_PRINT(F("heap ")); DEBUG_PRINTLN(ESP.getFreeHeap());
   #ifdef ARDUINO_ARCH_ESP32
   DEBUG_PRINT(pcTaskGetTaskName(NULL)); DEBUG_PRINT(F(" free stack ")); DEBUG_PRINTLN(uxTaskGetStackHighWaterMark(NULL));
@@ -877,6 +909,7 @@ void WLED::setup()
 
   USER_PRINT(F("Free heap ")); USER_PRINTLN(ESP.getFreeHeap());USER_PRINTLN();
   USER_PRINTLN(F("WLED initialization done.\n"));
+  bootMark(PSTR("setup"));
   delay(50);
   // repeat Ada prompt
   #ifdef WLED_ENABLE_ADALIGHT
@@ -938,13 +971,8 @@ void WLED::initAP(bool resetAP)
     DEBUG_PRINTLN(F("Init AP interfaces"));
     server.begin();
     if (udpPort > 0 && udpPort != ntpLocalPort) {
-      udpConnected = notifierUdp.begin(udpPort);
-    }
-    if (udpRgbPort > 0 && udpRgbPort != ntpLocalPort && udpRgbPort != udpPort) {
-      udpRgbConnected = rgbUdp.begin(udpRgbPort);
-    }
-    if (udpPort2 > 0 && udpPort2 != ntpLocalPort && udpPort2 != udpPort && udpPort2 != udpRgbPort) {
-      udp2Connected = notifier2Udp.begin(udpPort2);
+      initUdpReceivers(udpRgbPort > 0 && udpRgbPort != ntpLocalPort && udpRgbPort != udpPort,
+                       udpPort2 > 0 && udpPort2 != ntpLocalPort && udpPort2 != udpPort && udpPort2 != udpRgbPort);
     }
     e131.begin(false, e131Port, e131Universe, E131_MAX_UNIVERSE_COUNT);
     ddp.begin(false, DDP_DEFAULT_PORT);
@@ -1205,11 +1233,7 @@ void WLED::initInterfaces()
   server.begin();
 
   if (udpPort > 0 && udpPort != ntpLocalPort) {
-    udpConnected = notifierUdp.begin(udpPort);
-    if (udpConnected && udpRgbPort != udpPort)
-      udpRgbConnected = rgbUdp.begin(udpRgbPort);
-    if (udpConnected && udpPort2 != udpPort && udpPort2 != udpRgbPort)
-      udp2Connected = notifier2Udp.begin(udpPort2);
+    initUdpReceivers(udpRgbPort != udpPort, udpPort2 != udpPort && udpPort2 != udpRgbPort);
   }
   if (ntpEnabled)
     ntpConnected = ntpUdp.begin(ntpLocalPort);
@@ -1220,6 +1244,9 @@ void WLED::initInterfaces()
 #ifndef WLED_DISABLE_MQTT
   initMqtt();
 #endif
+  static bool bootNetwork = true; // WLEDMM first connection only
+  if (bootNetwork) bootMark(PSTR("network"));
+  bootNetwork = false;
   interfacesInited = true;
   wasConnected = true;
 }
@@ -1264,9 +1291,7 @@ void WLED::handleConnection()
       USER_PRINT(F("Heap too low! (step 1, flush unread UDP): "));
       USER_PRINTLN(heap);      
       strip.purgeSegments();
-      notifierUdp.flush();
-      rgbUdp.flush();
-      notifier2Udp.flush();
+      flushUdpRxQueue();
       ntpUdp.flush();
       // WLEDMM
       errorFlag = ERR_LOW_MEM;
@@ -475,6 +475,11 @@ WLED_GLOBAL uint16_t DMXSegmentSpacing _INIT(0);                  // Number of v
 WLED_GLOBAL byte e131LastSequenceNumber[E131_MAX_UNIVERSE_COUNT]; // to detect packet loss
 WLED_GLOBAL bool e131Multicast _INIT(false);                      // multicast or unicast
 WLED_GLOBAL bool e131SkipOutOfSequence _INIT(false);              // freeze instead of flickering
+WLED_GLOBAL bool e131FrameSync _INIT(false);                      // assemble multi-universe frames before showing them (honours ArtSync / E1.31 sync packets)
+WLED_GLOBAL uint16_t e131FrameTimeout _INIT(40);                  // ms to wait for missing universes (or sync) before showing a partial frame
+WLED_GLOBAL uint32_t e131FramesComplete _INIT(0);                 // frame assembler statistics
+WLED_GLOBAL uint32_t e131FramesPartial _INIT(0);
+WLED_GLOBAL uint32_t e131FramesDropped _INIT(0);
 WLED_GLOBAL uint16_t pollReplyCount _INIT(0);                     // count number of replies for ArtPoll node report
 
 // mqtt
@@ -628,6 +633,10 @@ WLED_GLOBAL bool stateChanged _INIT(false);
 
 // network
 WLED_GLOBAL bool udpConnected _INIT(false), udp2Connected _INIT(false), udpRgbConnected _INIT(false);
+WLED_GLOBAL volatile uint32_t udpRxDropped _INIT(0);              // UDP packets dropped because the receive queue was full
+WLED_GLOBAL volatile uint8_t udpRxMaxDepth _INIT(0);              // receive queue high-water mark
+WLED_GLOBAL unsigned long udpRxLatency _INIT(0);                  // smoothed realtime receive-to-show latency (us)
+WLED_GLOBAL unsigned long udpRxLatencyMax _INIT(0);               // worst realtime receive-to-show latency (us)
 
 // ui style
 WLED_GLOBAL bool showWelcomePage _INIT(false);
@@ -682,6 +691,13 @@ WLED_GLOBAL bool useMainSegmentOnly _INIT(false);
 
 WLED_GLOBAL unsigned long lastInterfaceUpdate _INIT(0);
 WLED_GLOBAL byte interfaceUpdateCallMode _INIT(CALL_MODE_INIT);
+WLED_GLOBAL uint16_t stateRevision _INIT(0);     // WLEDMM incremented by every stateUpdated()
+WLED_GLOBAL uint16_t configRevision _INIT(0);    // WLEDMM incremented whenever settings are loaded, set or saved
+WLED_GLOBAL uint32_t wsBroadcasts _INIT(0);      // WLEDMM state broadcasts serialized
+WLED_GLOBAL uint32_t wsBytesSent _INIT(0);       // WLEDMM bytes of state messages queued to WS clients
+WLED_GLOBAL uint32_t wsCoalesced _INIT(0);       // WLEDMM state updates merged into an already pending broadcast
+WLED_GLOBAL uint32_t wsCacheHits _INIT(0);       // WLEDMM single client messages served without serializing again
+WLED_GLOBAL uint32_t wsPatchesSent _INIT(0);     // WLEDMM state patches sent to {"patch":true} clients
 
 // alexa udp
 WLED_GLOBAL String escapedMac;
@@ -747,7 +763,7 @@ WLED_GLOBAL AsyncClient     *hueClient _INIT(NULL);
 WLED_GLOBAL AsyncWebHandler *editHandler _INIT(nullptr);
 
 // udp interface objects
-WLED_GLOBAL WiFiUDP notifierUdp, rgbUdp, notifier2Udp;
+WLED_GLOBAL AsyncUDP notifierUdp, rgbUdp, notifier2Udp;     // received by callbacks, see initUdpReceivers()
 WLED_GLOBAL WiFiUDP ntpUdp;
 WLED_GLOBAL ESPAsyncE131 e131 _INIT_N(((handleE131Packet)));
 WLED_GLOBAL ESPAsyncE131 ddp  _INIT_N(((handleE131Packet)));
@@ -761,6 +777,7 @@ WLED_GLOBAL BusConfig* busConfigs[WLED_MAX_BUSSES+WLED_MIN_VIRTUAL_BUSSES] _INIT
 WLED_GLOBAL volatile bool doInitBusses _INIT(false);        // WLEDMM "volatile" added - needed as we want to sync parallel tasks
 WLED_GLOBAL volatile bool loadLedmap _INIT(false);          // WLEDMM use as bool and use loadedLedmap for Nr
 WLED_GLOBAL volatile uint8_t loadedLedmap _INIT(0);         // WLEDMM default 0
+WLED_GLOBAL volatile bool reloadPalettes _INIT(false);      // WLEDMM load custom palettes from loop(), see finalizeInit()
 WLED_GLOBAL volatile bool suspendStripService _INIT(false); // WLEDMM temporarily prevent running strip.service, when strip or segments are "under update" and inconsistent
 WLED_GLOBAL volatile bool OTAisRunning _INIT(false);        // WLEDMM temporarily stop led updates during OTA
 #ifndef ESP8266
@@ -1,4 +1,5 @@
 #include "wled.h"
+#include <memory> // WLEDMM std::shared_ptr
 
 #include "html_ui.h"
 #ifdef WLED_ENABLE_SIMPLE_UI
@@ -49,7 +50,10 @@ void handleUpload(AsyncWebServerRequest *request, const String& filename, size_t
     request->_tempFile = WLED_FS.open(finalname, "w");
     DEBUG_PRINT(F("Uploading "));
     DEBUG_PRINTLN(finalname);
-    if (finalname.equals("/presets.json")) presetsModifiedTime = toki.second();
+    if (finalname.equals("/presets.json")) {
+      presetsModifiedTime = toki.second();
+      discardPresetLog(); // WLEDMM the uploaded file replaces all logged changes
+    }
   }
   if (len) {
     request->_tempFile.write(data,len);
@@ -72,15 +76,41 @@ void handleUpload(AsyncWebServerRequest *request, const String& filename, size_t
   }
 }
 
+#ifdef WLED_ENABLE_FS_EDITOR
+// WLEDMM /edit writes files without handleUpload(), so the preset log has to learn about a new presets.json here
+class PresetsAwareEditor : public AsyncWebHandler {
+  private:
+    SPIFFSEditor _editor;
+    static void presetsReplaced(const String& path) {
+      if (!path.equals("/presets.json") && !path.equals("presets.json")) return;
+      presetsModifiedTime = toki.second();
+      invalidateCompiledPresets();
+      discardPresetLog(); // logged changes belong to the old file
+    }
+  public:
+    #ifdef ARDUINO_ARCH_ESP32
+    PresetsAwareEditor(const fs::FS& fs) : _editor(fs) {}
+    #else
+    PresetsAwareEditor(const fs::FS& fs) : _editor("", "", fs) {}
+    #endif
+    virtual bool canHandle(AsyncWebServerRequest *request) override { return _editor.canHandle(request); }
+    virtual void handleRequest(AsyncWebServerRequest *request) override {
+      if (request->method() != HTTP_GET && request->hasParam("path", true)) presetsReplaced(request->getParam("path", true)->value()); // create or delete
+      _editor.handleRequest(request);
+    }
+    virtual void handleUpload(AsyncWebServerRequest *request, const String& filename, size_t index, uint8_t *data, size_t len, bool final) override {
+      if (!index) presetsReplaced(filename);
+      _editor.handleUpload(request, filename, index, data, len, final);
+    }
+    virtual bool isRequestHandlerTrivial() override { return false; }
+};
+#endif
+
 void createEditHandler(bool enable) {
   if (editHandler != nullptr) server.removeHandler(editHandler);
   if (enable) {
     #ifdef WLED_ENABLE_FS_EDITOR
-      #ifdef ARDUINO_ARCH_ESP32
-      editHandler = &server.addHandler(new SPIFFSEditor(WLED_FS));//http_username,http_password));
-      #else
-      editHandler = &server.addHandler(new SPIFFSEditor("","",WLED_FS));//http_username,http_password));
-      #endif
+      editHandler = &server.addHandler(new PresetsAwareEditor(WLED_FS));//http_username,http_password));
     #else
       editHandler = &server.on("/edit", HTTP_GET, [](AsyncWebServerRequest *request){
         serveMessage(request, 501, "Not implemented", F("The FS editor is disabled in this build."), 254);
@@ -194,17 +224,38 @@ void initServer()
     bool verboseResponse = false;
     bool isConfig = false;
 
-    if (!requestJSONBufferLock(14)) return;
+    const String& url = request->url();
+    isConfig = url.indexOf("cfg") > -1;
+
+    // WLEDMM queue state commands while the JSON buffer is in use, unless the caller waits for the new state ("v")
+    if (!tryRequestJSONBufferLock(14)) {
+      const uint8_t* body = (const uint8_t*)request->_tempObject;
+      size_t len = request->contentLength();
+      if (body && !isConfig) {
+        bool verbose = false;
+        DeserializationError error = validateJsonCommand(body, len, verbose);
+        if (error && error != DeserializationError::NoMemory) {
+          request->send(400, "application/json", F("{\"error\":9}"));
+          return;
+        }
+        if (!error && !verbose && queueJsonCommand(body, len)) {
+          request->send(200, "application/json", F("{\"success\":true}")); // applied by handleQueuedJson()
+          return;
+        }
+      }
+      if (!requestJSONBufferLock(14)) {
+        request->send(503, "application/json", F("{\"error\":3}"));
+        return;
+      }
+    }
 
-    DeserializationError error = deserializeJson(doc, (uint8_t*)(request->_tempObject));
+    DeserializationError error = deserializeJson(doc, (uint8_t*)(request->_tempObject), request->contentLength());
     JsonObject root = doc.as<JsonObject>();
     if (error || root.isNull()) {
       releaseJSONBufferLock();
       request->send(400, "application/json", F("{\"error\":9}"));
       return;
     }
-    const String& url = request->url();
-    isConfig = url.indexOf("cfg") > -1;
     if (!isConfig) {
       /*
       #ifdef WLED_DEBUG
@@ -215,7 +266,9 @@ void initServer()
       */
       verboseResponse = deserializeState(root);
     } else {
+      unsigned long t0 = micros();
       verboseResponse = deserializeConfig(root); //use verboseResponse to determine whether cfg change should be saved immediately
+      recordConfigApplyTime(micros() - t0); // WLEDMM
     }
     releaseJSONBufferLock();
 
@@ -573,10 +626,30 @@ String dmxProcessor(const String& var)
 #endif
 
 
+// WLEDMM generated settings.js, kept until the configuration changes (pages without live status only)
+#ifdef ARDUINO_ARCH_ESP32
+#define SETTINGS_JS_CACHE 3
+#else
+#define SETTINGS_JS_CACHE 1
+#endif
+static struct {
+  std::shared_ptr<OappendBlock> blocks;
+  uint16_t rev;
+  byte     subPage;
+} settingsJSCache[SETTINGS_JS_CACHE];
+static uint8_t settingsJSCacheNext = 0;
+
+// WiFi (IP), LED (current), Sync (Hue status) and Time (clock) show live values, usermod pages depend on the "um" argument
+static bool settingsJSCacheable(AsyncWebServerRequest* request, byte subPage)
+{
+  if (subPage == 1 || subPage == 2 || subPage == 4 || subPage == 5) return false;
+  if (subPage == 8 && request->hasParam("um")) return false;
+  return true;
+}
+
 void serveSettingsJS(AsyncWebServerRequest* request)
 {
-  char buf[SETTINGS_STACK_BUF_SIZE+37] = { '\0' }; // WLEDMM ensure buffer is cleared initially
-  buf[0] = 0;
+  char buf[64] = { '\0' };
   byte subPage = request->arg(F("p")).toInt();
   if (subPage > 10) {
     strcpy_P(buf, PSTR("alert('Settings for this request are not implemented.');"));
@@ -588,18 +661,48 @@ void serveSettingsJS(AsyncWebServerRequest* request)
     request->send(403, "application/javascript", buf);
     return;
   }
-  strcat_P(buf,PSTR("function GetV(){var d=document;"));
-  getSettingsJS(request, subPage, buf+strlen(buf));  // this may overflow by 35bytes!!! WLEDMM add request
-  strcat_P(buf,PSTR("}"));
-
-  #ifdef ARDUINO_ARCH_ESP32
-    DEBUG_PRINT(F("ServeSettingsJS: "));
-    DEBUG_PRINTF("%s min free stack %d", pcTaskGetTaskName(NULL), uxTaskGetStackHighWaterMark(NULL)); //WLEDMM
-    DEBUG_PRINTF(PSTR(" bytes.\t\tString buffer usage: %4d of %d bytes\n"), strlen(buf)+1, SETTINGS_STACK_BUF_SIZE+37);
-  #endif
-  
+
+  std::shared_ptr<OappendBlock> blocks;
+  const bool cacheable = settingsJSCacheable(request, subPage);
+  if (cacheable) {
+    for (size_t i = 0; i < SETTINGS_JS_CACHE; i++) {
+      if (settingsJSCache[i].blocks && settingsJSCache[i].subPage == subPage && settingsJSCache[i].rev == configRevision) {
+        blocks = settingsJSCache[i].blocks;
+        DEBUG_PRINTF("ServeSettingsJS: page %d from cache.\n", subPage);
+        break;
+      }
+    }
+  }
+
+  if (!blocks) {
+    if (!oappendBegin()) {
+      request->send(503, "application/javascript", F("alert('Not enough memory.');"));
+      return;
+    }
+    oappend(SET_F("function GetV(){var d=document;"));
+    getSettingsJS(request, subPage, nullptr);  // WLEDMM add request
+    oappend(SET_F("}"));
+    bool complete;
+    blocks = std::shared_ptr<OappendBlock>(oappendEnd(complete), oappendFree);
+
+    #ifdef ARDUINO_ARCH_ESP32
+      DEBUG_PRINT(F("ServeSettingsJS: "));
+      DEBUG_PRINTF("%s min free stack %d", pcTaskGetTaskName(NULL), uxTaskGetStackHighWaterMark(NULL)); //WLEDMM
+      DEBUG_PRINTF(PSTR(" bytes.\t\tOutput %s.\n"), complete ? "complete" : "truncated");
+    #endif
+
+    if (cacheable && complete) { // replace oldest entry
+      settingsJSCache[settingsJSCacheNext].blocks  = blocks;
+      settingsJSCache[settingsJSCacheNext].rev     = configRevision;
+      settingsJSCache[settingsJSCacheNext].subPage = subPage;
+      settingsJSCacheNext = (settingsJSCacheNext + 1) % SETTINGS_JS_CACHE;
+    }
+  }
+
   AsyncWebServerResponse *response;
-  response = request->beginResponse(200, "application/javascript", buf);
+  response = request->beginChunkedResponse("application/javascript", [blocks](uint8_t* buf, size_t maxLen, size_t index) -> size_t {
+    return oappendRead(blocks.get(), buf, maxLen, index);
+  });
   response->addHeader(F("Cache-Control"),"no-store");
   response->addHeader(F("Expires"),"0");
   request->send(response);
@@ -1,4 +1,5 @@
 #include "wled.h"
+#include "ddp_codec.h"  // WLEDMM op encoding shared with live preview v3
 
 /*
  * WebSockets server for bidirectional communication
@@ -16,16 +17,26 @@ static volatile unsigned long wsLastLiveTime = 0;   // WLEDMM
 #define WS_LIVE_INTERVAL_MAX 80
 #define WS_LIVE_INTERVAL_MIN 40
 #endif
+#define WS_LIVE_BACKOFF_MAX 500   // WLEDMM ms added to the live interval while the client can't keep up
+
+static volatile uint8_t wsLiveVersion = 1;     // WLEDMM live preview format requested by the client, see sendLiveLedsWsV3()
+static volatile bool wsLiveKeyframe = true;    // WLEDMM next v3 frame must be a keyframe
+static uint16_t wsLiveBackoff = 0;             // WLEDMM
+
+static void trackWsClient(uint32_t id, bool add);  // WLEDMM state broadcasts, see below
+static bool setWsClientPatch(uint32_t id);
 
 void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data, size_t len)
 {
   if(type == WS_EVT_CONNECT){
     //client connected
     DEBUG_PRINTLN(F("WS client connected."));
+    trackWsClient(client->id(), true); // WLEDMM
     sendDataWs(client);
   } else if(type == WS_EVT_DISCONNECT){
     //client disconnected
     if (client->id() == wsLiveClientId) wsLiveClientId = 0;
+    trackWsClient(client->id(), false); // WLEDMM
     DEBUG_PRINTLN(F("WS client disconnected."));
   } else if(type == WS_EVT_DATA){
     DEBUG_PRINTLN(F("WS event data."));
@@ -42,38 +53,7 @@ void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventTyp
           return;
         }
 
-        bool verboseResponse = false;
-        if (!requestJSONBufferLock(11)) {
-          client->text(F("{\"error\":3}")); // ERR_NOBUF
-          return;
-        }
-
-        DeserializationError error = deserializeJson(doc, data, len);
-        JsonObject root = doc.as<JsonObject>();
-        if (error || root.isNull()) {
-          releaseJSONBufferLock();
-          return;
-        }
-        if (root["v"] && root.size() == 1) {
-          //if the received value is just "{"v":true}", send only to this client
-          verboseResponse = true;
-        } else if (root.containsKey("lv")) {
-          wsLiveClientId = root["lv"] ? client->id() : 0;
-        } else {
-          verboseResponse = deserializeState(root);
-        }
-        releaseJSONBufferLock(); // will clean fileDoc
-
-        if (!interfaceUpdateCallMode) { // individual client response only needed if no WS broadcast soon
-          if (verboseResponse) {
-            sendDataWs(client);
-          } else {
-            // we have to send something back otherwise WS connection closes
-            client->text(F("{\"success\":true}"));
-          }
-          // force broadcast in 500ms after updating client
-          //lastInterfaceUpdate = millis() - (INTERFACE_UPDATE_COOLDOWN -500); // ESP8266 does not like this
-        }
+        handleWsJson(client, data, len, false); // WLEDMM
       }
     } else {
       //message is comprised of multiple frames or the frame is split into multiple packets
@@ -106,11 +86,222 @@ void wsEvent(AsyncWebSocket * server, AsyncWebSocketClient * client, AwsEventTyp
   }
 }
 
+/*
+ * WLEDMM state broadcasts
+ * state+info is serialized once into a refcounted buffer that is queued to every client. The same buffer answers
+ * single client requests (connect, {"v":true}) while the state has not changed and it is less than WS_STATE_CACHE_MS old.
+ * Bursts of changes are already merged into one broadcast per INTERFACE_UPDATE_COOLDOWN by updateInterfaces().
+ * Clients that send {"patch":true} get one full message and then only the changed state fields with each broadcast:
+ *   {"patch":{"bri":128,"seg":[{"id":0,"fx":5}]}}   top level keys replace the old value, seg entries are merged by "id",
+ *                                                   {"id":n,"stop":0} means segment n was removed; info is not included
+ * Fields are compared by key. A top level key that is no longer in the state is sent as "key":null; a segment that lost
+ * a field is sent as removed, followed by all its fields.
+ */
+#define WS_STATE_CACHE_MS  1000
+#define WS_TRACKED_CLIENTS 8     // clients tracked for patch delivery, more clients fall back to full messages
+#define WS_PATCH_FIELDS    48    // hashed fields per segment (and top level state)
+
+static AsyncWebSocketSharedBuffer wsStateBuffer;   // last serialized state+info
+static unsigned long wsStateTime = 0;
+static uint16_t wsStateRev = 0;
+static uint32_t wsClientIds[WS_TRACKED_CLIENTS] = {0};
+static bool wsClientPatch[WS_TRACKED_CLIENTS] = {false};
+static uint8_t wsPatchClients = 0;
+
+// the client table and the last message are used by the async_tcp task (WS events) and by loop() (broadcasts)
+#ifdef ARDUINO_ARCH_ESP32
+static SemaphoreHandle_t wsStateMux = xSemaphoreCreateMutex();
+#define WSStateLock()   xSemaphoreTake(wsStateMux, portMAX_DELAY)
+#define WSStateUnlock() xSemaphoreGive(wsStateMux)
+#else
+// ESP8266: network callbacks never run while loop() is running
+#define WSStateLock()
+#define WSStateUnlock()
+#endif
+static uint32_t* wsPatchHashes = nullptr;          // value hashes of the last broadcast, row 0 = top level, row 1+id = segment id
+static uint16_t* wsPatchKeys = nullptr;            // key hashes of the same fields
+static uint8_t*  wsPatchFields = nullptr;          // number of fields of each row in the last broadcast (0 = no segment)
+static String    wsPatchTopKeys;                   // top level keys of the last broadcast, ",key1,key2,"
+
+static void trackWsClient(uint32_t id, bool add) {
+  WSStateLock();
+  for (size_t i = 0; i < WS_TRACKED_CLIENTS; i++) {
+    if (add ? wsClientIds[i] == 0 : wsClientIds[i] == id) {
+      if (!add && wsClientPatch[i]) wsPatchClients--;
+      wsClientIds[i] = add ? id : 0;
+      wsClientPatch[i] = false;
+      break;
+    }
+  }
+  WSStateUnlock();
+}
+
+static bool setWsClientPatch(uint32_t id) {
+  bool found = false;
+  WSStateLock();
+  for (size_t i = 0; i < WS_TRACKED_CLIENTS; i++) {
+    if (wsClientIds[i] == id) {
+      if (!wsClientPatch[i]) wsPatchClients++;
+      wsClientPatch[i] = true;
+      found = true;
+      break;
+    }
+  }
+  WSStateUnlock();
+  return found;
+}
+
+// FNV-1a of the serialized value
+class HashPrint : public Print {
+  public:
+    uint32_t hash = 2166136261UL;
+    size_t write(uint8_t c) override { hash = (hash ^ c) * 16777619UL; return 1; }
+    size_t write(const uint8_t *buffer, size_t size) override { for (size_t i = 0; i < size; i++) write(buffer[i]); return size; }
+};
+
+static uint32_t jsonHash(JsonVariantConst v) {
+  HashPrint h;
+  serializeJson(v, h);
+  return h.hash;
+}
+
+static uint16_t keyHash(const char* key) {
+  HashPrint h;
+  h.print(key);
+  return h.hash ^ (h.hash >> 16);
+}
+
+static void freePatchHashes() {
+  free(wsPatchHashes); wsPatchHashes = nullptr;
+  free(wsPatchKeys); wsPatchKeys = nullptr;
+  free(wsPatchFields); wsPatchFields = nullptr;
+  wsPatchTopKeys = String();
+}
+
+// appends "key":value for every field of obj that is new or whose value hash changed since the last broadcast (row of
+// wsPatchHashes/wsPatchKeys), updates the row; returns number of fields appended. removed: fields of the last broadcast
+// that obj does not have anymore
+static size_t appendChangedFields(String& out, JsonObjectConst obj, size_t row, bool all, size_t& removed, const char* skipKey = nullptr) {
+  uint32_t* hashes = wsPatchHashes + row * WS_PATCH_FIELDS;
+  uint16_t* keys = wsPatchKeys + row * WS_PATCH_FIELDS;
+  const size_t old = all ? 0 : wsPatchFields[row];
+  uint32_t newHashes[WS_PATCH_FIELDS];
+  uint16_t newKeys[WS_PATCH_FIELDS];
+  size_t n = 0, f = 0, matched = 0;
+  for (JsonPairConst kv : obj) {
+    if (skipKey && strcmp(kv.key().c_str(), skipKey) == 0) continue;
+    uint16_t k = keyHash(kv.key().c_str());
+    uint32_t h = jsonHash(kv.value());
+    size_t j = f;   // fields normally keep their position
+    if (j >= old || keys[j] != k) for (j = 0; j < old && keys[j] != k; j++);
+    if (j < old) matched++;
+    bool changed = f >= WS_PATCH_FIELDS || j >= old || hashes[j] != h;
+    if (f < WS_PATCH_FIELDS) { newKeys[f] = k; newHashes[f] = h; }
+    f++;
+    if (!changed) continue;
+    if (n++ || out[out.length()-1] != '{') out += ',';
+    out += '"'; out += kv.key().c_str(); out += F("\":");
+    serializeJson(kv.value(), out);
+  }
+  removed = old - matched;
+  f = min(f, (size_t)WS_PATCH_FIELDS);
+  memcpy(hashes, newHashes, f * sizeof(uint32_t));
+  memcpy(keys, newKeys, f * sizeof(uint16_t));
+  wsPatchFields[row] = max(f, (size_t)1);   // a segment without fields is still a segment
+  return n;
+}
+
+// builds the patch message for patch clients from the state just serialized for the broadcast
+static String buildStatePatch(JsonObjectConst state) {
+  const size_t rows = strip.getMaxSegments() + 1;
+  if (!wsPatchHashes) {
+    wsPatchHashes = (uint32_t*) calloc(rows * WS_PATCH_FIELDS, sizeof(uint32_t));
+    wsPatchKeys = (uint16_t*) calloc(rows * WS_PATCH_FIELDS, sizeof(uint16_t));
+    wsPatchFields = (uint8_t*) calloc(rows, 1);
+    if (!wsPatchHashes || !wsPatchKeys || !wsPatchFields) {
+      freePatchHashes();
+      return String();
+    }
+  }
+  String out;
+  out.reserve(256);
+  out = F("{\"patch\":{");
+  size_t removed;
+  size_t changes = appendChangedFields(out, state, 0, false, removed, "seg");
+  if (removed) {
+    // top level keys that are gone: "key":null
+    int from = 0, to;
+    while ((to = wsPatchTopKeys.indexOf(',', from + 1)) > 0) {
+      String key = wsPatchTopKeys.substring(from + 1, to);
+      from = to;
+      if (state.containsKey(key)) continue;
+      if (changes++) out += ',';
+      out += '"'; out += key; out += F("\":null");
+    }
+  }
+  wsPatchTopKeys = ",";
+  for (JsonPairConst kv : state) {
+    if (strcmp(kv.key().c_str(), "seg") == 0) continue;
+    wsPatchTopKeys += kv.key().c_str(); wsPatchTopKeys += ',';
+  }
+
+  String segs;
+  bool present[WLED_MAX_SEGMENTS+1] = {false};
+  for (JsonObjectConst seg : state["seg"].as<JsonArrayConst>()) {
+    unsigned id = seg["id"] | 0U;
+    if (id + 1 >= rows) continue;
+    present[id] = true;
+    bool all = !wsPatchFields[id+1];   // new segment
+    String fields = F("{");
+    size_t n = appendChangedFields(fields, seg, id+1, all, removed);
+    if (removed) {
+      // a field is gone: remove the segment and send it again
+      fields = F("{");
+      n = appendChangedFields(fields, seg, id+1, true, removed);
+      if (segs.length()) segs += ',';
+      segs += F("{\"id\":"); segs += id; segs += F(",\"stop\":0}");
+      all = true;
+    }
+    if (n) {
+      if (!all) { fields += F(",\"id\":"); fields += id; }  // "id" never changes, so add it to partial updates
+      if (segs.length()) segs += ',';
+      segs += fields; segs += '}';
+    }
+  }
+  for (size_t id = 0; id + 1 < rows && id < WLED_MAX_SEGMENTS; id++) {
+    if (present[id] || !wsPatchFields[id+1]) continue;
+    wsPatchFields[id+1] = 0;
+    if (segs.length()) segs += ',';
+    segs += F("{\"id\":"); segs += id; segs += F(",\"stop\":0}");
+  }
+  if (segs.length()) {
+    if (changes++) out += ',';
+    out += F("\"seg\":["); out += segs; out += ']';
+  }
+  if (!changes) return String();
+  out += F("}}");
+  return out;
+}
+
 void sendDataWs(AsyncWebSocketClient * client)
 {
   DEBUG_PRINTF("sendDataWs\n");
   if (!ws.count()) return;
 
+  // WLEDMM single client, state unchanged: reuse the last message, without waiting for the JSON buffer
+  if (client) {
+    AsyncWebSocketSharedBuffer cached;
+    WSStateLock();
+    if (wsStateBuffer && wsStateRev == stateRevision && millis() - wsStateTime < WS_STATE_CACHE_MS) cached = wsStateBuffer;
+    WSStateUnlock();
+    if (cached) {
+      client->text(cached);
+      wsBytesSent += cached.size();
+      wsCacheHits++;
+      return;
+    }
+  }
+
   if (!requestJSONBufferLock(12)) {
     if (client) {
       client->text(F("{\"error\":3}")); // ERR_NOBUF
@@ -133,12 +324,16 @@ void sendDataWs(AsyncWebSocketClient * client)
   DEBUG_PRINT(F("heap ")); DEBUG_PRINTLN(ESP.getFreeHeap());
   if (len>heap1) {
     DEBUG_PRINTLN(F("Out of memory (WS)!"));
+    releaseJSONBufferLock();
     return;
   }
   #else
     // DEBUG_PRINTF("%s min free stack %d\n", pcTaskGetTaskName(NULL), uxTaskGetStackHighWaterMark(NULL)); //WLEDMM
   #endif
-  if (len < 1) return; // WLEDMM do not allocate 0 size buffer
+  if (len < 1) { releaseJSONBufferLock(); return; } // WLEDMM do not allocate 0 size buffer
+  WSStateLock();
+  wsStateBuffer = AsyncWebSocketSharedBuffer(); // WLEDMM drop our reference to the previous message first
+  WSStateUnlock();
   AsyncWebSocketBuffer buffer(len);
   #ifdef ESP8266
   size_t heap2 = ESP.getFreeHeap();
@@ -156,19 +351,100 @@ void sendDataWs(AsyncWebSocketClient * client)
     return; //out of memory
   }
   serializeJson(doc, (char *)buffer.data(), len);
+  AsyncWebSocketSharedBuffer message(std::move(buffer));
+  WSStateLock();
+  #ifndef ESP8266
+  wsStateBuffer = message;  // ESP8266: not enough heap to keep the message around after it was sent
+  #endif
+  wsStateTime = millis();
+  wsStateRev = stateRevision;
+  WSStateUnlock();
 
   DEBUG_PRINT(F("Sending WS data "));
   if (client) {
-    client->text(std::move(buffer));
+    client->text(message);
+    wsBytesSent += len;
     DEBUG_PRINTLN(F("to a single client."));
   } else {
-    ws.textAll(std::move(buffer));
+    wsBroadcasts++;
+    // copy of the client table, so the WS event callbacks don't wait while messages are queued
+    uint32_t ids[WS_TRACKED_CLIENTS];
+    bool patchClient[WS_TRACKED_CLIENTS];
+    WSStateLock();
+    memcpy(ids, wsClientIds, sizeof(ids));
+    memcpy(patchClient, wsClientPatch, sizeof(patchClient));
+    const bool patchClients = wsPatchClients > 0;
+    WSStateUnlock();
+    size_t tracked = 0;
+    for (size_t i = 0; i < WS_TRACKED_CLIENTS; i++) if (ids[i]) tracked++;
+    String patch;
+    if (patchClients && tracked == ws.count()) patch = buildStatePatch(state);
+    else if (wsPatchHashes) freePatchHashes(); // next patch starts from scratch
+
+    if (!wsPatchHashes) {
+      ws.textAll(message);
+      wsBytesSent += len * ws.count();
+    } else {
+      // per client: full message or patch (nothing if the broadcast did not change the state)
+      for (size_t i = 0; i < WS_TRACKED_CLIENTS; i++) {
+        AsyncWebSocketClient* c = ids[i] ? ws.client(ids[i]) : nullptr;  // nullptr if it disconnected meanwhile
+        if (!c) continue;
+        if (!patchClient[i]) { c->text(message); wsBytesSent += len; }
+        else if (patch.length()) { c->text(patch); wsBytesSent += patch.length(); wsPatchesSent++; }
+      }
+    }
     DEBUG_PRINTLN(F("to multiple clients."));
   }
 
   releaseJSONBufferLock();
 }
 
+// WLEDMM applies one JSON message of a WS client. From the WS callback (queued=false) the message is queued for loop()
+// if the JSON buffer is in use; from handleQueuedJson() (queued=true) false means "still busy, keep it queued".
+bool handleWsJson(AsyncWebSocketClient * client, uint8_t* data, size_t len, bool queued)
+{
+  if (!client) return true; // disconnected meanwhile
+  bool verboseResponse = false;
+  if (!tryRequestJSONBufferLock(11)) {
+    if (queued) return false;
+    if (!queueJsonCommand(data, len, client->id())) client->text(F("{\"error\":3}")); // ERR_NOBUF
+    return true;
+  }
+
+  DeserializationError error = deserializeJson(doc, data, len);
+  JsonObject root = doc.as<JsonObject>();
+  if (error || root.isNull()) {
+    releaseJSONBufferLock();
+    return true;
+  }
+  if (root["v"] && root.size() == 1) {
+    //if the received value is just "{"v":true}", send only to this client
+    verboseResponse = true;
+  } else if (root["patch"] && root.size() == 1) {
+    //WLEDMM {"patch":true}: full state now, only changed state fields with later broadcasts
+    verboseResponse = setWsClientPatch(client->id());
+  } else if (root.containsKey("lv")) {
+    wsLiveClientId = root["lv"] ? client->id() : 0;
+    wsLiveVersion = (root["lv"].is<int>() && root["lv"].as<int>() >= 3) ? 3 : 1; // WLEDMM {"lv":3} requests delta frames
+    wsLiveKeyframe = true;
+  } else {
+    verboseResponse = deserializeState(root);
+  }
+  releaseJSONBufferLock(); // will clean fileDoc
+
+  if (!interfaceUpdateCallMode) { // individual client response only needed if no WS broadcast soon
+    if (verboseResponse) {
+      sendDataWs(client);
+    } else {
+      // we have to send something back otherwise WS connection closes
+      client->text(F("{\"success\":true}"));
+    }
+    // force broadcast in 500ms after updating client
+    //lastInterfaceUpdate = millis() - (INTERFACE_UPDATE_COOLDOWN -500); // ESP8266 does not like this
+  }
+  return true;
+}
+
 // WLEDMM function to recover full-bright pixel (based on code from upstream alt-buffer, which is based on code from NeoPixelBrightnessBus)
 static uint32_t restoreColorLossy(uint32_t c, uint_fast8_t _restaurationBri) {
   if (_restaurationBri == 255) return c;
@@ -181,11 +457,24 @@ static uint32_t restoreColorLossy(uint32_t c, uint_fast8_t _restaurationBri) {
   return c;
 }
 
-static bool sendLiveLedsWs(uint32_t wsClient)  // WLEDMM added "static"
-{
-  AsyncWebSocketClient * wsc = ws.client(wsClient);
-  if (!wsc || wsc->queueLength() > 0) return false; //only send if queue free
+// WLEDMM preview color of one pixel, white channel is added to RGB as a simple RGBW -> RGB map
+static inline void livePixelRGB(uint32_t c, uint8_t* rgb) {
+  if (gammaCorrectPreview) {
+    uint8_t w = W(c);  // not sure why, but it looks better if using "white" without corrections
+    if (w>0) c = color_add(c, RGBW32(w, w, w, 0), false); // add white channel to RGB channels - color_add() will prevent over-saturation
+    rgb[0] = unGamma8(R(c));
+    rgb[1] = unGamma8(G(c));
+    rgb[2] = unGamma8(B(c));
+  } else {
+    uint8_t w = W(c);
+    rgb[0] = qadd8(w, R(c));
+    rgb[1] = qadd8(w, G(c));
+    rgb[2] = qadd8(w, B(c));
+  }
+}
 
+static bool sendLiveLedsWsLegacy(AsyncWebSocketClient * wsc)  // v1 (1D) and v2 (2D) raw RGB frames
+{
   #ifdef ARDUINO_ARCH_ESP32
   static unsigned long ws_delay = 0;
   if ((ws_delay > 0) && (millis() - ws_delay < 6000)) return false; // out of memory -> suspend for 6 seconds 
@@ -264,29 +553,190 @@ static bool sendLiveLedsWs(uint32_t wsClient)  // WLEDMM added "static"
   #endif
     uint32_t c = restoreColorLossy(strip.getPixelColor(i), stripBrightness); // WLEDMM full bright preview - does _not_ recover ABL reductions
     //uint32_t c = strip.getPixelColorRestored(i);
-    // WLEDMM begin: preview with color gamma correction
-    if (gammaCorrectPreview) {
-      uint8_t w = W(c);  // not sure why, but it looks better if using "white" without corrections
-      if (w>0) c = color_add(c, RGBW32(w, w, w, 0), false); // add white channel to RGB channels - color_add() will prevent over-saturation
-      buffer[pos++] = unGamma8(R(c)); //R
-      buffer[pos++] = unGamma8(G(c)); //G
-      buffer[pos++] = unGamma8(B(c)); //B
-    } else {
-    // WLEDMM end
-      uint8_t w = W(c);  // WLEDMM small optimization
-      buffer[pos++] = qadd8(w, R(c)); //R, add white channel to RGB channels as a simple RGBW -> RGB map
-      buffer[pos++] = qadd8(w, G(c)); //G
-      buffer[pos++] = qadd8(w, B(c)); //B
+    livePixelRGB(c, buffer + pos); // WLEDMM preview with color gamma correction
+    pos += 3;
+  }
+
+  wsc->binary(std::move(wsBuf));
+  return true;
+}
+
+/*
+ * WLEDMM live preview v3, requested by the client with {"lv":3}
+ *   [0] 'L'  [1] 3  [2..3] width  [4..5] height (0 = 1D strip), both big endian  [6] flags (bit 0 = keyframe)  [7..] ops
+ * ops encode the difference to the previously sent frame with the op bytes of compressed DDP (ddp_codec.h):
+ * SKIP (pixels unchanged), LITERAL (RGB values follow), REPEAT (one RGB value for count pixels).
+ * A frame without changes is not sent at all, a keyframe follows every (re)subscription and size change.
+ */
+#define WS_LIVE_V3_HEADER   7
+#define WS_LIVE_RUN_MAX     (64 + 0xFFFF)   // longest SKIP/REPEAT op
+#define WS_LIVE_LITERAL_MAX 63              // literal runs are capped so their op byte can be patched in place
+
+static uint8_t* liveFrame = nullptr;        // RGB of the previously sent frame
+static uint8_t* liveScratch = nullptr;      // encoder output, reused for every frame
+static size_t   livePixels = 0;
+static size_t   liveScratchSize = 0;
+
+static void freeLiveFrame() {
+  free(liveFrame);   liveFrame = nullptr;
+  free(liveScratch); liveScratch = nullptr;
+  livePixels = liveScratchSize = 0;
+}
+
+static uint8_t* allocLiveBuffer(size_t size) {
+  #if defined(ARDUINO_ARCH_ESP32) && defined(BOARD_HAS_PSRAM)
+  if (psramFound()) return (uint8_t*) ps_malloc(size);
+  #endif
+  return (uint8_t*) malloc(size);
+}
+
+static inline size_t liveEncodeOp(uint8_t* out, uint8_t op, uint32_t count) {  // count >= 1
+  if (count < 64) { out[0] = op | (count - 1); return 1; }
+  count -= 64;
+  out[0] = op | DDPZ_COUNT_MASK;
+  out[1] = count >> 8;
+  out[2] = count & 0xFF;
+  return 3;
+}
+
+static bool sendLiveLedsWsV3(AsyncWebSocketClient * wsc)
+{
+  #ifdef ESP8266
+  const size_t maxLeds = 256U;
+  #elif defined(BOARD_HAS_PSRAM)
+  const size_t maxLeds = psramFound() ? 32768U : 4096U; // full resolution for large matrices if frames can live in PSRAM
+  #else
+  const size_t maxLeds = 4096U;
+  #endif
+
+  // frame geometry, every n'th pixel in both directions if there are too many
+  size_t width = strip.getLengthTotal(), height = 0, n = 1, rowStep = 0;
+  #ifndef WLED_DISABLE_2D
+  if (strip.isMatrix) {
+    while ((Segment::maxWidth/n) * (Segment::maxHeight/n) > maxLeds) n++;
+    width = Segment::maxWidth/n;
+    height = Segment::maxHeight/n;
+    rowStep = Segment::maxWidth * n;
+  } else
+  #endif
+  {
+    n = ((width -1)/maxLeds) +1;
+    width = width/n;
+  }
+  const size_t pixels = width * max(height, (size_t)1);
+  if (pixels < 1) return false;
+
+  bool keyframe = wsLiveKeyframe;
+  wsLiveKeyframe = false;
+  if (pixels != livePixels || !liveFrame) {
+    freeLiveFrame();
+    liveScratchSize = WS_LIVE_V3_HEADER + pixels*3 + pixels/WS_LIVE_LITERAL_MAX + 4; // worst case: literal runs only
+    liveFrame = allocLiveBuffer(pixels*3);
+    liveScratch = allocLiveBuffer(liveScratchSize);
+    if (!liveFrame || !liveScratch) {
+      freeLiveFrame();
+      USER_PRINTF("WS live preview: buffer allocation failed (%u pixels).\n", pixels);
+      errorFlag = ERR_LOW_WS_MEM;
+      wsLiveBackoff = WS_LIVE_BACKOFF_MAX; // retry slowly
+      return false;
     }
+    livePixels = pixels;
+    keyframe = true;
   }
+  static uint32_t lastShape = 0;
+  if (((width << 16) | height) != lastShape) keyframe = true;  // same pixel count, different shape
+  lastShape = (width << 16) | height;
+
+  uint8_t* out = liveScratch;
+  size_t   pos = WS_LIVE_V3_HEADER;
+  uint8_t  runOp = 0xFF;      // pending op, none
+  uint32_t runCount = 0;
+  size_t   litPos = 0;        // position of the pending literal op byte
+  uint8_t  runRGB[3] = {0};   // value of the pending repeat, or last pixel of the pending literal
+  bool     changed = keyframe;
+
+  auto flush = [&]() {
+    if (runOp == DDPZ_OP_LITERAL) out[litPos] = DDPZ_OP_LITERAL | (runCount - 1);
+    else if (runOp == DDPZ_OP_SKIP || runOp == DDPZ_OP_REPEAT) {
+      pos += liveEncodeOp(out + pos, runOp, runCount);
+      if (runOp == DDPZ_OP_REPEAT) { memcpy(out + pos, runRGB, 3); pos += 3; }
+    }
+    runOp = 0xFF;
+    runCount = 0;
+  };
+
+  const uint8_t stripBrightness = strip.getBrightness();
+  uint8_t* prev = liveFrame;
+  for (size_t y = 0; y < max(height, (size_t)1); y++) {
+    for (size_t x = 0; x < width; x++, prev += 3) {
+      uint8_t rgb[3];
+      livePixelRGB(restoreColorLossy(strip.getPixelColor(y*rowStep + x*n), stripBrightness), rgb); // WLEDMM full bright preview - does _not_ recover ABL reductions
 
+      if (!keyframe && memcmp(prev, rgb, 3) == 0) {
+        if (runOp != DDPZ_OP_SKIP || runCount >= WS_LIVE_RUN_MAX) { flush(); runOp = DDPZ_OP_SKIP; }
+        runCount++;
+        continue;
+      }
+      memcpy(prev, rgb, 3);
+      changed = true;
+
+      const bool sameAsRun = memcmp(runRGB, rgb, 3) == 0;
+      if (runOp == DDPZ_OP_REPEAT && sameAsRun && runCount < WS_LIVE_RUN_MAX) {
+        runCount++;
+      } else if (runOp == DDPZ_OP_LITERAL && sameAsRun) {
+        // last literal pixel starts a repeat
+        pos -= 3;
+        if (--runCount) out[litPos] = DDPZ_OP_LITERAL | (runCount - 1);
+        else pos--;  // literal op became empty
+        runOp = DDPZ_OP_REPEAT;
+        runCount = 2;
+      } else if (runOp == DDPZ_OP_LITERAL && runCount < WS_LIVE_LITERAL_MAX) {
+        memcpy(out + pos, rgb, 3); pos += 3;
+        memcpy(runRGB, rgb, 3);
+        runCount++;
+      } else {
+        flush();
+        runOp = DDPZ_OP_LITERAL;
+        litPos = pos++;
+        memcpy(out + pos, rgb, 3); pos += 3;
+        memcpy(runRGB, rgb, 3);
+        runCount = 1;
+      }
+    }
+  }
+  if (runOp != DDPZ_OP_SKIP) flush(); // trailing unchanged pixels need no op
+  if (!changed) return true;          // nothing to send
+
+  out[0] = 'L';
+  out[1] = 3; //version
+  out[2] = width >> 8;  out[3] = width & 0xFF;
+  out[4] = height >> 8; out[5] = height & 0xFF;
+  out[6] = keyframe ? DDPZ_FLAG_KEYFRAME : 0;
+
+  AsyncWebSocketBuffer wsBuf(pos);  // the WS library owns sent buffers, so only the (small) encoded frame is allocated per send
+  if (!wsBuf || !wsBuf.data()) {
+    wsLiveKeyframe = true;  // liveFrame is ahead of the client now
+    errorFlag = ERR_LOW_WS_MEM;
+    return false;
+  }
+  memcpy(wsBuf.data(), out, pos);
   wsc->binary(std::move(wsBuf));
   return true;
 }
 
+static bool sendLiveLedsWs(uint32_t wsClient)  // WLEDMM added "static"
+{
+  AsyncWebSocketClient * wsc = ws.client(wsClient);
+  if (!wsc || wsc->queueLength() > 0) return false; //only send if queue free
+  if (wsLiveVersion >= 3) return sendLiveLedsWsV3(wsc);
+  return sendLiveLedsWsLegacy(wsc);
+}
+
 void handleWs()
 {
-  if ((millis() - wsLastLiveTime) > (unsigned long)(max(WS_LIVE_INTERVAL_MIN, min((strip.getLengthTotal()/80), WS_LIVE_INTERVAL_MAX)))) //WLEDMM dynamic nr of peek frames per second
+  // WLEDMM adaptive rate: back off while the client queue is not drained, speed up again once it keeps up
+  unsigned long interval = max(WS_LIVE_INTERVAL_MIN, min((strip.getLengthTotal()/80), WS_LIVE_INTERVAL_MAX)); //WLEDMM dynamic nr of peek frames per second
+  if ((millis() - wsLastLiveTime) > interval + wsLiveBackoff)
   {
     #ifdef ESP8266
     ws.cleanupClients(3);
@@ -295,13 +745,16 @@ void handleWs()
     #endif
     bool success = true;
     if (wsLiveClientId) success = sendLiveLedsWs(wsLiveClientId);
+    else if (liveFrame) freeLiveFrame();
     wsLastLiveTime = millis();
-    if (!success) wsLastLiveTime -= 20; //try again in 20ms if failed due to non-empty WS queue
+    if (success) wsLiveBackoff = (wsLiveBackoff > 4) ? wsLiveBackoff - wsLiveBackoff/4 : 0;
+    else wsLiveBackoff = min(unsigned(wsLiveBackoff) + 20U, unsigned(WS_LIVE_BACKOFF_MAX));  // slow down in 20ms steps while the WS queue is busy
   }
 }
 
 #else
 void handleWs() {}
 void sendDataWs(AsyncWebSocketClient * client) {}
+bool handleWsJson(AsyncWebSocketClient * client, uint8_t* data, size_t len, bool queued) { return true; }
 #pragma message "WebSockets disabled - no live preview."
 #endif
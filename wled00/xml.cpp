@@ -295,8 +295,10 @@ void getSettingsJS(AsyncWebServerRequest* request, byte subPage, char* dest) //W
   //0: menu 1: wifi 2: leds 3: ui 4: sync 5: time 6: sec
   DEBUG_PRINT(F("settings resp"));
   DEBUG_PRINTLN(subPage);
-  obuf = dest;
-  olen = 0;
+  if (dest) { // WLEDMM nullptr continues the current output, see oappendBegin()
+    obuf = dest;
+    olen = 0;
+  }
 
   if (subPage <0 || subPage >10) return;
 
@@ -587,6 +589,8 @@ void getSettingsJS(AsyncWebServerRequest* request, byte subPage, char* dest) //W
     sappend('c',SET_F("MO"),useMainSegmentOnly);
     sappend('v',SET_F("EP"),e131Port);
     sappend('c',SET_F("ES"),e131SkipOutOfSequence);
+    sappend('c',SET_F("EF"),e131FrameSync);
+    sappend('v',SET_F("EFT"),e131FrameTimeout);
     sappend('c',SET_F("EM"),e131Multicast);
     sappend('v',SET_F("EU"),e131Universe);
 #ifdef WLED_ENABLE_DMX